@@ -163,18 +163,25 @@ static const char *RcsId = "$Id$";
 //  DbGetClassPipePropertyHist            |  db_get_class_pipe_property_hist
 //  DbGetDevicePipePropertyHist           |  db_get_device_pipe_property_hist
 //  DbGetForwardedAttributeListForDevice  |  db_get_forwarded_attribute_list_for_device
+//  DbGetDataForServerCacheRaw            |  db_get_data_for_server_cache_raw
+//  DbGetDataForServerCacheList           |  db_get_data_for_server_cache_list
+//  DbGetDataForServerCacheDelta          |  db_get_data_for_server_cache_delta
+//  DbGetDataForServerCacheCompressed     |  db_get_data_for_server_cache_compressed
+//  DbGetDataForServerCacheChunk          |  db_get_data_for_server_cache_chunk
+//  GetTimingHistogram                    |  get_timing_histogram
+//  GetSqlProfile                         |  get_sql_profile
 //================================================================
 
 //================================================================
 //  Attributes managed are:
 //================================================================
 //  StoredProcedureRelease  |  Tango::DevString	Scalar
-//  Timing_average          |  Tango::DevDouble	Spectrum  ( max = 64)
-//  Timing_minimum          |  Tango::DevDouble	Spectrum  ( max = 64)
-//  Timing_maximum          |  Tango::DevDouble	Spectrum  ( max = 64)
-//  Timing_calls            |  Tango::DevDouble	Spectrum  ( max = 64)
-//  Timing_index            |  Tango::DevString	Spectrum  ( max = 64)
-//  Timing_info             |  Tango::DevString	Spectrum  ( max = 64)
+//  Timing_average          |  Tango::DevDouble	Spectrum  ( max = number of timed commands)
+//  Timing_minimum          |  Tango::DevDouble	Spectrum  ( max = number of timed commands)
+//  Timing_maximum          |  Tango::DevDouble	Spectrum  ( max = number of timed commands)
+//  Timing_calls            |  Tango::DevDouble	Spectrum  ( max = number of timed commands)
+//  Timing_index            |  Tango::DevString	Spectrum  ( max = number of timed commands)
+//  Timing_info             |  Tango::DevString	Spectrum  ( max = number of timed commands + 4)
 //================================================================
 
 namespace DataBase_ns
@@ -255,19 +262,62 @@ void DataBase::delete_device()
 	delete [] timing_stats_minimum;
 	delete [] timing_stats_maximum;
 	delete [] timing_stats_calls;
+	delete [] attr_Timing_p50_read;
+	delete [] attr_Timing_p90_read;
+	delete [] attr_Timing_p99_read;
+	delete [] attr_Timing_p999_read;
 
-	for (unsigned int i = 0;i < timing_stats_map.size();i++)
+	for (int i = 0;i < timing_stats_size;i++)
 		free(timing_stats_index[i]);
 	delete [] timing_stats_index;
 
-	std::map<std::string,TimingStatsStruct*>::iterator iter;
-	for (iter = timing_stats_map.begin(); iter != timing_stats_map.end(); iter++)
-		delete iter->second;
+	delete [] attr_Pool_in_use_read;
+	delete [] attr_Pool_waiters_read;
+	delete [] attr_Pool_size_read;
+	delete [] attr_Pool_wait_histo_read;
+	delete [] attr_Pool_wait_index_read;
+	delete [] attr_History_queue_depth_read;
+	delete [] attr_History_queue_lag_read;
 
-	for (int loop = 0;loop < conn_pool_size;loop++)
+	if (metrics_server != NULL)
+	{
+		metrics_server->stop();
+		metrics_server->join(NULL);
+		metrics_server = NULL;
+	}
+
+	// The storage engine may still have to write in MySQL
+	delete storage;
+	storage = NULL;
+
+	if (hist_writer != NULL)
+	{
+		hist_queue.stop();
+		hist_writer->join(NULL);
+		hist_writer = NULL;
+	}
+
+	if (hist_purger != NULL)
+	{
+		purge_queue.stop();
+		hist_purger->join(NULL);
+		hist_purger = NULL;
+	}
+
+	if (pool_maintainer != NULL)
+	{
+		pool.stop();
+		pool_maintainer->join(NULL);
+		pool_maintainer = NULL;
+	}
+
+	for (int loop = 0;loop <= conn_pool_size;loop++)
 	{
 		if (conn_pool[loop].db != NULL)
+		{
+			close_stmts(loop);
 			mysql_close(conn_pool[loop].db);
+		}
 	}
 	delete [] conn_pool;
 
@@ -286,6 +336,15 @@ void DataBase::init_device()
 	/*----- PROTECTED REGION ID(DataBase::init_device_before) ENABLED START -----*/
 
 	//	Initialization before get_device_property() call
+	attr_Pool_in_use_read = new Tango::DevLong[1];
+	attr_Pool_waiters_read = new Tango::DevLong[1];
+	attr_Pool_size_read = new Tango::DevLong[1];
+	attr_Pool_wait_histo_read = new Tango::DevDouble[POOL_WAIT_HISTO_SIZE];
+	attr_Pool_wait_index_read = new Tango::DevString[POOL_WAIT_HISTO_SIZE];
+	attr_History_queue_depth_read = new Tango::DevLong[1];
+	attr_History_queue_lag_read = new Tango::DevDouble[1];
+	for (int i = 0;i < POOL_WAIT_HISTO_SIZE;i++)
+		attr_Pool_wait_index_read[i] = const_cast<char *>(ConnPool::get_wait_histo_label(i));
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::init_device_before
 	
@@ -349,14 +408,30 @@ void DataBase::init_device()
 
 //
 // Create the connection pool after some initialisation
+// One more connection (not used by get_connection()) is dedicated
+// to the history identifiers
 //
 
-	conn_pool = new DbConnection[conn_pool_size];
-	for (int loop = 0;loop < conn_pool_size;loop++)
+	conn_pool = new DbConnection[conn_pool_size + 1];
+	for (int loop = 0;loop <= conn_pool_size;loop++)
+	{
 		conn_pool[loop].db = NULL;
+		for (int i = 0;i < STMT_NB;i++)
+			conn_pool[loop].stmt[i] = NULL;
+	}
+	id_con_nb = conn_pool_size;
+	pool_maintainer = NULL;
+	hist_purger = NULL;
+	hist_writer = NULL;
+	metrics_server = NULL;
 	mysql_svr_version = 0;
+	transactional_engine = false;
+	max_insert_size = DEFAULT_MAX_INSERT_SIZE;
+	storage = new MySqlStorage(this);
 
 	create_connection_pool(mysql_user,mysql_password,mysql_host,mysql_name);
+	check_table_engine();
+	read_max_allowed_packet();
 
 //
 // Do we need to propagate info to Starter
@@ -460,10 +535,137 @@ void DataBase::init_device()
 	catch(Tango::DevFailed &)
 	{}
 
+	// Load import cache timeout property (in seconds, 0 disables the cache)
+	int import_cache_timeout = get_long_property("importCacheTimeout",DEFAULT_IMPORT_CACHE_TIMEOUT);
+	device_cache.set_timeout(import_cache_timeout);
+	event_cache.set_timeout(import_cache_timeout);
+	WARN_STREAM << "importCacheTimeout = " << import_cache_timeout << std::endl;
+
+	// Load DbGetDataForServerCache cache timeout property (in seconds, 0 disables the cache)
+	int server_cache_timeout = get_long_property("serverCacheTimeout",DEFAULT_SERVER_CACHE_TIMEOUT);
+	server_cache.set_timeout(server_cache_timeout);
+	server_versions.set_instance(device_name);
+	WARN_STREAM << "serverCacheTimeout = " << server_cache_timeout << std::endl;
+
+	// Load DbGetDataForServerCacheDelta memory limit property (in MB, for the data
+	// kept to compute the changes, 0 means always send the full data)
+	long server_versions_size = get_long_property("serverVersionsSize",DEFAULT_SERVER_VERSIONS_SIZE);
+	server_versions.set_max_size(server_versions_size);
+	WARN_STREAM << "serverVersionsSize = " << server_versions_size << std::endl;
+
+	// Load DbGetDataForServerCache engine properties (dsStartNative: 0 = ds_start stored
+	// procedure, 1 = C++ implementation using at most dsStartFanOut MySQL connections)
+	native_ds_start = get_long_property("dsStartNative",DEFAULT_DS_START_NATIVE) != 0;
+	ds_start_fan_out = get_long_property("dsStartFanOut",DEFAULT_DS_START_FAN_OUT);
+	if (ds_start_fan_out < 1)
+		ds_start_fan_out = 1;
+	WARN_STREAM << "dsStartNative = " << native_ds_start << ", dsStartFanOut = " << ds_start_fan_out << std::endl;
+
+	// Load MySQL connection acquire timeout property (in ms, 0 means wait for ever)
+	long pool_acquire_timeout = get_long_property("poolAcquireTimeout",DEFAULT_POOL_ACQUIRE_TIMEOUT);
+	pool.set_timeout(pool_acquire_timeout);
+	WARN_STREAM << "poolAcquireTimeout = " << pool_acquire_timeout << std::endl;
+
+	// Load MySQL connection pool minimum size and idle timeout (in seconds, 0 means never close)
+	// properties. The pool maximum size is given by the -poolSize option
+	long pool_min_size = get_long_property("poolMinSize",DEFAULT_POOL_MIN_SIZE);
+	if (pool_min_size < 1)
+		pool_min_size = 1;
+	if (pool_min_size > conn_pool_size)
+		pool_min_size = conn_pool_size;
+	long pool_idle_timeout = get_long_property("poolIdleTimeout",DEFAULT_POOL_IDLE_TIMEOUT);
+	pool.set_min_size(pool_min_size);
+	pool.set_idle_timeout(pool_idle_timeout);
+	WARN_STREAM << "poolMinSize = " << pool_min_size << ", poolIdleTimeout = " << pool_idle_timeout << std::endl;
+
+	// Start the thread opening/closing MySQL connections
+	pool_maintainer = new PoolMaintainer(this,&pool);
+	pool_maintainer->start();
+
+	// Load history purge period property (in seconds). With 0, the put commands
+	// purge the history tables themselves
+	long history_purge_period = get_long_property("historyPurgePeriod",DEFAULT_HISTORY_PURGE_PERIOD);
+	if (history_purge_period > 0)
+	{
+		purge_queue.init();
+		hist_purger = new HistoryPurger(this,&purge_queue,history_purge_period);
+		hist_purger->start();
+	}
+	WARN_STREAM << "historyPurgePeriod = " << history_purge_period << std::endl;
+
+	// Load history write delay (in ms, -1 means synchronous, 0 means asynchronous but the
+	// put commands wait for their history to be written) and history queue size properties
+	long history_write_delay = get_long_property("historyWriteDelay",DEFAULT_HISTORY_WRITE_DELAY);
+	long history_queue_size = get_long_property("historyQueueSize",DEFAULT_HISTORY_QUEUE_SIZE);
+	if (history_write_delay >= 0)
+	{
+		hist_queue.init(history_queue_size,history_write_delay);
+		hist_writer = new HistoryWriter(this,&hist_queue);
+		hist_writer->start();
+	}
+	WARN_STREAM << "historyWriteDelay = " << history_write_delay << ", historyQueueSize = " << history_queue_size << std::endl;
+
+	// Load slow SQL statement threshold (in ms, 0 means no slow statement log)
+	long slow_query_threshold = get_long_property("slowQueryThreshold",DEFAULT_SLOW_QUERY_THRESHOLD);
+	sql_profile.set_slow_threshold(slow_query_threshold);
+	WARN_STREAM << "slowQueryThreshold = " << slow_query_threshold << std::endl;
+
+	// Load SQL statement template profiling property (0 = only the per command profile)
+	long sql_profile_templates = get_long_property("sqlProfileTemplates",DEFAULT_SQL_PROFILE_TEMPLATES);
+	sql_profile.set_templates(sql_profile_templates != 0);
+	WARN_STREAM << "sqlProfileTemplates = " << sql_profile_templates << std::endl;
+
 	// Check history tables
 	check_history_tables();
 
+	// Load storage engine properties: The engine (mysql or memory) and, for the memory
+	// one, the directory of its files, the snapshot period (in seconds, 0 means only
+	// at startup), whether the log is synced to disk for every write and how long (in
+	// ms) the commands wait for the writes to be applied to MySQL
+	std::string storage_engine = get_string_property("storageEngine","mysql");
+	transform(storage_engine.begin(),storage_engine.end(),storage_engine.begin(),::tolower);
+	if (storage_engine == "memory")
+	{
+		std::string memory_storage_dir = get_string_property("memoryStorageDir",DEFAULT_MEMORY_STORAGE_DIR);
+		long memory_snapshot_period = get_long_property("memorySnapshotPeriod",DEFAULT_MEMORY_SNAPSHOT_PERIOD);
+		long memory_wal_sync = get_long_property("memoryWalSync",DEFAULT_MEMORY_WAL_SYNC);
+		long memory_sync_timeout = get_long_property("memorySyncTimeout",DEFAULT_MEMORY_SYNC_TIMEOUT);
+		WARN_STREAM << "memoryStorageDir = " << memory_storage_dir << ", memorySnapshotPeriod = " << memory_snapshot_period
+					<< ", memoryWalSync = " << memory_wal_sync << ", memorySyncTimeout = " << memory_sync_timeout << std::endl;
+
+		MemoryStorage *mem_storage = new MemoryStorage(this,storage,memory_storage_dir,memory_snapshot_period,
+													   memory_wal_sync != 0,memory_sync_timeout);
+		try
+		{
+			mem_storage->open();
+			storage = mem_storage;
+		}
+		catch (Tango::DevFailed &e)
+		{
+			ERROR_STREAM << "Memory storage engine not started, using MySQL: " << e.errors[0].desc << std::endl;
+			storage = mem_storage->release_backing();
+			delete mem_storage;
+		}
+	}
+	WARN_STREAM << "storageEngine = " << storage->get_name() << std::endl;
+
 	init_timing_stats();
+
+	// Load metrics endpoint port (0 means no endpoint) and interface (only
+	// the loopback one by default) properties
+	long metrics_port = get_long_property("metricsPort",DEFAULT_METRICS_PORT);
+	long metrics_local_only = get_long_property("metricsLocalOnly",DEFAULT_METRICS_LOCAL_ONLY);
+	WARN_STREAM << "metricsPort = " << metrics_port << ", metricsLocalOnly = " << metrics_local_only << std::endl;
+	if (metrics_port > 0)
+	{
+		metrics_server = new MetricsServer(this,metrics_port,metrics_local_only != 0);
+		if (metrics_server->start() == false)
+		{
+			delete metrics_server;
+			metrics_server = NULL;
+		}
+	}
+
 	stored_release_ptr = &(stored_release[0]);
 	attr_StoredProcedureRelease_read = &stored_release_ptr;
 	set_state(Tango::ON);
@@ -572,24 +774,18 @@ void DataBase::read_StoredProcedureRelease(Tango::Attribute &attr)
  *	Description: 
  *
  *	Data type:	Tango::DevDouble
- *	Attr type:	Spectrum max = 64
+ *	Attr type:	Spectrum max = number of timed commands
  */
 //--------------------------------------------------------
 void DataBase::read_Timing_average(Tango::Attribute &attr)
 {
 	DEBUG_STREAM << "DataBase::read_Timing_average(Tango::Attribute &attr) entering... " << std::endl;
 	/*----- PROTECTED REGION ID(DataBase::read_Timing_average) ENABLED START -----*/
-	std::map<std::string,TimingStatsStruct*>::iterator iter;
-
+	double calls,average,minimum,maximum;
+	for (int i = 0;i < timing_stats_size;i++)
 	{
-		omni_mutex_lock guard(timing_stats_mutex);
-
-		int i = 0;
-		for (iter = timing_stats_map.begin(); iter != timing_stats_map.end(); iter++)
-		{
-			timing_stats_average[i] = iter->second->average;
-			i++;
-		}
+		timing_stats.get(i,calls,average,minimum,maximum);
+		timing_stats_average[i] = average;
 	}
 
 	attr.set_value(timing_stats_average, timing_stats_size);
@@ -602,24 +798,18 @@ void DataBase::read_Timing_average(Tango::Attribute &attr)
  *	Description: 
  *
  *	Data type:	Tango::DevDouble
- *	Attr type:	Spectrum max = 64
+ *	Attr type:	Spectrum max = number of timed commands
  */
 //--------------------------------------------------------
 void DataBase::read_Timing_minimum(Tango::Attribute &attr)
 {
 	DEBUG_STREAM << "DataBase::read_Timing_minimum(Tango::Attribute &attr) entering... " << std::endl;
 	/*----- PROTECTED REGION ID(DataBase::read_Timing_minimum) ENABLED START -----*/
-	std::map<std::string,TimingStatsStruct*>::iterator iter;
-
+	double calls,average,minimum,maximum;
+	for (int i = 0;i < timing_stats_size;i++)
 	{
-		omni_mutex_lock guard(timing_stats_mutex);
-
-		int i = 0;
-		for (iter = timing_stats_map.begin(); iter != timing_stats_map.end(); iter++)
-		{
-			timing_stats_minimum[i] = iter->second->minimum;
-			i++;
-		}
+		timing_stats.get(i,calls,average,minimum,maximum);
+		timing_stats_minimum[i] = minimum;
 	}
 
 	attr.set_value(timing_stats_minimum, timing_stats_size);
@@ -632,24 +822,18 @@ void DataBase::read_Timing_minimum(Tango::Attribute &attr)
  *	Description: 
  *
  *	Data type:	Tango::DevDouble
- *	Attr type:	Spectrum max = 64
+ *	Attr type:	Spectrum max = number of timed commands
  */
 //--------------------------------------------------------
 void DataBase::read_Timing_maximum(Tango::Attribute &attr)
 {
 	DEBUG_STREAM << "DataBase::read_Timing_maximum(Tango::Attribute &attr) entering... " << std::endl;
 	/*----- PROTECTED REGION ID(DataBase::read_Timing_maximum) ENABLED START -----*/
-	std::map<std::string,TimingStatsStruct*>::iterator iter;
-
+	double calls,average,minimum,maximum;
+	for (int i = 0;i < timing_stats_size;i++)
 	{
-		omni_mutex_lock guard(timing_stats_mutex);
-
-		int i = 0;
-		for (iter = timing_stats_map.begin(); iter != timing_stats_map.end(); iter++)
-		{
-			timing_stats_maximum[i] = iter->second->maximum;
-			i++;
-		}
+		timing_stats.get(i,calls,average,minimum,maximum);
+		timing_stats_maximum[i] = maximum;
 	}
 
 	attr.set_value(timing_stats_maximum, timing_stats_size);
@@ -662,24 +846,18 @@ void DataBase::read_Timing_maximum(Tango::Attribute &attr)
  *	Description: 
  *
  *	Data type:	Tango::DevDouble
- *	Attr type:	Spectrum max = 64
+ *	Attr type:	Spectrum max = number of timed commands
  */
 //--------------------------------------------------------
 void DataBase::read_Timing_calls(Tango::Attribute &attr)
 {
 	DEBUG_STREAM << "DataBase::read_Timing_calls(Tango::Attribute &attr) entering... " << std::endl;
 	/*----- PROTECTED REGION ID(DataBase::read_Timing_calls) ENABLED START -----*/
-	std::map<std::string,TimingStatsStruct*>::iterator iter;
-
+	double calls,average,minimum,maximum;
+	for (int i = 0;i < timing_stats_size;i++)
 	{
-		omni_mutex_lock guard(timing_stats_mutex);
-
-		int i = 0;
-		for (iter = timing_stats_map.begin(); iter != timing_stats_map.end(); iter++)
-		{
-			timing_stats_calls[i] = iter->second->calls;
-			i++;
-		}
+		timing_stats.get(i,calls,average,minimum,maximum);
+		timing_stats_calls[i] = calls;
 	}
 
 	attr.set_value(timing_stats_calls, timing_stats_size);
@@ -692,7 +870,7 @@ void DataBase::read_Timing_calls(Tango::Attribute &attr)
  *	Description: 
  *
  *	Data type:	Tango::DevString
- *	Attr type:	Spectrum max = 64
+ *	Attr type:	Spectrum max = number of timed commands
  */
 //--------------------------------------------------------
 void DataBase::read_Timing_index(Tango::Attribute &attr)
@@ -709,7 +887,7 @@ void DataBase::read_Timing_index(Tango::Attribute &attr)
  *	Description: 
  *
  *	Data type:	Tango::DevString
- *	Attr type:	Spectrum max = 64
+ *	Attr type:	Spectrum max = number of timed commands + 4
  */
 //--------------------------------------------------------
 void DataBase::read_Timing_info(Tango::Attribute &attr)
@@ -718,7 +896,7 @@ void DataBase::read_Timing_info(Tango::Attribute &attr)
 	/*----- PROTECTED REGION ID(DataBase::read_Timing_info) ENABLED START -----*/
 	char info_str[256];
 	char hostname[256];
-	Tango::DevString *timing_info = new Tango::DevString[timing_stats_size+4];
+	Tango::DevString *timing_info = new Tango::DevString[timing_stats_size+TIMING_INFO_HEADER];
 
 	gethostname(hostname, sizeof(hostname));
 	sprintf(info_str,"TANGO Database Timing info on host %s",hostname);
@@ -728,26 +906,212 @@ void DataBase::read_Timing_info(Tango::Attribute &attr)
 	timing_info[2] = CORBA::string_dup("command	average	minimum	maximum	calls");
  	timing_info[3] = CORBA::string_dup(" ");
 
-    std::map<std::string,TimingStatsStruct*>::iterator iter;
-
+	double calls,average,minimum,maximum;
+	for (int i = 0;i < timing_stats_size;i++)
 	{
-		omni_mutex_lock guard(timing_stats_mutex);
-		int i = 0;
-	    for (iter = timing_stats_map.begin(); iter != timing_stats_map.end(); iter++)
-	    {
-	    	sprintf(info_str,"%s\t%6.3f\t%6.3f\t%6.3f\t%.0f",
-					iter->first.c_str(), iter->second->average,
-	    			iter->second->minimum, iter->second->maximum,
-					iter->second->calls);
-	        timing_info[i+4] = CORBA::string_dup(info_str);
-	        i++;
-	    }
+		timing_stats.get(i,calls,average,minimum,maximum);
+		sprintf(info_str,"%s\t%6.3f\t%6.3f\t%6.3f\t%.0f",
+				timing_stats_index[i], average, minimum, maximum, calls);
+		timing_info[i+TIMING_INFO_HEADER] = CORBA::string_dup(info_str);
 	}
 
-	attr.set_value(timing_info,timing_stats_size+4,0,true);
+	attr.set_value(timing_info,timing_stats_size+TIMING_INFO_HEADER,0,true);
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::read_Timing_info
 }
+//--------------------------------------------------------
+/**
+ *	Read attribute Pool_in_use related method
+ *	Description: Number of MySQL connections in use
+ *
+ *	Data type:	Tango::DevLong
+ *	Attr type:	Scalar
+ */
+//--------------------------------------------------------
+void DataBase::read_Pool_in_use(Tango::Attribute &attr)
+{
+	DEBUG_STREAM << "DataBase::read_Pool_in_use(Tango::Attribute &attr) entering... " << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::read_Pool_in_use) ENABLED START -----*/
+	*attr_Pool_in_use_read = pool.get_nb_in_use();
+	attr.set_value(attr_Pool_in_use_read);
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::read_Pool_in_use
+}
+//--------------------------------------------------------
+/**
+ *	Read attribute Pool_waiters related method
+ *	Description: Number of requests waiting for a free MySQL connection
+ *
+ *	Data type:	Tango::DevLong
+ *	Attr type:	Scalar
+ */
+//--------------------------------------------------------
+void DataBase::read_Pool_waiters(Tango::Attribute &attr)
+{
+	DEBUG_STREAM << "DataBase::read_Pool_waiters(Tango::Attribute &attr) entering... " << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::read_Pool_waiters) ENABLED START -----*/
+	*attr_Pool_waiters_read = pool.get_nb_waiters();
+	attr.set_value(attr_Pool_waiters_read);
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::read_Pool_waiters
+}
+//--------------------------------------------------------
+/**
+ *	Read attribute Pool_wait_histo related method
+ *	Description: Histogram of the time spent to get a MySQL connection (see Pool_wait_index)
+ *
+ *	Data type:	Tango::DevDouble
+ *	Attr type:	Spectrum max = 8
+ */
+//--------------------------------------------------------
+void DataBase::read_Pool_wait_histo(Tango::Attribute &attr)
+{
+	DEBUG_STREAM << "DataBase::read_Pool_wait_histo(Tango::Attribute &attr) entering... " << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::read_Pool_wait_histo) ENABLED START -----*/
+	pool.get_wait_histo(attr_Pool_wait_histo_read);
+	attr.set_value(attr_Pool_wait_histo_read,POOL_WAIT_HISTO_SIZE);
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::read_Pool_wait_histo
+}
+//--------------------------------------------------------
+/**
+ *	Read attribute Pool_wait_index related method
+ *	Description: Pool_wait_histo buckets
+ *
+ *	Data type:	Tango::DevString
+ *	Attr type:	Spectrum max = 8
+ */
+//--------------------------------------------------------
+void DataBase::read_Pool_wait_index(Tango::Attribute &attr)
+{
+	DEBUG_STREAM << "DataBase::read_Pool_wait_index(Tango::Attribute &attr) entering... " << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::read_Pool_wait_index) ENABLED START -----*/
+	attr.set_value(attr_Pool_wait_index_read,POOL_WAIT_HISTO_SIZE);
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::read_Pool_wait_index
+}
+//--------------------------------------------------------
+/**
+ *	Read attribute Pool_size related method
+ *	Description: Number of MySQL connections currently opened in the pool (between poolMinSize and the -poolSize option)
+ *
+ *	Data type:	Tango::DevLong
+ *	Attr type:	Scalar
+ */
+//--------------------------------------------------------
+void DataBase::read_Pool_size(Tango::Attribute &attr)
+{
+	DEBUG_STREAM << "DataBase::read_Pool_size(Tango::Attribute &attr) entering... " << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::read_Pool_size) ENABLED START -----*/
+	*attr_Pool_size_read = pool.get_nb_open();
+	attr.set_value(attr_Pool_size_read);
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::read_Pool_size
+}
+//--------------------------------------------------------
+/**
+ *	Read attribute History_queue_depth related method
+ *	Description: Number of history records waiting for the asynchronous history writer
+ *
+ *	Data type:	Tango::DevLong
+ *	Attr type:	Scalar
+ */
+//--------------------------------------------------------
+void DataBase::read_History_queue_depth(Tango::Attribute &attr)
+{
+	DEBUG_STREAM << "DataBase::read_History_queue_depth(Tango::Attribute &attr) entering... " << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::read_History_queue_depth) ENABLED START -----*/
+	*attr_History_queue_depth_read = hist_queue.get_depth();
+	attr.set_value(attr_History_queue_depth_read);
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::read_History_queue_depth
+}
+//--------------------------------------------------------
+/**
+ *	Read attribute History_queue_lag related method
+ *	Description: Age (ms) of the oldest history record not yet written by the asynchronous history writer
+ *
+ *	Data type:	Tango::DevDouble
+ *	Attr type:	Scalar
+ */
+//--------------------------------------------------------
+void DataBase::read_History_queue_lag(Tango::Attribute &attr)
+{
+	DEBUG_STREAM << "DataBase::read_History_queue_lag(Tango::Attribute &attr) entering... " << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::read_History_queue_lag) ENABLED START -----*/
+	*attr_History_queue_lag_read = hist_queue.get_lag();
+	attr.set_value(attr_History_queue_lag_read);
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::read_History_queue_lag
+}
+//--------------------------------------------------------
+/**
+ *	Read attribute Timing_p50 related method
+ *	Description: Median command durations (ms) since the last ResetTimingValues, in the Timing_index order
+ *
+ *	Data type:	Tango::DevDouble
+ *	Attr type:	Spectrum max = number of timed commands
+ */
+//--------------------------------------------------------
+void DataBase::read_Timing_p50(Tango::Attribute &attr)
+{
+	DEBUG_STREAM << "DataBase::read_Timing_p50(Tango::Attribute &attr) entering... " << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::read_Timing_p50) ENABLED START -----*/
+	read_timing_percentile(attr,attr_Timing_p50_read,50.0);
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::read_Timing_p50
+}
+//--------------------------------------------------------
+/**
+ *	Read attribute Timing_p90 related method
+ *	Description: 90th percentile of the command durations (ms) since the last ResetTimingValues, in the Timing_index order
+ *
+ *	Data type:	Tango::DevDouble
+ *	Attr type:	Spectrum max = number of timed commands
+ */
+//--------------------------------------------------------
+void DataBase::read_Timing_p90(Tango::Attribute &attr)
+{
+	DEBUG_STREAM << "DataBase::read_Timing_p90(Tango::Attribute &attr) entering... " << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::read_Timing_p90) ENABLED START -----*/
+	read_timing_percentile(attr,attr_Timing_p90_read,90.0);
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::read_Timing_p90
+}
+//--------------------------------------------------------
+/**
+ *	Read attribute Timing_p99 related method
+ *	Description: 99th percentile of the command durations (ms) since the last ResetTimingValues, in the Timing_index order
+ *
+ *	Data type:	Tango::DevDouble
+ *	Attr type:	Spectrum max = number of timed commands
+ */
+//--------------------------------------------------------
+void DataBase::read_Timing_p99(Tango::Attribute &attr)
+{
+	DEBUG_STREAM << "DataBase::read_Timing_p99(Tango::Attribute &attr) entering... " << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::read_Timing_p99) ENABLED START -----*/
+	read_timing_percentile(attr,attr_Timing_p99_read,99.0);
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::read_Timing_p99
+}
+//--------------------------------------------------------
+/**
+ *	Read attribute Timing_p999 related method
+ *	Description: 99.9th percentile of the command durations (ms) since the last ResetTimingValues, in the Timing_index order
+ *
+ *	Data type:	Tango::DevDouble
+ *	Attr type:	Spectrum max = number of timed commands
+ */
+//--------------------------------------------------------
+void DataBase::read_Timing_p999(Tango::Attribute &attr)
+{
+	DEBUG_STREAM << "DataBase::read_Timing_p999(Tango::Attribute &attr) entering... " << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::read_Timing_p999) ENABLED START -----*/
+	read_timing_percentile(attr,attr_Timing_p999_read,99.9);
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::read_Timing_p999
+}
 
 //--------------------------------------------------------
 /**
@@ -839,8 +1203,9 @@ void DataBase::db_add_device(const Tango::DevVarStringArray *argin)
 	}
 	device_name_to_dfm(tmp_device, domain, family, member);
 
+	DirectWrite dw(storage);
 	{
-		AutoLock al("LOCK TABLE device WRITE",this);
+		AutoTransaction al("LOCK TABLE device WRITE",TRANSACTION_WRITE,this);
 		int n_rows=0;
 
 // first delete the tuple (device,name) from the device table
@@ -907,7 +1272,20 @@ void DataBase::db_add_device(const Tango::DevVarStringArray *argin)
 		}
 
 		mysql_free_result(result);
+		al.commit();
 	}
+	dw.unlock();
+
+	device_cache.invalidate(tmp_device);
+	if (tmp_alias != NULL)
+		device_cache.invalidate(tmp_alias);
+	if (dserver_name.empty() == false)
+		device_cache.invalidate(dserver_name);
+	server_cache.invalidate_device(tmp_device);
+	storage->reload_devices("name",tmp_device);
+	if (dserver_name.empty() == false)
+		storage->reload_devices("name",dserver_name);
+	server_cache.invalidate_server(tmp_server);
 
 	return;
 
@@ -935,6 +1313,7 @@ void DataBase::db_add_server(const Tango::DevVarStringArray *argin)
 	TangoSys_MemStream sql_query_stream;
 	char domain[256], family[256], member[256];
 	const char *tmp_server, *tmp_class;
+	std::vector<std::string> added_devices;
 
 	if (server_device_list->length() < 3)
 	{
@@ -947,8 +1326,9 @@ void DataBase::db_add_server(const Tango::DevVarStringArray *argin)
 	INFO_STREAM << "DataBase::AddServer(): insert " << (*server_device_list)[0] << " server with device " << (*server_device_list)[1] << std::endl;
 	tmp_server = (*server_device_list)[0];
 
+	DirectWrite dw(storage);
 	{
-		AutoLock al("LOCK TABLE device WRITE",this);
+		AutoTransaction al("LOCK TABLE device WRITE",TRANSACTION_WRITE,this);
 
 		for (unsigned int i=0; i<(server_device_list->length()-1)/2; i++)
 		{
@@ -984,6 +1364,7 @@ void DataBase::db_add_server(const Tango::DevVarStringArray *argin)
 			DEBUG_STREAM << "DataBase::AddServer(): sql_query " << sql_query_stream.str() << std::endl;
 			simple_query(sql_query_stream.str(),"db_add_server()",al.get_con_nb());
 
+			added_devices.push_back(tmp_device);
 		}
 
 // Finally, add the admin device
@@ -1009,7 +1390,20 @@ void DataBase::db_add_server(const Tango::DevVarStringArray *argin)
 							 << "\",version=0,started=NULL,stopped=NULL";
         DEBUG_STREAM << "DataBase::AddServer(): sql_query " << sql_query_stream.str() << std::endl;
         simple_query(sql_query_stream.str(),"db_add_server()",al.get_con_nb());
+
+        added_devices.push_back(tmp_device);
+		al.commit();
+	}
+	dw.unlock();
+
+	for (unsigned int i = 0;i < added_devices.size();i++)
+	{
+		device_cache.invalidate(added_devices[i]);
+		server_cache.invalidate_device(added_devices[i]);
+		storage->reload_devices("name",added_devices[i]);
 	}
+	server_cache.invalidate_server((*argin)[0].in());
+	storage->reload_devices("server",(*argin)[0].in());
 
 	return;
 
@@ -1077,6 +1471,8 @@ void DataBase::db_delete_class_attribute(const Tango::DevVarStringArray *argin)
     DEBUG_STREAM << "DataBase::db_delete_class_attribute(): sql_query " << sql_query_stream.str() << std::endl;
 	simple_query(sql_query_stream.str(),"db_delete_class_attribute()");
 
+	server_cache.invalidate_class((*argin)[0].in());
+
     return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_class_attribute
@@ -1116,7 +1512,7 @@ void DataBase::db_delete_class_attribute_property(const Tango::DevVarStringArray
 	attribute = (*argin)[1];
 
 	{
-		AutoLock al("LOCK TABLES property_attribute_class WRITE,property_attribute_class_hist WRITE,class_attribute_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property_attribute_class WRITE,property_attribute_class_hist WRITE,class_attribute_history_id WRITE",TRANSACTION_WRITE,this);
 
 		for (unsigned  int i=0; i<argin->length()-2; i++)
 		{
@@ -1166,8 +1562,11 @@ void DataBase::db_delete_class_attribute_property(const Tango::DevVarStringArray
 			}
 			purge_att_property("property_attribute_class_hist","class",tmp_class.c_str(),attribute,property,al.get_con_nb());
 		}
+		al.commit();
 	}
 
+	server_cache.invalidate_class((*argin)[0].in());
+
   	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_class_attribute_property
@@ -1200,7 +1599,7 @@ void DataBase::db_delete_class_property(const Tango::DevVarStringArray *argin)
 	INFO_STREAM << "DataBase::DeleteClassProperty(): delete " << n_properties << " properties for class " << (*property_list)[0] << std::endl;
 
 	{
-		AutoLock al("LOCK TABLES property_class WRITE,property_class_hist WRITE,class_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property_class WRITE,property_class_hist WRITE,class_history_id WRITE",TRANSACTION_WRITE,this);
 
 		int i,j;
 		for (i=0; i<n_properties; i++)
@@ -1243,8 +1642,11 @@ void DataBase::db_delete_class_property(const Tango::DevVarStringArray *argin)
   	    	  mysql_free_result(result);
 
 		}
+		al.commit();
 	}
 
+	server_cache.invalidate_class((*argin)[0].in());
+
 	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_class_property
@@ -1285,8 +1687,9 @@ void DataBase::db_delete_device(Tango::DevString argin)
 
 	std::string tmp_wildcard = replace_wildcard(tmp_device.c_str());
 
+	DirectWrite dw(storage);
 	{
-		AutoLock al("LOCK TABLES device WRITE, property_device WRITE, property_attribute_device WRITE, property_pipe_device WRITE, attribute_alias WRITE",this);
+		AutoTransaction al("LOCK TABLES device WRITE, property_device WRITE, property_attribute_device WRITE, property_pipe_device WRITE, attribute_alias WRITE",TRANSACTION_WRITE,this);
 
 // then delete the device from the device table
 
@@ -1321,7 +1724,13 @@ void DataBase::db_delete_device(Tango::DevString argin)
 		sql_query_stream << "DELETE FROM attribute_alias WHERE device LIKE \"" << tmp_wildcard << "\"";
 		DEBUG_STREAM << "DataBase::db_delete_device(): sql_query " << sql_query_stream.str() << std::endl;
 		simple_query(sql_query_stream.str(),"db_delete_device()",al.get_con_nb());
+		al.commit();
 	}
+	dw.unlock();
+
+	device_cache.invalidate(tmp_device);
+	server_cache.invalidate_device(tmp_device);
+	storage->reload_devices("name",tmp_wildcard);
 
     return;
 
@@ -1346,7 +1755,12 @@ void DataBase::db_delete_device_alias(Tango::DevString argin)
 	// first check to see if this alias exists
 	sql_query_stream << "UPDATE device SET alias=null WHERE alias=\'" << argin << "\' ";
 	DEBUG_STREAM  << "DataBase::db_delete_device_alias(): sql_query " << sql_query_stream.str() << std::endl;
+	DirectWrite dw(storage);
 	simple_query(sql_query_stream.str(),"db_delete_device_alias()");
+	dw.unlock();
+
+	device_cache.invalidate(argin);
+	storage->reload_devices("alias",argin);
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_device_alias
 }
@@ -1404,6 +1818,8 @@ void DataBase::db_delete_device_attribute(const Tango::DevVarStringArray *argin)
     DEBUG_STREAM << "DataBase::db_delete_device_attribute(): sql_query " << sql_query_stream.str() << std::endl;
 	simple_query(sql_query_stream.str(),"db_delete_device_attribute()");
 
+	server_cache.invalidate_device((*argin)[0].in());
+
     return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_device_attribute
@@ -1451,7 +1867,7 @@ void DataBase::db_delete_device_attribute_property(const Tango::DevVarStringArra
 	attribute = (*argin)[1];
 
 	{
-		AutoLock al("LOCK TABLES property_attribute_device WRITE, property_attribute_device_hist WRITE,device_attribute_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property_attribute_device WRITE, property_attribute_device_hist WRITE,device_attribute_history_id WRITE",TRANSACTION_WRITE,this);
 
 		unsigned int i;
 		for (i=0; i<argin->length()-2; i++)
@@ -1499,8 +1915,11 @@ void DataBase::db_delete_device_attribute_property(const Tango::DevVarStringArra
 			}
 			purge_att_property("property_attribute_device_hist","device",tmp_device.c_str(),attribute,property,al.get_con_nb());
 		}
+		al.commit();
 	}
 
+	server_cache.invalidate_device((*argin)[0].in());
+
 	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_device_attribute_property
@@ -1522,68 +1941,18 @@ void DataBase::db_delete_device_property(const Tango::DevVarStringArray *argin)
 
 	//	Add your own code
 	const Tango::DevVarStringArray  *property_list = argin;
-	TangoSys_MemStream	sql_query_stream;
 	int n_properties=0;
-	const char *tmp_device;
-	std::string tmp_name;
-	MYSQL_RES *result;
-	MYSQL_ROW row;
-
-	TimeVal	before, after;
-	GetTime(before);
 
 	n_properties = property_list->length() - 1;
 	INFO_STREAM << "DataBase::DeleteDeviceProperty(): delete " << n_properties << " properties for device " << (*property_list)[0] << std::endl;
 
-	{
-		AutoLock al("LOCK TABLES property_device WRITE, property_device_hist WRITE,device_history_id WRITE",this);
-
-		int i,j;
-		for (i=0; i<n_properties; i++)
-		{
-	    	  tmp_device = (*property_list)[0];
-	    	  tmp_name =   replace_wildcard((*property_list)[i+1]);
-
-			  // Is there something to delete ?
-
-        	  sql_query_stream.str("");
-	    	  sql_query_stream << "SELECT DISTINCT name FROM property_device WHERE device=\""
-		                	   << tmp_device << "\" AND name LIKE \"" << tmp_name << "\"";
-			  result = query(sql_query_stream.str(),"db_delete_device_property()",al.get_con_nb());
-			  int count = mysql_num_rows(result);
-
-			  for(j=0;j<count;j++) {
-
-  		    	row = mysql_fetch_row(result);
-
-				// delete the tuple (device,name,count) from the property table
-
-            	sql_query_stream.str("");
-	        	sql_query_stream << "DELETE FROM property_device WHERE device=\""
-		                    	 << tmp_device << "\" AND name=\"" << row[0] << "\"";
-	        	DEBUG_STREAM << "DataBase::DeleteDeviceProperty(): sql_query " << sql_query_stream.str() << std::endl;
-		    	simple_query(sql_query_stream.str(),"db_delete_device_property()",al.get_con_nb());
-
-				// Mark this property as deleted
-
-	        	Tango::DevULong64 device_property_hist_id = get_id("device",al.get_con_nb());
-		    	sql_query_stream.str("");
-		    	sql_query_stream << "INSERT INTO property_device_hist SET device='"
-		                	   << tmp_device << "',id='" << device_property_hist_id << "',name='"
-							   << row[0] << "',count='0',value='DELETED'";
-		    	simple_query(sql_query_stream.str(),"db_delete_device_property()",al.get_con_nb());
-
-            	purge_property("property_device_hist","device",tmp_device,row[0],al.get_con_nb());
-
-        	  }
-
-  	    	  mysql_free_result(result);
+	std::vector<std::string> names;
+	for (int i=0; i<n_properties; i++)
+		names.push_back((*property_list)[i+1].in());
+	storage->delete_device_property((*property_list)[0],names);
 
-		}
-	}
+	server_cache.invalidate_device((*argin)[0].in());
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbDeleteDeviceProperty");
 	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_device_property
@@ -1616,7 +1985,7 @@ void DataBase::db_delete_property(const Tango::DevVarStringArray *argin)
 	INFO_STREAM << "DataBase::db_delete_property(): put " << n_properties << " properties for device " << (*property_list)[0] << std::endl;
 
 	{
-		AutoLock al("LOCK TABLES property WRITE, property_hist WRITE,object_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property WRITE, property_hist WRITE,object_history_id WRITE",TRANSACTION_WRITE,this);
 
 		int i,j;
 		for (i=0; i<n_properties; i++)
@@ -1662,8 +2031,11 @@ void DataBase::db_delete_property(const Tango::DevVarStringArray *argin)
   	    	  mysql_free_result(result);
 
 		}
+		al.commit();
 	}
 
+	server_cache.invalidate_object((*argin)[0].in());
+
 	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_property
@@ -1837,14 +2209,8 @@ void DataBase::db_export_device(const Tango::DevVarStringArray *argin)
 
 	//	Add your own code
 	const Tango::DevVarStringArray  *export_info = argin;
-	TangoSys_MemStream sql_query_stream;
-	MYSQL_RES *result;
-	MYSQL_ROW row;
 	const char *tmp_ior, *tmp_host, *tmp_pid, *tmp_version;
-	std::string tmp_device, tmp_server;
-
-	TimeVal	before, after;
-	GetTime(before);
+	std::string tmp_device;
 
 
 	if (export_info->length() < 5) {
@@ -1872,88 +2238,28 @@ void DataBase::db_export_device(const Tango::DevVarStringArray *argin)
 //
 	bool	do_fire = false;
 	std::string	previous_host;
+	if (fireToStarter==true && tmp_device.substr(0,8) == "dserver/")
 	{
-		AutoLock al("LOCK TABLES device WRITE, server WRITE",this);
-
-		if (fireToStarter==true)
-		{
-			if (tmp_device.substr(0,8) == "dserver/")
-			{
-				omni_mutex_lock oml(starter_mutex);
-
-				//	Get database server name
-				//--------------------------------------
-				Tango::Util *tg = Tango::Util::instance();
-				std::string	db_serv = tg->get_ds_name();
-				transform(db_serv.begin(), db_serv.end(), db_serv.begin(), ::tolower);
-				std::string	adm_dev("dserver/");
-				adm_dev += db_serv;
-
-				//	Check if not database or starter servers
-				if (tmp_device !=  adm_dev &&
-					tmp_device.substr(0,16) != "dserver/starter/" )
-				{
-					do_fire = true;
-					char *tmp_ptr = db_get_device_host((Tango::DevString)tmp_device.c_str(),al.get_con_nb());
-					previous_host = tmp_ptr;
-					DEBUG_STREAM << tmp_device << " was running on " << previous_host << std::endl;
-					CORBA::string_free(tmp_ptr);
-				}
-			}
-		}
-
-//
-// check if device is defined and if so get server name in order to
-// update server table
-//
-		sql_query_stream << "SELECT server FROM device WHERE name LIKE \"" << tmp_device << "\" ";
-		DEBUG_STREAM << "DataBase::ExportDevice(): sql_query " << sql_query_stream.str() << std::endl;
-
-		result = query(sql_query_stream.str(),"db_export_device()",al.get_con_nb());
-
-		long n_rows=0;
-		n_rows = mysql_num_rows(result);
-		DEBUG_STREAM << "DataBase::ExportDevice(): mysql_num_rows() " << n_rows << std::endl;
-
-		if (n_rows > 0)
-		{
-		   if ((row = mysql_fetch_row(result)) != NULL)
-		   {
-	    	  DEBUG_STREAM << "DataBase::ExportDevice(): device "<< tmp_device << " server name " << row[0] << std::endl;
-	    	  tmp_server = row[0];
-		   }
-		}
-		else
-		{
-	    	 INFO_STREAM << "DataBase::ExportDevice(): device not defined !" << std::endl;
-  	 		 TangoSys_OMemStream o;
-			 o << "device " << tmp_device << " not defined in the database !";
-	    	 mysql_free_result(result);
-	    	 Tango::Except::throw_exception((const char *)DB_DeviceNotDefined,
-	     				                	o.str(),
-					                    	(const char *)"DataBase::ExportDevice()");
-		}
-		mysql_free_result(result);
-
-// update the new value for this tuple
-   		sql_query_stream.str("");
-		sql_query_stream << "UPDATE device set exported=1,ior=\'" << tmp_ior
-	                 << "\',host=\'" << tmp_host << "\',pid=\'" << tmp_pid
-					 << "\',version=\'" << tmp_version
-					 << "\',started=NOW() where name LIKE \'" << tmp_device << "\'";
-		DEBUG_STREAM << "DataBase::ExportDevice(): sql_query " << sql_query_stream.str() << std::endl;
-
-		simple_query(sql_query_stream.str(),"db_export_device()",al.get_con_nb());
+		//	Get database server name
+		//--------------------------------------
+		Tango::Util *tg = Tango::Util::instance();
+		std::string	db_serv = tg->get_ds_name();
+		transform(db_serv.begin(), db_serv.end(), db_serv.begin(), ::tolower);
+		std::string	adm_dev("dserver/");
+		adm_dev += db_serv;
 
-// update host name in server table
+		//	Check if not database or starter servers
+		if (tmp_device !=  adm_dev &&
+			tmp_device.substr(0,16) != "dserver/starter/" )
+			do_fire = true;
+	}
 
-    	sql_query_stream.str("");
-		sql_query_stream << "UPDATE server set host=\'" << tmp_host << "\' where name LIKE \'"
-	                 << tmp_server << "\'";
-    	DEBUG_STREAM << "DataBase::ExportDevice(): sql_query " << sql_query_stream.str() << std::endl;
+	storage->export_device(tmp_device,tmp_ior,tmp_host,tmp_pid,tmp_version,do_fire == true ? &previous_host : NULL);
+	if (do_fire == true)
+		DEBUG_STREAM << tmp_device << " was running on " << previous_host << std::endl;
 
-		simple_query(sql_query_stream.str(),"db_export_device()",al.get_con_nb());
-	}
+	device_cache.invalidate_device(tmp_device);
+	server_cache.invalidate_import(tmp_device);
 
 	//	Check if a server has been started.
 	if (do_fire)
@@ -1970,8 +2276,6 @@ void DataBase::db_export_device(const Tango::DevVarStringArray *argin)
 
 		starter_shared->send_starter_cmd(hosts);
 	}
-	GetTime(after);
-	update_timing_stats(before, after, "DbExportDevice");
 	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_export_device
@@ -1999,9 +2303,6 @@ void DataBase::db_export_event(const Tango::DevVarStringArray *argin)
 	const char *tmp_ior, *tmp_host, *tmp_pid, *tmp_version;
 	std::string tmp_event, tmp_server;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 	if (export_info->length() < 5) {
    		WARN_STREAM << "DataBase::db_export_event(): insufficient export info for event ";
    		Tango::Except::throw_exception((const char *)DB_IncorrectArguments,
@@ -2024,7 +2325,7 @@ void DataBase::db_export_event(const Tango::DevVarStringArray *argin)
 // first delete existing information from database
 
 	{
-		AutoLock al("LOCK TABLE event WRITE",this);
+		AutoTransaction al("LOCK TABLE event WRITE",TRANSACTION_WRITE,this);
 
 		sql_query_stream << "DELETE FROM event WHERE name=\"" << tmp_event << "\"";
    		DEBUG_STREAM << "DataBase::db_export_event(): sql_query " << sql_query_stream.str() << std::endl;
@@ -2039,10 +2340,11 @@ void DataBase::db_export_event(const Tango::DevVarStringArray *argin)
 					 << "\',version=\'" << tmp_version << "\',started=NOW();";
 		DEBUG_STREAM << "DataBase::export_event(): sql_query " << sql_query_stream.str() << std::endl;
 		simple_query(sql_query_stream.str(),"db_export_event()",al.get_con_nb());
+		al.commit();
 	}
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbExportEvent");
+	event_cache.invalidate(tmp_event);
+	server_cache.invalidate_event(tmp_event);
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_export_event
 }
@@ -2588,7 +2890,7 @@ Tango::DevVarStringArray *DataBase::db_get_class_attribute_property_hist(const T
 				     << "\" AND name LIKE \"" << tmp_name << "\" ORDER by date ASC";
 
 	{
-		AutoLock al("LOCK TABLE property_attribute_class_hist READ",this);
+		AutoTransaction al("LOCK TABLE property_attribute_class_hist READ",TRANSACTION_READ,this);
 
 		ids = query(sql_query_stream.str(),"db_get_class_attribute_property_hist()",al.get_con_nb());
 
@@ -2631,6 +2933,7 @@ Tango::DevVarStringArray *DataBase::db_get_class_attribute_property_hist(const T
 		   nb_item += 4+count;
 		   mysql_free_result(result);
 		}
+		al.commit();
 	}
 
 	mysql_free_result(ids);
@@ -2921,7 +3224,7 @@ Tango::DevVarStringArray *DataBase::db_get_class_property_hist(const Tango::DevV
 	                 << tmp_class << "\" AND name LIKE \"" << tmp_name << "\" ORDER by date ASC";
 
 	{
-		AutoLock al("LOCK TABLE property_class_hist READ",this);
+		AutoTransaction al("LOCK TABLE property_class_hist READ",TRANSACTION_READ,this);
 
 		ids = query(sql_query_stream.str(),"db_get_class_property_hist()",al.get_con_nb());
 
@@ -2963,6 +3266,7 @@ Tango::DevVarStringArray *DataBase::db_get_class_property_hist(const Tango::DevV
 		   nb_item += 3+count;
 		   mysql_free_result(result);
 		}
+		al.commit();
 	}
 
 	mysql_free_result(ids);
@@ -2992,9 +3296,6 @@ Tango::DevVarStringArray *DataBase::db_get_class_property_list(Tango::DevString
 	MYSQL_ROW row;
 	int n_rows;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 
 	INFO_STREAM << "DataBase::db_get_class_property_list(): class " << class_name << std::endl;
 
@@ -3032,9 +3333,6 @@ Tango::DevVarStringArray *DataBase::db_get_class_property_list(Tango::DevString
 		argout->length(0);
 	mysql_free_result(result);
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetClassPropertyList");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_class_property_list
 	return argout;
 }
@@ -3284,9 +3582,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property(const Tango
 	argout = new Tango::DevVarStringArray;
 	const char *tmp_device, *tmp_attribute;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 
 	INFO_STREAM << "DataBase::GetAttributeProperty(): get " << property_names->length()-1 << " properties for device " << (*property_names)[0] << std::endl;
 
@@ -3338,9 +3633,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property(const Tango
 
 	DEBUG_STREAM << "DataBase::GetDeviceProperty(): argout->length() "<< argout->length() << std::endl;
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetDeviceAttributeProperty");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_device_attribute_property
 	return argout;
 }
@@ -3375,19 +3667,13 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property2(const Tang
 
 	//	Add your own code
 	const Tango::DevVarStringArray  *property_names = argin;
-	TangoSys_MemStream sql_query_stream;
 	char n_attributes_str[256];
 	char n_rows_str[256];
 	char prop_size_str[256];
-	MYSQL_RES *result;
-	MYSQL_ROW row;
 	int n_rows=0, n_props=0;
 	argout = new Tango::DevVarStringArray;
 	const char *tmp_device, *tmp_attribute;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 	INFO_STREAM << "DataBase::GetDeviceAttributeProperty2(): get " << property_names->length()-1 << " properties for device " << (*property_names)[0] << std::endl;
 
 	tmp_device = (*property_names)[0];
@@ -3407,48 +3693,35 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property2(const Tang
 //
 
 	bool all_attr = false;
-	sql_query_stream << "SELECT COUNT(DISTINCT attribute) FROM property_attribute_device WHERE device = \"" << tmp_device << "\"";
-	DEBUG_STREAM << "Database::GetDeviceAttributeProperty2(): sql_query " << sql_query_stream.str() << std::endl;
+	DbStmt count_stmt(this,STMT_COUNT_DEVICE_ATT_PROPERTY,-1,"db_get_device_attribute_property2()");
+	int con_nb = count_stmt.get_con_nb();
+	count_stmt.bind(tmp_device);
+	count_stmt.execute();
 
-	result = query(sql_query_stream.str(),"db_get_device_attribute_property2()");
-	n_rows = mysql_num_rows(result);
-	DEBUG_STREAM << "DataBase::GetDeviceAttributeProperty2(): mysql_num_rows() " << n_rows << std::endl;
+	if (count_stmt.fetch() == true)
+	{
+		unsigned int nb_attr = (unsigned int)count_stmt.get_long(0);
+		if (property_names->length()-1 >= nb_attr)
+			all_attr = true;
+	}
 
-	if (n_rows != 0)
-	{
-		if ((row = mysql_fetch_row(result)) != NULL)
-		{
-			std::stringstream tmp_str;
-			std::string nb_attr_str = row[0];
-		 	tmp_str << nb_attr_str;
-			unsigned int nb_attr = 0;
-			tmp_str >> nb_attr;
-			if (property_names->length()-1 >= nb_attr)
-				all_attr = true;
-	   		mysql_free_result(result);
-		}
-	}
-
-	if (all_attr == true)
+	if (all_attr == true)
 	{
 		DEBUG_STREAM << "DataBase::GetDeviceAttributeProperty2(): Get attribute properties for all attribute(s)" << std::endl;
 	}
 
 	if (all_attr == false)
 	{
+		DbStmt stmt(this,STMT_GET_DEVICE_ATT_PROPERTY,con_nb,"db_get_device_attribute_property2()");
 		for (unsigned int i=1; i<property_names->length(); i++)
 		{
 	   		tmp_attribute = (*property_names)[i];
-			sql_query_stream.str("");
-			sql_query_stream << "SELECT name,value FROM property_attribute_device WHERE device = \""
-		                 << tmp_device << "\" AND attribute LIKE \"" << tmp_attribute
-						 << "\" ORDER BY name,count";
-	   		DEBUG_STREAM << "DataBase::GetDeviceAttributeProperty2(): sql_query " << sql_query_stream.str() << std::endl;
+			stmt.bind(tmp_device);
+			stmt.bind(tmp_attribute);
+			stmt.execute();
 
-			result = query(sql_query_stream.str(),"db_get_device_attribute_property2()");
-
-	   		n_rows = mysql_num_rows(result);
-	   		DEBUG_STREAM << "DataBase::GetDeviceAttributeProperty2(): mysql_num_rows() " << n_rows << std::endl;
+	   		n_rows = stmt.get_nb_rows();
+	   		DEBUG_STREAM << "DataBase::GetDeviceAttributeProperty2(): rows " << n_rows << std::endl;
 	   		n_props = n_props+2;
 	   		argout->length(n_props);
 	   		(*argout)[n_props-2] = CORBA::string_dup(tmp_attribute);
@@ -3462,14 +3735,13 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property2(const Tang
 				int prop_size = 0;
 	      		for (int j=0; j<n_rows; j++)
 	      		{
-	        		if ((row = mysql_fetch_row(result)) != NULL)
+	        		if (stmt.fetch() == true)
 	         		{
-						name = row[0];
+						name = stmt.get_string(0);
 						if (j == 0)
 							old_name = name;
 						else
 						{
-							name = row[0];
 							if (name != old_name)
 							{
 								new_prop = true;
@@ -3483,8 +3755,8 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property2(const Tang
 						{
 							n_props = n_props + 3;
 							argout->length(n_props);
-	            			(*argout)[n_props-3] = CORBA::string_dup(row[0]);
-	            			(*argout)[n_props-1] = CORBA::string_dup(row[1]);
+	            			(*argout)[n_props-3] = CORBA::string_dup(stmt.get_string(0));
+	            			(*argout)[n_props-1] = CORBA::string_dup(stmt.get_string(1));
 							if (prop_size != 0)
 							{
 								sprintf(prop_size_str,"%d",prop_size);
@@ -3498,7 +3770,7 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property2(const Tang
 						{
 							n_props = n_props + 1;
 							argout->length(n_props);
-							(*argout)[n_props-1] = CORBA::string_dup(row[1]);
+							(*argout)[n_props-1] = CORBA::string_dup(stmt.get_string(1));
 							prop_size++;
 						}
 	         		}
@@ -3512,19 +3784,15 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property2(const Tang
 	   		}
 	   		sprintf(n_rows_str,"%d",prop_number);
 			(*argout)[prop_number_idx] = CORBA::string_dup(n_rows_str);
-	   		mysql_free_result(result);
 		}
 	}
 	else
 	{
-		sql_query_stream.str("");
-		sql_query_stream << "SELECT attribute,name,value FROM property_attribute_device WHERE device = \""
-		                 << tmp_device << "\" ORDER BY attribute,name,count";
-	   	DEBUG_STREAM << "DataBase::GetDeviceAttributeProperty2(): sql_query " << sql_query_stream.str() << std::endl;
-
-		result = query(sql_query_stream.str(),"db_get_device_attribute_property2()");
-		n_rows = mysql_num_rows(result);
-		DEBUG_STREAM << "DataBase::GetDeviceAttributeProperty2(): mysql_num_rows() " << n_rows << std::endl;
+		DbStmt stmt(this,STMT_GET_ALL_DEVICE_ATT_PROPERTY,con_nb,"db_get_device_attribute_property2()");
+		stmt.bind(tmp_device);
+		stmt.execute();
+		n_rows = stmt.get_nb_rows();
+		DEBUG_STREAM << "DataBase::GetDeviceAttributeProperty2(): rows " << n_rows << std::endl;
 
 		std::map<std::string,std::vector<PropDef> > db_data;
 
@@ -3540,9 +3808,9 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property2(const Tang
 
 		for (int j = 0;j < n_rows;j++)
 		{
-			if ((row = mysql_fetch_row(result)) != NULL)
+			if (stmt.fetch() == true)
 			{
-				att = row[0];
+				att = stmt.get_string(0);
 				transform(att.begin(),att.end(),att.begin(),::tolower);
 
 				if (att != prev_att)
@@ -3554,12 +3822,12 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property2(const Tang
 						prop.prop_val.clear();
 						att_props.clear();
 					}
-					p_name = row[1];
+					p_name = stmt.get_string(1);
 					prop.prop_name_cd = p_name;
 					transform(p_name.begin(),p_name.end(),p_name.begin(),::tolower);
 
 					prop.prop_name = p_name;
-					value = row[2];
+					value = stmt.get_string(2);
 					prop.prop_val.push_back(value);
 
 					prev_p_name = p_name;
@@ -3567,7 +3835,7 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property2(const Tang
 				}
 				else
 				{
-					p_name = row[1];
+					p_name = stmt.get_string(1);
 					transform(p_name.begin(),p_name.end(),p_name.begin(),::tolower);
 
 					if (p_name != prev_p_name)
@@ -3576,21 +3844,20 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property2(const Tang
 						prop.prop_val.clear();
 
 						prop.prop_name = p_name;
-						prop.prop_name_cd = row[1];
-						value = row[2];
+						prop.prop_name_cd = stmt.get_string(1);
+						value = stmt.get_string(2);
 						prop.prop_val.push_back(value);
 
 						prev_p_name = p_name;
 					}
 					else
 					{
-						value = row[2];
+						value = stmt.get_string(2);
 						prop.prop_val.push_back(value);
 					}
 				}
 			}
 		}
-	   	mysql_free_result(result);
 
 		if (n_rows != 0)
 		{
@@ -3654,9 +3921,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property2(const Tang
 
 	DEBUG_STREAM << "DataBase::GetDeviceAttributeProperty2(): argout->length() "<< argout->length() << std::endl;
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetDeviceAttributeProperty2");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_device_attribute_property2
 	return argout;
 }
@@ -3712,7 +3976,7 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property_hist(const
  			         << "\" AND name LIKE \"" << tmp_name << "\" ORDER by date ASC";
 
 	{
-		AutoLock al("LOCK TABLE property_attribute_device_hist READ",this);
+		AutoTransaction al("LOCK TABLE property_attribute_device_hist READ",TRANSACTION_READ,this);
 
 		ids = query(sql_query_stream.str(),"db_get_device_attribute_property_hist()",al.get_con_nb());
 
@@ -3755,6 +4019,7 @@ Tango::DevVarStringArray *DataBase::db_get_device_attribute_property_hist(const
 		   nb_item += 4+count;
 		   mysql_free_result(result);
 		}
+		al.commit();
 	}
 
 	mysql_free_result(ids);
@@ -3787,9 +4052,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_class_list(Tango::DevString ar
 	MYSQL_ROW row;
 	int n_rows;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 
 	INFO_STREAM << "DataBase::GetDeviceClassList(): server " << server << std::endl;
 
@@ -3821,9 +4083,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_class_list(Tango::DevString ar
 		argout->length(0);
 	mysql_free_result(result);
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetDeviceClassList");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_device_class_list
 	return argout;
 }
@@ -3850,9 +4109,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_domain_list(Tango::DevString a
 	MYSQL_ROW row;
 	int n_rows;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 	INFO_STREAM << "DataBase::db_get_device_domain_list(): wild card " << wildcard << std::endl;
 
 	if (wildcard == NULL)
@@ -3890,9 +4146,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_domain_list(Tango::DevString a
 		argout->length(0);
 	mysql_free_result(result);
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetDeviceDomainList");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_device_domain_list
 	return argout;
 }
@@ -3919,11 +4172,10 @@ Tango::DevVarStringArray *DataBase::db_get_device_exported_list(Tango::DevString
 	MYSQL_ROW row;
 	int n_rows;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 	INFO_STREAM << "DataBase::db_get_device_exported_list(): filter " << filter << std::endl;
 
+	storage->sync();
+
 	if (filter == NULL)
 	{
 		sql_query_stream << "SELECT DISTINCT name FROM device WHERE name LIKE \"%\" AND exported=1 ORDER BY name";
@@ -3960,9 +4212,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_exported_list(Tango::DevString
 		argout->length(0);
 	mysql_free_result(result);
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetDeviceExportedList");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_device_exported_list
 	return argout;
 }
@@ -3990,9 +4239,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_family_list(Tango::DevString a
 	MYSQL_ROW row;
 	int n_rows;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 
 	INFO_STREAM << "DataBase::db_get_device_family_list(): wild card " << wildcard << std::endl;
 
@@ -4031,9 +4277,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_family_list(Tango::DevString a
 		argout->length(0);
 	mysql_free_result(result);
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetDeviceFamilyList");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_device_family_list
 	return argout;
 }
@@ -4077,6 +4320,8 @@ Tango::DevVarLongStringArray *DataBase::db_get_device_info(Tango::DevString argi
 		tmp_device[i] = tolower(tmp_device[i]);
 	}
 
+	storage->sync();
+
 	sql_query_stream << "SELECT exported,ior,version,pid,server,host,started,stopped,class FROM device WHERE name = '"
 	                 << tmp_device << "' or alias = '" << tmp_device << "';";
 	DEBUG_STREAM << "DataBase::ImportDevice(): sql_query " << sql_query_stream.str() << std::endl;
@@ -4274,9 +4519,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_wide_list(Tango::DevString arg
 	MYSQL_ROW row;
 	int n_rows;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 	INFO_STREAM << "DataBase::db_get_device_wide_list(): filter " << filter << std::endl;
 
 	if (filter == NULL)
@@ -4314,8 +4556,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_wide_list(Tango::DevString arg
 		argout->length(0);
 	mysql_free_result(result);
 
-	GetTime(after);
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_device_wide_list
 	return argout;
 }
@@ -4343,9 +4583,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_member_list(Tango::DevString a
 	MYSQL_ROW row;
 	int n_rows;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 
 	INFO_STREAM << "DataBase::db_get_device_member_list(): wild card " << wildcard << std::endl;
 
@@ -4384,9 +4621,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_member_list(Tango::DevString a
 		argout->length(0);
 	mysql_free_result(result);
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetDeviceMemberList");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_device_member_list
 	return argout;
 }
@@ -4418,18 +4652,10 @@ Tango::DevVarStringArray *DataBase::db_get_device_property(const Tango::DevVarSt
 
 	//	Add your own code
 	const Tango::DevVarStringArray  *property_names = argin;
-	TangoSys_MemStream	sql_query_stream;
 	char n_properties_str[256];
 	char n_rows_str[256];
-	MYSQL_RES *result;
-	MYSQL_ROW row;
 	int n_rows=0, n_props=0;
 	const char *tmp_device;
-	std::string	tmp_name;
-	std::string	prop_name;
-
-	TimeVal	before, after;
-	GetTime(before);
 
 	if (property_names->length() < 2)
 	{
@@ -4454,52 +4680,36 @@ Tango::DevVarStringArray *DataBase::db_get_device_property(const Tango::DevVarSt
 	(*argout)[0] = CORBA::string_dup(tmp_device);
 	(*argout)[1] = CORBA::string_dup(n_properties_str);
 
+	std::vector<std::string> names;
 	for (unsigned int i=1; i<property_names->length(); i++)
-	{
-	   prop_name = (*property_names)[i];
-	   tmp_name = replace_wildcard((*property_names)[i]);
-	   sql_query_stream.str("");
-	   sql_query_stream << "SELECT count,value,name FROM property_device WHERE device = \""
-	                    << tmp_device << "\" AND name LIKE \"" << tmp_name << "\" ORDER BY count";
-	   DEBUG_STREAM << "DataBase::GetDeviceProperty(): sql_query " << sql_query_stream.str() << std::endl;
+		names.push_back((*property_names)[i].in());
+	std::vector<DbProperty> props;
+	storage->get_device_property(tmp_device,names,props);
 
-	   result = query(sql_query_stream.str(),"db_get_device_property()");
-
-	   n_rows = mysql_num_rows(result);
-	   DEBUG_STREAM << "DataBase::GetDeviceProperty(): mysql_num_rows() " << n_rows << std::endl;
+	for (size_t i=0; i<props.size(); i++)
+	{
+	   n_rows = props[i].values.size();
+	   DEBUG_STREAM << "DataBase::GetDeviceProperty(): rows " << n_rows << std::endl;
 	   sprintf(n_rows_str,"%d",n_rows);
 	   n_props = n_props+2;
-	   argout->length(n_props);
-	   (*argout)[n_props-2] = CORBA::string_dup(prop_name.c_str());
-       (*argout)[n_props-1] = CORBA::string_dup(n_rows_str);
+	   argout->length(n_props + (n_rows > 0 ? n_rows : 1));
+	   (*argout)[n_props-2] = CORBA::string_dup(props[i].name.c_str());
+	   (*argout)[n_props-1] = CORBA::string_dup(n_rows_str);
 	   if (n_rows > 0)
 	   {
-
 	      for (int j=0; j<n_rows; j++)
-	      {
-	         if ((row = mysql_fetch_row(result)) != NULL)
-	         {
-	            DEBUG_STREAM << "DataBase::GetDeviceProperty(): property[ "<< i << "] count " << row[0] << " value " << row[1] << std::endl;
-		    	n_props++;
-		    	argout->length(n_props);
-	            (*argout)[n_props-1] = CORBA::string_dup(row[1]);
-	         }
-	      }
+	         (*argout)[n_props+j] = CORBA::string_dup(props[i].values[j].c_str());
+	      n_props = n_props+n_rows;
 	   }
 	   else
 	   {
 	      n_props++;
-	      argout->length(n_props);
 	      (*argout)[n_props-1] = CORBA::string_dup(" ");
 	   }
-	   mysql_free_result(result);
 	}
 
 	DEBUG_STREAM << "DataBase::GetDeviceProperty(): argout->length() "<< argout->length() << std::endl;
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetDeviceProperty");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_device_property
 	return argout;
 }
@@ -4544,13 +4754,15 @@ Tango::DevVarStringArray *DataBase::db_get_device_property_hist(const Tango::Dev
 	tmp_device = (*argin)[0];
 	tmp_name   = replace_wildcard((*argin)[1]);
 
+	storage->sync();
+
 	// Get id list
 
     sql_query_stream << "SELECT DISTINCT id,date FROM property_device_hist WHERE device = \""
 	                 << tmp_device << "\" AND name LIKE \"" << tmp_name << "\" ORDER by date ASC";
 
 	{
-		AutoLock al("LOCK TABLE property_device_hist READ",this);
+		AutoTransaction al("LOCK TABLE property_device_hist READ",TRANSACTION_READ,this);
 
 		ids = query(sql_query_stream.str(),"db_get_device_property_hist()",al.get_con_nb());
 
@@ -4592,6 +4804,7 @@ Tango::DevVarStringArray *DataBase::db_get_device_property_hist(const Tango::Dev
 		   nb_item += 3+count;
 		   mysql_free_result(result);
 		}
+		al.commit();
 	}
 
 	mysql_free_result(ids);
@@ -4625,15 +4838,14 @@ Tango::DevVarStringArray *DataBase::db_get_device_property_list(const Tango::Dev
 	const char *device,*wildcard;
 	std::string tmp_wildcard;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 
 	device = (*device_wildcard)[0];
 	wildcard = (*device_wildcard)[1];
 	INFO_STREAM << "DataBase::db_get_device_property_list(): device " << device ;
 	INFO_STREAM << " wildcard " << wildcard << std::endl;
 
+	storage->sync();
+
 	if (wildcard == NULL)
 	{
 		sql_query_stream << "SELECT name FROM property_device WHERE device=\"" << device
@@ -4670,9 +4882,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_property_list(const Tango::Dev
 		argout->length(0);
 	mysql_free_result(result);
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetDevicePropertyList");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_device_property_list
 	return argout;
 }
@@ -4757,6 +4966,8 @@ Tango::DevVarStringArray *DataBase::db_get_exportd_device_list_for_class(Tango::
 
 	INFO_STREAM << "DataBase::db_get_device_exported_list(): classname " << classname << std::endl;
 
+	storage->sync();
+
 	if (classname == NULL)
 	{
 		sql_query_stream << "SELECT DISTINCT name FROM device WHERE class LIKE \"%\" AND exported=1 ORDER BY name";
@@ -4818,12 +5029,11 @@ Tango::DevVarStringArray *DataBase::db_get_host_list(Tango::DevString argin)
 	MYSQL_ROW row;
 	int n_rows;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 
 	INFO_STREAM << "DataBase::db_get_host_list(): wild card " << wildcard << std::endl;
 
+	storage->sync();
+
 	if (wildcard == NULL)
 	{
 		sql_query_stream << "SELECT DISTINCT host FROM device WHERE host LIKE \"%\" ORDER BY host";
@@ -4859,9 +5069,6 @@ Tango::DevVarStringArray *DataBase::db_get_host_list(Tango::DevString argin)
 		argout->length(0);
 	mysql_free_result(result);
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetHostList");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_host_list
 	return argout;
 }
@@ -4889,11 +5096,10 @@ Tango::DevVarStringArray *DataBase::db_get_host_server_list(Tango::DevString arg
 	MYSQL_ROW row;
 	int n_rows;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 	INFO_STREAM << "DataBase::db_get_host_server_list(): wild card " << wildcard << std::endl;
 
+	storage->sync();
+
 	if (wildcard == NULL)
 	{
 		sql_query_stream << "SELECT DISTINCT server FROM device WHERE host LIKE \"%\" ORDER BY server";
@@ -4931,9 +5137,6 @@ Tango::DevVarStringArray *DataBase::db_get_host_server_list(Tango::DevString arg
 		argout->length(0);
 	mysql_free_result(result);
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetHostServerList");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_host_server_list
 	return argout;
 }
@@ -5229,7 +5432,7 @@ Tango::DevVarStringArray *DataBase::db_get_property_hist(const Tango::DevVarStri
 	                 << tmp_object << "\" AND name LIKE \"" << tmp_name << "\" ORDER by date";
 
 	{
-		AutoLock al("LOCK TABLE property_hist READ",this);
+		AutoTransaction al("LOCK TABLE property_hist READ",TRANSACTION_READ,this);
 
 		ids = query(sql_query_stream.str(),"db_get_property_hist()",al.get_con_nb());
 
@@ -5271,6 +5474,7 @@ Tango::DevVarStringArray *DataBase::db_get_property_hist(const Tango::DevVarStri
 		   nb_item += 3+count;
 		   mysql_free_result(result);
 		}
+		al.commit();
 	}
 
 	mysql_free_result(ids);
@@ -5436,9 +5640,6 @@ Tango::DevVarStringArray *DataBase::db_get_server_list(Tango::DevString argin)
 	MYSQL_ROW row;
 	int n_rows;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 
 	INFO_STREAM << "DataBase::db_get_server_list(): wild card " << wildcard << std::endl;
 
@@ -5477,9 +5678,6 @@ Tango::DevVarStringArray *DataBase::db_get_server_list(Tango::DevString argin)
 		argout->length(0);
 	mysql_free_result(result);
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetServerList");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_server_list
 	return argout;
 }
@@ -5575,16 +5773,8 @@ Tango::DevVarLongStringArray *DataBase::db_import_device(Tango::DevString argin)
 	cout << Elapsed(t0, t1) << "   " ;
 	GetTime(t0);
 	*/
-	TangoSys_MemStream sql_query_stream;
-	MYSQL_RES *result;
-	MYSQL_ROW row;
-	int n_rows=0;
-	int exported, pid;
 	std::string tmp_device;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 	INFO_STREAM << "DataBase::ImportDevice(): get import info for " << devname << " device " << std::endl;
 
 	tmp_device = devname;
@@ -5593,100 +5783,70 @@ Tango::DevVarLongStringArray *DataBase::db_import_device(Tango::DevString argin)
 	}
 //	tmp_device = replace_wildcard(tmp_device.c_str());
 
-// the following query takes too long because the use of OR in the SELECT means the
-// indices cannot be used by mysql. therefore do the SELECT in two stages - andy 31may05
-
-//	sprintf(sql_query,"SELECT exported,ior,version,pid,server,host FROM device WHERE name = '%s' or alias = '%s';",
-//	        tmp_device.c_str(),tmp_device.c_str());
+//
+// First try the import cache. Negative entries are also cached
+//
 
+	ImportCache::ImportEntry cache_entry;
+	if (device_cache.lookup(tmp_device,cache_entry) == true)
 	{
-		AutoLock al("LOCK TABLE device READ",this);
-
-		sql_query_stream << "SELECT exported,ior,version,pid,server,host,class FROM device WHERE name = '"
-	                 	<< tmp_device << "';";
-		DEBUG_STREAM << "DataBase::ImportDevice(): sql_query " << sql_query_stream.str() << std::endl;
-
-		result = query(sql_query_stream.str(),"db_import_device()",al.get_con_nb());
-
-		n_rows = mysql_num_rows(result);
-		DEBUG_STREAM << "DataBase::ImportDevice(): mysql_num_rows() " << n_rows << std::endl;
-
-		if (n_rows <= 0)
+		if (cache_entry.defined == false)
 		{
-//
-// could not find device by name, try to look for by alias
-//
-   			INFO_STREAM << "DataBase::ImportDevice(): could not find device by name, look for alias !" << std::endl;
-			mysql_free_result(result);
-			sql_query_stream.str("");
-			sql_query_stream << "SELECT exported,ior,version,pid,server,host,class FROM device WHERE alias = '"
-		                	 << tmp_device << "';";
-			DEBUG_STREAM << "DataBase::ImportDevice(): sql_query " << sql_query_stream.str() << std::endl;
+			INFO_STREAM << "DataBase::ImportDevice(" << tmp_device << "): device not defined (cached) !" << std::endl;
+			TangoSys_OMemStream o;
+			o << "device " << tmp_device << " not defined in the database !";
+			Tango::Except::throw_exception((const char *)DB_DeviceNotDefined,
+							            o.str(),
+							            (const char *)"DataBase::ImportDevice()");
+		}
 
- 	    	result = query(sql_query_stream.str(),"db_import_device()",al.get_con_nb());
+		argout = import_entry_to_argout(cache_entry);
 
-			n_rows = mysql_num_rows(result);
-			DEBUG_STREAM << "DataBase::ImportDevice(): mysql_num_rows() " << n_rows << std::endl;
-		}
+		return argout;
 	}
+	unsigned long cache_epoch = device_cache.get_epoch();
 
-
-	argout = new Tango::DevVarLongStringArray;
-	if (n_rows > 0)
+	DbDeviceInfo info;
+	if (storage->import_device(tmp_device,info) == false)
 	{
-
-	   if ((row = mysql_fetch_row(result)) != NULL)
-	   {
-		  int n_svalues=0, n_lvalues=0;
-	      DEBUG_STREAM << "DataBase::ImportDevice(): device exported " << row[0] << " version " << row[2] << " server " << row[4] << " host " << row[5] << std::endl;
-	      n_svalues = n_svalues+6;
-	      (argout->svalue).length(n_svalues);
-	      (argout->svalue)[n_svalues-6] = CORBA::string_dup(tmp_device.c_str());
-	      (argout->svalue)[n_svalues-4] = CORBA::string_dup(row[2]);
-	      (argout->svalue)[n_svalues-3] = CORBA::string_dup(row[4]);
-	      (argout->svalue)[n_svalues-2] = CORBA::string_dup(row[5]);
-		  (argout->svalue)[n_svalues-1] = CORBA::string_dup(row[6]);
-			//	IOR Check
-		  if (row[1]!=NULL)
-	     	(argout->svalue)[n_svalues-5] = CORBA::string_dup(row[1]);
-		  else
-		  	(argout->svalue)[n_svalues-5] = CORBA::string_dup("");
-	      exported = -1;
-	      if (row[0] != NULL) sscanf(row[0],"%6d",&exported);
-	      n_lvalues++;
-	      (argout->lvalue).length(n_lvalues);
-	      (argout->lvalue)[n_lvalues-1] = exported;
-	      pid = -1;
-	      if (row[3] != NULL) sscanf(row[3],"%6d",&pid);
-	      n_lvalues++;
-	      (argout->lvalue).length(n_lvalues);
-	      (argout->lvalue)[n_lvalues-1] = pid;
-	   }
-		else {
-	    	 INFO_STREAM << "DataBase::ImportDevice(" << tmp_device << "): info not defined !" << std::endl;
-	    	 mysql_free_result(result);
-		     delete argout;
-	    	 Tango::Except::throw_exception((const char *)DB_DeviceNotDefined,
-								(const char *)"Device import info not found in the database !",
-								(const char *)"DataBase::ImportDevice()");
-		}
-	}
-	else {
 	     INFO_STREAM << "DataBase::ImportDevice(" << tmp_device << "): device not defined !" << std::endl;
+		 cache_entry.defined = false;
+		 device_cache.insert(tmp_device,cache_entry,cache_epoch);
  	 	 TangoSys_OMemStream o;
 		 o << "device " << tmp_device << " not defined in the database !";
-	     mysql_free_result(result);
-	     delete argout;
 	     Tango::Except::throw_exception((const char *)DB_DeviceNotDefined,
 							            o.str(),
 							            (const char *)"DataBase::ImportDevice()");
 	}
-	mysql_free_result(result);
+
+	DEBUG_STREAM << "DataBase::ImportDevice(): device exported " << info.exported << " version " << info.version << " server " << info.server << " host " << info.host << std::endl;
+	argout = new Tango::DevVarLongStringArray;
+	(argout->svalue).length(6);
+	(argout->svalue)[0] = CORBA::string_dup(tmp_device.c_str());
+	(argout->svalue)[1] = CORBA::string_dup(info.ior.c_str());
+	(argout->svalue)[2] = CORBA::string_dup(info.version.c_str());
+	(argout->svalue)[3] = CORBA::string_dup(info.server.c_str());
+	(argout->svalue)[4] = CORBA::string_dup(info.host.c_str());
+	(argout->svalue)[5] = CORBA::string_dup(info.class_name.c_str());
+	(argout->lvalue).length(2);
+	(argout->lvalue)[0] = info.exported;
+	(argout->lvalue)[1] = info.pid;
+
+	if (device_cache.is_enabled() == true)
+	{
+		cache_entry.defined = true;
+		cache_entry.device = info.name;
+		transform(cache_entry.device.begin(),cache_entry.device.end(),cache_entry.device.begin(),::tolower);
+		cache_entry.server = info.server;
+		for (unsigned int i = 0;i < (argout->svalue).length();i++)
+			cache_entry.svalue.push_back((argout->svalue)[i].in());
+		for (unsigned int i = 0;i < (argout->lvalue).length();i++)
+			cache_entry.lvalue.push_back((argout->lvalue)[i]);
+		device_cache.insert(tmp_device,cache_entry,cache_epoch);
+	}
 	/*
 	 * calculate elapsed time and update timing variables
 	 */
-	GetTime(after);
-	update_timing_stats(before, after, "DbImportDevice");
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_import_device
 	return argout;
@@ -5715,9 +5875,6 @@ Tango::DevVarLongStringArray *DataBase::db_import_event(Tango::DevString argin)
 	int exported, pid;
 	std::string tmp_event;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 	INFO_STREAM << "DataBase::db_import_event(): get import info for " << event_name << std::endl;
 
 	tmp_event = event_name;
@@ -5726,6 +5883,25 @@ Tango::DevVarLongStringArray *DataBase::db_import_event(Tango::DevString argin)
 	}
 	tmp_event = replace_wildcard(tmp_event.c_str());
 
+	ImportCache::ImportEntry cache_entry;
+	if (event_cache.lookup(tmp_event,cache_entry) == true)
+	{
+		if (cache_entry.defined == false)
+		{
+			INFO_STREAM << "DataBase::db_import_event(): event not defined (cached) !" << std::endl;
+			TangoSys_OMemStream o;
+			o << "event " << tmp_event << " not defined in the database !";
+			Tango::Except::throw_exception((const char *)DB_DeviceNotDefined,
+			     				                o.str(),
+							                    (const char *)"DataBase::db_import_event()");
+		}
+
+		argout = import_entry_to_argout(cache_entry);
+
+		return argout;
+	}
+	unsigned long cache_epoch = event_cache.get_epoch();
+
     sql_query_stream << "SELECT exported,ior,version,pid,host FROM event WHERE name = '" << tmp_event << "';";
 	DEBUG_STREAM  << "DataBase::db_import_event(): sql_query " << sql_query_stream.str() << std::endl;
 
@@ -5758,10 +5934,23 @@ Tango::DevVarLongStringArray *DataBase::db_import_event(Tango::DevString argin)
 	      n_lvalues++;
 	      (argout->lvalue).length(n_lvalues);
 	      (argout->lvalue)[n_lvalues-1] = pid;
+
+		  if (event_cache.is_enabled() == true)
+		  {
+			cache_entry.defined = true;
+			cache_entry.device = tmp_event;
+			for (unsigned int i = 0;i < (argout->svalue).length();i++)
+				cache_entry.svalue.push_back((argout->svalue)[i].in());
+			for (unsigned int i = 0;i < (argout->lvalue).length();i++)
+				cache_entry.lvalue.push_back((argout->lvalue)[i]);
+			event_cache.insert(tmp_event,cache_entry,cache_epoch);
+		  }
 	   }
 	}
 	else {
 	     INFO_STREAM << "DataBase::db_import_event(): event not defined !" << std::endl;
+		 cache_entry.defined = false;
+		 event_cache.insert(tmp_event,cache_entry,cache_epoch);
    	 	 TangoSys_OMemStream o;
 		 o << "event " << tmp_event << " not defined in the database !";
 	     mysql_free_result(result);
@@ -5772,9 +5961,6 @@ Tango::DevVarLongStringArray *DataBase::db_import_event(Tango::DevString argin)
 	}
 	mysql_free_result(result);
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbImportEvent");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_import_event
 	return argout;
 }
@@ -5811,9 +5997,6 @@ Tango::DevVarStringArray *DataBase::db_info()
 	int n_rows=0, n_infos=0;
 	argout = new Tango::DevVarStringArray;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 
 	INFO_STREAM << "DataBase::db_info(): get general database infos" << std::endl;
 
@@ -5830,6 +6013,8 @@ Tango::DevVarStringArray *DataBase::db_info()
 
 // get start time of database
 
+	storage->sync();
+
 	sql_query_stream << "SELECT started FROM device WHERE name = \"" << DataBase::db_name << "\" ";
 //	DEBUG_STREAM << "DataBase::db_info(): sql_query " << sql_query_stream.str() << std::endl;
 
@@ -6052,9 +6237,6 @@ Tango::DevVarStringArray *DataBase::db_info()
 
 	DEBUG_STREAM << "DataBase::db_info(): argout->length() "<< argout->length() << std::endl;
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbInfo");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_info
 	return argout;
 }
@@ -6103,7 +6285,7 @@ void DataBase::db_put_attribute_alias(const Tango::DevVarStringArray *argin)
 // first check to see if this alias exists
 
 	{
-		AutoLock al("LOCK TABLE attribute_alias WRITE",this);
+		AutoTransaction al("LOCK TABLE attribute_alias WRITE",TRANSACTION_WRITE,this);
 
 		long n_rows=0;
     	sql_query_stream << "SELECT alias from attribute_alias WHERE alias=\'" << tmp_alias
@@ -6162,6 +6344,7 @@ void DataBase::db_put_attribute_alias(const Tango::DevVarStringArray *argin)
 						 << "\',attribute=\'" << tmp_attribute << "\',updated=NOW()";
 		DEBUG_STREAM << "DataBase::db_put_attribute_alias(): sql_query " << sql_query_stream.str() << std::endl;
 		simple_query(sql_query_stream.str(),"db_put_attribute_alias()",al.get_con_nb());
+		al.commit();
 	}
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_put_attribute_alias
@@ -6195,7 +6378,7 @@ void DataBase::db_put_class_attribute_property(const Tango::DevVarStringArray *a
 	INFO_STREAM << "DataBase::PutAttributeProperty(): put " << n_attributes << " attributes for device " << (*property_list)[0] << std::endl;
 
 	{
-		AutoLock al("LOCK TABLES property_attribute_class WRITE, property_attribute_class_hist WRITE,class_attribute_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property_attribute_class WRITE, property_attribute_class_hist WRITE,class_attribute_history_id WRITE",TRANSACTION_WRITE,this);
 
 		int i, j, k;
 		k = 2;
@@ -6243,8 +6426,11 @@ void DataBase::db_put_class_attribute_property(const Tango::DevVarStringArray *a
 		   }
 		   k = k+n_properties*2+2;
 		}
+		al.commit();
 	}
 
+	server_cache.invalidate_class((*argin)[0].in());
+
 	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_put_class_attribute_property
@@ -6273,7 +6459,6 @@ void DataBase::db_put_class_attribute_property2(const Tango::DevVarStringArray *
 
 	//	Add your own code
 	TangoSys_MemStream sql_query_stream;
-	char tmp_count_str[256];
 	int n_attributes, n_properties=0, n_rows=0;
 	const char *tmp_class, *tmp_attribute, *tmp_name;
 
@@ -6281,7 +6466,11 @@ void DataBase::db_put_class_attribute_property2(const Tango::DevVarStringArray *
 	INFO_STREAM << "DataBase::PutClassAttributeProperty2(): put " << n_attributes << " attributes for device " << (*argin)[0] << std::endl;
 
 	{
-		AutoLock al("LOCK TABLES property_attribute_class WRITE, property_attribute_class_hist WRITE,class_attribute_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property_attribute_class WRITE, property_attribute_class_hist WRITE,class_attribute_history_id WRITE",TRANSACTION_WRITE,this);
+		InsertBatch prop_batch(this,"INSERT INTO property_attribute_class (class,attribute,name,count,value,updated,accessed) VALUES ",
+							   al.get_con_nb(),"db_put_class_attribute_property2()");
+		InsertBatch hist_batch(this,"INSERT INTO property_attribute_class_hist (class,attribute,name,count,id,value) VALUES ",
+							   al.get_con_nb(),"db_put_class_attribute_property2()",true);
 
 		int tmp_count, i, j, k, l, jj;
 		k = 2;
@@ -6310,38 +6499,38 @@ void DataBase::db_put_class_attribute_property2(const Tango::DevVarStringArray *
 	   			for (l=j+1; l<j+n_rows+1; l++)
 	   			{
           				std::string tmp_escaped_string = escape_string((*argin)[l+1]);
-	      				tmp_count++; sprintf(tmp_count_str, "%d", tmp_count);
+	      				tmp_count++;
 
 // then insert the new value for this tuple
 
  			        sql_query_stream.str("");
-					sql_query_stream << "INSERT INTO property_attribute_class SET class=\'"
-					                 << tmp_class << "\',attribute=\'" << tmp_attribute
-									 << "\',name=\'" << tmp_name << "\',count=\'" << tmp_count_str
-									 << "\',value=\'" << tmp_escaped_string
-									 << "\',updated=NOW(),accessed=NOW()";
-	      			DEBUG_STREAM << "DataBase::PutClassAttributeProperty2(): sql_query " << sql_query_stream.str() << std::endl;
-			        simple_query(sql_query_stream.str(),"db_put_class_attribute_property2()",al.get_con_nb());
+					sql_query_stream << "(\'" << tmp_class << "\',\'" << tmp_attribute
+									 << "\',\'" << tmp_name << "\'," << tmp_count
+									 << ",\'" << tmp_escaped_string << "\',NOW(),NOW())";
+			        prop_batch.add(sql_query_stream.str());
 
 // then insert the new value into the history table
 
  			        sql_query_stream.str("");
-					sql_query_stream << "INSERT INTO property_attribute_class_hist SET class=\'"
-					                 << tmp_class << "\',attribute=\'" << tmp_attribute
-									 << "\',name=\'" << tmp_name << "\',count=\'" << tmp_count_str
-									 << "\',id=\'" << class_attribute_property_hist_id
-									 << "\',value=\'" << tmp_escaped_string << "\'";
-	      			DEBUG_STREAM << "DataBase::PutClassAttributeProperty2(): sql_query " << sql_query_stream.str() << std::endl;
-			        simple_query(sql_query_stream.str(),"db_put_class_attribute_property2()",al.get_con_nb());
+					sql_query_stream << "(\'" << tmp_class << "\',\'" << tmp_attribute
+									 << "\',\'" << tmp_name << "\'," << tmp_count
+									 << "," << class_attribute_property_hist_id
+									 << ",\'" << tmp_escaped_string << "\')";
+			        hist_batch.add(sql_query_stream.str());
 
 				}
+				prop_batch.flush();
+				hist_batch.flush();
 		        purge_att_property("property_attribute_class_hist","class",tmp_class,tmp_attribute,tmp_name,al.get_con_nb());
 				k = k + n_rows + 2;
 	   		}
 	   		k = k+2;
 		}
+		al.commit();
 	}
 
+	server_cache.invalidate_class((*argin)[0].in());
+
 	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_put_class_attribute_property2
@@ -6368,18 +6557,18 @@ void DataBase::db_put_class_property(const Tango::DevVarStringArray *argin)
 	//	Add your own code
 	const Tango::DevVarStringArray  *property_list = argin;
 	TangoSys_MemStream sql_query_stream;
-    char tmp_count_str[256];
 	int n_properties=0, n_rows=0;
 	const char *tmp_class, *tmp_name;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 	sscanf((*property_list)[1],"%6d",&n_properties);
 	INFO_STREAM << "DataBase::PutClassProperty(): put " << n_properties << " properties for device " << (*property_list)[0] << std::endl;
 
 	{
-		AutoLock al("LOCK TABLES property_class WRITE, property_class_hist WRITE, class_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property_class WRITE, property_class_hist WRITE, class_history_id WRITE",TRANSACTION_WRITE,this);
+		InsertBatch prop_batch(this,"INSERT INTO property_class (class,name,count,value,updated,accessed) VALUES ",
+							   al.get_con_nb(),"db_put_class_property()");
+		InsertBatch hist_batch(this,"INSERT INTO property_class_hist (class,name,count,id,value) VALUES ",
+							   al.get_con_nb(),"db_put_class_property()",true);
 
 		int i, j, k;
 		int tmp_count;
@@ -6403,35 +6592,34 @@ void DataBase::db_put_class_property(const Tango::DevVarStringArray *argin)
 		   	for (j=k+2; j<k+n_rows+2; j++)
 		   	{
         	  	std::string tmp_escaped_string = escape_string((*property_list)[j]);
-	    	  	tmp_count++; sprintf(tmp_count_str, "%d", tmp_count);
+	    	  	tmp_count++;
 
 // then insert the new value for this tuple
 				sql_query_stream.str("");
-				sql_query_stream << "INSERT INTO property_class SET class='" << tmp_class \
-													 << "',name='" << tmp_name \
-													 << "',count='" << tmp_count_str \
-													 << "',value='" << tmp_escaped_string \
-													 << "',updated=NOW(),accessed=NOW()";
-	    	  	DEBUG_STREAM << "DataBase::PutClassProperty(): sql_query " << sql_query_stream.str() << std::endl;
-  	    	  	simple_query(sql_query_stream.str(),"db_put_class_property()",al.get_con_nb());
+				sql_query_stream << "('" << tmp_class << "','" << tmp_name \
+													 << "'," << tmp_count \
+													 << ",'" << tmp_escaped_string \
+													 << "',NOW(),NOW())";
+  	    	  	prop_batch.add(sql_query_stream.str());
 
 // then insert the new value into the history table
 				sql_query_stream.str("");
-				sql_query_stream << "INSERT INTO property_class_hist SET class='" << tmp_class \
-													 << "',name='" << tmp_name \
-													 << "',count='" << tmp_count_str \
-													 << "',id='" << class_property_hist_id \
-													 << "',value='" << tmp_escaped_string << "'";
-	    	  	DEBUG_STREAM << "DataBase::PutClassProperty(): sql_query " << sql_query_stream.str() << std::endl;
-  	    	  	simple_query(sql_query_stream.str(),"db_put_class_property()",al.get_con_nb());
+				sql_query_stream << "('" << tmp_class << "','" << tmp_name \
+													 << "'," << tmp_count \
+													 << "," << class_property_hist_id \
+													 << ",'" << tmp_escaped_string << "')";
+  	    	  	hist_batch.add(sql_query_stream.str());
 		   	}
+			prop_batch.flush();
+			hist_batch.flush();
 		   	purge_property("property_class_hist","class",tmp_class,tmp_name,al.get_con_nb());
 		   	k = k+n_rows+2;
 		}
+		al.commit();
 	}
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbPutClassProperty");
+	server_cache.invalidate_class((*argin)[0].in());
+
 	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_put_class_property
@@ -6481,8 +6669,9 @@ void DataBase::db_put_device_alias(const Tango::DevVarStringArray *argin)
 
 // first check to see if this alias exists
 
+	DirectWrite dw(storage);
 	{
-		AutoLock al("LOCK TABLE device WRITE",this);
+		AutoTransaction al("LOCK TABLE device WRITE",TRANSACTION_WRITE,this);
 
     	sql_query_stream << "SELECT alias from device WHERE alias=\'" << tmp_alias
 	                	 << "\' AND name <> \'" << tmp_device << "\'";
@@ -6511,7 +6700,13 @@ void DataBase::db_put_device_alias(const Tango::DevVarStringArray *argin)
 	                	 << "\',started=NOW() where name LIKE \'" << tmp_device << "\'";
 		DEBUG_STREAM << "DataBase::db_put_device_alias(): sql_query " << sql_query_stream.str() << std::endl;
 		simple_query(sql_query_stream.str(),"db_put_device_alias()",al.get_con_nb());
+		al.commit();
 	}
+	dw.unlock();
+
+	device_cache.invalidate_device(tmp_device);
+	device_cache.invalidate(tmp_alias);
+	storage->reload_devices("name",tmp_device);
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_put_device_alias
 }
@@ -6540,15 +6735,12 @@ void DataBase::db_put_device_attribute_property(const Tango::DevVarStringArray *
 	int n_attributes, n_properties=0;
 	const char *tmp_device, *tmp_attribute, *tmp_name;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 
 	sscanf((*property_list)[1],"%6d",&n_attributes);
 	INFO_STREAM << "DataBase::PutAttributeProperty(): put " << n_attributes << " attributes for device " << (*property_list)[0] << std::endl;
 
 	{
-		AutoLock al("LOCK TABLES property_attribute_device WRITE, property_attribute_device_hist WRITE,device_attribute_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property_attribute_device WRITE, property_attribute_device_hist WRITE,device_attribute_history_id WRITE",TRANSACTION_WRITE,this);
 
 		int i, j, k;
 		k = 2;
@@ -6596,10 +6788,11 @@ void DataBase::db_put_device_attribute_property(const Tango::DevVarStringArray *
 		   }
 		   k = k+n_properties*2+2;
 		}
+		al.commit();
 	}
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbPutDeviceAttributeProperty");
+	server_cache.invalidate_device((*argin)[0].in());
+
 	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_put_device_attribute_property
@@ -6629,13 +6822,9 @@ void DataBase::db_put_device_attribute_property2(const Tango::DevVarStringArray
 
 	//	Add your own code
 	TangoSys_MemStream sql_query_stream;
-	char tmp_count_str[256];
 	int n_attributes, n_properties=0, n_rows=0;
 	const char *tmp_device, *tmp_attribute, *tmp_name;
 
-	TimeVal	before, after;
-	GetTime(before);
-
     if (argin->length() == 7 &&
         ::strcmp((*argin)[1].in(),"1") == 0 &&
         ::strcmp((*argin)[3].in(),"1") == 0 &&
@@ -6650,7 +6839,11 @@ void DataBase::db_put_device_attribute_property2(const Tango::DevVarStringArray
         INFO_STREAM << "DataBase::PutAttributeProperty2(): put " << n_attributes << " attributes for device " << (*argin)[0] << std::endl;
 
         {
-            AutoLock al("LOCK TABLES property_attribute_device WRITE, property_attribute_device_hist WRITE,device_attribute_history_id WRITE",this);
+            AutoTransaction al("LOCK TABLES property_attribute_device WRITE, property_attribute_device_hist WRITE,device_attribute_history_id WRITE",TRANSACTION_WRITE,this);
+            InsertBatch prop_batch(this,"INSERT INTO property_attribute_device (device,attribute,name,count,value,updated,accessed) VALUES ",
+                                   al.get_con_nb(),"db_put_device_attribute_property2()");
+            InsertBatch hist_batch(this,"INSERT INTO property_attribute_device_hist (device,attribute,name,count,id,value) VALUES ",
+                                   al.get_con_nb(),"db_put_device_attribute_property2()",true);
 
             int tmp_count, i, j, k, l, jj;
             k = 2;
@@ -6679,38 +6872,37 @@ void DataBase::db_put_device_attribute_property2(const Tango::DevVarStringArray
                     for (l=j+1; l<j+n_rows+1; l++)
                     {
                         std::string tmp_escaped_string = escape_string((*argin)[l+1]);
-                        tmp_count++; sprintf(tmp_count_str, "%d", tmp_count);
+                        tmp_count++;
 
 // then insert the new value for this tuple
                         sql_query_stream.str("");
-                        sql_query_stream << "INSERT INTO property_attribute_device SET device=\'"
-                                             << tmp_device << "\',attribute=\'" << tmp_attribute
-                                             << "\',name=\'" << tmp_name << "\',count=\'" << tmp_count_str
-                                             << "\',value=\'" << tmp_escaped_string << "\',updated=NOW(),accessed=NOW()";
-                        DEBUG_STREAM << "DataBase::PutAttributeProperty(): sql_query " << sql_query_stream.str() << std::endl;
-                        simple_query(sql_query_stream.str(),"db_put_device_attribute_property2()",al.get_con_nb());
+                        sql_query_stream << "(\'" << tmp_device << "\',\'" << tmp_attribute
+                                             << "\',\'" << tmp_name << "\'," << tmp_count
+                                             << ",\'" << tmp_escaped_string << "\',NOW(),NOW())";
+                        prop_batch.add(sql_query_stream.str());
 
 // then insert the new value into the history table
                         sql_query_stream.str("");
-                        sql_query_stream << "INSERT INTO property_attribute_device_hist SET device=\'"
-                                             << tmp_device << "\',attribute=\'" << tmp_attribute
-                                             << "\',name=\'" << tmp_name << "\',count=\'" << tmp_count_str
-                                             << "\',id=\'" << device_attribute_property_hist_id
-                                             << "\',value=\'" << tmp_escaped_string << "\'";
-                        DEBUG_STREAM << "DataBase::PutAttributeProperty(): sql_query " << sql_query_stream.str() << std::endl;
-                        simple_query(sql_query_stream.str(),"db_put_device_attribute_property2()",al.get_con_nb());
+                        sql_query_stream << "(\'" << tmp_device << "\',\'" << tmp_attribute
+                                             << "\',\'" << tmp_name << "\'," << tmp_count
+                                             << "," << device_attribute_property_hist_id
+                                             << ",\'" << tmp_escaped_string << "\')";
+                        hist_batch.add(sql_query_stream.str());
 
                     }
+                    prop_batch.flush();
+                    hist_batch.flush();
                     purge_att_property("property_attribute_device_hist","device",tmp_device,tmp_attribute,tmp_name,al.get_con_nb());
                     k = k + n_rows + 2;
                 }
                 k = k+2;
             }
+            al.commit();
         }
     }
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbPutDeviceAttributeProperty2");
+	server_cache.invalidate_device((*argin)[0].in());
+
 	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_put_device_attribute_property2
@@ -6736,78 +6928,25 @@ void DataBase::db_put_device_property(const Tango::DevVarStringArray *argin)
 
 	//	Add your own code
 	const Tango::DevVarStringArray  *property_list = argin;
-	TangoSys_MemStream sql_query_stream;
-	char tmp_count_str[256];
 	int n_properties=0, n_rows=0;
-	const char *tmp_device;
-	std::string tmp_name;
-
-	TimeVal	before, after;
-	GetTime(before);
 
 	sscanf((*property_list)[1],"%6d",&n_properties);
 	INFO_STREAM << "DataBase::PutDeviceProperty(): put " << n_properties << " properties for device " << (*property_list)[0] << std::endl;
 
+	std::vector<DbProperty> props(n_properties);
+	int k = 2;
+	for (int i=0; i<n_properties; i++)
 	{
-		AutoLock al("LOCK TABLES property_device WRITE, property_device_hist WRITE,device_history_id WRITE",this);
-
-		int i, j, k;
-		int tmp_count;
-
-		k = 2;
-		for (i=0; i<n_properties; i++)
-		{
-		   tmp_count = 0;
-		   tmp_device = (*property_list)[0];
-		   tmp_name = (*property_list)[k];
-
-// first delete all tuples (device,name) from the property table
-    	   sql_query_stream.str("");
-		   sql_query_stream << "DELETE FROM property_device WHERE device LIKE \"" << tmp_device \
-													 << "\" AND name LIKE \"" << tmp_name << "\"";
-		   DEBUG_STREAM << "DataBase::PutDeviceProperty(): sql_query " << sql_query_stream.str() << std::endl;
-
-		   simple_query(sql_query_stream.str(),"db_put_device_property()",al.get_con_nb());
-		   sscanf((*property_list)[k+1], "%6d", &n_rows);
-		   Tango::DevULong64 device_property_hist_id = get_id("device",al.get_con_nb());
-
-		   for (j=k+2; j<k+n_rows+2; j++)
-		   {
-        	  std::string tmp_escaped_string = escape_string((*property_list)[j]);
-	    	  tmp_count++; sprintf(tmp_count_str, "%d", tmp_count);
-
-			// then insert the new value for this tuple
-					sql_query_stream.str("");
-					sql_query_stream << "INSERT INTO property_device SET device='" << tmp_device \
-													 << "',name='" << tmp_name \
-													 << "',count='" << tmp_count_str \
-													 << "',value='" << tmp_escaped_string \
-													 << "',updated=NOW(),accessed=NOW()";
-	    	  DEBUG_STREAM << "DataBase::PutDeviceProperty(): sql_query " << sql_query_stream.str() << std::endl;
-
-			  simple_query(sql_query_stream.str(),"db_put_device_property",al.get_con_nb());
-
-			// insert the new value into the history table
-					sql_query_stream.str("");
-					sql_query_stream << "INSERT INTO property_device_hist SET device='" << tmp_device \
-													 << "',id='" << device_property_hist_id \
-													 << "',name='" << tmp_name \
-													 << "',count='" << tmp_count_str \
-													 << "',value='" << tmp_escaped_string \
-													 << "'";
-
-	    	  DEBUG_STREAM << "DataBase::PutDeviceProperty(): sql_query " << sql_query_stream.str() << std::endl;
-
-			  simple_query(sql_query_stream.str(),"db_put_device_property",al.get_con_nb());
-
-		   }
-		   purge_property("property_device_hist","device",tmp_device,tmp_name.c_str(),al.get_con_nb());
-		   k = k+n_rows+2;
-		}
+		props[i].name = (*property_list)[k];
+		sscanf((*property_list)[k+1], "%6d", &n_rows);
+		for (int j=k+2; j<k+n_rows+2; j++)
+			props[i].values.push_back((*property_list)[j].in());
+		k = k+n_rows+2;
 	}
+	storage->put_device_property((*property_list)[0],props);
+
+	server_cache.invalidate_device((*argin)[0].in());
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbPutDeviceProperty");
 	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_put_device_property
@@ -6843,7 +6982,11 @@ void DataBase::db_put_property(const Tango::DevVarStringArray *argin)
 	INFO_STREAM << "DataBase::db_put_property(): put " << n_properties << " properties for object " << (*property_list)[0] << std::endl;
 
 	{
-		AutoLock al("LOCK TABLES property WRITE, property_hist WRITE,object_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property WRITE, property_hist WRITE,object_history_id WRITE",TRANSACTION_WRITE,this);
+		InsertBatch prop_batch(this,"INSERT INTO property (object,name,count,value,updated,accessed) VALUES ",
+							   al.get_con_nb(),"db_put_property()");
+		InsertBatch hist_batch(this,"INSERT INTO property_hist (object,name,count,id,value) VALUES ",
+							   al.get_con_nb(),"db_put_property()",true);
 
 		int	k = 2;
 		int	tmp_count;
@@ -6869,29 +7012,32 @@ void DataBase::db_put_property(const Tango::DevVarStringArray *argin)
 
 			  // then insert the new value for this tuple
 			  sql_query_stream.str("");
-			  sql_query_stream << "INSERT INTO property SET object='" << tmp_object
-											 << "',name='" << tmp_name
-											 << "',count='" << tmp_count
-											 << "',value='" << tmp_escaped_string
-											 << "',updated=NOW(),accessed=NOW()";
-	    	  DEBUG_STREAM << "DataBase::db_put_property(): sql_query " << sql_query_stream.str() << std::endl;
-			  simple_query(sql_query_stream.str(),"db_put_property()",al.get_con_nb());
+			  sql_query_stream << "('" << tmp_object
+											 << "','" << tmp_name
+											 << "'," << tmp_count
+											 << ",'" << tmp_escaped_string
+											 << "',NOW(),NOW())";
+			  prop_batch.add(sql_query_stream.str());
 
 			  // then insert the new value into history table
 			  sql_query_stream.str("");
-			  sql_query_stream << "INSERT INTO property_hist SET object='" << tmp_object
-											 << "',name='" << tmp_name
-											 << "',count='" << tmp_count
-											 << "',id='" << object_property_hist_id
-											 << "',value='" << tmp_escaped_string << "'";
-	    	  DEBUG_STREAM << "DataBase::db_put_property(): sql_query " << sql_query_stream.str() << std::endl;
-			  simple_query(sql_query_stream.str(),"db_put_property()",al.get_con_nb());
+			  sql_query_stream << "('" << tmp_object
+											 << "','" << tmp_name
+											 << "'," << tmp_count
+											 << "," << object_property_hist_id
+											 << ",'" << tmp_escaped_string << "')";
+			  hist_batch.add(sql_query_stream.str());
 			}
+			prop_batch.flush();
+			hist_batch.flush();
 			purge_property("property_hist","object",tmp_object,tmp_name.c_str(),al.get_con_nb());
 			k = k+n_rows+2;
 		}
+		al.commit();
 	}
 
+	server_cache.invalidate_object((*argin)[0].in());
+
 	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_put_property
@@ -6941,7 +7087,7 @@ void DataBase::db_put_server_info(const Tango::DevVarStringArray *argin)
 
 	std::string previous_host("");
 	{
-		AutoLock al("LOCK TABLES device READ, server WRITE",this);
+		AutoTransaction al("LOCK TABLES device READ, server WRITE",TRANSACTION_WRITE,this);
 
 		if (fireToStarter==true)
 		{
@@ -6976,6 +7122,7 @@ void DataBase::db_put_server_info(const Tango::DevVarStringArray *argin)
 	                	 << tmp_host << "\',mode=\'" << tmp_mode << "\',level=\'" << tmp_level << "\'";
 		DEBUG_STREAM << "DataBase::db_put_server_info(): sql_query " << sql_query_stream.str() << std::endl;
 		simple_query(sql_query_stream.str(),"db_put_server_info()",al.get_con_nb());
+		al.commit();
 	}
 
 	//	Update host's starter to update controlled servers list
@@ -7008,7 +7155,6 @@ void DataBase::db_un_export_device(Tango::DevString argin)
 
 	//	Add your own code
 	Tango::DevString  devname = argin;
-	TangoSys_MemStream sql_query_stream;
 	char *tmp_device;
 
 	INFO_STREAM << "DataBase::UnExportDevice(): un-export " << devname << " device " << std::endl;
@@ -7020,10 +7166,10 @@ void DataBase::db_un_export_device(Tango::DevString argin)
 	}
 
 // un-export device from database by seting ior="not exported"
-    sql_query_stream << "UPDATE device SET exported=0,stopped=NOW() WHERE name like \""
-	                 << tmp_device << "\"";
-	DEBUG_STREAM << "DataBase::UnExportDevice(): sql_query " << sql_query_stream.str() << std::endl;
-	simple_query(sql_query_stream.str(),"db_export_device()");
+	storage->unexport_device(tmp_device);
+
+	device_cache.invalidate_device(tmp_device);
+	server_cache.invalidate_import(tmp_device);
 
 	free(tmp_device);
 
@@ -7063,6 +7209,9 @@ void DataBase::db_un_export_event(Tango::DevString argin)
 	DEBUG_STREAM << "DataBase::un_export_event(): sql_query " << sql_query_stream.str() << std::endl;
 	simple_query(sql_query_stream.str(),"db_un_export_event()");
 
+	event_cache.invalidate(tmp_event);
+	server_cache.invalidate_event(tmp_event);
+
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_un_export_event
 }
 //--------------------------------------------------------
@@ -7084,9 +7233,6 @@ void DataBase::db_un_export_server(Tango::DevString argin)
 	TangoSys_MemStream sql_query_stream;
 	char *tmp_server;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 	INFO_STREAM << "DataBase::UnExportServer(): un-export all device(s) from server " << server_name << " device " << std::endl;
 
 	tmp_server = (char*)malloc(strlen(server_name)+1);
@@ -7100,12 +7246,16 @@ void DataBase::db_un_export_server(Tango::DevString argin)
 	sql_query_stream << "UPDATE device SET exported=0,stopped=NOW() WHERE server like \""
 	                 << tmp_server << "\"";
 	DEBUG_STREAM << "DataBase::UnExportServer(): sql_query " << sql_query_stream.str() << std::endl;
-	simple_query(sql_query_stream.str(),"db_un_export_server()");
+	{
+		DirectWrite dw(storage);
+		simple_query(sql_query_stream.str(),"db_un_export_server()");
+	}
 
-	free(tmp_server);
+	device_cache.invalidate_server(tmp_server);
+	server_cache.invalidate_server(tmp_server);
+	storage->reload_devices("server",tmp_server);
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbUnExportServer");
+	free(tmp_server);
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_un_export_server
 }
@@ -7122,20 +7272,8 @@ void DataBase::reset_timing_values()
 	/*----- PROTECTED REGION ID(DataBase::reset_timing_values) ENABLED START -----*/
 
 	//	Add your own code
-	timing_stats_mutex.lock();
-
-	//	Loop over map to re-initialise remaining variables
-	std::map<std::string,TimingStatsStruct*>::iterator iter;
-	for (iter=timing_stats_map.begin(); iter!=timing_stats_map.end(); iter++)
-	{
-		iter->second->average       =
-		iter->second->minimum       =
-		iter->second->maximum       =
-		iter->second->total_elapsed =
-		iter->second->calls         = 0.0;
-	}
-
-	timing_stats_mutex.unlock();
+	timing_stats.reset();
+	sql_profile.reset();
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::reset_timing_values
 }
@@ -7165,171 +7303,11 @@ Tango::DevVarStringArray *DataBase::db_get_data_for_server_cache(const Tango::De
 
 	DEBUG_STREAM << "DataBase::db_get_data_for_server_cache(): entering... !" << std::endl;
 
-	//	Add your own code to control device here
-
-	if (argin->length() != 2)
-	{
-	   WARN_STREAM << "DataBase::DbGetDataForServerCache(): incorrect number of input arguments " << std::endl;
-	   Tango::Except::throw_exception((const char *)DB_IncorrectArguments,
-	   				  (const char *)"Incorrect no. of input arguments, needs 2 (ds_name,host_name)",
-					  (const char *)"DataBase::DbGetDataForServerCache()");
-	}
-
-	if (mysql_svr_version < 50000)
-	{
-		WARN_STREAM << "DataBase::DbGetDataForServerCache(): MySQL server too old for this command" << std::endl;
-		Tango::Except::throw_exception((const char *)"DB_MySQLServerTooOld",
-						(const char *)"The MySQL server release does not support stored procedure. Update MySQL to release >= 5",
-						(const char *)"DataBase::DbGetDataForServerCache()");
-	}
+	ServerData data;
+	get_server_data(argin,data);
 
 	argout  = new Tango::DevVarStringArray();
-	TimeVal	before, after;
-	GetTime(before);
-
-	std::string	sql_query;
-	std::string svc((*argin)[0]);
-	std::string host((*argin)[1]);
-	MYSQL_RES *res;
-	MYSQL_ROW row;
-
-	Tango::Util *tg = Tango::Util::instance();
-	std::string	&db_inst_name = tg->get_ds_inst_name();
-	std::string tmp_var_name("@param_out");
-	tmp_var_name = tmp_var_name + db_inst_name;
-
-//
-// Do not use methods query() or simple_query() because we are
-// calling a stored procedure.
-// Calling a stored procedure needs special care to retrieve its OUT
-// parameter(s). We have to code a loop using mysql_next_result
-// function. The first result with data is the one we are
-// interested in
-//
-
-	sql_query = "CALL ";
-	sql_query = sql_query + mysql_db_name;
-	sql_query = sql_query + ".ds_start('" + svc + "','" + host + "'," + tmp_var_name + ")";
-	sql_query = sql_query + ";SELECT " + tmp_var_name;
-//  cout << "Query = " << sql_query << std::endl;
-
-	int con_nb = get_connection();
-	if (mysql_real_query(conn_pool[con_nb].db, sql_query.c_str(),sql_query.length()) != 0)
-	{
-		delete argout;
-		TangoSys_OMemStream o;
-
-		WARN_STREAM << "DataBase::db_get_data_for_server_cache failed to query TANGO database:" << std::endl;
-		WARN_STREAM << "  query = " << sql_query << std::endl;
-		WARN_STREAM << " (SQL error=" << mysql_error(conn_pool[con_nb].db) << ")" << std::endl;
-
-		o << "Failed to query TANGO database (error=" << mysql_error(conn_pool[con_nb].db) << ")";
-		o << "\nThe query was: " << sql_query << std::ends;
-
-		release_connection(con_nb);
-
-		Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),
-									   (const char *)"DataBase::DbGetDataForServerCache()");
-	}
-
-	int status;
-	do
-	{
-		if ((res = mysql_store_result(conn_pool[con_nb].db)) != NULL)
-		{
-			break;
-		}
-		else
-		{
-			if (mysql_field_count(conn_pool[con_nb].db) != 0)
-			{
-				delete argout;
-				TangoSys_OMemStream o;
-
-				WARN_STREAM << "DataBase::db_get_data_for_server_cache: mysql_store_result() failed  (error=" << mysql_error(conn_pool[con_nb].db) << ")" << std::endl;
-
-				o << "mysql_store_result() failed (error=" << mysql_error(conn_pool[con_nb].db) << ")";
-
-				release_connection(con_nb);
-
-				Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),
-											   (const char *)"DataBase::DbGetDataForServerCache()");
-			}
-
-			if ((status = mysql_next_result(conn_pool[con_nb].db)) > 0)
-			{
-				delete argout;
-				TangoSys_OMemStream o;
-
-				WARN_STREAM << "DataBase::db_get_data_for_server_cache: mysql_next_result() failed  (error=" << mysql_error(conn_pool[con_nb].db) << ")" << std::endl;
-
-				o << "mysql_next_result() failed (error=" << mysql_error(conn_pool[con_nb].db) << ")";
-
-				release_connection(con_nb);
-
-				Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),
-											   (const char *)"DataBase::DbGetDataForServerCache()");
-			}
-		}
-	}while (status == 0);
-
-	release_connection(con_nb);
-
-	row = mysql_fetch_row(res);
-	unsigned long *length_ptr = mysql_fetch_lengths(res);
-	std::string str(row[0],length_ptr[0]);
-#ifdef __SUNPRO_CC
-	int nb_field;
-	count(str.begin(),str.end(),'\0',nb_field);
-#else
-	int nb_field = count(str.begin(),str.end(),'\0');
-#endif
-
-	if (nb_field == 0)
-	{
-		if (str.size() == 0)
-		{
-			delete argout;
-			mysql_free_result(res);
-			WARN_STREAM << "DataBase::DbGetDataForServerCache(): Stored procedure does not return any result!!!" << std::endl;
-			Tango::Except::throw_exception((const char *)"DB_StoredProcedureNoResult",
-						(const char *)"The stored procedure did not return any results!!!",
-						(const char *)"DataBase::DbGetDataForServerCache()");
-		}
-		else
-		{
-			delete argout;
-			mysql_free_result(res);
-			WARN_STREAM << "DataBase::DbGetDataForServerCache(): Stored procedure failed with a MySQL error!!!" << std::endl;
-			Tango::Except::throw_exception((const char *)"DB_StoredProcedureFailed",
-						(const char *)"The stored procedure failed with a MySQL error!!!",
-						(const char *)"DataBase::DbGetDataForServerCache()");
-		}
-	}
-
-	argout->length(nb_field + 1);
-
-	std::string::size_type pos = 0;
-	std::string::size_type start = 0;
-	int idx = 0;
-	std::string tmp_elt;
-
-	pos = str.find('\0');
-	while (pos != std::string::npos)
-	{
-		tmp_elt = str.substr(start,pos - start);
-		(*argout)[idx] = CORBA::string_dup(tmp_elt.c_str());
-		start = pos + 1;
-		idx++;
-		pos = str.find('\0',start);
-	}
-	tmp_elt = str.substr(start);
-	(*argout)[idx] = CORBA::string_dup(tmp_elt.c_str());
-
-	mysql_free_result(res);
-
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetDataForServerCache");
+	data.to_string_array(*argout);
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_data_for_server_cache
 	return argout;
@@ -7375,7 +7353,7 @@ void DataBase::db_delete_all_device_attribute_property(const Tango::DevVarString
 
 
 	{
-		AutoLock al("LOCK TABLES property_attribute_device WRITE, property_attribute_device_hist WRITE,device_attribute_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property_attribute_device WRITE, property_attribute_device_hist WRITE,device_attribute_history_id WRITE",TRANSACTION_WRITE,this);
 
 		for (unsigned int i=0; i<argin->length()-1; i++)
 		{
@@ -7422,8 +7400,11 @@ void DataBase::db_delete_all_device_attribute_property(const Tango::DevVarString
 			}
 			mysql_free_result(result);
 		}
+		al.commit();
 	}
 
+	server_cache.invalidate_device((*argin)[0].in());
+
 	return;
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_all_device_attribute_property
@@ -7448,8 +7429,6 @@ Tango::DevVarLongStringArray *DataBase::db_my_sql_select(Tango::DevString argin)
 	/*----- PROTECTED REGION ID(DataBase::db_my_sql_select) ENABLED START -----*/
 
 	//	Add your own code
-	TimeVal	before, after;
-	GetTime(before);
 
 	//	Check if SELECT key is alread inside command
 	std::string	cmd(argin);
@@ -7475,6 +7454,8 @@ Tango::DevVarLongStringArray *DataBase::db_my_sql_select(Tango::DevString argin)
 
 	INFO_STREAM << "DataBase::db_my_sql_select(): \ncmd: " << cmd << std::endl;
 
+	storage->sync();
+
 	MYSQL_RES	*result   = query(cmd, "db_my_sql_select()");
 	int			nb_rows   = mysql_num_rows(result);
 	int			nb_fields = mysql_num_fields(result);
@@ -7516,9 +7497,6 @@ Tango::DevVarLongStringArray *DataBase::db_my_sql_select(Tango::DevString argin)
 	(argout->lvalue)[idx++] = nb_fields;
 	mysql_free_result(result);
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbMySqlSelect");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_my_sql_select
 	return argout;
 }
@@ -7542,6 +7520,8 @@ Tango::DevVarStringArray *DataBase::db_get_csdb_server_list()
 	MYSQL_ROW row;
 	int n_rows;
 
+	storage->sync();
+
 	sql_query_stream << "SELECT DISTINCT ior FROM device WHERE exported=1 AND domain=\'sys\' AND family=\'database\'";
 
 	DEBUG_STREAM << "DataBase::db_get_csdb_server_list(): sql_query " << sql_query_stream.str() << std::endl;
@@ -7821,8 +7801,9 @@ void DataBase::db_rename_server(const Tango::DevVarStringArray *argin)
 	std::string new_exec = new_name.substr(0,pos_new);
 	std::string new_inst = new_name.substr(pos_new + 1);
 
+	DirectWrite dw(storage);
 	{
-		AutoLock al("LOCK TABLES device WRITE, property_device WRITE, property_attribute_device WRITE",this);
+		AutoTransaction al("LOCK TABLES device WRITE, property_device WRITE, property_attribute_device WRITE",TRANSACTION_WRITE,this);
 
    		sql_query_stream.str("");
 		sql_query_stream << "UPDATE device set server=\'" << new_name << "\' where server=\'" << old_name << "\'";
@@ -7852,7 +7833,18 @@ void DataBase::db_rename_server(const Tango::DevVarStringArray *argin)
 		DEBUG_STREAM << "DataBase::db_rename_server(): sql_query " << sql_query_stream.str() << std::endl;
 
 		simple_query(sql_query_stream.str(),"db_rename_server()",al.get_con_nb());
+		al.commit();
 	}
+	dw.unlock();
+
+	device_cache.invalidate_server(old_name);
+	server_cache.invalidate_server(old_name);
+	server_cache.invalidate_server(new_name);
+	device_cache.invalidate(old_adm_name);
+	device_cache.invalidate(new_adm_name);
+	storage->reload_devices("server",old_name);
+	storage->reload_devices("name",old_adm_name);
+	storage->reload_devices("name",new_adm_name);
 
 //
 //	Update host's starter to update controlled servers list
@@ -8046,9 +8038,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_pipe_property(const Tango::Dev
 	argout = new Tango::DevVarStringArray;
 	const char *tmp_device, *tmp_pipe;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 	INFO_STREAM << "DataBase::GetDevicePipeProperty(): get properties for " << property_names->length()-1 << " pipe(s) for device " << (*property_names)[0] << std::endl;
 
 	tmp_device = (*property_names)[0];
@@ -8315,9 +8304,6 @@ Tango::DevVarStringArray *DataBase::db_get_device_pipe_property(const Tango::Dev
 
 	DEBUG_STREAM << "DataBase::GetDevicePipeProperty(): argout->length() "<< argout->length() << std::endl;
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbGetDevicePipeProperty");
-
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_device_pipe_property
 	return argout;
 }
@@ -8360,6 +8346,8 @@ void DataBase::db_delete_class_pipe(const Tango::DevVarStringArray *argin)
     DEBUG_STREAM << "DataBase::db_delete_class_pipe(): sql_query " << sql_query_stream.str() << std::endl;
 	simple_query(sql_query_stream.str(),"db_delete_class_pipe()");
 
+	server_cache.invalidate_class((*argin)[0].in());
+
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_class_pipe
 }
 //--------------------------------------------------------
@@ -8416,6 +8404,8 @@ void DataBase::db_delete_device_pipe(const Tango::DevVarStringArray *argin)
     DEBUG_STREAM << "DataBase::db_delete_device_pipe(): sql_query " << sql_query_stream.str() << std::endl;
 	simple_query(sql_query_stream.str(),"db_delete_device_pipe()");
 
+	server_cache.invalidate_device((*argin)[0].in());
+
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_device_pipe
 }
 //--------------------------------------------------------
@@ -8453,7 +8443,7 @@ void DataBase::db_delete_class_pipe_property(const Tango::DevVarStringArray *arg
 	pipe = (*argin)[1];
 
 	{
-		AutoLock al("LOCK TABLES property_pipe_class WRITE,property_pipe_class_hist WRITE,class_pipe_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property_pipe_class WRITE,property_pipe_class_hist WRITE,class_pipe_history_id WRITE",TRANSACTION_WRITE,this);
 
 		for (unsigned  int i=0; i<argin->length()-2; i++)
 		{
@@ -8503,8 +8493,11 @@ void DataBase::db_delete_class_pipe_property(const Tango::DevVarStringArray *arg
 			}
 			purge_pipe_property("property_pipe_class_hist","class",tmp_class.c_str(),pipe,property,al.get_con_nb());
 		}
+		al.commit();
 	}
 
+	server_cache.invalidate_class((*argin)[0].in());
+
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_class_pipe_property
 }
 //--------------------------------------------------------
@@ -8550,7 +8543,7 @@ void DataBase::db_delete_device_pipe_property(const Tango::DevVarStringArray *ar
 	pipe = (*argin)[1];
 
 	{
-		AutoLock al("LOCK TABLES property_pipe_device WRITE, property_pipe_device_hist WRITE,device_pipe_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property_pipe_device WRITE, property_pipe_device_hist WRITE,device_pipe_history_id WRITE",TRANSACTION_WRITE,this);
 
 		unsigned int i;
 		for (i=0; i<argin->length()-2; i++)
@@ -8598,8 +8591,11 @@ void DataBase::db_delete_device_pipe_property(const Tango::DevVarStringArray *ar
 			}
 			purge_pipe_property("property_pipe_device_hist","device",tmp_device.c_str(),pipe,property,al.get_con_nb());
 		}
+		al.commit();
 	}
 
+	server_cache.invalidate_device((*argin)[0].in());
+
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_device_pipe_property
 }
 //--------------------------------------------------------
@@ -8784,7 +8780,7 @@ void DataBase::db_delete_all_device_pipe_property(const Tango::DevVarStringArray
 
 
 	{
-		AutoLock al("LOCK TABLES property_pipe_device WRITE, property_pipe_device_hist WRITE,device_pipe_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property_pipe_device WRITE, property_pipe_device_hist WRITE,device_pipe_history_id WRITE",TRANSACTION_WRITE,this);
 
 		for (unsigned int i=0; i<argin->length()-1; i++)
 		{
@@ -8831,8 +8827,11 @@ void DataBase::db_delete_all_device_pipe_property(const Tango::DevVarStringArray
 			}
 			mysql_free_result(result);
 		}
+		al.commit();
 	}
 
+	server_cache.invalidate_device((*argin)[0].in());
+
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_delete_all_device_pipe_property
 }
 //--------------------------------------------------------
@@ -8857,7 +8856,6 @@ void DataBase::db_put_class_pipe_property(const Tango::DevVarStringArray *argin)
 
 	//	Add your own code
 	TangoSys_MemStream sql_query_stream;
-	char tmp_count_str[256];
 	int n_pipes, n_properties=0, n_rows=0;
 	const char *tmp_class, *tmp_pipe, *tmp_name;
 
@@ -8865,7 +8863,11 @@ void DataBase::db_put_class_pipe_property(const Tango::DevVarStringArray *argin)
 	INFO_STREAM << "DataBase::PutClasspipeProperty2(): put " << n_pipes << " pipes for device " << (*argin)[0] << std::endl;
 
 	{
-		AutoLock al("LOCK TABLES property_pipe_class WRITE, property_pipe_class_hist WRITE,class_pipe_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property_pipe_class WRITE, property_pipe_class_hist WRITE,class_pipe_history_id WRITE",TRANSACTION_WRITE,this);
+		InsertBatch prop_batch(this,"INSERT INTO property_pipe_class (class,pipe,name,count,value,updated,accessed) VALUES ",
+							   al.get_con_nb(),"db_put_class_pipe_property()");
+		InsertBatch hist_batch(this,"INSERT INTO property_pipe_class_hist (class,pipe,name,count,id,value) VALUES ",
+							   al.get_con_nb(),"db_put_class_pipe_property()",true);
 
 		int tmp_count, i, j, k, l, jj;
 		k = 2;
@@ -8894,38 +8896,38 @@ void DataBase::db_put_class_pipe_property(const Tango::DevVarStringArray *argin)
 	   			for (l=j+1; l<j+n_rows+1; l++)
 	   			{
           				std::string tmp_escaped_string = escape_string((*argin)[l+1]);
-	      				tmp_count++; sprintf(tmp_count_str, "%d", tmp_count);
+	      				tmp_count++;
 
 // then insert the new value for this tuple
 
- 			        sql_query_stream.str("");
-					sql_query_stream << "INSERT INTO property_pipe_class SET class=\'"
-					                 << tmp_class << "\',pipe=\'" << tmp_pipe
-									 << "\',name=\'" << tmp_name << "\',count=\'" << tmp_count_str
-									 << "\',value=\'" << tmp_escaped_string
-									 << "\',updated=NOW(),accessed=NOW()";
-	      			DEBUG_STREAM << "DataBase::PutClassPipeProperty(): sql_query " << sql_query_stream.str() << std::endl;
-			        simple_query(sql_query_stream.str(),"db_put_class_pipe_property()",al.get_con_nb());
+					sql_query_stream.str("");
+					sql_query_stream << "(\'" << tmp_class << "\',\'" << tmp_pipe
+									 << "\',\'" << tmp_name << "\'," << tmp_count
+									 << ",\'" << tmp_escaped_string << "\',NOW(),NOW())";
+					prop_batch.add(sql_query_stream.str());
 
 // then insert the new value into the history table
 
- 			        sql_query_stream.str("");
-					sql_query_stream << "INSERT INTO property_pipe_class_hist SET class=\'"
-					                 << tmp_class << "\',pipe=\'" << tmp_pipe
-									 << "\',name=\'" << tmp_name << "\',count=\'" << tmp_count_str
-									 << "\',id=\'" << class_pipe_property_hist_id
-									 << "\',value=\'" << tmp_escaped_string << "\'";
-	      			DEBUG_STREAM << "DataBase::PutClassPipeProperty(): sql_query " << sql_query_stream.str() << std::endl;
-			        simple_query(sql_query_stream.str(),"db_put_class_pipe_property()",al.get_con_nb());
+					sql_query_stream.str("");
+					sql_query_stream << "(\'" << tmp_class << "\',\'" << tmp_pipe
+									 << "\',\'" << tmp_name << "\'," << tmp_count
+									 << "," << class_pipe_property_hist_id
+									 << ",\'" << tmp_escaped_string << "\')";
+					hist_batch.add(sql_query_stream.str());
 
 				}
+		        prop_batch.flush();
+		        hist_batch.flush();
 		        purge_pipe_property("property_pipe_class_hist","class",tmp_class,tmp_pipe,tmp_name,al.get_con_nb());
 				k = k + n_rows + 2;
 	   		}
 	   		k = k+2;
 		}
+		al.commit();
 	}
 
+	server_cache.invalidate_class((*argin)[0].in());
+
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_put_class_pipe_property
 }
 //--------------------------------------------------------
@@ -8950,19 +8952,19 @@ void DataBase::db_put_device_pipe_property(const Tango::DevVarStringArray *argin
 
 	//	Add your own code
 	TangoSys_MemStream sql_query_stream;
-	char tmp_count_str[256];
 	int n_pipes, n_properties=0, n_rows=0;
 	const char *tmp_device, *tmp_pipe, *tmp_name;
 
-	TimeVal	before, after;
-	GetTime(before);
-
 
 	sscanf((*argin)[1],"%6d",&n_pipes);
 	INFO_STREAM << "DataBase::DbPutDevicePipeProperty(): put " << n_pipes << " pipes for device " << (*argin)[0] << std::endl;
 
 	{
-		AutoLock al("LOCK TABLES property_pipe_device WRITE, property_pipe_device_hist WRITE,device_pipe_history_id WRITE",this);
+		AutoTransaction al("LOCK TABLES property_pipe_device WRITE, property_pipe_device_hist WRITE,device_pipe_history_id WRITE",TRANSACTION_WRITE,this);
+		InsertBatch prop_batch(this,"INSERT INTO property_pipe_device (device,pipe,name,count,value,updated,accessed) VALUES ",
+							   al.get_con_nb(),"db_put_device_pipe_property()");
+		InsertBatch hist_batch(this,"INSERT INTO property_pipe_device_hist (device,pipe,name,count,id,value) VALUES ",
+							   al.get_con_nb(),"db_put_device_pipe_property()",true);
 
 		int tmp_count, i, j, k, l, jj;
 		k = 2;
@@ -8991,37 +8993,37 @@ void DataBase::db_put_device_pipe_property(const Tango::DevVarStringArray *argin
 	   			for (l=j+1; l<j+n_rows+1; l++)
 	   			{
           			std::string tmp_escaped_string = escape_string((*argin)[l+1]);
-	      			tmp_count++; sprintf(tmp_count_str, "%d", tmp_count);
+	      			tmp_count++;
 
 // then insert the new value for this tuple
+
 					sql_query_stream.str("");
-					sql_query_stream << "INSERT INTO property_pipe_device SET device=\'"
-					                	 << tmp_device << "\',pipe=\'" << tmp_pipe
-										 << "\',name=\'" << tmp_name << "\',count=\'" << tmp_count_str
-										 << "\',value=\'" << tmp_escaped_string << "\',updated=NOW(),accessed=NOW()";
-	      			DEBUG_STREAM << "DataBase::DbPutDevicePipeProperty(): sql_query " << sql_query_stream.str() << std::endl;
-					simple_query(sql_query_stream.str(),"db_put_device_pipe_property()",al.get_con_nb());
+					sql_query_stream << "(\'" << tmp_device << "\',\'" << tmp_pipe
+									 << "\',\'" << tmp_name << "\'," << tmp_count
+									 << ",\'" << tmp_escaped_string << "\',NOW(),NOW())";
+					prop_batch.add(sql_query_stream.str());
 
 // then insert the new value into the history table
+
 					sql_query_stream.str("");
-					sql_query_stream << "INSERT INTO property_pipe_device_hist SET device=\'"
-					                	 << tmp_device << "\',pipe=\'" << tmp_pipe
-										 << "\',name=\'" << tmp_name << "\',count=\'" << tmp_count_str
-										 << "\',id=\'" << device_pipe_property_hist_id
-										 << "\',value=\'" << tmp_escaped_string << "\'";
-	      			DEBUG_STREAM << "DataBase::DbPutDevicePipeProperty(): sql_query " << sql_query_stream.str() << std::endl;
-					simple_query(sql_query_stream.str(),"db_put_device_pipe_property()",al.get_con_nb());
+					sql_query_stream << "(\'" << tmp_device << "\',\'" << tmp_pipe
+									 << "\',\'" << tmp_name << "\'," << tmp_count
+									 << "," << device_pipe_property_hist_id
+									 << ",\'" << tmp_escaped_string << "\')";
+					hist_batch.add(sql_query_stream.str());
 
 				}
+				prop_batch.flush();
+				hist_batch.flush();
 				purge_pipe_property("property_pipe_device_hist","device",tmp_device,tmp_pipe,tmp_name,al.get_con_nb());
 				k = k + n_rows + 2;
 	   		}
 	   		k = k+2;
 		}
+		al.commit();
 	}
 
-	GetTime(after);
-	update_timing_stats(before, after, "DbPutDevicePipeProperty");
+	server_cache.invalidate_device((*argin)[0].in());
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::db_put_device_pipe_property
 }
@@ -9077,7 +9079,7 @@ Tango::DevVarStringArray *DataBase::db_get_class_pipe_property_hist(const Tango:
 				     << "\" AND name LIKE \"" << tmp_name << "\" ORDER by date ASC";
 
 	{
-		AutoLock al("LOCK TABLE property_pipe_class_hist READ",this);
+		AutoTransaction al("LOCK TABLE property_pipe_class_hist READ",TRANSACTION_READ,this);
 
 		ids = query(sql_query_stream.str(),"db_get_class_pipe_property_hist()",al.get_con_nb());
 
@@ -9120,6 +9122,7 @@ Tango::DevVarStringArray *DataBase::db_get_class_pipe_property_hist(const Tango:
 		   nb_item += 4+count;
 		   mysql_free_result(result);
 		}
+		al.commit();
 	}
 
 	mysql_free_result(ids);
@@ -9179,7 +9182,7 @@ Tango::DevVarStringArray *DataBase::db_get_device_pipe_property_hist(const Tango
  			         << "\" AND name LIKE \"" << tmp_name << "\" ORDER by date ASC";
 
 	{
-		AutoLock al("LOCK TABLE property_pipe_device_hist READ",this);
+		AutoTransaction al("LOCK TABLE property_pipe_device_hist READ",TRANSACTION_READ,this);
 
 		ids = query(sql_query_stream.str(),"db_get_device_pipe_property_hist()",al.get_con_nb());
 
@@ -9222,6 +9225,7 @@ Tango::DevVarStringArray *DataBase::db_get_device_pipe_property_hist(const Tango
 		   nb_item += 4+count;
 		   mysql_free_result(result);
 		}
+		al.commit();
 	}
 
 	mysql_free_result(ids);
@@ -9280,6 +9284,413 @@ Tango::DevVarStringArray *DataBase::db_get_forwarded_attribute_list_for_device(T
 	return argout;
 }
 //--------------------------------------------------------
+/**
+ *	Command DbGetDataForServerCacheRaw related method
+ *	Description: Same data than the DbGetDataForServerCache command, returned as one block.
+ *               The elements are separated by a NUL character (encoded format "ds_start").
+ *               This avoids building one CORBA string per element.
+ *
+ *	@param argin Elt[0] = DS name (exec_name/inst_name), Elt[1] = Host name
+ *	@returns All the data needed by the device server during its startup sequence, separated by NUL characters
+ */
+//--------------------------------------------------------
+Tango::DevEncoded *DataBase::db_get_data_for_server_cache_raw(const Tango::DevVarStringArray *argin)
+{
+	Tango::DevEncoded *argout;
+	DEBUG_STREAM << "DataBase::DbGetDataForServerCacheRaw()  - " << device_name << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::db_get_data_for_server_cache_raw) ENABLED START -----*/
+
+	DEBUG_STREAM << "DataBase::db_get_data_for_server_cache_raw(): entering... !" << std::endl;
+
+	ServerData data;
+	get_server_data(argin,data);
+
+	argout  = new Tango::DevEncoded();
+	data.to_encoded(*argout);
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_data_for_server_cache_raw
+	return argout;
+}
+//--------------------------------------------------------
+/**
+ *	Command DbGetDataForServerCacheList related method
+ *	Description: Same data than the DbGetDataForServerCache command for several servers in one call (Starter).
+ *               The data common to all servers (DServer and Default class properties, notifd event,
+ *               CtrlSystem properties) are read only once, with one database connection.
+ *
+ *	@param argin Elt[2n] = DS name (exec_name/inst_name), Elt[2n + 1] = Host name
+ *	@returns Lvalue[n] = Number of strings in svalue for server n, Svalue = The DbGetDataForServerCache data of each server
+ */
+//--------------------------------------------------------
+Tango::DevVarLongStringArray *DataBase::db_get_data_for_server_cache_list(const Tango::DevVarStringArray *argin)
+{
+	Tango::DevVarLongStringArray *argout;
+	DEBUG_STREAM << "DataBase::DbGetDataForServerCacheList()  - " << device_name << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::db_get_data_for_server_cache_list) ENABLED START -----*/
+
+	DEBUG_STREAM << "DataBase::db_get_data_for_server_cache_list(): entering... !" << std::endl;
+
+	std::vector<std::vector<std::string> > data;
+	get_server_list_data(argin,data);
+
+	unsigned long nb_elt = 0;
+	for (size_t i = 0;i < data.size();i++)
+		nb_elt = nb_elt + data[i].size();
+
+	argout  = new Tango::DevVarLongStringArray();
+	argout->lvalue.length(data.size());
+	argout->svalue.length(nb_elt);
+
+	unsigned long idx = 0;
+	for (size_t i = 0;i < data.size();i++)
+	{
+		argout->lvalue[i] = data[i].size();
+		for (size_t j = 0;j < data[i].size();j++)
+			argout->svalue[idx++] = CORBA::string_dup(data[i][j].c_str());
+	}
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_data_for_server_cache_list
+	return argout;
+}
+//--------------------------------------------------------
+/**
+ *	Command DbGetDataForServerCacheDelta related method
+ *	Description: DbGetDataForServerCache data with a version token. Given the token of the data it already has,
+ *               the client gets only the changes since this version (or nothing if unchanged).
+ *
+ *	@param argin Elt[0] = DS name (exec_name/inst_name), Elt[1] = Host name, Elt[2] = Token of the data previously received (optional)
+ *	@returns Svalue[0] = Token of the current data. Lvalue[0] = 0: Data unchanged. Lvalue[0] = 1: Lvalue[1] = Number of hunks,
+ *           then for each hunk: Index and number of the previous data elements replaced and number of new elements,
+ *           the new elements being in Svalue from index 1. Lvalue[0] = 2: Svalue from index 1 = Full data
+ */
+//--------------------------------------------------------
+Tango::DevVarLongStringArray *DataBase::db_get_data_for_server_cache_delta(const Tango::DevVarStringArray *argin)
+{
+	Tango::DevVarLongStringArray *argout;
+	DEBUG_STREAM << "DataBase::DbGetDataForServerCacheDelta()  - " << device_name << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::db_get_data_for_server_cache_delta) ENABLED START -----*/
+
+	DEBUG_STREAM << "DataBase::db_get_data_for_server_cache_delta(): entering... !" << std::endl;
+
+	if (argin->length() != 2 && argin->length() != 3)
+	{
+	   WARN_STREAM << "DataBase::DbGetDataForServerCacheDelta(): incorrect number of input arguments " << std::endl;
+	   Tango::Except::throw_exception((const char *)DB_IncorrectArguments,
+	   				  (const char *)"Incorrect no. of input arguments, needs 2 or 3 (ds_name,host_name[,token])",
+					  (const char *)"DataBase::DbGetDataForServerCacheDelta()");
+	}
+
+	Tango::DevVarStringArray server_argin;
+	server_argin.length(2);
+	server_argin[0] = CORBA::string_dup((*argin)[0]);
+	server_argin[1] = CORBA::string_dup((*argin)[1]);
+
+	std::vector<std::string> data;
+	{
+		ServerData server_data;
+		get_server_data(&server_argin,server_data);
+		server_data.get_elts(data);
+	}
+
+	std::string server,host,new_token;
+	std::string key = ServerCache::make_key((*argin)[0],(*argin)[1],server,host);
+	std::string token;
+	if (argin->length() == 3)
+		token = (*argin)[2];
+	std::vector<ServerVersions::Hunk> hunks;
+	int status = server_versions.update(key,data,token,new_token,hunks);
+
+	argout  = new Tango::DevVarLongStringArray();
+	argout->svalue.length(1);
+	argout->svalue[0] = CORBA::string_dup(new_token.c_str());
+
+	switch (status)
+	{
+	case SERVER_DATA_UNCHANGED:
+		argout->lvalue.length(1);
+		argout->lvalue[0] = status;
+		break;
+
+	case SERVER_DATA_DELTA:
+	{
+		unsigned long nb_elt = 1;
+		argout->lvalue.length(2 + 3 * hunks.size());
+		argout->lvalue[0] = status;
+		argout->lvalue[1] = hunks.size();
+		for (size_t i = 0;i < hunks.size();i++)
+		{
+			argout->lvalue[2 + 3 * i] = hunks[i].old_start;
+			argout->lvalue[3 + 3 * i] = hunks[i].old_len;
+			argout->lvalue[4 + 3 * i] = hunks[i].new_len;
+			nb_elt = nb_elt + hunks[i].new_len;
+		}
+
+		argout->svalue.length(nb_elt);
+		unsigned long idx = 1;
+		for (size_t i = 0;i < hunks.size();i++)
+		{
+			for (unsigned long j = 0;j < hunks[i].new_len;j++)
+				argout->svalue[idx++] = CORBA::string_dup(data[hunks[i].new_start + j].c_str());
+		}
+		break;
+	}
+
+	default:
+		argout->lvalue.length(1);
+		argout->lvalue[0] = SERVER_DATA_FULL;
+		argout->svalue.length(data.size() + 1);
+		for (size_t i = 0;i < data.size();i++)
+			argout->svalue[i + 1] = CORBA::string_dup(data[i].c_str());
+		break;
+	}
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_data_for_server_cache_delta
+	return argout;
+}
+//--------------------------------------------------------
+/**
+ *	Command DbGetDataForServerCacheCompressed related method
+ *	Description: Same data than the DbGetDataForServerCache command, compressed with zlib in one block
+ *               (encoded format "ds_start_zlib"). See benchmark/ds_start_decode.cpp for a decoder.
+ *
+ *	@param argin Elt[0] = DS name (exec_name/inst_name), Elt[1] = Host name
+ *	@returns Uncompressed size (4 bytes, big endian) followed by the zlib stream of the data separated by NUL characters
+ */
+//--------------------------------------------------------
+Tango::DevEncoded *DataBase::db_get_data_for_server_cache_compressed(const Tango::DevVarStringArray *argin)
+{
+	Tango::DevEncoded *argout;
+	DEBUG_STREAM << "DataBase::DbGetDataForServerCacheCompressed()  - " << device_name << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::db_get_data_for_server_cache_compressed) ENABLED START -----*/
+
+	DEBUG_STREAM << "DataBase::db_get_data_for_server_cache_compressed(): entering... !" << std::endl;
+
+	ServerData data;
+	get_server_data(argin,data);
+
+	argout  = new Tango::DevEncoded();
+	try
+	{
+		data.to_compressed(*argout);
+	}
+	catch (Tango::DevFailed &)
+	{
+		delete argout;
+		throw;
+	}
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_data_for_server_cache_compressed
+	return argout;
+}
+//--------------------------------------------------------
+/**
+ *	Command DbGetDataForServerCacheChunk related method
+ *	Description: Same data than the DbGetDataForServerCache command, returned by parts of bounded size.
+ *               The data are built part by part, there is no size limit on the whole data.
+ *
+ *	@param argin Elt[0] = DS name (exec_name/inst_name), Elt[1] = Host name, Elt[2] = Continuation token (empty or missing for the first part),
+ *               Elt[3] = Maximum number of elements per part (optional, default 10000)
+ *	@returns Lvalue[0] = 1 if more parts follow, 0 for the last one. Svalue[0] = Continuation token for the next part,
+ *           Svalue from index 1 = The data elements of this part
+ */
+//--------------------------------------------------------
+Tango::DevVarLongStringArray *DataBase::db_get_data_for_server_cache_chunk(const Tango::DevVarStringArray *argin)
+{
+	Tango::DevVarLongStringArray *argout;
+	DEBUG_STREAM << "DataBase::DbGetDataForServerCacheChunk()  - " << device_name << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::db_get_data_for_server_cache_chunk) ENABLED START -----*/
+
+	DEBUG_STREAM << "DataBase::db_get_data_for_server_cache_chunk(): entering... !" << std::endl;
+
+	if (argin->length() < 2 || argin->length() > 4)
+	{
+	   WARN_STREAM << "DataBase::DbGetDataForServerCacheChunk(): incorrect number of input arguments " << std::endl;
+	   Tango::Except::throw_exception((const char *)DB_IncorrectArguments,
+	   				  (const char *)"Incorrect no. of input arguments, needs 2 to 4 (ds_name,host_name[,token[,max elements]])",
+					  (const char *)"DataBase::DbGetDataForServerCacheChunk()");
+	}
+
+	std::string token;
+	if (argin->length() >= 3)
+		token = (*argin)[2];
+	long max_elt = DEFAULT_DS_START_CHUNK_SIZE;
+	if (argin->length() == 4)
+		max_elt = atol((*argin)[3]);
+	if (max_elt <= 0)
+		max_elt = DEFAULT_DS_START_CHUNK_SIZE;
+
+//
+// First part: Start a new retrieval. Otherwise, continue the one of the
+// token
+//
+
+	DsStart *ds_start;
+	if (token.empty() == true)
+		ds_start = new DsStart(this,(*argin)[0],(*argin)[1],escape_string((*argin)[0]),ds_start_fan_out);
+	else
+	{
+		ds_start = ds_start_streams.take(token,(*argin)[0]);
+		if (ds_start == NULL)
+		{
+			TangoSys_OMemStream o;
+			o << "Unknown or expired token " << token << " for server " << (*argin)[0] << std::ends;
+			Tango::Except::throw_exception((const char *)"DB_InvalidToken",o.str(),
+						(const char *)"DataBase::DbGetDataForServerCacheChunk()");
+		}
+	}
+
+	std::vector<std::string> chunk;
+	bool more;
+	int con_nb;
+	try
+	{
+		storage->sync();
+		con_nb = get_connection();
+	}
+	catch (Tango::DevFailed &)
+	{
+		delete ds_start;
+		throw;
+	}
+	try
+	{
+		more = ds_start->build_chunk(chunk,max_elt,con_nb);
+	}
+	catch (Tango::DevFailed &)
+	{
+		release_connection(con_nb);
+		delete ds_start;
+		throw;
+	}
+	release_connection(con_nb);
+
+	std::string new_token;
+	if (more == true)
+	{
+		try
+		{
+			new_token = ds_start_streams.add(ds_start);
+		}
+		catch (Tango::DevFailed &)
+		{
+			delete ds_start;
+			throw;
+		}
+	}
+	else
+		delete ds_start;
+
+	argout  = new Tango::DevVarLongStringArray();
+	argout->lvalue.length(1);
+	argout->lvalue[0] = more == true ? 1 : 0;
+	argout->svalue.length(chunk.size() + 1);
+	argout->svalue[0] = CORBA::string_dup(new_token.c_str());
+	for (size_t i = 0;i < chunk.size();i++)
+		argout->svalue[i + 1] = CORBA::string_dup(chunk[i].c_str());
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::db_get_data_for_server_cache_chunk
+	return argout;
+}
+//--------------------------------------------------------
+/**
+ *	Command GetTimingHistogram related method
+ *	Description: Dump the latency histogram of timed commands since the last ResetTimingValues.
+ *               For each command: One line with its name and number of calls, then one line
+ *               per non empty bucket with the bucket limits (ms) and count (tab separated).
+ *
+ *	@param argin Command name (empty or * for all the called commands)
+ *	@returns Command name and calls, then lower limit, upper limit and count of each bucket
+ */
+//--------------------------------------------------------
+Tango::DevVarStringArray *DataBase::get_timing_histogram(Tango::DevString argin)
+{
+	Tango::DevVarStringArray *argout;
+	DEBUG_STREAM << "DataBase::GetTimingHistogram()  - " << device_name << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::get_timing_histogram) ENABLED START -----*/
+
+	//	Add your own code
+	std::string cmd_name(argin);
+	bool all = cmd_name.empty() == true || cmd_name == "*";
+
+	std::vector<std::string> lines;
+	std::vector<unsigned long long> histo;
+	char line[256];
+	for (int i = 0;i < timing_stats_size;i++)
+	{
+		if (all == false && strcasecmp(cmd_name.c_str(),timing_stats_index[i]) != 0)
+			continue;
+
+		timing_stats.get_histogram(i,histo);
+		unsigned long long calls = 0;
+		for (int j = 0;j < TIMING_NB_BUCKET;j++)
+			calls = calls + histo[j];
+		if (all == true && calls == 0)
+			continue;
+
+		sprintf(line,"%s\t%llu",timing_stats_index[i],calls);
+		lines.push_back(line);
+		for (int j = 0;j < TIMING_NB_BUCKET;j++)
+		{
+			if (histo[j] == 0)
+				continue;
+			double low,high;
+			TimingStats::get_bucket_limits(j,low,high);
+			sprintf(line,"%.3f\t%.3f\t%llu",low,high,histo[j]);
+			lines.push_back(line);
+		}
+	}
+
+	if (all == false && lines.empty() == true)
+	{
+		TangoSys_OMemStream o;
+		o << "Command " << cmd_name << " is not timed" << std::ends;
+		Tango::Except::throw_exception((const char *)DB_IncorrectArguments,o.str(),
+					(const char *)"DataBase::get_timing_histogram()");
+	}
+
+	argout = new Tango::DevVarStringArray();
+	argout->length(lines.size());
+	for (size_t i = 0;i < lines.size();i++)
+		(*argout)[i] = CORBA::string_dup(lines[i].c_str());
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::get_timing_histogram
+	return argout;
+}
+//--------------------------------------------------------
+/**
+ *	Command GetSqlProfile related method
+ *	Description: SQL statements profile since the last ResetTimingValues.
+ *               Per command: Average number of statements and average time (ms) spent waiting for a MySQL
+ *               connection, executing the statements, transferring their results and in the command itself.
+ *               Per statement template (literals replaced by ?): Count, total execution and result transfer
+ *               times (ms), maximum duration (ms) and number of rows, the most expensive first.
+ *
+ *	@returns Tab separated lines, per command then per statement template
+ */
+//--------------------------------------------------------
+Tango::DevVarStringArray *DataBase::get_sql_profile()
+{
+	Tango::DevVarStringArray *argout;
+	DEBUG_STREAM << "DataBase::GetSqlProfile()  - " << device_name << std::endl;
+	/*----- PROTECTED REGION ID(DataBase::get_sql_profile) ENABLED START -----*/
+
+	//	Add your own code
+	std::vector<std::string> cmd_names;
+	for (int i = 0;i < timing_stats.get_nb_cmd();i++)
+		cmd_names.push_back(timing_stats.get_name(i));
+
+	std::vector<std::string> lines;
+	sql_profile.get_report(cmd_names,lines);
+
+	argout = new Tango::DevVarStringArray();
+	argout->length(lines.size());
+	for (size_t i = 0;i < lines.size();i++)
+		(*argout)[i] = CORBA::string_dup(lines[i].c_str());
+
+	/*----- PROTECTED REGION END -----*/	//	DataBase::get_sql_profile
+	return argout;
+}
+//--------------------------------------------------------
 /**
  *	Method      : DataBase::add_dynamic_commands()
  *	Description : Create the dynamic commands if any
@@ -9356,39 +9767,20 @@ void DataBase::create_update_mem_att(const Tango::DevVarStringArray *argin)
 {
     const char *tmp_device = (*argin)[0];
     const char *tmp_attribute = (*argin)[2];
+    std::string value_buf;
+    const char *value = stored_value((*argin)[6],value_buf);
 
 //
 // First the update
 //
 
-    std::stringstream sql_query_stream;
-    std::string tmp_escaped_string = escape_string((*argin)[6]);
-    sql_query_stream << "UPDATE property_attribute_device SET value=\"" << tmp_escaped_string
-                     << "\" WHERE device=\"" << tmp_device << "\" AND attribute=\"" << tmp_attribute
-                     << "\" AND name=\"__value\" AND count=1";
-    DEBUG_STREAM << "DataBase::PutAttributeProperty2(): sql_query " << sql_query_stream.str() << std::endl;
-
-    int con_nb = get_connection();
-
-    std::string sql_query = sql_query_stream.str();
-	if (mysql_real_query(conn_pool[con_nb].db, sql_query.c_str(),sql_query.length()) != 0)
-	{
-		std::stringstream o;
-
-		WARN_STREAM << "DataBase::db_put_device_attribute_property2() failed to query TANGO database:" << std::endl;
-		WARN_STREAM << "  query = " << sql_query << std::endl;
-		WARN_STREAM << " (SQL error=" << mysql_error(conn_pool[con_nb].db) << ")" << std::endl;
-
-		o << "Failed to query TANGO database (error=" << mysql_error(conn_pool[con_nb].db) << ")";
-		o << "\n.The query was: " << sql_query << std::ends;
-
-        release_connection(con_nb);
-
-		Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),"Database::db_put_device_attribute_property2()");
-	}
+    DbStmt update_stmt(this,STMT_UPDATE_MEM_ATT,-1,"db_put_device_attribute_property2()");
+    update_stmt.bind(value);
+    update_stmt.bind(tmp_device);
+    update_stmt.bind(tmp_attribute);
+    update_stmt.execute();
 
-    my_ulonglong nb_rows = mysql_affected_rows(conn_pool[con_nb].db);
-    if (nb_rows == 0)
+    if (update_stmt.get_affected_rows() == 0)
     {
 
 //
@@ -9396,32 +9788,12 @@ void DataBase::create_update_mem_att(const Tango::DevVarStringArray *argin)
 // created in DB. Therefore, create it now
 //
 
-        sql_query_stream.str("");
-        sql_query_stream << "INSERT INTO property_attribute_device SET device=\'"
-                         << tmp_device << "\',attribute=\'" << tmp_attribute
-                         << "\',name=\'__value\',count=1,value=\'" << tmp_escaped_string << "\',updated=NOW(),accessed=NOW()";
-        DEBUG_STREAM << "DataBase::PutAttributeProperty(): sql_query " << sql_query_stream.str() << std::endl;
-
-        sql_query = sql_query_stream.str();
-        if (mysql_real_query(conn_pool[con_nb].db, sql_query.c_str(),sql_query.length()) != 0)
-        {
-            std::stringstream o;
-
-            WARN_STREAM << "DataBase::db_put_device_attribute_property2() failed to query TANGO database:" << std::endl;
-            WARN_STREAM << "  query = " << sql_query << std::endl;
-            WARN_STREAM << " (SQL error=" << mysql_error(conn_pool[con_nb].db) << ")" << std::endl;
-
-            o << "Failed to query TANGO database (error=" << mysql_error(conn_pool[con_nb].db) << ")";
-            o << "\n.The query was: " << sql_query << std::ends;
-
-            release_connection(con_nb);
-
-            Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),"Database::db_put_device_attribute_property2()");
-        }
-
+        DbStmt insert_stmt(this,STMT_INSERT_MEM_ATT,update_stmt.get_con_nb(),"db_put_device_attribute_property2()");
+        insert_stmt.bind(tmp_device);
+        insert_stmt.bind(tmp_attribute);
+        insert_stmt.bind(value);
+        insert_stmt.execute();
     }
-
-    release_connection(con_nb);
 }
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::namespace_ending
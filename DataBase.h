@@ -50,6 +50,18 @@
 #endif
 #include <mysql.h>
 #include <update_starter.h>
+#include <import_cache.h>
+#include <server_cache.h>
+#include <timing_stats.h>
+#include <sql_profile.h>
+#include <metrics_server.h>
+#include <conn_pool.h>
+#include <hist_purge.h>
+#include <hist_writer.h>
+#include <ds_start.h>
+#include <db_helpers.h>
+#include <mysql_storage.h>
+#include <memory_storage.h>
 
 #ifndef LIBMARIADB
 #if MYSQL_VERSION_ID >= 80001
@@ -57,6 +69,8 @@ typedef bool my_bool;
 #endif
 #endif
 
+#include <db_stmt.h>
+
 #define DB_SQLError 				"DB_SQLError"
 #define DB_IncorrectArguments		"DB_IncorrectArguments"
 #define DB_IncorrectDeviceName		"DB_IncorrectDeviceName"
@@ -66,10 +80,18 @@ typedef bool my_bool;
 #define	DB_NoFreeMySQLConnection	"DB_NoFreeMySQLConnection"
 #define	DB_MySQLLibNotThreadSafe	"DB_MySQLLibNotThreadSafe"
 
+//	Log streams of the DataBase device, for the classes working for it
+//	(history writer, storage engines)
+#define	DB_ERROR_STREAM(db)	if (db->get_logger()->is_error_enabled()) db->get_logger()->error_stream() << log4tango::LogInitiator::_begin_log
+#define	DB_WARN_STREAM(db)	if (db->get_logger()->is_warn_enabled()) db->get_logger()->warn_stream() << log4tango::LogInitiator::_begin_log
+#define	DB_INFO_STREAM(db)	if (db->get_logger()->is_info_enabled()) db->get_logger()->info_stream() << log4tango::LogInitiator::_begin_log
+
 #define	STARTER_DEVNAME_DOMAIN		"tango"
 #define	STARTER_DEVNAME_FAMILY		"/admin/"
 
 #define	DEFAULT_CONN_POOL_SIZE		20
+#define	DEFAULT_MAX_INSERT_SIZE		1047552		// 1 MB - margin
+#define	MAX_INSERT_SIZE_MARGIN		1024
 
 //	Define time measuremnt type (depends on OS)
 #ifndef WIN32
@@ -154,19 +176,32 @@ public:
 	 */
 	UpdateStarter	*upd_starter_thread;
 
+	/**
+	 *	Import info caches (DbImportDevice and DbImportEvent)
+	 */
+	ImportCache	device_cache;
+	ImportCache	event_cache;
+
+	/**
+	 *	DbGetDataForServerCache replies cache
+	 */
+	ServerCache	server_cache;
+
+	/**
+	 *	DbGetDataForServerCacheDelta data versions
+	 */
+	ServerVersions	server_versions;
+
+	/**
+	 *	DbGetDataForServerCacheChunk retrievals in progress
+	 */
+	DsStartStreams	ds_start_streams;
+
 	/*
 	 * timing related variables
 	 */
-	typedef struct timing_stats_struct
-	{
-		double calls;
-		double total_elapsed;
-		double average;
-		double minimum;
-		double maximum;
-	} TimingStatsStruct;
-
-	std::map<std::string,TimingStatsStruct*> timing_stats_map;
+	TimingStats	timing_stats;
+	SqlProfile	sql_profile;
 
 	int timing_stats_size;
 	double *timing_stats_average;
@@ -189,6 +224,9 @@ public:
 private:
     std::string              mysql_db_name;
 
+	friend class MySqlStorage;
+	friend class MemoryStorage;
+
 	/*----- PROTECTED REGION END -----*/	//	DataBase::Data Members
 
 
@@ -201,6 +239,17 @@ public:
 	Tango::DevDouble	*attr_Timing_calls_read;
 	Tango::DevString	*attr_Timing_index_read;
 	Tango::DevString	*attr_Timing_info_read;
+	Tango::DevLong	*attr_Pool_in_use_read;
+	Tango::DevLong	*attr_Pool_waiters_read;
+	Tango::DevDouble	*attr_Pool_wait_histo_read;
+	Tango::DevString	*attr_Pool_wait_index_read;
+	Tango::DevLong	*attr_Pool_size_read;
+	Tango::DevLong	*attr_History_queue_depth_read;
+	Tango::DevDouble	*attr_History_queue_lag_read;
+	Tango::DevDouble	*attr_Timing_p50_read;
+	Tango::DevDouble	*attr_Timing_p90_read;
+	Tango::DevDouble	*attr_Timing_p99_read;
+	Tango::DevDouble	*attr_Timing_p999_read;
 
 //	Constructors and destructors
 public:
@@ -272,7 +321,7 @@ public:
  *	Description: 
  *
  *	Data type:	Tango::DevDouble
- *	Attr type:	Spectrum max = 64
+ *	Attr type:	Spectrum max = number of timed commands
  */
 	virtual void read_Timing_average(Tango::Attribute &attr);
 	virtual bool is_Timing_average_allowed(Tango::AttReqType type);
@@ -281,7 +330,7 @@ public:
  *	Description: 
  *
  *	Data type:	Tango::DevDouble
- *	Attr type:	Spectrum max = 64
+ *	Attr type:	Spectrum max = number of timed commands
  */
 	virtual void read_Timing_minimum(Tango::Attribute &attr);
 	virtual bool is_Timing_minimum_allowed(Tango::AttReqType type);
@@ -290,7 +339,7 @@ public:
  *	Description: 
  *
  *	Data type:	Tango::DevDouble
- *	Attr type:	Spectrum max = 64
+ *	Attr type:	Spectrum max = number of timed commands
  */
 	virtual void read_Timing_maximum(Tango::Attribute &attr);
 	virtual bool is_Timing_maximum_allowed(Tango::AttReqType type);
@@ -299,7 +348,7 @@ public:
  *	Description: 
  *
  *	Data type:	Tango::DevDouble
- *	Attr type:	Spectrum max = 64
+ *	Attr type:	Spectrum max = number of timed commands
  */
 	virtual void read_Timing_calls(Tango::Attribute &attr);
 	virtual bool is_Timing_calls_allowed(Tango::AttReqType type);
@@ -308,7 +357,7 @@ public:
  *	Description: 
  *
  *	Data type:	Tango::DevString
- *	Attr type:	Spectrum max = 64
+ *	Attr type:	Spectrum max = number of timed commands
  */
 	virtual void read_Timing_index(Tango::Attribute &attr);
 	virtual bool is_Timing_index_allowed(Tango::AttReqType type);
@@ -317,10 +366,109 @@ public:
  *	Description: 
  *
  *	Data type:	Tango::DevString
- *	Attr type:	Spectrum max = 64
+ *	Attr type:	Spectrum max = number of timed commands + 4
  */
 	virtual void read_Timing_info(Tango::Attribute &attr);
 	virtual bool is_Timing_info_allowed(Tango::AttReqType type);
+/**
+ *	Attribute Pool_in_use related methods
+ *	Description: Number of MySQL connections in use
+ *
+ *	Data type:	Tango::DevLong
+ *	Attr type:	Scalar
+ */
+	virtual void read_Pool_in_use(Tango::Attribute &attr);
+	virtual bool is_Pool_in_use_allowed(Tango::AttReqType type);
+/**
+ *	Attribute Pool_waiters related methods
+ *	Description: Number of requests waiting for a free MySQL connection
+ *
+ *	Data type:	Tango::DevLong
+ *	Attr type:	Scalar
+ */
+	virtual void read_Pool_waiters(Tango::Attribute &attr);
+	virtual bool is_Pool_waiters_allowed(Tango::AttReqType type);
+/**
+ *	Attribute Pool_wait_histo related methods
+ *	Description: Histogram of the time spent to get a MySQL connection (see Pool_wait_index)
+ *
+ *	Data type:	Tango::DevDouble
+ *	Attr type:	Spectrum max = 8
+ */
+	virtual void read_Pool_wait_histo(Tango::Attribute &attr);
+	virtual bool is_Pool_wait_histo_allowed(Tango::AttReqType type);
+/**
+ *	Attribute Pool_wait_index related methods
+ *	Description: Pool_wait_histo buckets
+ *
+ *	Data type:	Tango::DevString
+ *	Attr type:	Spectrum max = 8
+ */
+	virtual void read_Pool_wait_index(Tango::Attribute &attr);
+	virtual bool is_Pool_wait_index_allowed(Tango::AttReqType type);
+/**
+ *	Attribute Pool_size related methods
+ *	Description: Number of MySQL connections currently opened in the pool (between poolMinSize and the -poolSize option)
+ *
+ *	Data type:	Tango::DevLong
+ *	Attr type:	Scalar
+ */
+	virtual void read_Pool_size(Tango::Attribute &attr);
+	virtual bool is_Pool_size_allowed(Tango::AttReqType type);
+/**
+ *	Attribute History_queue_depth related methods
+ *	Description: Number of history records waiting for the asynchronous history writer
+ *
+ *	Data type:	Tango::DevLong
+ *	Attr type:	Scalar
+ */
+	virtual void read_History_queue_depth(Tango::Attribute &attr);
+	virtual bool is_History_queue_depth_allowed(Tango::AttReqType type);
+/**
+ *	Attribute History_queue_lag related methods
+ *	Description: Age (ms) of the oldest history record not yet written by the asynchronous history writer
+ *
+ *	Data type:	Tango::DevDouble
+ *	Attr type:	Scalar
+ */
+	virtual void read_History_queue_lag(Tango::Attribute &attr);
+	virtual bool is_History_queue_lag_allowed(Tango::AttReqType type);
+/**
+ *	Attribute Timing_p50 related methods
+ *	Description: Median command durations (ms) since the last ResetTimingValues, in the Timing_index order
+ *
+ *	Data type:	Tango::DevDouble
+ *	Attr type:	Spectrum max = number of timed commands
+ */
+	virtual void read_Timing_p50(Tango::Attribute &attr);
+	virtual bool is_Timing_p50_allowed(Tango::AttReqType type);
+/**
+ *	Attribute Timing_p90 related methods
+ *	Description: 90th percentile of the command durations (ms) since the last ResetTimingValues, in the Timing_index order
+ *
+ *	Data type:	Tango::DevDouble
+ *	Attr type:	Spectrum max = number of timed commands
+ */
+	virtual void read_Timing_p90(Tango::Attribute &attr);
+	virtual bool is_Timing_p90_allowed(Tango::AttReqType type);
+/**
+ *	Attribute Timing_p99 related methods
+ *	Description: 99th percentile of the command durations (ms) since the last ResetTimingValues, in the Timing_index order
+ *
+ *	Data type:	Tango::DevDouble
+ *	Attr type:	Spectrum max = number of timed commands
+ */
+	virtual void read_Timing_p99(Tango::Attribute &attr);
+	virtual bool is_Timing_p99_allowed(Tango::AttReqType type);
+/**
+ *	Attribute Timing_p999 related methods
+ *	Description: 99.9th percentile of the command durations (ms) since the last ResetTimingValues, in the Timing_index order
+ *
+ *	Data type:	Tango::DevDouble
+ *	Attr type:	Spectrum max = number of timed commands
+ */
+	virtual void read_Timing_p999(Tango::Attribute &attr);
+	virtual bool is_Timing_p999_allowed(Tango::AttReqType type);
 
 
 	//--------------------------------------------------------
@@ -1479,6 +1627,85 @@ public:
 	virtual Tango::DevVarStringArray *db_get_forwarded_attribute_list_for_device(Tango::DevString argin);
 	virtual bool is_DbGetForwardedAttributeListForDevice_allowed(const CORBA::Any &any);
 
+	/**
+	 *	Command DbGetDataForServerCacheRaw related method
+	 *	Description: Same data than the DbGetDataForServerCache command, returned as one block.
+	 *             The elements are separated by a NUL character (encoded format "ds_start").
+	 *             This avoids building one CORBA string per element.
+	 *
+	 *	@param argin Elt[0] = DS name (exec_name/inst_name), Elt[1] = Host name
+	 *	@returns All the data needed by the device server during its startup sequence, separated by NUL characters
+	 */
+	virtual Tango::DevEncoded *db_get_data_for_server_cache_raw(const Tango::DevVarStringArray *argin);
+	virtual bool is_DbGetDataForServerCacheRaw_allowed(const CORBA::Any &any);
+	/**
+	 *	Command DbGetDataForServerCacheList related method
+	 *	Description: Same data than the DbGetDataForServerCache command for several servers in one call (Starter).
+	 *             The data common to all servers (DServer and Default class properties, notifd event,
+	 *             CtrlSystem properties) are read only once, with one database connection.
+	 *
+	 *	@param argin Elt[2n] = DS name (exec_name/inst_name), Elt[2n + 1] = Host name
+	 *	@returns Lvalue[n] = Number of strings in svalue for server n, Svalue = The DbGetDataForServerCache data of each server
+	 */
+	virtual Tango::DevVarLongStringArray *db_get_data_for_server_cache_list(const Tango::DevVarStringArray *argin);
+	virtual bool is_DbGetDataForServerCacheList_allowed(const CORBA::Any &any);
+	/**
+	 *	Command DbGetDataForServerCacheDelta related method
+	 *	Description: DbGetDataForServerCache data with a version token. Given the token of the data it already has,
+	 *             the client gets only the changes since this version (or nothing if unchanged).
+	 *
+	 *	@param argin Elt[0] = DS name (exec_name/inst_name), Elt[1] = Host name, Elt[2] = Token of the data previously received (optional)
+	 *	@returns Svalue[0] = Token of the current data. Lvalue[0] = 0: Data unchanged. Lvalue[0] = 1: Lvalue[1] = Number of hunks,
+	 *           then for each hunk: Index and number of the previous data elements replaced and number of new elements,
+	 *           the new elements being in Svalue from index 1. Lvalue[0] = 2: Svalue from index 1 = Full data
+	 */
+	virtual Tango::DevVarLongStringArray *db_get_data_for_server_cache_delta(const Tango::DevVarStringArray *argin);
+	virtual bool is_DbGetDataForServerCacheDelta_allowed(const CORBA::Any &any);
+	/**
+	 *	Command DbGetDataForServerCacheCompressed related method
+	 *	Description: Same data than the DbGetDataForServerCache command, compressed with zlib in one block
+	 *             (encoded format "ds_start_zlib"). See benchmark/ds_start_decode.cpp for a decoder.
+	 *
+	 *	@param argin Elt[0] = DS name (exec_name/inst_name), Elt[1] = Host name
+	 *	@returns Uncompressed size (4 bytes, big endian) followed by the zlib stream of the data separated by NUL characters
+	 */
+	virtual Tango::DevEncoded *db_get_data_for_server_cache_compressed(const Tango::DevVarStringArray *argin);
+	virtual bool is_DbGetDataForServerCacheCompressed_allowed(const CORBA::Any &any);
+	/**
+	 *	Command DbGetDataForServerCacheChunk related method
+	 *	Description: Same data than the DbGetDataForServerCache command, returned by parts of bounded size.
+	 *             The data are built part by part, there is no size limit on the whole data.
+	 *
+	 *	@param argin Elt[0] = DS name (exec_name/inst_name), Elt[1] = Host name, Elt[2] = Continuation token (empty or missing for the first part),
+	 *             Elt[3] = Maximum number of elements per part (optional, default 10000)
+	 *	@returns Lvalue[0] = 1 if more parts follow, 0 for the last one. Svalue[0] = Continuation token for the next part,
+	 *           Svalue from index 1 = The data elements of this part
+	 */
+	virtual Tango::DevVarLongStringArray *db_get_data_for_server_cache_chunk(const Tango::DevVarStringArray *argin);
+	virtual bool is_DbGetDataForServerCacheChunk_allowed(const CORBA::Any &any);
+	/**
+	 *	Command GetTimingHistogram related method
+	 *	Description: Dump the latency histogram of timed commands since the last ResetTimingValues.
+	 *             For each command: One line with its name and number of calls, then one line
+	 *             per non empty bucket with the bucket limits (ms) and count (tab separated).
+	 *
+	 *	@param argin Command name (empty or * for all the called commands)
+	 *	@returns Command name and calls, then lower limit, upper limit and count of each bucket
+	 */
+	virtual Tango::DevVarStringArray *get_timing_histogram(Tango::DevString argin);
+	virtual bool is_GetTimingHistogram_allowed(const CORBA::Any &any);
+	/**
+	 *	Command GetSqlProfile related method
+	 *	Description: SQL statements profile since the last ResetTimingValues.
+	 *             Per command: Average number of statements and average time (ms) spent waiting for a MySQL
+	 *             connection, executing the statements, transferring their results and in the command itself.
+	 *             Per statement template (literals replaced by ?): Count, total execution and result transfer
+	 *             times (ms), maximum duration (ms) and number of rows, the most expensive first.
+	 *
+	 *	@returns Tab separated lines, per command then per statement template
+	 */
+	virtual Tango::DevVarStringArray *get_sql_profile();
+	virtual bool is_GetSqlProfile_allowed(const CORBA::Any &any);
 
 	//--------------------------------------------------------
 	/**
@@ -1494,14 +1721,19 @@ public:
 protected :
 	unsigned long	mysql_svr_version;
 
-	bool check_device_name(std::string &);
-	bool device_name_to_dfm(std::string &device_name, char domain[], char family[], char member[]);
-	std::string replace_wildcard(const char*);
 	Tango::DevString db_get_device_host(Tango::DevString,int con_nb=-1);
-	std::string escape_string(const char *string_c_str);
 	void init_timing_stats();
+	void read_timing_percentile(Tango::Attribute &,Tango::DevDouble *,double);
 	Tango::DevULong64 get_id(const char *name,int con_nb=-1);
 	void check_history_tables();
+	long get_long_property(const char *,long);
+	std::string get_string_property(const char *,const char *);
+	void check_table_engine();
+	void read_max_allowed_packet();
+	void get_server_cache_dependencies(const std::string &,ServerCache::ServerEntry &,int con_nb=-1);
+	void get_server_data(const Tango::DevVarStringArray *,ServerData &);
+	void get_server_list_data(const Tango::DevVarStringArray *,std::vector<std::vector<std::string> > &);
+	void request_purge(const char *table,const std::string &cond,int con_nb);
 	void purge_property(const char *table,const char *field,const char *object,const char *name,int con_nb=-1);
 	void purge_att_property(const char *table,const char *field,const char *object,const char *attribute,const char *name,int con_nb=-1);
 	void purge_pipe_property(const char *table,const char *field,const char *object,const char *pipe,const char *name,int con_nb=-1);
@@ -1509,40 +1741,57 @@ protected :
 	typedef struct
 	{
 		MYSQL 			*db;
-		omni_semaphore 	the_sema;
+		MYSQL_STMT		*stmt[STMT_NB];
+		std::vector<HistRecord>	hist_pending;
 	}DbConnection;
+	typedef struct
+	{
+		std::string		user;
+		std::string		password;
+		std::string		host;
+		bool			user_def;
+		bool			password_def;
+		bool			host_def;
+		unsigned int	port;
+	}ConnParams;
 	DbConnection	*conn_pool;
-	int				last_sem_wait;
+	ConnPool		pool;
+	PoolMaintainer	*pool_maintainer;
+	PurgeQueue		purge_queue;
+	HistoryPurger	*hist_purger;
+	HistoryQueue	hist_queue;
+	HistoryWriter	*hist_writer;
+	MetricsServer	*metrics_server;
+	DbStorage		*storage;
+	ConnParams		conn_params;
 	static int		conn_pool_size;
+	int				id_con_nb;
+	bool			transactional_engine;
+	bool			native_ds_start;
+	long			ds_start_fan_out;
+	unsigned long	max_insert_size;
 	char 			*stored_release_ptr;
 	char			stored_release[128];
 
-	std::string			ho;
-	char			ho_name[1024];
-
-	omni_mutex		timing_stats_mutex;
 	omni_mutex		starter_mutex;
-	omni_mutex		sem_wait_mutex;
+	omni_mutex		id_mutex;
 
 	void create_connection_pool(const char *,const char *,const char *,const char *);
 	void base_connect(int);
-	bool host_port_from_ior(const char *,std::string &);
     void create_update_mem_att(const Tango::DevVarStringArray *);
+	Tango::DevVarLongStringArray *import_entry_to_argout(ImportCache::ImportEntry &);
+
+public:
+
+//
+// Called by the timed commands (TimedCommand class)
+//
 
-	inline void update_timing_stats(TimeVal before, TimeVal after, std::string command)
+	inline void update_timing_stats(TimeVal before, TimeVal after, int command)
 	{
 		double time_elapsed = Elapsed(before, after);
-		timing_stats_mutex.lock();
-		TimingStatsStruct *timing_stats = timing_stats_map[command];
-		if (timing_stats != NULL)
-		{
-			timing_stats->calls++;
-			timing_stats->total_elapsed = timing_stats->total_elapsed+time_elapsed;
-			timing_stats->average = timing_stats->total_elapsed/timing_stats->calls;
-			if (time_elapsed > timing_stats->maximum) timing_stats->maximum = time_elapsed;
-			if (time_elapsed < timing_stats->minimum || timing_stats->minimum == 0.0) timing_stats->minimum = time_elapsed;
-		}
-		timing_stats_mutex.unlock();
+		timing_stats.update(command,time_elapsed);
+		sql_profile.end_command(command,time_elapsed);
 	}
 
 #ifdef WIN32
@@ -1560,14 +1809,30 @@ protected :
 	}
 #endif
 
-public:
-
 	void simple_query(std::string sql_query,const char *method,int con_nb=-1);
+	void profile_statement(const char *,size_t,TimeVal &,TimeVal &,TimeVal &,unsigned long long,const char *);
+	void get_metrics(std::string &);
 	MYSQL_RES *query(std::string sql_query,const char *method,int con_nb=-1);
 	static void set_conn_pool_size(int si) {conn_pool_size = si;}
+	bool is_transactional() {return transactional_engine;}
+	unsigned long get_max_insert_size() {return max_insert_size;}
 
 	int get_connection();
-	void release_connection(int con_nb) {conn_pool[con_nb].the_sema.post();}
+	int try_get_connection() {return pool.try_acquire();}
+	bool open_connection(int);
+	void close_connection(int);
+	MYSQL_STMT *get_stmt(int,DbStmtId,const char *);
+	MYSQL_STMT *reset_stmt(int,DbStmtId,const char *);
+	void close_stmts(int);
+	void purge_history(const char *,const std::string &,int con_nb=-1);
+	void start_purge(const char *,const std::string &,int con_nb=-1);
+	bool defer_history(int,const char *,const std::string &);
+	unsigned long long commit_history(int,unsigned long long &);
+	void drop_history(int con_nb) {if (con_nb >= 0) conn_pool[con_nb].hist_pending.clear();}
+	void wait_history(unsigned long long,unsigned long long);
+	void stmt_error(MYSQL_STMT *,DbStmtId,const char *);
+	const char *stored_value(const char *,std::string &);
+	void release_connection(int con_nb) {if (con_nb == id_con_nb) id_mutex.unlock(); else pool.release(con_nb);}
 
 	/*----- PROTECTED REGION END -----*/	//	DataBase::Additional Method prototypes
 };
@@ -1575,17 +1840,42 @@ public:
 /*----- PROTECTED REGION ID(DataBase::Additional Classes Definitions) ENABLED START -----*/
 
 	//	Additional Classes definitions
-class AutoLock
+enum TransactionMode {TRANSACTION_READ = 0, TRANSACTION_WRITE};
+
+class AutoTransaction
 {
 public:
-	AutoLock(const char *,DataBase *);
-	~AutoLock();
+	AutoTransaction(const char *,TransactionMode,DataBase *);
+	~AutoTransaction() noexcept(false);
 
+	void commit();
 	int get_con_nb() {return con_nb;}
 
 private:
 	DataBase	*the_db;
 	int 		con_nb;
+	bool		transactional;
+	bool		committed;
+	unsigned long long	hist_first;
+	unsigned long long	hist_seq;
+};
+
+class InsertBatch
+{
+public:
+	InsertBatch(DataBase *,const char *,int,const char *,bool hist=false);
+
+	void add(const std::string &);
+	void flush();
+
+private:
+	DataBase	*the_db;
+	std::string	head;
+	std::string	sql;
+	int			con_nb;
+	const char	*method;
+	int			nb_rows;
+	bool		history;
 };
 
 class DbInter: public Tango::Interceptors
@@ -2040,6 +2040,137 @@ CORBA::Any *DbGetForwardedAttributeListForDeviceClass::execute(Tango::DeviceImpl
 	return insert((static_cast<DataBase *>(device))->db_get_forwarded_attribute_list_for_device(argin));
 }
 
+//--------------------------------------------------------
+/**
+ * method : 		DbGetDataForServerCacheRawClass::execute()
+ * description : 	method to trigger the execution of the command.
+ *
+ * @param	device	The device on which the command must be executed
+ * @param	in_any	The command input data
+ *
+ *	returns The command output data (packed in the Any object)
+ */
+//--------------------------------------------------------
+CORBA::Any *DbGetDataForServerCacheRawClass::execute(Tango::DeviceImpl *device, const CORBA::Any &in_any)
+{
+	cout2 << "DbGetDataForServerCacheRawClass::execute(): arrived" << std::endl;
+	const Tango::DevVarStringArray *argin;
+	extract(in_any, argin);
+	return insert((static_cast<DataBase *>(device))->db_get_data_for_server_cache_raw(argin));
+}
+
+//--------------------------------------------------------
+/**
+ * method : 		DbGetDataForServerCacheListClass::execute()
+ * description : 	method to trigger the execution of the command.
+ *
+ * @param	device	The device on which the command must be executed
+ * @param	in_any	The command input data
+ *
+ *	returns The command output data (packed in the Any object)
+ */
+//--------------------------------------------------------
+CORBA::Any *DbGetDataForServerCacheListClass::execute(Tango::DeviceImpl *device, const CORBA::Any &in_any)
+{
+	cout2 << "DbGetDataForServerCacheListClass::execute(): arrived" << std::endl;
+	const Tango::DevVarStringArray *argin;
+	extract(in_any, argin);
+	return insert((static_cast<DataBase *>(device))->db_get_data_for_server_cache_list(argin));
+}
+
+//--------------------------------------------------------
+/**
+ * method : 		DbGetDataForServerCacheDeltaClass::execute()
+ * description : 	method to trigger the execution of the command.
+ *
+ * @param	device	The device on which the command must be executed
+ * @param	in_any	The command input data
+ *
+ *	returns The command output data (packed in the Any object)
+ */
+//--------------------------------------------------------
+CORBA::Any *DbGetDataForServerCacheDeltaClass::execute(Tango::DeviceImpl *device, const CORBA::Any &in_any)
+{
+	cout2 << "DbGetDataForServerCacheDeltaClass::execute(): arrived" << std::endl;
+	const Tango::DevVarStringArray *argin;
+	extract(in_any, argin);
+	return insert((static_cast<DataBase *>(device))->db_get_data_for_server_cache_delta(argin));
+}
+
+//--------------------------------------------------------
+/**
+ * method : 		DbGetDataForServerCacheCompressedClass::execute()
+ * description : 	method to trigger the execution of the command.
+ *
+ * @param	device	The device on which the command must be executed
+ * @param	in_any	The command input data
+ *
+ *	returns The command output data (packed in the Any object)
+ */
+//--------------------------------------------------------
+CORBA::Any *DbGetDataForServerCacheCompressedClass::execute(Tango::DeviceImpl *device, const CORBA::Any &in_any)
+{
+	cout2 << "DbGetDataForServerCacheCompressedClass::execute(): arrived" << std::endl;
+	const Tango::DevVarStringArray *argin;
+	extract(in_any, argin);
+	return insert((static_cast<DataBase *>(device))->db_get_data_for_server_cache_compressed(argin));
+}
+
+//--------------------------------------------------------
+/**
+ * method : 		DbGetDataForServerCacheChunkClass::execute()
+ * description : 	method to trigger the execution of the command.
+ *
+ * @param	device	The device on which the command must be executed
+ * @param	in_any	The command input data
+ *
+ *	returns The command output data (packed in the Any object)
+ */
+//--------------------------------------------------------
+CORBA::Any *DbGetDataForServerCacheChunkClass::execute(Tango::DeviceImpl *device, const CORBA::Any &in_any)
+{
+	cout2 << "DbGetDataForServerCacheChunkClass::execute(): arrived" << std::endl;
+	const Tango::DevVarStringArray *argin;
+	extract(in_any, argin);
+	return insert((static_cast<DataBase *>(device))->db_get_data_for_server_cache_chunk(argin));
+}
+
+//--------------------------------------------------------
+/**
+ * method : 		GetTimingHistogramClass::execute()
+ * description : 	method to trigger the execution of the command.
+ *
+ * @param	device	The device on which the command must be executed
+ * @param	in_any	The command input data
+ *
+ *	returns The command output data (packed in the Any object)
+ */
+//--------------------------------------------------------
+CORBA::Any *GetTimingHistogramClass::execute(Tango::DeviceImpl *device, const CORBA::Any &in_any)
+{
+	cout2 << "GetTimingHistogramClass::execute(): arrived" << std::endl;
+	Tango::DevString argin;
+	extract(in_any, argin);
+	return insert((static_cast<DataBase *>(device))->get_timing_histogram(argin));
+}
+
+//--------------------------------------------------------
+/**
+ * method : 		GetSqlProfileClass::execute()
+ * description : 	method to trigger the execution of the command.
+ *
+ * @param	device	The device on which the command must be executed
+ * @param	in_any	The command input data
+ *
+ *	returns The command output data (packed in the Any object)
+ */
+//--------------------------------------------------------
+CORBA::Any *GetSqlProfileClass::execute(Tango::DeviceImpl *device, TANGO_UNUSED(const CORBA::Any &in_any))
+{
+	cout2 << "GetSqlProfileClass::execute(): arrived" << std::endl;
+	return insert((static_cast<DataBase *>(device))->get_sql_profile());
+}
+
 
 //===================================================================
 //	Properties management
@@ -2180,7 +2311,17 @@ void DataBaseClass::attribute_factory(std::vector<Tango::Attr *> &att_list)
 {
 	/*----- PROTECTED REGION ID(DataBaseClass::attribute_factory_before) ENABLED START -----*/
 
-	//	Add your own code
+	//	The Timing_xxx spectrums have one element per timed command (the
+	//	commands are created and wrapped before the attributes)
+	std::vector<std::string> timed_names;
+	TimedCommand::get_names(get_command_list(),timed_names);
+	long nb_timed = timed_names.size();
+	if (nb_timed == 0)
+	{
+		Tango::Except::throw_exception((const char *)"DB_TimingNoCommand",
+			"No timed command: The Timing_xxx attributes cannot be sized",
+			(const char *)"DataBaseClass::attribute_factory()");
+	}
 
 	/*----- PROTECTED REGION END -----*/	//	DataBaseClass::attribute_factory_before
 	//	Attribute : StoredProcedureRelease
@@ -2208,7 +2349,7 @@ void DataBaseClass::attribute_factory(std::vector<Tango::Attr *> &att_list)
 	att_list.push_back(storedprocedurerelease);
 
 	//	Attribute : Timing_average
-	Timing_averageAttrib	*timing_average = new Timing_averageAttrib();
+	Timing_averageAttrib	*timing_average = new Timing_averageAttrib(nb_timed);
 	Tango::UserDefaultAttrProp	timing_average_prop;
 	//	description	not set for Timing_average
 	//	label	not set for Timing_average
@@ -2232,7 +2373,7 @@ void DataBaseClass::attribute_factory(std::vector<Tango::Attr *> &att_list)
 	att_list.push_back(timing_average);
 
 	//	Attribute : Timing_minimum
-	Timing_minimumAttrib	*timing_minimum = new Timing_minimumAttrib();
+	Timing_minimumAttrib	*timing_minimum = new Timing_minimumAttrib(nb_timed);
 	Tango::UserDefaultAttrProp	timing_minimum_prop;
 	//	description	not set for Timing_minimum
 	//	label	not set for Timing_minimum
@@ -2256,7 +2397,7 @@ void DataBaseClass::attribute_factory(std::vector<Tango::Attr *> &att_list)
 	att_list.push_back(timing_minimum);
 
 	//	Attribute : Timing_maximum
-	Timing_maximumAttrib	*timing_maximum = new Timing_maximumAttrib();
+	Timing_maximumAttrib	*timing_maximum = new Timing_maximumAttrib(nb_timed);
 	Tango::UserDefaultAttrProp	timing_maximum_prop;
 	//	description	not set for Timing_maximum
 	//	label	not set for Timing_maximum
@@ -2280,7 +2421,7 @@ void DataBaseClass::attribute_factory(std::vector<Tango::Attr *> &att_list)
 	att_list.push_back(timing_maximum);
 
 	//	Attribute : Timing_calls
-	Timing_callsAttrib	*timing_calls = new Timing_callsAttrib();
+	Timing_callsAttrib	*timing_calls = new Timing_callsAttrib(nb_timed);
 	Tango::UserDefaultAttrProp	timing_calls_prop;
 	//	description	not set for Timing_calls
 	//	label	not set for Timing_calls
@@ -2304,7 +2445,7 @@ void DataBaseClass::attribute_factory(std::vector<Tango::Attr *> &att_list)
 	att_list.push_back(timing_calls);
 
 	//	Attribute : Timing_index
-	Timing_indexAttrib	*timing_index = new Timing_indexAttrib();
+	Timing_indexAttrib	*timing_index = new Timing_indexAttrib(nb_timed);
 	Tango::UserDefaultAttrProp	timing_index_prop;
 	//	description	not set for Timing_index
 	//	label	not set for Timing_index
@@ -2328,7 +2469,7 @@ void DataBaseClass::attribute_factory(std::vector<Tango::Attr *> &att_list)
 	att_list.push_back(timing_index);
 
 	//	Attribute : Timing_info
-	Timing_infoAttrib	*timing_info = new Timing_infoAttrib();
+	Timing_infoAttrib	*timing_info = new Timing_infoAttrib(nb_timed + TIMING_INFO_HEADER);
 	Tango::UserDefaultAttrProp	timing_info_prop;
 	//	description	not set for Timing_info
 	//	label	not set for Timing_info
@@ -2351,6 +2492,270 @@ void DataBaseClass::attribute_factory(std::vector<Tango::Attr *> &att_list)
 	//	Not Memorized
 	att_list.push_back(timing_info);
 
+	//	Attribute : Pool_in_use
+	Pool_in_useAttrib	*pool_in_use = new Pool_in_useAttrib();
+	Tango::UserDefaultAttrProp	pool_in_use_prop;
+	pool_in_use_prop.set_description("Number of MySQL connections in use");
+	//	label	not set for Pool_in_use
+	//	unit	not set for Pool_in_use
+	//	standard_unit	not set for Pool_in_use
+	//	display_unit	not set for Pool_in_use
+	//	format	not set for Pool_in_use
+	//	max_value	not set for Pool_in_use
+	//	min_value	not set for Pool_in_use
+	//	max_alarm	not set for Pool_in_use
+	//	min_alarm	not set for Pool_in_use
+	//	max_warning	not set for Pool_in_use
+	//	min_warning	not set for Pool_in_use
+	//	delta_t	not set for Pool_in_use
+	//	delta_val	not set for Pool_in_use
+	
+	pool_in_use->set_default_properties(pool_in_use_prop);
+	//	Not Polled
+	pool_in_use->set_disp_level(Tango::OPERATOR);
+	//	Not Memorized
+	att_list.push_back(pool_in_use);
+
+	//	Attribute : Pool_waiters
+	Pool_waitersAttrib	*pool_waiters = new Pool_waitersAttrib();
+	Tango::UserDefaultAttrProp	pool_waiters_prop;
+	pool_waiters_prop.set_description("Number of requests waiting for a free MySQL connection");
+	//	label	not set for Pool_waiters
+	//	unit	not set for Pool_waiters
+	//	standard_unit	not set for Pool_waiters
+	//	display_unit	not set for Pool_waiters
+	//	format	not set for Pool_waiters
+	//	max_value	not set for Pool_waiters
+	//	min_value	not set for Pool_waiters
+	//	max_alarm	not set for Pool_waiters
+	//	min_alarm	not set for Pool_waiters
+	//	max_warning	not set for Pool_waiters
+	//	min_warning	not set for Pool_waiters
+	//	delta_t	not set for Pool_waiters
+	//	delta_val	not set for Pool_waiters
+	
+	pool_waiters->set_default_properties(pool_waiters_prop);
+	//	Not Polled
+	pool_waiters->set_disp_level(Tango::OPERATOR);
+	//	Not Memorized
+	att_list.push_back(pool_waiters);
+
+	//	Attribute : Pool_wait_histo
+	Pool_wait_histoAttrib	*pool_wait_histo = new Pool_wait_histoAttrib();
+	Tango::UserDefaultAttrProp	pool_wait_histo_prop;
+	pool_wait_histo_prop.set_description("Histogram of the time spent to get a MySQL connection (see Pool_wait_index)");
+	//	label	not set for Pool_wait_histo
+	//	unit	not set for Pool_wait_histo
+	//	standard_unit	not set for Pool_wait_histo
+	//	display_unit	not set for Pool_wait_histo
+	//	format	not set for Pool_wait_histo
+	//	max_value	not set for Pool_wait_histo
+	//	min_value	not set for Pool_wait_histo
+	//	max_alarm	not set for Pool_wait_histo
+	//	min_alarm	not set for Pool_wait_histo
+	//	max_warning	not set for Pool_wait_histo
+	//	min_warning	not set for Pool_wait_histo
+	//	delta_t	not set for Pool_wait_histo
+	//	delta_val	not set for Pool_wait_histo
+	
+	pool_wait_histo->set_default_properties(pool_wait_histo_prop);
+	//	Not Polled
+	pool_wait_histo->set_disp_level(Tango::OPERATOR);
+	//	Not Memorized
+	att_list.push_back(pool_wait_histo);
+
+	//	Attribute : Pool_wait_index
+	Pool_wait_indexAttrib	*pool_wait_index = new Pool_wait_indexAttrib();
+	Tango::UserDefaultAttrProp	pool_wait_index_prop;
+	pool_wait_index_prop.set_description("Pool_wait_histo buckets");
+	//	label	not set for Pool_wait_index
+	//	unit	not set for Pool_wait_index
+	//	standard_unit	not set for Pool_wait_index
+	//	display_unit	not set for Pool_wait_index
+	//	format	not set for Pool_wait_index
+	//	max_value	not set for Pool_wait_index
+	//	min_value	not set for Pool_wait_index
+	//	max_alarm	not set for Pool_wait_index
+	//	min_alarm	not set for Pool_wait_index
+	//	max_warning	not set for Pool_wait_index
+	//	min_warning	not set for Pool_wait_index
+	//	delta_t	not set for Pool_wait_index
+	//	delta_val	not set for Pool_wait_index
+	
+	pool_wait_index->set_default_properties(pool_wait_index_prop);
+	//	Not Polled
+	pool_wait_index->set_disp_level(Tango::OPERATOR);
+	//	Not Memorized
+	att_list.push_back(pool_wait_index);
+
+	//	Attribute : Pool_size
+	Pool_sizeAttrib	*pool_size = new Pool_sizeAttrib();
+	Tango::UserDefaultAttrProp	pool_size_prop;
+	pool_size_prop.set_description("Number of MySQL connections currently opened in the pool (between poolMinSize and the -poolSize option)");
+	//	label	not set for Pool_size
+	//	unit	not set for Pool_size
+	//	standard_unit	not set for Pool_size
+	//	display_unit	not set for Pool_size
+	//	format	not set for Pool_size
+	//	max_value	not set for Pool_size
+	//	min_value	not set for Pool_size
+	//	max_alarm	not set for Pool_size
+	//	min_alarm	not set for Pool_size
+	//	max_warning	not set for Pool_size
+	//	min_warning	not set for Pool_size
+	//	delta_t	not set for Pool_size
+	//	delta_val	not set for Pool_size
+	
+	pool_size->set_default_properties(pool_size_prop);
+	//	Not Polled
+	pool_size->set_disp_level(Tango::OPERATOR);
+	//	Not Memorized
+	att_list.push_back(pool_size);
+
+	//	Attribute : History_queue_depth
+	History_queue_depthAttrib	*history_queue_depth = new History_queue_depthAttrib();
+	Tango::UserDefaultAttrProp	history_queue_depth_prop;
+	history_queue_depth_prop.set_description("Number of history records waiting for the asynchronous history writer");
+	//	label	not set for History_queue_depth
+	//	unit	not set for History_queue_depth
+	//	standard_unit	not set for History_queue_depth
+	//	display_unit	not set for History_queue_depth
+	//	format	not set for History_queue_depth
+	//	max_value	not set for History_queue_depth
+	//	min_value	not set for History_queue_depth
+	//	max_alarm	not set for History_queue_depth
+	//	min_alarm	not set for History_queue_depth
+	//	max_warning	not set for History_queue_depth
+	//	min_warning	not set for History_queue_depth
+	//	delta_t	not set for History_queue_depth
+	//	delta_val	not set for History_queue_depth
+	
+	history_queue_depth->set_default_properties(history_queue_depth_prop);
+	//	Not Polled
+	history_queue_depth->set_disp_level(Tango::OPERATOR);
+	//	Not Memorized
+	att_list.push_back(history_queue_depth);
+
+	//	Attribute : History_queue_lag
+	History_queue_lagAttrib	*history_queue_lag = new History_queue_lagAttrib();
+	Tango::UserDefaultAttrProp	history_queue_lag_prop;
+	history_queue_lag_prop.set_description("Age (ms) of the oldest history record not yet written by the asynchronous history writer");
+	//	label	not set for History_queue_lag
+	//	unit	not set for History_queue_lag
+	//	standard_unit	not set for History_queue_lag
+	//	display_unit	not set for History_queue_lag
+	//	format	not set for History_queue_lag
+	//	max_value	not set for History_queue_lag
+	//	min_value	not set for History_queue_lag
+	//	max_alarm	not set for History_queue_lag
+	//	min_alarm	not set for History_queue_lag
+	//	max_warning	not set for History_queue_lag
+	//	min_warning	not set for History_queue_lag
+	//	delta_t	not set for History_queue_lag
+	//	delta_val	not set for History_queue_lag
+	
+	history_queue_lag->set_default_properties(history_queue_lag_prop);
+	//	Not Polled
+	history_queue_lag->set_disp_level(Tango::OPERATOR);
+	//	Not Memorized
+	att_list.push_back(history_queue_lag);
+
+	//	Attribute : Timing_p50
+	Timing_p50Attrib	*timing_p50 = new Timing_p50Attrib(nb_timed);
+	Tango::UserDefaultAttrProp	timing_p50_prop;
+	timing_p50_prop.set_description("Median command durations (ms) since the last ResetTimingValues, in the Timing_index order");
+	//	label	not set for Timing_p50
+	//	unit	not set for Timing_p50
+	//	standard_unit	not set for Timing_p50
+	//	display_unit	not set for Timing_p50
+	//	format	not set for Timing_p50
+	//	max_value	not set for Timing_p50
+	//	min_value	not set for Timing_p50
+	//	max_alarm	not set for Timing_p50
+	//	min_alarm	not set for Timing_p50
+	//	max_warning	not set for Timing_p50
+	//	min_warning	not set for Timing_p50
+	//	delta_t	not set for Timing_p50
+	//	delta_val	not set for Timing_p50
+	
+	timing_p50->set_default_properties(timing_p50_prop);
+	//	Not Polled
+	timing_p50->set_disp_level(Tango::OPERATOR);
+	//	Not Memorized
+	att_list.push_back(timing_p50);
+
+	//	Attribute : Timing_p90
+	Timing_p90Attrib	*timing_p90 = new Timing_p90Attrib(nb_timed);
+	Tango::UserDefaultAttrProp	timing_p90_prop;
+	timing_p90_prop.set_description("90th percentile of the command durations (ms) since the last ResetTimingValues, in the Timing_index order");
+	//	label	not set for Timing_p90
+	//	unit	not set for Timing_p90
+	//	standard_unit	not set for Timing_p90
+	//	display_unit	not set for Timing_p90
+	//	format	not set for Timing_p90
+	//	max_value	not set for Timing_p90
+	//	min_value	not set for Timing_p90
+	//	max_alarm	not set for Timing_p90
+	//	min_alarm	not set for Timing_p90
+	//	max_warning	not set for Timing_p90
+	//	min_warning	not set for Timing_p90
+	//	delta_t	not set for Timing_p90
+	//	delta_val	not set for Timing_p90
+	
+	timing_p90->set_default_properties(timing_p90_prop);
+	//	Not Polled
+	timing_p90->set_disp_level(Tango::OPERATOR);
+	//	Not Memorized
+	att_list.push_back(timing_p90);
+
+	//	Attribute : Timing_p99
+	Timing_p99Attrib	*timing_p99 = new Timing_p99Attrib(nb_timed);
+	Tango::UserDefaultAttrProp	timing_p99_prop;
+	timing_p99_prop.set_description("99th percentile of the command durations (ms) since the last ResetTimingValues, in the Timing_index order");
+	//	label	not set for Timing_p99
+	//	unit	not set for Timing_p99
+	//	standard_unit	not set for Timing_p99
+	//	display_unit	not set for Timing_p99
+	//	format	not set for Timing_p99
+	//	max_value	not set for Timing_p99
+	//	min_value	not set for Timing_p99
+	//	max_alarm	not set for Timing_p99
+	//	min_alarm	not set for Timing_p99
+	//	max_warning	not set for Timing_p99
+	//	min_warning	not set for Timing_p99
+	//	delta_t	not set for Timing_p99
+	//	delta_val	not set for Timing_p99
+	
+	timing_p99->set_default_properties(timing_p99_prop);
+	//	Not Polled
+	timing_p99->set_disp_level(Tango::OPERATOR);
+	//	Not Memorized
+	att_list.push_back(timing_p99);
+
+	//	Attribute : Timing_p999
+	Timing_p999Attrib	*timing_p999 = new Timing_p999Attrib(nb_timed);
+	Tango::UserDefaultAttrProp	timing_p999_prop;
+	timing_p999_prop.set_description("99.9th percentile of the command durations (ms) since the last ResetTimingValues, in the Timing_index order");
+	//	label	not set for Timing_p999
+	//	unit	not set for Timing_p999
+	//	standard_unit	not set for Timing_p999
+	//	display_unit	not set for Timing_p999
+	//	format	not set for Timing_p999
+	//	max_value	not set for Timing_p999
+	//	min_value	not set for Timing_p999
+	//	max_alarm	not set for Timing_p999
+	//	min_alarm	not set for Timing_p999
+	//	max_warning	not set for Timing_p999
+	//	min_warning	not set for Timing_p999
+	//	delta_t	not set for Timing_p999
+	//	delta_val	not set for Timing_p999
+	
+	timing_p999->set_default_properties(timing_p999_prop);
+	//	Not Polled
+	timing_p999->set_disp_level(Tango::OPERATOR);
+	//	Not Memorized
+	att_list.push_back(timing_p999);
+
 
 	//	Create a list of static attributes
 	create_static_attribute_list(get_class_attr()->get_attr_list());
@@ -3267,8 +3672,74 @@ void DataBaseClass::command_factory()
 			Tango::OPERATOR);
 	command_list.push_back(pDbGetForwardedAttributeListForDeviceCmd);
 
+	//	Command DbGetDataForServerCacheRaw
+	DbGetDataForServerCacheRawClass	*pDbGetDataForServerCacheRawCmd =
+		new DbGetDataForServerCacheRawClass("DbGetDataForServerCacheRaw",
+			Tango::DEVVAR_STRINGARRAY, Tango::DEV_ENCODED,
+			"Elt[0] = DS name (exec_name/inst_name), Elt[1] = Host name",
+			"All the data needed by the device server during its startup sequence, separated by NUL characters",
+			Tango::OPERATOR);
+	command_list.push_back(pDbGetDataForServerCacheRawCmd);
+
+	//	Command DbGetDataForServerCacheList
+	DbGetDataForServerCacheListClass	*pDbGetDataForServerCacheListCmd =
+		new DbGetDataForServerCacheListClass("DbGetDataForServerCacheList",
+			Tango::DEVVAR_STRINGARRAY, Tango::DEVVAR_LONGSTRINGARRAY,
+			"Elt[2n] = DS name (exec_name/inst_name), Elt[2n + 1] = Host name",
+			"Lvalue[n] = Number of strings in svalue for server n, Svalue = The DbGetDataForServerCache data of each server",
+			Tango::OPERATOR);
+	command_list.push_back(pDbGetDataForServerCacheListCmd);
+
+	//	Command DbGetDataForServerCacheDelta
+	DbGetDataForServerCacheDeltaClass	*pDbGetDataForServerCacheDeltaCmd =
+		new DbGetDataForServerCacheDeltaClass("DbGetDataForServerCacheDelta",
+			Tango::DEVVAR_STRINGARRAY, Tango::DEVVAR_LONGSTRINGARRAY,
+			"Elt[0] = DS name (exec_name/inst_name), Elt[1] = Host name, Elt[2] = Token of the data previously received (optional)",
+			"Svalue[0] = Token of the current data. Lvalue[0] = 0: Data unchanged. Lvalue[0] = 1: Lvalue[1] = Number of hunks,\nthen for each hunk: Index and number of the previous data elements replaced and number of new elements,\nthe new elements being in Svalue from index 1. Lvalue[0] = 2: Svalue from index 1 = Full data",
+			Tango::OPERATOR);
+	command_list.push_back(pDbGetDataForServerCacheDeltaCmd);
+
+	//	Command DbGetDataForServerCacheCompressed
+	DbGetDataForServerCacheCompressedClass	*pDbGetDataForServerCacheCompressedCmd =
+		new DbGetDataForServerCacheCompressedClass("DbGetDataForServerCacheCompressed",
+			Tango::DEVVAR_STRINGARRAY, Tango::DEV_ENCODED,
+			"Elt[0] = DS name (exec_name/inst_name), Elt[1] = Host name",
+			"Uncompressed size (4 bytes, big endian) followed by the zlib stream of the data separated by NUL characters",
+			Tango::OPERATOR);
+	command_list.push_back(pDbGetDataForServerCacheCompressedCmd);
+
+	//	Command DbGetDataForServerCacheChunk
+	DbGetDataForServerCacheChunkClass	*pDbGetDataForServerCacheChunkCmd =
+		new DbGetDataForServerCacheChunkClass("DbGetDataForServerCacheChunk",
+			Tango::DEVVAR_STRINGARRAY, Tango::DEVVAR_LONGSTRINGARRAY,
+			"Elt[0] = DS name (exec_name/inst_name), Elt[1] = Host name, Elt[2] = Continuation token (empty or missing for the first part),\nElt[3] = Maximum number of elements per part (optional, default 10000)",
+			"Lvalue[0] = 1 if more parts follow, 0 for the last one. Svalue[0] = Continuation token for the next part,\nSvalue from index 1 = The data elements of this part",
+			Tango::OPERATOR);
+	command_list.push_back(pDbGetDataForServerCacheChunkCmd);
+
+	//	Command GetTimingHistogram
+	GetTimingHistogramClass	*pGetTimingHistogramCmd =
+		new GetTimingHistogramClass("GetTimingHistogram",
+			Tango::DEV_STRING, Tango::DEVVAR_STRINGARRAY,
+			"Command name (empty or * for all the called commands)",
+			"Command name and calls, then lower limit, upper limit and count of each bucket",
+			Tango::OPERATOR);
+	command_list.push_back(pGetTimingHistogramCmd);
+
+	//	Command GetSqlProfile
+	GetSqlProfileClass	*pGetSqlProfileCmd =
+		new GetSqlProfileClass("GetSqlProfile",
+			Tango::DEV_VOID, Tango::DEVVAR_STRINGARRAY,
+			"none",
+			"Tab separated lines, per command then per statement template",
+			Tango::OPERATOR);
+	command_list.push_back(pGetSqlProfileCmd);
+
 	/*----- PROTECTED REGION ID(DataBaseClass::command_factory_after) ENABLED START -----*/
 
+	//	Time all the commands (Timing_xxx attributes)
+	TimedCommand::wrap_commands(command_list);
+
 	/*----- PROTECTED REGION END -----*/	//	DataBaseClass::command_factory_after
 }
 
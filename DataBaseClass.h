@@ -79,8 +79,8 @@ public:
 class Timing_averageAttrib: public Tango::SpectrumAttr
 {
 public:
-	Timing_averageAttrib():SpectrumAttr("Timing_average",
-			Tango::DEV_DOUBLE, Tango::READ, 64) {};
+	Timing_averageAttrib(long max_x):SpectrumAttr("Timing_average",
+			Tango::DEV_DOUBLE, Tango::READ, max_x) {};
 	~Timing_averageAttrib() {};
 	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
 		{(static_cast<DataBase *>(dev))->read_Timing_average(att);}
@@ -92,8 +92,8 @@ public:
 class Timing_minimumAttrib: public Tango::SpectrumAttr
 {
 public:
-	Timing_minimumAttrib():SpectrumAttr("Timing_minimum",
-			Tango::DEV_DOUBLE, Tango::READ, 64) {};
+	Timing_minimumAttrib(long max_x):SpectrumAttr("Timing_minimum",
+			Tango::DEV_DOUBLE, Tango::READ, max_x) {};
 	~Timing_minimumAttrib() {};
 	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
 		{(static_cast<DataBase *>(dev))->read_Timing_minimum(att);}
@@ -105,8 +105,8 @@ public:
 class Timing_maximumAttrib: public Tango::SpectrumAttr
 {
 public:
-	Timing_maximumAttrib():SpectrumAttr("Timing_maximum",
-			Tango::DEV_DOUBLE, Tango::READ, 64) {};
+	Timing_maximumAttrib(long max_x):SpectrumAttr("Timing_maximum",
+			Tango::DEV_DOUBLE, Tango::READ, max_x) {};
 	~Timing_maximumAttrib() {};
 	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
 		{(static_cast<DataBase *>(dev))->read_Timing_maximum(att);}
@@ -118,8 +118,8 @@ public:
 class Timing_callsAttrib: public Tango::SpectrumAttr
 {
 public:
-	Timing_callsAttrib():SpectrumAttr("Timing_calls",
-			Tango::DEV_DOUBLE, Tango::READ, 64) {};
+	Timing_callsAttrib(long max_x):SpectrumAttr("Timing_calls",
+			Tango::DEV_DOUBLE, Tango::READ, max_x) {};
 	~Timing_callsAttrib() {};
 	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
 		{(static_cast<DataBase *>(dev))->read_Timing_calls(att);}
@@ -131,8 +131,8 @@ public:
 class Timing_indexAttrib: public Tango::SpectrumAttr
 {
 public:
-	Timing_indexAttrib():SpectrumAttr("Timing_index",
-			Tango::DEV_STRING, Tango::READ, 64) {};
+	Timing_indexAttrib(long max_x):SpectrumAttr("Timing_index",
+			Tango::DEV_STRING, Tango::READ, max_x) {};
 	~Timing_indexAttrib() {};
 	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
 		{(static_cast<DataBase *>(dev))->read_Timing_index(att);}
@@ -144,8 +144,8 @@ public:
 class Timing_infoAttrib: public Tango::SpectrumAttr
 {
 public:
-	Timing_infoAttrib():SpectrumAttr("Timing_info",
-			Tango::DEV_STRING, Tango::READ, 64) {};
+	Timing_infoAttrib(long max_x):SpectrumAttr("Timing_info",
+			Tango::DEV_STRING, Tango::READ, max_x) {};
 	~Timing_infoAttrib() {};
 	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
 		{(static_cast<DataBase *>(dev))->read_Timing_info(att);}
@@ -153,6 +153,149 @@ public:
 		{return (static_cast<DataBase *>(dev))->is_Timing_info_allowed(ty);}
 };
 
+//	Attribute Pool_in_use class definition
+class Pool_in_useAttrib: public Tango::Attr
+{
+public:
+	Pool_in_useAttrib():Attr("Pool_in_use",
+			Tango::DEV_LONG, Tango::READ) {};
+	~Pool_in_useAttrib() {};
+	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
+		{(static_cast<DataBase *>(dev))->read_Pool_in_use(att);}
+	virtual bool is_allowed(Tango::DeviceImpl *dev,Tango::AttReqType ty)
+		{return (static_cast<DataBase *>(dev))->is_Pool_in_use_allowed(ty);}
+};
+
+//	Attribute Pool_waiters class definition
+class Pool_waitersAttrib: public Tango::Attr
+{
+public:
+	Pool_waitersAttrib():Attr("Pool_waiters",
+			Tango::DEV_LONG, Tango::READ) {};
+	~Pool_waitersAttrib() {};
+	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
+		{(static_cast<DataBase *>(dev))->read_Pool_waiters(att);}
+	virtual bool is_allowed(Tango::DeviceImpl *dev,Tango::AttReqType ty)
+		{return (static_cast<DataBase *>(dev))->is_Pool_waiters_allowed(ty);}
+};
+
+//	Attribute Pool_wait_histo class definition
+class Pool_wait_histoAttrib: public Tango::SpectrumAttr
+{
+public:
+	Pool_wait_histoAttrib():SpectrumAttr("Pool_wait_histo",
+			Tango::DEV_DOUBLE, Tango::READ, 8) {};
+	~Pool_wait_histoAttrib() {};
+	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
+		{(static_cast<DataBase *>(dev))->read_Pool_wait_histo(att);}
+	virtual bool is_allowed(Tango::DeviceImpl *dev,Tango::AttReqType ty)
+		{return (static_cast<DataBase *>(dev))->is_Pool_wait_histo_allowed(ty);}
+};
+
+//	Attribute Pool_wait_index class definition
+class Pool_wait_indexAttrib: public Tango::SpectrumAttr
+{
+public:
+	Pool_wait_indexAttrib():SpectrumAttr("Pool_wait_index",
+			Tango::DEV_STRING, Tango::READ, 8) {};
+	~Pool_wait_indexAttrib() {};
+	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
+		{(static_cast<DataBase *>(dev))->read_Pool_wait_index(att);}
+	virtual bool is_allowed(Tango::DeviceImpl *dev,Tango::AttReqType ty)
+		{return (static_cast<DataBase *>(dev))->is_Pool_wait_index_allowed(ty);}
+};
+
+//	Attribute Pool_size class definition
+class Pool_sizeAttrib: public Tango::Attr
+{
+public:
+	Pool_sizeAttrib():Attr("Pool_size",
+			Tango::DEV_LONG, Tango::READ) {};
+	~Pool_sizeAttrib() {};
+	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
+		{(static_cast<DataBase *>(dev))->read_Pool_size(att);}
+	virtual bool is_allowed(Tango::DeviceImpl *dev,Tango::AttReqType ty)
+		{return (static_cast<DataBase *>(dev))->is_Pool_size_allowed(ty);}
+};
+
+//	Attribute History_queue_depth class definition
+class History_queue_depthAttrib: public Tango::Attr
+{
+public:
+	History_queue_depthAttrib():Attr("History_queue_depth",
+			Tango::DEV_LONG, Tango::READ) {};
+	~History_queue_depthAttrib() {};
+	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
+		{(static_cast<DataBase *>(dev))->read_History_queue_depth(att);}
+	virtual bool is_allowed(Tango::DeviceImpl *dev,Tango::AttReqType ty)
+		{return (static_cast<DataBase *>(dev))->is_History_queue_depth_allowed(ty);}
+};
+
+//	Attribute History_queue_lag class definition
+class History_queue_lagAttrib: public Tango::Attr
+{
+public:
+	History_queue_lagAttrib():Attr("History_queue_lag",
+			Tango::DEV_DOUBLE, Tango::READ) {};
+	~History_queue_lagAttrib() {};
+	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
+		{(static_cast<DataBase *>(dev))->read_History_queue_lag(att);}
+	virtual bool is_allowed(Tango::DeviceImpl *dev,Tango::AttReqType ty)
+		{return (static_cast<DataBase *>(dev))->is_History_queue_lag_allowed(ty);}
+};
+
+//	Attribute Timing_p50 class definition
+class Timing_p50Attrib: public Tango::SpectrumAttr
+{
+public:
+	Timing_p50Attrib(long max_x):SpectrumAttr("Timing_p50",
+			Tango::DEV_DOUBLE, Tango::READ, max_x) {};
+	~Timing_p50Attrib() {};
+	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
+		{(static_cast<DataBase *>(dev))->read_Timing_p50(att);}
+	virtual bool is_allowed(Tango::DeviceImpl *dev,Tango::AttReqType ty)
+		{return (static_cast<DataBase *>(dev))->is_Timing_p50_allowed(ty);}
+};
+
+//	Attribute Timing_p90 class definition
+class Timing_p90Attrib: public Tango::SpectrumAttr
+{
+public:
+	Timing_p90Attrib(long max_x):SpectrumAttr("Timing_p90",
+			Tango::DEV_DOUBLE, Tango::READ, max_x) {};
+	~Timing_p90Attrib() {};
+	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
+		{(static_cast<DataBase *>(dev))->read_Timing_p90(att);}
+	virtual bool is_allowed(Tango::DeviceImpl *dev,Tango::AttReqType ty)
+		{return (static_cast<DataBase *>(dev))->is_Timing_p90_allowed(ty);}
+};
+
+//	Attribute Timing_p99 class definition
+class Timing_p99Attrib: public Tango::SpectrumAttr
+{
+public:
+	Timing_p99Attrib(long max_x):SpectrumAttr("Timing_p99",
+			Tango::DEV_DOUBLE, Tango::READ, max_x) {};
+	~Timing_p99Attrib() {};
+	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
+		{(static_cast<DataBase *>(dev))->read_Timing_p99(att);}
+	virtual bool is_allowed(Tango::DeviceImpl *dev,Tango::AttReqType ty)
+		{return (static_cast<DataBase *>(dev))->is_Timing_p99_allowed(ty);}
+};
+
+//	Attribute Timing_p999 class definition
+class Timing_p999Attrib: public Tango::SpectrumAttr
+{
+public:
+	Timing_p999Attrib(long max_x):SpectrumAttr("Timing_p999",
+			Tango::DEV_DOUBLE, Tango::READ, max_x) {};
+	~Timing_p999Attrib() {};
+	virtual void read(Tango::DeviceImpl *dev,Tango::Attribute &att)
+		{(static_cast<DataBase *>(dev))->read_Timing_p999(att);}
+	virtual bool is_allowed(Tango::DeviceImpl *dev,Tango::AttReqType ty)
+		{return (static_cast<DataBase *>(dev))->is_Timing_p999_allowed(ty);}
+};
+
 
 //=========================================
 //	Define classes for commands
@@ -2388,6 +2531,167 @@ public:
 	{return (static_cast<DataBase *>(dev))->is_DbGetForwardedAttributeListForDevice_allowed(any);}
 };
 
+//	Command DbGetDataForServerCacheRaw class definition
+class DbGetDataForServerCacheRawClass : public Tango::Command
+{
+public:
+	DbGetDataForServerCacheRawClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out,
+				   const char        *in_desc,
+				   const char        *out_desc,
+				   Tango::DispLevel  level)
+	:Command(name,in,out,in_desc,out_desc, level)	{};
+
+	DbGetDataForServerCacheRawClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out)
+	:Command(name,in,out)	{};
+	~DbGetDataForServerCacheRawClass() {};
+	
+	virtual CORBA::Any *execute (Tango::DeviceImpl *dev, const CORBA::Any &any);
+	virtual bool is_allowed (Tango::DeviceImpl *dev, const CORBA::Any &any)
+	{return (static_cast<DataBase *>(dev))->is_DbGetDataForServerCacheRaw_allowed(any);}
+};
+
+//	Command DbGetDataForServerCacheList class definition
+class DbGetDataForServerCacheListClass : public Tango::Command
+{
+public:
+	DbGetDataForServerCacheListClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out,
+				   const char        *in_desc,
+				   const char        *out_desc,
+				   Tango::DispLevel  level)
+	:Command(name,in,out,in_desc,out_desc, level)	{};
+
+	DbGetDataForServerCacheListClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out)
+	:Command(name,in,out)	{};
+	~DbGetDataForServerCacheListClass() {};
+	
+	virtual CORBA::Any *execute (Tango::DeviceImpl *dev, const CORBA::Any &any);
+	virtual bool is_allowed (Tango::DeviceImpl *dev, const CORBA::Any &any)
+	{return (static_cast<DataBase *>(dev))->is_DbGetDataForServerCacheList_allowed(any);}
+};
+
+//	Command DbGetDataForServerCacheDelta class definition
+class DbGetDataForServerCacheDeltaClass : public Tango::Command
+{
+public:
+	DbGetDataForServerCacheDeltaClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out,
+				   const char        *in_desc,
+				   const char        *out_desc,
+				   Tango::DispLevel  level)
+	:Command(name,in,out,in_desc,out_desc, level)	{};
+
+	DbGetDataForServerCacheDeltaClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out)
+	:Command(name,in,out)	{};
+	~DbGetDataForServerCacheDeltaClass() {};
+	
+	virtual CORBA::Any *execute (Tango::DeviceImpl *dev, const CORBA::Any &any);
+	virtual bool is_allowed (Tango::DeviceImpl *dev, const CORBA::Any &any)
+	{return (static_cast<DataBase *>(dev))->is_DbGetDataForServerCacheDelta_allowed(any);}
+};
+
+//	Command DbGetDataForServerCacheCompressed class definition
+class DbGetDataForServerCacheCompressedClass : public Tango::Command
+{
+public:
+	DbGetDataForServerCacheCompressedClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out,
+				   const char        *in_desc,
+				   const char        *out_desc,
+				   Tango::DispLevel  level)
+	:Command(name,in,out,in_desc,out_desc, level)	{};
+
+	DbGetDataForServerCacheCompressedClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out)
+	:Command(name,in,out)	{};
+	~DbGetDataForServerCacheCompressedClass() {};
+	
+	virtual CORBA::Any *execute (Tango::DeviceImpl *dev, const CORBA::Any &any);
+	virtual bool is_allowed (Tango::DeviceImpl *dev, const CORBA::Any &any)
+	{return (static_cast<DataBase *>(dev))->is_DbGetDataForServerCacheCompressed_allowed(any);}
+};
+
+//	Command DbGetDataForServerCacheChunk class definition
+class DbGetDataForServerCacheChunkClass : public Tango::Command
+{
+public:
+	DbGetDataForServerCacheChunkClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out,
+				   const char        *in_desc,
+				   const char        *out_desc,
+				   Tango::DispLevel  level)
+	:Command(name,in,out,in_desc,out_desc, level)	{};
+
+	DbGetDataForServerCacheChunkClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out)
+	:Command(name,in,out)	{};
+	~DbGetDataForServerCacheChunkClass() {};
+	
+	virtual CORBA::Any *execute (Tango::DeviceImpl *dev, const CORBA::Any &any);
+	virtual bool is_allowed (Tango::DeviceImpl *dev, const CORBA::Any &any)
+	{return (static_cast<DataBase *>(dev))->is_DbGetDataForServerCacheChunk_allowed(any);}
+};
+
+//	Command GetTimingHistogram class definition
+class GetTimingHistogramClass : public Tango::Command
+{
+public:
+	GetTimingHistogramClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out,
+				   const char        *in_desc,
+				   const char        *out_desc,
+				   Tango::DispLevel  level)
+	:Command(name,in,out,in_desc,out_desc, level)	{};
+
+	GetTimingHistogramClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out)
+	:Command(name,in,out)	{};
+	~GetTimingHistogramClass() {};
+	
+	virtual CORBA::Any *execute (Tango::DeviceImpl *dev, const CORBA::Any &any);
+	virtual bool is_allowed (Tango::DeviceImpl *dev, const CORBA::Any &any)
+	{return (static_cast<DataBase *>(dev))->is_GetTimingHistogram_allowed(any);}
+};
+
+//	Command GetSqlProfile class definition
+class GetSqlProfileClass : public Tango::Command
+{
+public:
+	GetSqlProfileClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out,
+				   const char        *in_desc,
+				   const char        *out_desc,
+				   Tango::DispLevel  level)
+	:Command(name,in,out,in_desc,out_desc, level)	{};
+
+	GetSqlProfileClass(const char   *name,
+	               Tango::CmdArgType in,
+				   Tango::CmdArgType out)
+	:Command(name,in,out)	{};
+	~GetSqlProfileClass() {};
+	
+	virtual CORBA::Any *execute (Tango::DeviceImpl *dev, const CORBA::Any &any);
+	virtual bool is_allowed (Tango::DeviceImpl *dev, const CORBA::Any &any)
+	{return (static_cast<DataBase *>(dev))->is_GetSqlProfile_allowed(any);}
+};
+
 
 /**
  *	The DataBaseClass singleton definition
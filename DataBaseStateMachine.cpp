@@ -171,6 +171,182 @@ bool DataBase::is_Timing_info_allowed(TANGO_UNUSED(Tango::AttReqType type))
 	return true;
 }
 
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_Pool_in_use_allowed()
+ *	Description : Execution allowed for Pool_in_use attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_Pool_in_use_allowed(TANGO_UNUSED(Tango::AttReqType type))
+{
+
+	//	Not any excluded states for Pool_in_use attribute in read access.
+	/*----- PROTECTED REGION ID(DataBase::Pool_in_useStateAllowed_READ) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::Pool_in_useStateAllowed_READ
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_Pool_waiters_allowed()
+ *	Description : Execution allowed for Pool_waiters attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_Pool_waiters_allowed(TANGO_UNUSED(Tango::AttReqType type))
+{
+
+	//	Not any excluded states for Pool_waiters attribute in read access.
+	/*----- PROTECTED REGION ID(DataBase::Pool_waitersStateAllowed_READ) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::Pool_waitersStateAllowed_READ
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_Pool_wait_histo_allowed()
+ *	Description : Execution allowed for Pool_wait_histo attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_Pool_wait_histo_allowed(TANGO_UNUSED(Tango::AttReqType type))
+{
+
+	//	Not any excluded states for Pool_wait_histo attribute in read access.
+	/*----- PROTECTED REGION ID(DataBase::Pool_wait_histoStateAllowed_READ) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::Pool_wait_histoStateAllowed_READ
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_Pool_wait_index_allowed()
+ *	Description : Execution allowed for Pool_wait_index attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_Pool_wait_index_allowed(TANGO_UNUSED(Tango::AttReqType type))
+{
+
+	//	Not any excluded states for Pool_wait_index attribute in read access.
+	/*----- PROTECTED REGION ID(DataBase::Pool_wait_indexStateAllowed_READ) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::Pool_wait_indexStateAllowed_READ
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_Pool_size_allowed()
+ *	Description : Execution allowed for Pool_size attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_Pool_size_allowed(TANGO_UNUSED(Tango::AttReqType type))
+{
+
+	//	Not any excluded states for Pool_size attribute in read access.
+	/*----- PROTECTED REGION ID(DataBase::Pool_sizeStateAllowed_READ) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::Pool_sizeStateAllowed_READ
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_History_queue_depth_allowed()
+ *	Description : Execution allowed for History_queue_depth attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_History_queue_depth_allowed(TANGO_UNUSED(Tango::AttReqType type))
+{
+
+	//	Not any excluded states for History_queue_depth attribute in read access.
+	/*----- PROTECTED REGION ID(DataBase::History_queue_depthStateAllowed_READ) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::History_queue_depthStateAllowed_READ
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_History_queue_lag_allowed()
+ *	Description : Execution allowed for History_queue_lag attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_History_queue_lag_allowed(TANGO_UNUSED(Tango::AttReqType type))
+{
+
+	//	Not any excluded states for History_queue_lag attribute in read access.
+	/*----- PROTECTED REGION ID(DataBase::History_queue_lagStateAllowed_READ) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::History_queue_lagStateAllowed_READ
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_Timing_p50_allowed()
+ *	Description : Execution allowed for Timing_p50 attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_Timing_p50_allowed(TANGO_UNUSED(Tango::AttReqType type))
+{
+
+	//	Not any excluded states for Timing_p50 attribute in read access.
+	/*----- PROTECTED REGION ID(DataBase::Timing_p50StateAllowed_READ) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::Timing_p50StateAllowed_READ
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_Timing_p90_allowed()
+ *	Description : Execution allowed for Timing_p90 attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_Timing_p90_allowed(TANGO_UNUSED(Tango::AttReqType type))
+{
+
+	//	Not any excluded states for Timing_p90 attribute in read access.
+	/*----- PROTECTED REGION ID(DataBase::Timing_p90StateAllowed_READ) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::Timing_p90StateAllowed_READ
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_Timing_p99_allowed()
+ *	Description : Execution allowed for Timing_p99 attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_Timing_p99_allowed(TANGO_UNUSED(Tango::AttReqType type))
+{
+
+	//	Not any excluded states for Timing_p99 attribute in read access.
+	/*----- PROTECTED REGION ID(DataBase::Timing_p99StateAllowed_READ) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::Timing_p99StateAllowed_READ
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_Timing_p999_allowed()
+ *	Description : Execution allowed for Timing_p999 attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_Timing_p999_allowed(TANGO_UNUSED(Tango::AttReqType type))
+{
+
+	//	Not any excluded states for Timing_p999 attribute in read access.
+	/*----- PROTECTED REGION ID(DataBase::Timing_p999StateAllowed_READ) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::Timing_p999StateAllowed_READ
+	return true;
+}
+
 
 //=================================================
 //		Commands Allowed Methods
@@ -1631,6 +1807,111 @@ bool DataBase::is_DbGetForwardedAttributeListForDevice_allowed(TANGO_UNUSED(cons
 	return true;
 }
 
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_DbGetDataForServerCacheRaw_allowed()
+ *	Description : Execution allowed for DbGetDataForServerCacheRaw attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_DbGetDataForServerCacheRaw_allowed(TANGO_UNUSED(const CORBA::Any &any))
+{
+	//	Not any excluded states for DbGetDataForServerCacheRaw command.
+	/*----- PROTECTED REGION ID(DataBase::DbGetDataForServerCacheRawStateAllowed) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::DbGetDataForServerCacheRawStateAllowed
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_DbGetDataForServerCacheList_allowed()
+ *	Description : Execution allowed for DbGetDataForServerCacheList attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_DbGetDataForServerCacheList_allowed(TANGO_UNUSED(const CORBA::Any &any))
+{
+	//	Not any excluded states for DbGetDataForServerCacheList command.
+	/*----- PROTECTED REGION ID(DataBase::DbGetDataForServerCacheListStateAllowed) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::DbGetDataForServerCacheListStateAllowed
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_DbGetDataForServerCacheDelta_allowed()
+ *	Description : Execution allowed for DbGetDataForServerCacheDelta attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_DbGetDataForServerCacheDelta_allowed(TANGO_UNUSED(const CORBA::Any &any))
+{
+	//	Not any excluded states for DbGetDataForServerCacheDelta command.
+	/*----- PROTECTED REGION ID(DataBase::DbGetDataForServerCacheDeltaStateAllowed) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::DbGetDataForServerCacheDeltaStateAllowed
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_DbGetDataForServerCacheCompressed_allowed()
+ *	Description : Execution allowed for DbGetDataForServerCacheCompressed attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_DbGetDataForServerCacheCompressed_allowed(TANGO_UNUSED(const CORBA::Any &any))
+{
+	//	Not any excluded states for DbGetDataForServerCacheCompressed command.
+	/*----- PROTECTED REGION ID(DataBase::DbGetDataForServerCacheCompressedStateAllowed) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::DbGetDataForServerCacheCompressedStateAllowed
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_DbGetDataForServerCacheChunk_allowed()
+ *	Description : Execution allowed for DbGetDataForServerCacheChunk attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_DbGetDataForServerCacheChunk_allowed(TANGO_UNUSED(const CORBA::Any &any))
+{
+	//	Not any excluded states for DbGetDataForServerCacheChunk command.
+	/*----- PROTECTED REGION ID(DataBase::DbGetDataForServerCacheChunkStateAllowed) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::DbGetDataForServerCacheChunkStateAllowed
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_GetTimingHistogram_allowed()
+ *	Description : Execution allowed for GetTimingHistogram attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_GetTimingHistogram_allowed(TANGO_UNUSED(const CORBA::Any &any))
+{
+	//	Not any excluded states for GetTimingHistogram command.
+	/*----- PROTECTED REGION ID(DataBase::GetTimingHistogramStateAllowed) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::GetTimingHistogramStateAllowed
+	return true;
+}
+
+//--------------------------------------------------------
+/**
+ *	Method      : DataBase::is_GetSqlProfile_allowed()
+ *	Description : Execution allowed for GetSqlProfile attribute
+ */
+//--------------------------------------------------------
+bool DataBase::is_GetSqlProfile_allowed(TANGO_UNUSED(const CORBA::Any &any))
+{
+	//	Not any excluded states for GetSqlProfile command.
+	/*----- PROTECTED REGION ID(DataBase::GetSqlProfileStateAllowed) ENABLED START -----*/
+	
+	/*----- PROTECTED REGION END -----*/	//	DataBase::GetSqlProfileStateAllowed
+	return true;
+}
+
 
 /*----- PROTECTED REGION ID(DataBase::DataBaseStateAllowed.AdditionalMethods) ENABLED START -----*/
 
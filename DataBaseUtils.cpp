@@ -61,358 +61,598 @@ using namespace std;
 
 namespace DataBase_ns {
 
+//+------------------------------------------------------------------
+/**
+ *	method:	DataBase::init_timing_stats
+ *
+ *	description:	method to initialise the timing statistics variables
+ *	Returns void
+ *
+ * @param	none
+ * @return	void
+ *
+ */
+//+------------------------------------------------------------------
+void DataBase::init_timing_stats()
+{
+	std::vector<std::string> cmd_names;
+	TimedCommand::get_names(get_device_class()->get_command_list(),cmd_names);
+	timing_stats.init(cmd_names);
+	sql_profile.init(cmd_names.size());
+
+	timing_stats_size = timing_stats.get_nb_cmd();
+	timing_stats_average = new double[timing_stats_size];
+	timing_stats_minimum = new double[timing_stats_size];
+	timing_stats_maximum = new double[timing_stats_size];
+	timing_stats_calls = new double[timing_stats_size];
+	timing_stats_index = new Tango::DevString[timing_stats_size];
+	attr_Timing_p50_read = new Tango::DevDouble[timing_stats_size];
+	attr_Timing_p90_read = new Tango::DevDouble[timing_stats_size];
+	attr_Timing_p99_read = new Tango::DevDouble[timing_stats_size];
+	attr_Timing_p999_read = new Tango::DevDouble[timing_stats_size];
+
+	for (int i = 0;i < timing_stats_size;i++)
+	{
+		const char *name = timing_stats.get_name(i).c_str();
+		timing_stats_index[i] = (char*)malloc(strlen(name)+1);
+		strcpy(timing_stats_index[i],name);
+	}
+}
+
+//+------------------------------------------------------------------
+/**
+ *	method:	DataBase::read_timing_percentile()
+ *
+ *	description:	Set the value of a Timing_pXX attribute: The percentile
+ *			of each timed command (in the Timing_index order), computed
+ *			from its latency histogram
+ *
+ */
+//+------------------------------------------------------------------
+void DataBase::read_timing_percentile(Tango::Attribute &attr,Tango::DevDouble *buf,double pct)
+{
+	for (int i = 0;i < timing_stats_size;i++)
+		buf[i] = timing_stats.get_percentile(i,pct);
+
+	attr.set_value(buf,timing_stats_size);
+}
+
 //+----------------------------------------------------------------------------
 //
-// method : 		DataBase::replace_wildcard(char *wildcard_c_str)
-//
-// description : 	utility method to replace all occurrences of
-//			wildcards (*) with SQL wildcards % and to escape
-//			all occurrences	of '%' and '_' with '\'
+// method : 		DataBase::get_metrics()
 //
-// in :			string **wildcard_c_str - wildcard C string
-//
-// out :		void - nothing
+// description : 	Build the OpenMetrics page of the metrics endpoint from
+//					the in-process statistics (no MySQL connection used):
+//					Command durations histograms and SQL phases, connection
+//					pool, caches, starter notifications and history queue
 //
 //-----------------------------------------------------------------------------
-std::string DataBase::replace_wildcard(const char *wildcard_c_str)
+void DataBase::get_metrics(std::string &page)
 {
-	std::string wildcard(wildcard_c_str);
-	std::string::size_type index;
+	std::ostringstream o;
+	o.precision(9);
 
-	DEBUG_STREAM << "DataBase::replace_wildcard() wildcard in " << wildcard << std::endl;
-// escape %
+//
+// Commands (only the called ones). The histogram buckets are the powers
+// of 2 of the timing statistics histogram
+//
 
-	index = 0;
-	while ((index = wildcard.find('%',index)) != std::string::npos)
+	o << "# TYPE tango_db_command_duration_seconds histogram\n";
+	o << "# UNIT tango_db_command_duration_seconds seconds\n";
+	o << "# HELP tango_db_command_duration_seconds Command execution time.\n";
+
+	std::vector<int> called;
+	std::vector<unsigned long long> histo;
+	for (int i = 0;i < timing_stats.get_nb_cmd();i++)
 	{
-		wildcard.insert(index, 1, '\\');
-		index = index+2;
+		double calls,average,minimum,maximum;
+		timing_stats.get(i,calls,average,minimum,maximum);
+		if (calls == 0)
+			continue;
+		called.push_back(i);
+
+		const std::string &name = timing_stats.get_name(i);
+		timing_stats.get_histogram(i,histo);
+		unsigned long long cumul = 0;
+		for (int j = 0;j < TIMING_NB_BUCKET;j++)
+		{
+			cumul = cumul + histo[j];
+			if ((j + 1) % TIMING_HISTO_SUB != 0 || j == TIMING_NB_BUCKET - 1)
+				continue;
+			double low,high;
+			TimingStats::get_bucket_limits(j,low,high);
+			o << "tango_db_command_duration_seconds_bucket{command=\"" << name << "\",le=\"" << high / 1000.0 << "\"} " << cumul << "\n";
+		}
+		o << "tango_db_command_duration_seconds_bucket{command=\"" << name << "\",le=\"+Inf\"} " << cumul << "\n";
+		o << "tango_db_command_duration_seconds_count{command=\"" << name << "\"} " << cumul << "\n";
+		o << "tango_db_command_duration_seconds_sum{command=\"" << name << "\"} " << average * calls / 1000.0 << "\n";
 	}
 
-// escape _
-
-	index = 0;
-	while ((index = wildcard.find('_',index)) != std::string::npos)
+	const char *phase_names[SqlProfile::NB_PHASE] = {"pool_wait","mysql","store_result","other"};
+	std::ostringstream stmts;
+	o << "# TYPE tango_db_command_phase_seconds counter\n";
+	o << "# UNIT tango_db_command_phase_seconds seconds\n";
+	o << "# HELP tango_db_command_phase_seconds Command time spent waiting for a MySQL connection, in MySQL, transferring results and in the DB server.\n";
+	stmts << "# TYPE tango_db_command_sql_statements counter\n";
+	stmts << "# HELP tango_db_command_sql_statements SQL statements run by the command.\n";
+	for (size_t i = 0;i < called.size();i++)
 	{
-		wildcard.insert(index, 1, '\\');
-		index = index+2;
+		const std::string &name = timing_stats.get_name(called[i]);
+		unsigned long long calls,nb_stmt;
+		double phases[SqlProfile::NB_PHASE];
+		sql_profile.get_command(called[i],calls,nb_stmt,phases);
+		for (int j = 0;j < SqlProfile::NB_PHASE;j++)
+			o << "tango_db_command_phase_seconds_total{command=\"" << name << "\",phase=\"" << phase_names[j] << "\"} " << phases[j] << "\n";
+		stmts << "tango_db_command_sql_statements_total{command=\"" << name << "\"} " << nb_stmt << "\n";
 	}
-
-
-// escape "
-
-	index = 0;
-	while ((index = wildcard.find('"',index)) != std::string::npos)
+	o << stmts.str();
+
+//
+// Connection pool. The wait histogram buckets are 10 us, 100 us... 1 s,
+// the last one counting the timeouts
+//
+
+	o << "# TYPE tango_db_pool_connections gauge\n";
+	o << "# HELP tango_db_pool_connections MySQL connections (open, in use, maximum).\n";
+	o << "tango_db_pool_connections{state=\"open\"} " << pool.get_nb_open() << "\n";
+	o << "tango_db_pool_connections{state=\"in_use\"} " << pool.get_nb_in_use() << "\n";
+	o << "tango_db_pool_connections{state=\"max\"} " << conn_pool_size << "\n";
+	o << "# TYPE tango_db_pool_waiters gauge\n";
+	o << "# HELP tango_db_pool_waiters Requests waiting for a MySQL connection.\n";
+	o << "tango_db_pool_waiters " << pool.get_nb_waiters() << "\n";
+
+	Tango::DevDouble wait_histo[POOL_WAIT_HISTO_SIZE];
+	pool.get_wait_histo(wait_histo);
+	double wait_sum = pool.get_wait_sum();
+	o << "# TYPE tango_db_pool_acquire_wait_seconds histogram\n";
+	o << "# UNIT tango_db_pool_acquire_wait_seconds seconds\n";
+	o << "# HELP tango_db_pool_acquire_wait_seconds Time spent to get a MySQL connection.\n";
+	double cumul = 0.0;
+	double limit = 1.0e-5;
+	for (int i = 0;i < POOL_WAIT_HISTO_SIZE - 2;i++)
 	{
-		wildcard.insert(index, 1, '\\');
-		index = index+2;
+		cumul = cumul + wait_histo[i];
+		o << "tango_db_pool_acquire_wait_seconds_bucket{le=\"" << limit << "\"} " << cumul << "\n";
+		limit = limit * 10.0;
 	}
+	cumul = cumul + wait_histo[POOL_WAIT_HISTO_SIZE - 2];
+	o << "tango_db_pool_acquire_wait_seconds_bucket{le=\"+Inf\"} " << cumul << "\n";
+	o << "tango_db_pool_acquire_wait_seconds_count " << cumul << "\n";
+	o << "tango_db_pool_acquire_wait_seconds_sum " << wait_sum << "\n";
+	o << "# TYPE tango_db_pool_acquire_timeouts counter\n";
+	o << "# HELP tango_db_pool_acquire_timeouts Requests which did not get a MySQL connection in time.\n";
+	o << "tango_db_pool_acquire_timeouts_total " << wait_histo[POOL_WAIT_HISTO_SIZE - 1] << "\n";
 
+//
+// Caches
+//
 
-// escape '
+	const char *cache_names[3] = {"import_device","import_event","server_data"};
+	unsigned long long hits[3],misses[3];
+	device_cache.get_stats(hits[0],misses[0]);
+	event_cache.get_stats(hits[1],misses[1]);
+	server_cache.get_stats(hits[2],misses[2]);
 
-	index = 0;
-	while ((index = wildcard.find('\'',index)) != std::string::npos)
+	o << "# TYPE tango_db_cache_lookups counter\n";
+	o << "# HELP tango_db_cache_lookups Cache lookups (DbImportDevice, DbImportEvent, DbGetDataForServerCache).\n";
+	for (int i = 0;i < 3;i++)
 	{
-		wildcard.insert(index, 1, '\\');
-		index = index+2;
+		o << "tango_db_cache_lookups_total{cache=\"" << cache_names[i] << "\",result=\"hit\"} " << hits[i] << "\n";
+		o << "tango_db_cache_lookups_total{cache=\"" << cache_names[i] << "\",result=\"miss\"} " << misses[i] << "\n";
 	}
-
-// replace wildcard * with %
-
-	while ((index = wildcard.find('*')) != std::string::npos)
+	o << "# TYPE tango_db_cache_hit_ratio gauge\n";
+	o << "# HELP tango_db_cache_hit_ratio Cache hit ratio since the DB server start.\n";
+	for (int i = 0;i < 3;i++)
 	{
-		wildcard.replace(index, 1, 1, '%');
+		double ratio = hits[i] + misses[i] == 0 ? 0.0 : (double)hits[i] / (hits[i] + misses[i]);
+		o << "tango_db_cache_hit_ratio{cache=\"" << cache_names[i] << "\"} " << ratio << "\n";
 	}
 
-	DEBUG_STREAM << "DataBase::replace_wildcard() wildcard out " << wildcard << std::endl;
-	return wildcard;
+//
+// Starter notifications and history queue
+//
+
+	o << "# TYPE tango_db_starter_pending_notifications gauge\n";
+	o << "# HELP tango_db_starter_pending_notifications Starters still to be notified of a server list change.\n";
+	o << "tango_db_starter_pending_notifications " << (fireToStarter == true ? starter_shared->get_nb_pending() : 0) << "\n";
+
+	o << "# TYPE tango_db_history_queue_depth gauge\n";
+	o << "# HELP tango_db_history_queue_depth Property history records waiting to be written.\n";
+	o << "tango_db_history_queue_depth " << hist_queue.get_depth() << "\n";
+	o << "# TYPE tango_db_history_queue_lag_seconds gauge\n";
+	o << "# UNIT tango_db_history_queue_lag_seconds seconds\n";
+	o << "# HELP tango_db_history_queue_lag_seconds Age of the oldest property history record not written yet.\n";
+	o << "tango_db_history_queue_lag_seconds " << hist_queue.get_lag() / 1000.0 << "\n";
+
+	o << "# EOF\n";
+	page = o.str();
 }
 
 //+----------------------------------------------------------------------------
 //
-// method : 		DataBase::escape_string(char *string_c_str)
-//
-// description : 	utility method to escape all occurrences
-//			of ' and " with '\'
-//
-// in :			const char *string_c_str -  C string to be modified.
+// method : 		DataBase::get_long_property()
 //
-// out :		string - The result string .
+// description : 	Return the value of a numerical property of this
+//					device. The default value is returned if the property
+//					is not defined or if its value is invalid (negative)
 //
 //-----------------------------------------------------------------------------
-std::string DataBase::escape_string(const char *string_c_str)
+long DataBase::get_long_property(const char *prop_name,long default_value)
 {
-	std::string escaped_string(string_c_str);
-	std::string::size_type index;
-
-	DEBUG_STREAM << "DataBase::escape_string() string in : " << escaped_string << std::endl;
-
-	//	escape bakckslash
-	index = 0;
-	while ((index = escaped_string.find('\\',index)) != std::string::npos)
+	long value = default_value;
+	try
 	{
-		//	Check if double backslash already treated by client
-		std::string	s = escaped_string.substr(index+1);
+		Tango::DevVarStringArray *argin = new Tango::DevVarStringArray();
+		argin->length(2);
+		(*argin)[0] = CORBA::string_dup(get_name().c_str());
+		(*argin)[1] = CORBA::string_dup(prop_name);
+		Tango::DevVarStringArray *argout = db_get_device_property(argin);
 
-			//	Check if another escape sequence treated by client
-		if (s.find('\"')==0 || s.find('\'')==0)
-			index++;
-		else
+		if ((*argout)[3] != 0)
 		{
-			escaped_string.insert(index, 1, '\\');
-			index += 2;
-		}
-	}
-
-	//	escape "
-	index = 0;
-	while ((index = escaped_string.find('"',index)) != std::string::npos)
-	{
-		if (index==0)	//	Cannot have '\' at -1 !
-		{
-			escaped_string.insert(index, 1, '\\');
-			index += 2;
-		}
-		else
-		{
-			//	Check if double quotes already treated by client
-			std::string	s = escaped_string.substr(index-1);
-			if (s.find('\\')==0)
-				index++;
-			else
+			if (strcmp((*argout)[4]," ") != 0)
 			{
-				escaped_string.insert(index, 1, '\\');
-				index += 2;
+				std::stringstream ss;
+				ss << (*argout)[4];
+				ss >> value;
+				if (!ss || value < 0)
+				{
+					cout << "Warning, Invalid " << prop_name << " property, resetting to default value (" << default_value << ")" << std::endl;
+					value = default_value;
+				}
 			}
 		}
+		delete argin;
+		delete argout;
 	}
+	catch(Tango::DevFailed &)
+	{}
 
+	return value;
+}
 
-	//	escape '
-	index = 0;
-	while ((index = escaped_string.find('\'',index)) != std::string::npos)
+//+----------------------------------------------------------------------------
+//
+// method : 		DataBase::get_string_property()
+//
+// description : 	Return the value of a string property of this device.
+//					The default value is returned if the property is not
+//					defined
+//
+//-----------------------------------------------------------------------------
+std::string DataBase::get_string_property(const char *prop_name,const char *default_value)
+{
+	std::string value(default_value);
+	try
 	{
-		if (index==0)	//	Cannot have '\' at -1 !
-		{
-			escaped_string.insert(index, 1, '\\');
-			index += 2;
-		}
-		else
-		{
-			//	Check if simple quotes already treated by client
-			std::string	s = escaped_string.substr(index-1);
-			if (s.find('\\')==0)
-				index++;
-			else
-			{
-				escaped_string.insert(index, 1, '\\');
-				index += 2;
-			}
-		}
+		Tango::DevVarStringArray *argin = new Tango::DevVarStringArray();
+		argin->length(2);
+		(*argin)[0] = CORBA::string_dup(get_name().c_str());
+		(*argin)[1] = CORBA::string_dup(prop_name);
+		Tango::DevVarStringArray *argout = db_get_device_property(argin);
+
+		if ((*argout)[3] != 0 && strcmp((*argout)[4]," ") != 0)
+			value = (*argout)[4];
+		delete argin;
+		delete argout;
 	}
+	catch(Tango::DevFailed &)
+	{}
 
-	DEBUG_STREAM << "DataBase::escaped_string() wildcard out : " << escaped_string << std::endl;
-	return escaped_string;
+	return value;
 }
 
 //+----------------------------------------------------------------------------
 //
-// method : 		DataBase::device_name_to_dfm(std::string &device_name,
-//			          char **domain, char **family, char **member)
-//
-// description : 	utility function to return domain, family and member
-//			from device name. Assumes device name has (optional)
-//			protocol and instance stripped off i.e. conforms
-//			to domain/family/member
-//
-// in :			char *devname - device name
+// method : 		DataBase::check_history_tables()
 //
-// out :		bool - true or false
+// description : 	Return history id
 //
 //-----------------------------------------------------------------------------
-bool DataBase::device_name_to_dfm(std::string &devname, char domain[], char family[], char member[])
+void DataBase::check_history_tables()
 {
-	std::string::size_type index, index2;
-
-	DEBUG_STREAM << "DataBase::device_name_to_dfm() device name in " << devname << std::endl;
+	TangoSys_MemStream	sql_query_stream;
+	MYSQL_RES *result;
 
-	index = devname.find('/');
-	index2 = devname.find('/', index+1);
+	INFO_STREAM << "DataBase::check_history_tables(): entering" << std::endl;
 
-	(devname.substr(0,index)).copy(domain,index);
-	domain[index] = '\0';
+	sql_query_stream.str("");
+	sql_query_stream << "SELECT count(*) FROM property_device_hist";
+	DEBUG_STREAM << "DataBase::check_history_tables(): sql_query " << sql_query_stream.str() << std::endl;
+	result = query(sql_query_stream.str(),"check_history_tables()");
+	mysql_free_result(result);
+}
 
-	(devname.substr(index+1,index2-index)).copy(family,index2-index);
-	family[index2-index-1] = '\0';
+//+----------------------------------------------------------------------------
+//
+// method : 		DataBase::check_table_engine()
+//
+// description : 	Check if all the database tables use the InnoDB
+//					engine. If it is the case, the commands modifying
+//					the database use transactions instead of table locks
+//
+//-----------------------------------------------------------------------------
+void DataBase::check_table_engine()
+{
+	TangoSys_MemStream	sql_query_stream;
+	MYSQL_RES *result;
+	MYSQL_ROW row;
 
-	(devname.substr(index2+1)).copy(member,devname.length()-index2);
-	member[devname.length()-index2-1] = '\0';
+	sql_query_stream << "SELECT COUNT(*) FROM information_schema.tables WHERE table_schema=DATABASE()"
+					 << " AND table_type='BASE TABLE' AND engine<>'InnoDB'";
+	DEBUG_STREAM << "DataBase::check_table_engine(): sql_query " << sql_query_stream.str() << std::endl;
+	result = query(sql_query_stream.str(),"check_table_engine()");
 
-	DEBUG_STREAM << "DataBase::device_name_to_dfm() domain/family/member out " << domain << "/" << family << "/" << member << std::endl;
+	transactional_engine = false;
+	if ((row = mysql_fetch_row(result)) != NULL && row[0] != NULL)
+		transactional_engine = (atoi(row[0]) == 0);
+	mysql_free_result(result);
 
-	return true;
+	if (transactional_engine == true)
+		WARN_STREAM << "DataBase::check_table_engine(): all tables use InnoDB, using transactions" << std::endl;
+	else
+		WARN_STREAM << "DataBase::check_table_engine(): some tables do not use InnoDB, using table locks (run update_db_to_innodb.sql)" << std::endl;
 }
 
 //+----------------------------------------------------------------------------
 //
-// method : 		DataBase::check_device_name(std::string *device_name)
-//
-// description : 	utility function to check whether device name conforms
-//			to the TANGO naming convention of
-//
-//			[tango!taco:][//instance/]domain/family/member
-//
-// in :			string *device_name - device name
+// method : 		DataBase::read_max_allowed_packet()
 //
-// out :		bool - true or false
+// description : 	Read the server max_allowed_packet variable. It gives
+//					the size of the multi-row INSERT statements built by
+//					the property put commands (some room is kept for the
+//					protocol header)
 //
 //-----------------------------------------------------------------------------
-bool DataBase::check_device_name(std::string &device_name_str)
+void DataBase::read_max_allowed_packet()
 {
-	std::string devname(device_name_str);
-	std::string::size_type index, index2;
-
-	DEBUG_STREAM << "DataBase::check_device_name(): device_name in " << devname << std::endl;
-
-// check there are no special characters which could be interpreted
-// as wildcards or which are otherwise excluded
-
-	if (devname.find('*') != std::string::npos) return false;
+	TangoSys_MemStream	sql_query_stream;
+	MYSQL_RES *result;
+	MYSQL_ROW row;
 
-// check protocol - "tango:" | "taco:"
+	sql_query_stream << "SELECT @@max_allowed_packet";
+	DEBUG_STREAM << "DataBase::read_max_allowed_packet(): sql_query " << sql_query_stream.str() << std::endl;
 
-	if (devname.substr(0,6) == "tango:")
+	try
 	{
-		devname.erase(0,6);
+		result = query(sql_query_stream.str(),"read_max_allowed_packet()");
 	}
-	else
+	catch (Tango::DevFailed &)
 	{
-		if (devname.substr(0,5) == "taco:")
-		{
-			devname.erase(0,5);
-		}
+		WARN_STREAM << "DataBase::read_max_allowed_packet(): cannot read max_allowed_packet, INSERT statements limited to "
+					<< max_insert_size << " bytes" << std::endl;
+		return;
 	}
 
-// check instance - "//instance/"
+	if ((row = mysql_fetch_row(result)) != NULL && row[0] != NULL)
+	{
+		unsigned long packet = strtoul(row[0],NULL,10);
+		if (packet > 2 * MAX_INSERT_SIZE_MARGIN)
+			max_insert_size = packet - MAX_INSERT_SIZE_MARGIN;
+	}
+	mysql_free_result(result);
+
+	DEBUG_STREAM << "DataBase::read_max_allowed_packet(): INSERT statements limited to " << max_insert_size << " bytes" << std::endl;
+}
 
-	if (devname.substr(0,2) == "//")
+//+----------------------------------------------------------------------------
+//
+// method : 		DataBase::get_server_cache_dependencies()
+//
+// description : 	Get the classes and devices of a server (and the access
+//					control device) on which the DbGetDataForServerCache
+//					result depends
+//
+// in :			ds_name - server name
+//				con_nb - MySQL connection (-1 to take one from the pool)
+//
+//-----------------------------------------------------------------------------
+void DataBase::get_server_cache_dependencies(const std::string &ds_name,ServerCache::ServerEntry &entry,int con_nb)
+{
+	TangoSys_MemStream	sql_query_stream;
+	MYSQL_RES *result;
+	MYSQL_ROW row;
+
+	sql_query_stream << "SELECT DISTINCT name,class FROM device WHERE server=\"" << ds_name << "\"";
+	DEBUG_STREAM << "DataBase::get_server_cache_dependencies(): sql_query " << sql_query_stream.str() << std::endl;
+	result = query(sql_query_stream.str(),"get_server_cache_dependencies()",con_nb);
+
+	while ((row = mysql_fetch_row(result)) != NULL)
 	{
-		index = devname.find('/',(string::size_type)2);
-		if (index == 0 || index == std::string::npos)
+		std::string dev(row[0]);
+		std::transform(dev.begin(),dev.end(),dev.begin(),::tolower);
+		entry.devices.insert(dev);
+		if (row[1] != NULL)
 		{
-			return false;
-
+			std::string cl(row[1]);
+			std::transform(cl.begin(),cl.end(),cl.begin(),::tolower);
+			entry.classes.insert(cl);
 		}
-		devname.erase(0,index+1);
 	}
+	mysql_free_result(result);
 
-// check name conforms to "D/F/M"
+//
+// The access control device is defined in the CtrlSystem Services
+// property as "AccessControl/tango:<device name>"
+//
 
-	index = devname.find('/');
-	index2 = devname.find('/',index+1);
+	sql_query_stream.str("");
+	sql_query_stream << "SELECT value FROM property WHERE object=\"CtrlSystem\" AND name=\"Services\"";
+	DEBUG_STREAM << "DataBase::get_server_cache_dependencies(): sql_query " << sql_query_stream.str() << std::endl;
+	result = query(sql_query_stream.str(),"get_server_cache_dependencies()",con_nb);
 
-	if (index == 0 || index == std::string::npos || index2 == std::string::npos ||
-	    index2-index <= 0 || devname.length() - index2 <= 0)
+	std::string ca_dev;
+	while ((row = mysql_fetch_row(result)) != NULL)
 	{
-		return false;
+		if (row[0] != NULL)
+			DsStart::get_ca_device(row[0],ca_dev);
 	}
+	mysql_free_result(result);
 
-	device_name_str = devname;
-
-	DEBUG_STREAM << "DataBase::check_device_name(): device_name out " << device_name_str << std::endl;
-
-	return true;
+	server_cache.set_ca_device(ca_dev);
 }
 
-//+------------------------------------------------------------------
-/**
- *	method:	DataBase::init_timing_stats
- *
- *	description:	method to initialise the timing statistics variables
- *	Returns void
- *
- * @param	none
- * @return	void
- *
- */
-//+------------------------------------------------------------------
-void DataBase::init_timing_stats()
+//+----------------------------------------------------------------------------
+//
+// method : 		DataBase::get_server_data()
+//
+// description : 	Get the DbGetDataForServerCache data of a server from
+//					the cache or from the storage engine
+//
+// in :			argin - ds name and host name
+//
+//-----------------------------------------------------------------------------
+void DataBase::get_server_data(const Tango::DevVarStringArray *argin,ServerData &data)
 {
-	TimingStatsStruct new_timing_stats = {0.0, 0.0, 0.0, 0.0, 0.0};
-
-	timing_stats_mutex.lock();
-
-	timing_stats_map["DbImportDevice"] = new TimingStatsStruct;
-	timing_stats_map["DbExportDevice"] = new TimingStatsStruct;
-	timing_stats_map["DbGetHostServerList"] = new TimingStatsStruct;
-	timing_stats_map["DbGetHostList"] = new TimingStatsStruct;
-	timing_stats_map["DbGetServerList"] = new TimingStatsStruct;
-	timing_stats_map["DbGetDevicePropertyList"] = new TimingStatsStruct;
-	timing_stats_map["DbGetClassPropertyList"] = new TimingStatsStruct;
-	timing_stats_map["DbGetDeviceMemberList"] = new TimingStatsStruct;
-	timing_stats_map["DbGetDeviceFamilyList"] = new TimingStatsStruct;
-	timing_stats_map["DbGetDeviceDomainList"] = new TimingStatsStruct;
-	timing_stats_map["DbGetDeviceProperty"] = new TimingStatsStruct;
-	timing_stats_map["DbPutDeviceProperty"] = new TimingStatsStruct;
-	timing_stats_map["DbDeleteDeviceProperty"] = new TimingStatsStruct;
-	timing_stats_map["DbInfo"] = new TimingStatsStruct;
-	timing_stats_map["DbGetDeviceClassList"] = new TimingStatsStruct;
-	timing_stats_map["DbGetDeviceAttributeProperty"] = new TimingStatsStruct;
-	timing_stats_map["DbPutDeviceAttributeProperty"] = new TimingStatsStruct;
-	timing_stats_map["DbGetDeviceAttributeProperty2"] = new TimingStatsStruct;
-	timing_stats_map["DbPutDeviceAttributeProperty2"] = new TimingStatsStruct;
-	timing_stats_map["DbUnExportServer"] = new TimingStatsStruct;
-	timing_stats_map["DbGetDeviceExportedList"] = new TimingStatsStruct;
-	timing_stats_map["DbExportEvent"] = new TimingStatsStruct;
-	timing_stats_map["DbImportEvent"] = new TimingStatsStruct;
-	timing_stats_map["DbGetDataForServerCache"] = new TimingStatsStruct;
-	timing_stats_map["DbPutClassProperty"] = new TimingStatsStruct;
-	timing_stats_map["DbMySqlSelect"] = new TimingStatsStruct;
-	timing_stats_map["DbGetDevicePipeProperty"] = new TimingStatsStruct;
-	timing_stats_map["DbPutDevicePipeProperty"] = new TimingStatsStruct;
-
-	timing_stats_size = timing_stats_map.size();
-	timing_stats_average = new double[timing_stats_size];
-	timing_stats_minimum = new double[timing_stats_size];
-	timing_stats_maximum = new double[timing_stats_size];
-	timing_stats_calls = new double[timing_stats_size];
-	timing_stats_index = new Tango::DevString[timing_stats_size];
+	if (argin->length() != 2)
+	{
+	   WARN_STREAM << "DataBase::DbGetDataForServerCache(): incorrect number of input arguments " << std::endl;
+	   Tango::Except::throw_exception((const char *)DB_IncorrectArguments,
+	   				  (const char *)"Incorrect no. of input arguments, needs 2 (ds_name,host_name)",
+					  (const char *)"DataBase::DbGetDataForServerCache()");
+	}
+
+	std::string svc((*argin)[0]);
 
-	//	now loop over map and initialise remaining variables
-	std::map<std::string,TimingStatsStruct*>::iterator iter;
-	int i=0;
+//
+// First, try the cache
+//
+
+	ServerCache::ServerEntry cache_entry;
+	std::string cache_key = ServerCache::make_key((*argin)[0],(*argin)[1],cache_entry.server,cache_entry.host);
+	if (server_cache.lookup(cache_key,data.elts) == true)
+		return;
 
-	for (iter = timing_stats_map.begin(); iter != timing_stats_map.end(); iter++)
+//
+// Get the server classes and devices before calling the stored procedure.
+// A change of one of them while the procedure runs prevents the result to
+// be cached
+//
+
+	ServerCacheFill cache_fill(&server_cache,cache_key);
+	if (server_cache.is_enabled() == true)
 	{
-		*(iter->second) = new_timing_stats;
-		timing_stats_index[i] = (char*)malloc(strlen(iter->first.c_str())+1);
-		strcpy(timing_stats_index[i],iter->first.c_str());
-		i++;
+		try
+		{
+			storage->get_server_dependencies(svc,cache_entry);
+			cache_fill.start(cache_entry);
+		}
+		catch (Tango::DevFailed &)
+		{
+			WARN_STREAM << "DataBase::DbGetDataForServerCache(): cannot get the " << svc << " classes and devices, result not cached" << std::endl;
+		}
 	}
 
-	timing_stats_mutex.unlock();
+	bool cacheable = storage->get_server_data((*argin)[0],(*argin)[1],data);
+
+//
+// Store the result in the cache, unless the stored procedure reported
+// an error
+//
+
+	if (server_cache.is_enabled() == true && cacheable == true)
+	{
+		data.get_elts(cache_entry.data);
+		cache_fill.store(cache_entry);
+	}
 }
 
 //+----------------------------------------------------------------------------
 //
-// method : 		DataBase::check_history_tables()
+// method : 		DataBase::get_server_list_data()
 //
-// description : 	Return history id
+// description : 	Get the DbGetDataForServerCache data of several servers
+//					with one MySQL connection. The C++ ds_start
+//					implementation is used and the data common to all
+//					servers are read only once. The servers not in the
+//					cache are registered in the cache before reading any
+//					data, a change done while the data are read then
+//					prevents them to be stored
+//
+// in :			argin - ds name and host name of each server
 //
 //-----------------------------------------------------------------------------
-void DataBase::check_history_tables()
+void DataBase::get_server_list_data(const Tango::DevVarStringArray *argin,std::vector<std::vector<std::string> > &data)
 {
-	TangoSys_MemStream	sql_query_stream;
-	MYSQL_RES *result;
+	unsigned int nb_server = argin->length() / 2;
+	if (nb_server == 0 || (argin->length() % 2) != 0)
+	{
+	   WARN_STREAM << "DataBase::DbGetDataForServerCacheList(): incorrect number of input arguments " << std::endl;
+	   Tango::Except::throw_exception((const char *)DB_IncorrectArguments,
+	   				  (const char *)"Incorrect no. of input arguments, needs pairs of (ds_name,host_name)",
+					  (const char *)"DataBase::DbGetDataForServerCacheList()");
+	}
 
-	INFO_STREAM << "DataBase::check_history_tables(): entering" << std::endl;
+	data.clear();
+	data.resize(nb_server);
 
-	sql_query_stream.str("");
-	sql_query_stream << "SELECT count(*) FROM property_device_hist";
-	DEBUG_STREAM << "DataBase::check_history_tables(): sql_query " << sql_query_stream.str() << std::endl;
-	result = query(sql_query_stream.str(),"check_history_tables()");
-	mysql_free_result(result);
+	std::vector<ServerCache::ServerEntry> cache_entries(nb_server);
+	std::vector<ServerCacheFill *> cache_fills(nb_server,(ServerCacheFill *)NULL);
+	std::vector<bool> in_cache(nb_server,false);
+	DsStartCommon common;
+
+	int con_nb = get_connection();
+	try
+	{
+		for (unsigned int i = 0;i < nb_server;i++)
+		{
+			const char *ds = (*argin)[2 * i];
+			std::string cache_key = ServerCache::make_key(ds,(*argin)[2 * i + 1],
+														  cache_entries[i].server,cache_entries[i].host);
+			in_cache[i] = server_cache.lookup(cache_key,data[i]);
+			if (in_cache[i] == true || server_cache.is_enabled() == false)
+				continue;
+
+			cache_fills[i] = new ServerCacheFill(&server_cache,cache_key);
+			try
+			{
+				get_server_cache_dependencies(ds,cache_entries[i],con_nb);
+				cache_fills[i]->start(cache_entries[i]);
+			}
+			catch (Tango::DevFailed &)
+			{
+				WARN_STREAM << "DataBase::DbGetDataForServerCacheList(): cannot get the " << ds << " classes and devices, result not cached" << std::endl;
+			}
+		}
+
+//
+// The engine may need a connection to apply its writes to MySQL, none is
+// held while waiting for them
+//
+
+		release_connection(con_nb);
+		con_nb = -1;
+		storage->sync();
+		con_nb = get_connection();
+
+		for (unsigned int i = 0;i < nb_server;i++)
+		{
+			if (in_cache[i] == true)
+				continue;
+
+			const char *ds = (*argin)[2 * i];
+			DsStart ds_start(this,ds,(*argin)[2 * i + 1],escape_string(ds),1,&common);
+			ds_start.build(data[i],con_nb);
+
+			if (cache_fills[i] != NULL)
+			{
+				cache_entries[i].data = data[i];
+				cache_fills[i]->store(cache_entries[i]);
+			}
+		}
+	}
+	catch (Tango::DevFailed &)
+	{
+		if (con_nb != -1)
+			release_connection(con_nb);
+		for (unsigned int i = 0;i < nb_server;i++)
+			delete cache_fills[i];
+		throw;
+	}
+
+	release_connection(con_nb);
+	for (unsigned int i = 0;i < nb_server;i++)
+		delete cache_fills[i];
 }
 
 //+----------------------------------------------------------------------------
@@ -431,13 +671,28 @@ Tango::DevULong64 DataBase::get_id(const char *name,int con_nb)
 	TangoSys_MemStream sql_query;
 
 //
-// If no MySQL connection passed to this method,
+// With InnoDB, the history id row stays locked until the end of the
+// caller transaction. Use the dedicated connection (in autocommit mode)
+// in order not to serialize all the transactions updating the same
+// history table.
+// Otherwise, if no MySQL connection passed to this method,
 // get one
 //
 
 	bool need_release = false;
 
-	if (con_nb == -1)
+	if (transactional_engine == true)
+	{
+		TimeVal	before, after;
+		GetTime(before);
+		id_mutex.lock();
+		GetTime(after);
+		double wait = Elapsed(before, after);
+		SqlProfile::add_pool_wait(wait);
+		con_nb = id_con_nb;
+		need_release = true;
+	}
+	else if (con_nb == -1)
 	{
 		con_nb = get_connection();
 		need_release = true;
@@ -447,7 +702,14 @@ Tango::DevULong64 DataBase::get_id(const char *name,int con_nb)
     sql_query << "UPDATE " << name << "_history_id SET id=LAST_INSERT_ID(id+1)";
 	std::string tmp_str = sql_query.str();
 
-	if (mysql_real_query(conn_pool[con_nb].db, tmp_str.c_str(),tmp_str.length()) != 0)
+	TimeVal	before, after;
+	GetTime(before);
+	int ret = mysql_real_query(conn_pool[con_nb].db, tmp_str.c_str(),tmp_str.length());
+	GetTime(after);
+	profile_statement(tmp_str.c_str(),tmp_str.length(),before,after,after,
+					  ret == 0 ? mysql_affected_rows(conn_pool[con_nb].db) : 0,"get_id()");
+
+	if (ret != 0)
 	{
 		TangoSys_OMemStream o;
 
@@ -511,7 +773,14 @@ void DataBase::simple_query(std::string sql_query,const char *method,int con_nb)
 // Call MySQL
 //
 
-	if (mysql_real_query(conn_pool[con_nb].db, sql_query.c_str(),sql_query.length()) != 0)
+	TimeVal	before, after;
+	GetTime(before);
+	int ret = mysql_real_query(conn_pool[con_nb].db, sql_query.c_str(),sql_query.length());
+	GetTime(after);
+	profile_statement(sql_query.c_str(),sql_query.length(),before,after,after,
+					  ret == 0 ? mysql_affected_rows(conn_pool[con_nb].db) : 0,method);
+
+	if (ret != 0)
 	{
 		TangoSys_OMemStream o;
 		TangoSys_OMemStream o2;
@@ -559,127 +828,433 @@ MYSQL_RES *DataBase::query(std::string sql_query,const char *method,int con_nb)
 		need_release = true;
 	}
 
-	DEBUG_STREAM << "Using MySQL connection with semaphore " << con_nb << std::endl;
+	DEBUG_STREAM << "Using MySQL connection with semaphore " << con_nb << std::endl;
+
+//
+// Call MySQL
+//
+
+	TimeVal	before, exec_end, store_end;
+	GetTime(before);
+	int ret = mysql_real_query(conn_pool[con_nb].db, sql_query.c_str(),sql_query.length());
+	GetTime(exec_end);
+
+	if (ret != 0)
+	{
+		profile_statement(sql_query.c_str(),sql_query.length(),before,exec_end,exec_end,0,method);
+
+		TangoSys_OMemStream o;
+		TangoSys_OMemStream o2;
+
+		WARN_STREAM << "DataBase::" << method << " failed to query TANGO database:" << std::endl;
+		WARN_STREAM << "  query = " << sql_query << std::endl;
+		WARN_STREAM << " (SQL error=" << mysql_error(conn_pool[con_nb].db) << ")" << std::endl;
+
+		o << "Failed to query TANGO database (error=" << mysql_error(conn_pool[con_nb].db) << ")";
+		o << "\nThe query was: " << sql_query << std::ends;
+		o2 << "DataBase::" << method << std::ends;
+
+		if (need_release == true)
+			release_connection(con_nb);
+
+		Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),o2.str());
+	}
+
+	result = mysql_store_result(conn_pool[con_nb].db);
+	GetTime(store_end);
+	profile_statement(sql_query.c_str(),sql_query.length(),before,exec_end,store_end,
+					  result != NULL ? mysql_num_rows(result) : 0,method);
+
+	if (result == NULL)
+	{
+		TangoSys_OMemStream o;
+		TangoSys_OMemStream o2;
+
+		WARN_STREAM << "DataBase:: " << method << " : mysql_store_result() failed  (error=" << mysql_error(conn_pool[con_nb].db) << ")" << std::endl;
+
+		o << "mysql_store_result() failed (error=" << mysql_error(conn_pool[con_nb].db) << ")";
+		o2 << "DataBase::" << method;
+
+		if (need_release == true)
+			release_connection(con_nb);
+
+		Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),o2.str());
+	}
+
+	if (need_release)
+		release_connection(con_nb);
+
+	return result;
+
+}
+
+//+----------------------------------------------------------------------------
+//
+// method : 		DataBase::profile_statement()
+//
+// description : 	Add a statement to the SQL profile: Its execution
+//					(start -> exec_end) and result transfer (exec_end ->
+//					store_end) durations and its number of rows. Log it if
+//					it took longer than the slowQueryThreshold property
+//
+//-----------------------------------------------------------------------------
+void DataBase::profile_statement(const char *sql,size_t len,TimeVal &start,TimeVal &exec_end,TimeVal &store_end,
+								 unsigned long long rows,const char *method)
+{
+	double exec = Elapsed(start, exec_end);
+	double store = Elapsed(exec_end, store_end);
+
+//
+// mysql_affected_rows() returns -1 for an error or a SELECT
+//
+
+	if (rows == (unsigned long long)-1)
+		rows = 0;
+
+	sql_profile.add_statement(sql,len,exec,store,rows);
+
+	if (sql_profile.is_slow(exec + store) == true)
+	{
+		std::string stmt(sql,len > SQL_PROFILE_MAX_SQL_LENGTH ? SQL_PROFILE_MAX_SQL_LENGTH : len);
+		if (len > SQL_PROFILE_MAX_SQL_LENGTH)
+			stmt = stmt + "...";
+		WARN_STREAM << "Slow SQL statement in " << method << ": " << exec + store << " ms (mysql " << exec
+					<< " ms, store result " << store << " ms), " << rows << " row(s): " << stmt << std::endl;
+	}
+}
+
+//+----------------------------------------------------------------------------
+//
+// method : 		DataBase::get_connection()
+//
+// description : 	Get a MySQl connection from the connection pool
+//
+//-----------------------------------------------------------------------------
+int DataBase::get_connection()
+{
+
+//
+// Get a MySQL connection from the pool free list
+// If none available, wait for one (in FIFO order) at most
+// the acquire timeout
+//
+
+	TimeVal	before, after;
+	GetTime(before);
+	int con_nb = pool.acquire();
+	GetTime(after);
+	double wait = Elapsed(before, after);
+	SqlProfile::add_pool_wait(wait);
+
+	if (con_nb == -1)
+	{
+		TangoSys_OMemStream o;
+		o << "No free MySQL connection after " << pool.get_timeout() << " ms (pool size = " << conn_pool_size << ")";
+		WARN_STREAM << "DataBase::get_connection(): " << o.str() << std::endl;
+		Tango::Except::throw_exception((const char *)DB_NoFreeMySQLConnection,o.str(),
+									   (const char *)"DataBase::get_connection()");
+	}
+
+	return con_nb;
+}
 
+
+//+----------------------------------------------------------------------------
 //
-// Call MySQL
+// method : 		DataBase::get_stmt()
+//
+// description : 	Get a prepared statement of a MySQL connection. It is
+//					prepared at its first use on this connection
 //
+//-----------------------------------------------------------------------------
+MYSQL_STMT *DataBase::get_stmt(int con_nb,DbStmtId id,const char *method)
+{
+	MYSQL_STMT *stmt = conn_pool[con_nb].stmt[id];
+	if (stmt != NULL)
+		return stmt;
 
-	if (mysql_real_query(conn_pool[con_nb].db, sql_query.c_str(),sql_query.length()) != 0)
+	stmt = mysql_stmt_init(conn_pool[con_nb].db);
+	if (stmt == NULL)
 	{
 		TangoSys_OMemStream o;
 		TangoSys_OMemStream o2;
 
-		WARN_STREAM << "DataBase::" << method << " failed to query TANGO database:" << std::endl;
-		WARN_STREAM << "  query = " << sql_query << std::endl;
-		WARN_STREAM << " (SQL error=" << mysql_error(conn_pool[con_nb].db) << ")" << std::endl;
-
-		o << "Failed to query TANGO database (error=" << mysql_error(conn_pool[con_nb].db) << ")";
-		o << "\nThe query was: " << sql_query << std::ends;
+		o << "mysql_stmt_init() failed (error=" << mysql_error(conn_pool[con_nb].db) << ")" << std::ends;
 		o2 << "DataBase::" << method << std::ends;
-
-		if (need_release == true)
-			release_connection(con_nb);
-
 		Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),o2.str());
 	}
 
-	if ((result = mysql_store_result(conn_pool[con_nb].db)) == NULL)
+	my_bool update_max_length = 1;
+	mysql_stmt_attr_set(stmt,STMT_ATTR_UPDATE_MAX_LENGTH,&update_max_length);
+
+	const char *sql = DbStmt::get_sql(id);
+	if (mysql_stmt_prepare(stmt,sql,::strlen(sql)) != 0)
 	{
 		TangoSys_OMemStream o;
 		TangoSys_OMemStream o2;
 
-		WARN_STREAM << "DataBase:: " << method << " : mysql_store_result() failed  (error=" << mysql_error(conn_pool[con_nb].db) << ")" << std::endl;
-
-		o << "mysql_store_result() failed (error=" << mysql_error(conn_pool[con_nb].db) << ")";
-		o2 << "DataBase::" << method;
+		WARN_STREAM << "DataBase::" << method << " failed to prepare statement:" << std::endl;
+		WARN_STREAM << "  statement = " << sql << std::endl;
+		WARN_STREAM << " (SQL error=" << mysql_stmt_error(stmt) << ")" << std::endl;
 
-		if (need_release == true)
-			release_connection(con_nb);
+		o << "Failed to prepare statement (error=" << mysql_stmt_error(stmt) << ")";
+		o << "\nThe statement was: " << sql << std::ends;
+		o2 << "DataBase::" << method << std::ends;
 
+		mysql_stmt_close(stmt);
 		Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),o2.str());
 	}
 
-	if (need_release)
-		release_connection(con_nb);
-
-	return result;
-
+	DEBUG_STREAM << "Statement " << id << " prepared for MySQL connection " << con_nb << std::endl;
+	conn_pool[con_nb].stmt[id] = stmt;
+	return stmt;
 }
 
 //+----------------------------------------------------------------------------
 //
-// method : 		DataBase::get_connection()
+// method : 		DataBase::reset_stmt()
 //
-// description : 	Get a MySQl connection from the connection pool
+// description : 	Prepare again a statement lost by a MySQL re-connection
+//					(MYSQL_OPT_RECONNECT). All the statements of the
+//					connection are lost in this case
 //
 //-----------------------------------------------------------------------------
-int DataBase::get_connection()
+MYSQL_STMT *DataBase::reset_stmt(int con_nb,DbStmtId id,const char *method)
 {
+	WARN_STREAM << "DataBase::" << method << ": prepared statements lost for MySQL connection " << con_nb << ", preparing them again" << std::endl;
 
+	close_stmts(con_nb);
+	mysql_ping(conn_pool[con_nb].db);
+	return get_stmt(con_nb,id,method);
+}
+
+//+----------------------------------------------------------------------------
 //
-// Get a MySQL connection and lock it
-// If none available, wait for one
+// method : 		DataBase::close_stmts()
 //
-
-	int loop = 0;
-	while (conn_pool[loop].the_sema.trywait() == 0)
+// description : 	Close all the prepared statements of a MySQL connection
+//
+//-----------------------------------------------------------------------------
+void DataBase::close_stmts(int con_nb)
+{
+	for (int i = 0;i < STMT_NB;i++)
 	{
-		loop++;
-		if (loop == conn_pool_size)
+		if (conn_pool[con_nb].stmt[i] != NULL)
 		{
-			int sem_to_wait;
-			{
-				omni_mutex_lock oml(sem_wait_mutex);
-				sem_to_wait = last_sem_wait++;
-				if (last_sem_wait == conn_pool_size)
-					last_sem_wait = 0;
-			}
-			loop = sem_to_wait;
-			WARN_STREAM << "Waiting for one free MySQL connection on semaphore " << loop << std::endl;
-			conn_pool[loop].the_sema.wait();
-			break;
+			mysql_stmt_close(conn_pool[con_nb].stmt[i]);
+			conn_pool[con_nb].stmt[i] = NULL;
 		}
 	}
+}
+
+//+----------------------------------------------------------------------------
+//
+// method : 		DataBase::stmt_error()
+//
+// description : 	Throw the exception for a failed prepared statement
+//
+//-----------------------------------------------------------------------------
+void DataBase::stmt_error(MYSQL_STMT *stmt,DbStmtId id,const char *method)
+{
+	TangoSys_OMemStream o;
+	TangoSys_OMemStream o2;
+
+	WARN_STREAM << "DataBase::" << method << " failed to query TANGO database:" << std::endl;
+	WARN_STREAM << "  statement = " << DbStmt::get_sql(id) << std::endl;
+	WARN_STREAM << " (SQL error=" << mysql_stmt_error(stmt) << ")" << std::endl;
 
-	return loop;
+	o << "Failed to query TANGO database (error=" << mysql_stmt_error(stmt) << ")";
+	o << "\nThe statement was: " << DbStmt::get_sql(id) << std::ends;
+	o2 << "DataBase::" << method << std::ends;
+
+	Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),o2.str());
 }
 
+//+----------------------------------------------------------------------------
+//
+// method : 		DataBase::stored_value()
+//
+// description : 	Return a property value as it is stored by escape_string()
+//					and a SQL string literal: A backslash sent by the client
+//					before a quote is removed. The value is returned as is
+//					(no copy) when it has no backslash
+//
+//-----------------------------------------------------------------------------
+const char *DataBase::stored_value(const char *value,std::string &buf)
+{
+	if (::strchr(value,'\\') == NULL)
+		return value;
+
+	buf.clear();
+	for (const char *ptr = value;*ptr != '\0';ptr++)
+	{
+		if (*ptr == '\\' && (*(ptr + 1) == '"' || *(ptr + 1) == '\''))
+			continue;
+		buf += *ptr;
+	}
+	return buf.c_str();
+}
 
 //+------------------------------------------------------------------
 /**
- *	method:	purge_property()
+ *	method:	purge_history()
  *
- *	description:	purge a property history table.
+ *	description:	Keep only the historyDepth newest values of one property
+ *					in a history table. The history ids are increasing, the
+ *					id of the first value to remove is read and all the
+ *					older ones are removed with a single DELETE.
  *
  */
 //+------------------------------------------------------------------
-void DataBase::purge_property(const char *table,const char *field,const char *object,const char *name,int con_nb) {
+void DataBase::purge_history(const char *table,const std::string &cond,int con_nb) {
 
   TangoSys_MemStream sql_query;
   MYSQL_RES *result;
-  MYSQL_ROW row2;
-
-  sql_query.str("");
-  sql_query << "SELECT DISTINCT id,date FROM " << table
-            << " WHERE " << field << "=\"" << object << "\" AND name=\"" << name
-            << "\" ORDER by date";
-
-  result = query(sql_query.str(),"purge_property()",con_nb);
-  int nb_item = mysql_num_rows(result);
-
-  if(nb_item>historyDepth) {
-    // Purge
-    int toDelete = nb_item-historyDepth;
-    for(int j=0;j<toDelete;j++) {
-        row2 = mysql_fetch_row(result);
-        sql_query.str("");
-        sql_query << "DELETE FROM " << table << " WHERE id='" << row2[0] << "'";
-		simple_query(sql_query.str(),"purge_property()",con_nb);
+  MYSQL_ROW row;
+  std::string first_purged_id;
+
+  sql_query << "SELECT DISTINCT id FROM " << table << " WHERE " << cond
+            << " ORDER BY id DESC LIMIT " << historyDepth << ",1";
+
+  result = query(sql_query.str(),"purge_history()",con_nb);
+  if ((row = mysql_fetch_row(result)) != NULL && row[0] != NULL)
+    first_purged_id = row[0];
+  mysql_free_result(result);
+
+  if (first_purged_id.empty() == false) {
+    sql_query.str("");
+    sql_query << "DELETE FROM " << table << " WHERE " << cond << " AND id<=" << first_purged_id;
+    simple_query(sql_query.str(),"purge_history()",con_nb);
+  }
+}
+
+//+------------------------------------------------------------------
+/**
+ *	method:	start_purge()
+ *
+ *	description:	Purge a history table now or, when the history is
+ *					purged in background, queue the purge.
+ *
+ */
+//+------------------------------------------------------------------
+void DataBase::start_purge(const char *table,const std::string &cond,int con_nb) {
+
+  if (hist_purger != NULL)
+    purge_queue.add(table,cond);
+  else
+    purge_history(table,cond,con_nb);
+}
+
+//+------------------------------------------------------------------
+/**
+ *	method:	request_purge()
+ *
+ *	description:	Purge requested by a put command. With the
+ *					asynchronous history writer, the purge is done by
+ *					the writer after the history values.
+ *
+ */
+//+------------------------------------------------------------------
+void DataBase::request_purge(const char *table,const std::string &cond,int con_nb) {
+
+  if (defer_history(con_nb,table,cond) == false)
+    start_purge(table,cond,con_nb);
+}
+
+//+------------------------------------------------------------------
+/**
+ *	method:	defer_history()
+ *
+ *	description:	When the history is written asynchronously, keep a
+ *					history record (INSERT statement if table is empty,
+ *					purge otherwise) with the connection until the
+ *					transaction is committed. Return false if the record
+ *					has to be written now.
+ *
+ */
+//+------------------------------------------------------------------
+bool DataBase::defer_history(int con_nb,const char *table,const std::string &sql) {
+
+  if (hist_writer == NULL || con_nb < 0)
+    return false;
+
+  conn_pool[con_nb].hist_pending.push_back(HistRecord(table,sql));
+  return true;
+}
+
+//+------------------------------------------------------------------
+/**
+ *	method:	commit_history()
+ *
+ *	description:	Give the history records kept with the connection to
+ *					the writer thread, once the caller transaction is
+ *					committed. They are written now (on the caller
+ *					connection) if the queue is full. Return the
+ *					sequence numbers of the first and of the last record
+ *					queued, 0 if none.
+ *
+ */
+//+------------------------------------------------------------------
+unsigned long long DataBase::commit_history(int con_nb,unsigned long long &first) {
+
+  std::vector<HistRecord> &pending = conn_pool[con_nb].hist_pending;
+  first = 0;
+  if (pending.empty() == true)
+    return 0;
+
+  unsigned long long nb = pending.size();
+  unsigned long long seq = hist_queue.push(pending);
+  if (seq != 0)
+    first = seq - nb + 1;
+  if (seq == 0) {
+    std::vector<HistRecord> recs;
+    recs.swap(pending);
+    for (unsigned int i = 0;i < recs.size();i++) {
+      if (recs[i].table.empty() == true)
+        simple_query(recs[i].sql,"commit_history()",con_nb);
+      else
+        start_purge(recs[i].table.c_str(),recs[i].sql,con_nb);
     }
   }
+  pending.clear();
+  return seq;
+}
 
-  mysql_free_result(result);
+//+------------------------------------------------------------------
+/**
+ *	method:	wait_history()
+ *
+ *	description:	With a history write delay of 0, wait until the
+ *					writer thread has written the given history records.
+ *					Throw an exception if they could not be written.
+ *
+ */
+//+------------------------------------------------------------------
+void DataBase::wait_history(unsigned long long first,unsigned long long seq) {
+
+  if (seq == 0 || hist_queue.get_delay() != 0)
+    return;
+
+  if (hist_queue.wait_written(first,seq) == false)
+    Tango::Except::throw_exception((const char *)DB_SQLError,
+                                   (const char *)"Failed to write the property history (see the DB server log)",
+                                   (const char *)"DataBase::wait_history()");
+}
+
+//+------------------------------------------------------------------
+/**
+ *	method:	purge_property()
+ *
+ *	description:	purge a property history table.
+ *
+ */
+//+------------------------------------------------------------------
+void DataBase::purge_property(const char *table,const char *field,const char *object,const char *name,int con_nb) {
+
+  TangoSys_MemStream cond;
+
+  cond << field << "=\"" << object << "\" AND name=\"" << name << "\"";
+  request_purge(table,cond.str(),con_nb);
 }
 
 //+------------------------------------------------------------------
@@ -692,31 +1267,11 @@ void DataBase::purge_property(const char *table,const char *field,const char *ob
 //+------------------------------------------------------------------
 void DataBase::purge_att_property(const char *table,const char *field,const char *object,const char *attribute,const char *name,int con_nb) {
 
-  TangoSys_MemStream sql_query;
-  MYSQL_RES *result;
-  MYSQL_ROW row2;
-
-  //cout << "purge_att_property(" << object << "," << attribute << "," << name << ")" << std::endl;
-
-  sql_query.str("");
-  sql_query << "SELECT DISTINCT id,date FROM " << table
-            << " WHERE " << field << "=\"" << object << "\" AND name=\"" << name
-            << "\" AND attribute=\"" << attribute << "\" ORDER by date";
-
-  result = query(sql_query.str(),"purge_att_property()",con_nb);
-  int nb_item = mysql_num_rows(result);
-
-  if(nb_item>historyDepth) {
-    // Purge
-    int toDelete = nb_item-historyDepth;
-    for(int j=0;j<toDelete;j++) {
-		row2 = mysql_fetch_row(result);
-        sql_query.str("");
-        sql_query << "DELETE FROM " << table << " WHERE id='" << row2[0] << "'";
-		simple_query(sql_query.str(),"purge_att_property()",con_nb);
-    }
-  }
-  mysql_free_result(result);
+  TangoSys_MemStream cond;
+
+  cond << field << "=\"" << object << "\" AND name=\"" << name
+       << "\" AND attribute=\"" << attribute << "\"";
+  request_purge(table,cond.str(),con_nb);
 }
 
 //+------------------------------------------------------------------
@@ -729,31 +1284,11 @@ void DataBase::purge_att_property(const char *table,const char *field,const char
 //+------------------------------------------------------------------
 void DataBase::purge_pipe_property(const char *table,const char *field,const char *object,const char *pipe,const char *name,int con_nb) {
 
-  TangoSys_MemStream sql_query;
-  MYSQL_RES *result;
-  MYSQL_ROW row2;
-
-  //cout << "purge_pipe_property(" << object << "," << pipe << "," << name << ")" << std::endl;
-
-  sql_query.str("");
-  sql_query << "SELECT DISTINCT id,date FROM " << table
-            << " WHERE " << field << "=\"" << object << "\" AND name=\"" << name
-            << "\" AND pipe=\"" << pipe << "\" ORDER by date";
-
-  result = query(sql_query.str(),"purge_pipe_property()",con_nb);
-  int nb_item = mysql_num_rows(result);
-
-  if(nb_item>historyDepth) {
-    // Purge
-    int toDelete = nb_item-historyDepth;
-    for(int j=0;j<toDelete;j++) {
-		row2 = mysql_fetch_row(result);
-        sql_query.str("");
-        sql_query << "DELETE FROM " << table << " WHERE id='" << row2[0] << "'";
-		simple_query(sql_query.str(),"purge_pipe_property()",con_nb);
-    }
-  }
-  mysql_free_result(result);
+  TangoSys_MemStream cond;
+
+  cond << field << "=\"" << object << "\" AND name=\"" << name
+       << "\" AND pipe=\"" << pipe << "\"";
+  request_purge(table,cond.str(),con_nb);
 }
 
 //+------------------------------------------------------------------
@@ -862,8 +1397,31 @@ void DataBase::create_connection_pool(const char *mysql_user,
 	else
 		host = NULL;
 
-	for (int loop = 0;loop < conn_pool_size;loop++)
+//
+// Keep connection parameters for the connections opened later
+//
+
+	conn_params.user_def = mysql_user != NULL;
+	conn_params.password_def = mysql_password != NULL;
+	conn_params.host_def = host != NULL;
+	if (conn_params.user_def == true)
+		conn_params.user = mysql_user;
+	if (conn_params.password_def == true)
+		conn_params.password = mysql_password;
+	if (conn_params.host_def == true)
+		conn_params.host = host;
+	conn_params.port = port_num;
+
+//
+// Only the first connection and the one dedicated to the history
+// identifiers are opened here. The other ones are opened on demand
+// by the PoolMaintainer thread
+//
+
+	int first_conns[2] = {0,id_con_nb};
+	for (int i = 0;i < 2;i++)
 	{
+		int loop = first_conns[i];
 
 		base_connect(loop);
 
@@ -931,212 +1489,234 @@ void DataBase::create_connection_pool(const char *mysql_user,
 	}
 
 	mysql_svr_version = mysql_get_server_version(conn_pool[0].db);
-	last_sem_wait = 0;
+	pool.init(1,conn_pool_size);
 
 }
 
 //+------------------------------------------------------------------
 /**
- *	method:	host_port_from_ior()
+ *	method:	open_connection()
  *
- *	description:	Get host and port from a device IOR
+ *	description:	Open one connection of the pool (called by the
+ *					PoolMaintainer thread)
  *
+ *	@return	false if the connection failed
  */
 //+------------------------------------------------------------------
 
-bool DataBase::host_port_from_ior(const char *iorstr,std::string &h_p)
+bool DataBase::open_connection(int con_nb)
 {
-	size_t s = (iorstr ? strlen(iorstr) : 0);
+	base_connect(con_nb);
 
-  	if (s < 4)
-    	return false;
+	const char *host = conn_params.host_def == true ? conn_params.host.c_str() : NULL;
+	const char *user = conn_params.user_def == true ? conn_params.user.c_str() : NULL;
+	const char *passwd = conn_params.password_def == true ? conn_params.password.c_str() : NULL;
 
-  	const char *p = iorstr;
-  	if (p[0] != 'I' || p[1] != 'O' || p[2] != 'R' || p[3] != ':')
-    	return false;
+	if (!mysql_real_connect(conn_pool[con_nb].db, host, user, passwd, mysql_db_name.c_str(), conn_params.port, NULL, CLIENT_MULTI_STATEMENTS | CLIENT_FOUND_ROWS))
+	{
+		WARN_STREAM << "Failed to connect to MySQL for conn. " << con_nb << " (error = " << mysql_error(conn_pool[con_nb].db) << ")" << std::endl;
+		mysql_close(conn_pool[con_nb].db);
+		conn_pool[con_nb].db = NULL;
+		return false;
+	}
 
-  	s = (s - 4) / 2;  // how many octets are there in the string
-  	p += 4;
+	DEBUG_STREAM << "MySQL connection " << con_nb << " opened" << std::endl;
+	return true;
+}
 
-  	cdrMemoryStream buf((CORBA::ULong)s,0);
+//+------------------------------------------------------------------
+/**
+ *	method:	close_connection()
+ *
+ *	description:	Close one idle connection of the pool (called by the
+ *					PoolMaintainer thread)
+ */
+//+------------------------------------------------------------------
 
-  	for (int i=0; i<(int)s; i++)
-	{
-    	int j = i*2;
-    	CORBA::Octet v;
+void DataBase::close_connection(int con_nb)
+{
+	close_stmts(con_nb);
+	mysql_close(conn_pool[con_nb].db);
+	conn_pool[con_nb].db = NULL;
 
-    	if (p[j] >= '0' && p[j] <= '9')
-		{
-      		v = ((p[j] - '0') << 4);
-    	}
-    	else if (p[j] >= 'a' && p[j] <= 'f')
-		{
-      		v = ((p[j] - 'a' + 10) << 4);
-    	}
-    	else if (p[j] >= 'A' && p[j] <= 'F')
-		{
-      		v = ((p[j] - 'A' + 10) << 4);
-    	}
-    	else
-      		return false;
+	DEBUG_STREAM << "MySQL connection " << con_nb << " closed" << std::endl;
+}
 
-    	if (p[j+1] >= '0' && p[j+1] <= '9')
-		{
-      		v += (p[j+1] - '0');
-    	}
-    	else if (p[j+1] >= 'a' && p[j+1] <= 'f')
-		{
-      		v += (p[j+1] - 'a' + 10);
-    	}
-    	else if (p[j+1] >= 'A' && p[j+1] <= 'F')
-		{
-      		v += (p[j+1] - 'A' + 10);
-    	}
-    	else
-      		return false;
+//+------------------------------------------------------------------
+/**
+ *	method:	import_entry_to_argout()
+ *
+ *	description:	Build a DbImportDevice/DbImportEvent reply from
+ *					an import cache entry
+ *
+ */
+//+------------------------------------------------------------------
 
-    	buf.marshalOctet(v);
-  	}
+Tango::DevVarLongStringArray *DataBase::import_entry_to_argout(ImportCache::ImportEntry &entry)
+{
+	Tango::DevVarLongStringArray *argout = new Tango::DevVarLongStringArray;
 
-  	buf.rewindInputPtr();
-  	CORBA::Boolean b = buf.unmarshalBoolean();
-  	buf.setByteSwapFlag(b);
+	(argout->svalue).length(entry.svalue.size());
+	for (unsigned int i = 0;i < entry.svalue.size();i++)
+		(argout->svalue)[i] = CORBA::string_dup(entry.svalue[i].c_str());
 
-  	IOP::IOR ior;
+	(argout->lvalue).length(entry.lvalue.size());
+	for (unsigned int i = 0;i < entry.lvalue.size();i++)
+		(argout->lvalue)[i] = entry.lvalue[i];
 
-  	ior.type_id = IOP::IOR::unmarshaltype_id(buf);
-  	ior.profiles <<= buf;
+	return argout;
+}
 
+//+------------------------------------------------------------------
+/**
+ *	method:	AutoTransaction class ctor, commit and dtor
+ *
+ *	description:	AutoTransaction is a small helper class which get a
+ *					MySQL connection from the pool and which start a
+ *					transaction on it (read only or not, as given by
+ *					the mode). The commit() method has to be
+ *					called once all the SQL statements are done. If it
+ *					is not (exception thrown), the dtor roll back the
+ *					transaction.
+ *					With a database still using MyISAM tables, there is
+ *					no transaction and the lock statement passed to the
+ *					ctor is used instead (the dtor release the table(s)
+ *					lock)
+ *					With the asynchronous history writer, the history
+ *					records of the transaction are queued by commit()
+ *					and dropped by the dtor if it is not called. The dtor
+ *					waits for them to be written if the history write
+ *					delay is 0
+ *
+ */
+//+------------------------------------------------------------------
 
-    if (ior.profiles.length() == 0 && strlen(ior.type_id) == 0)
-	{
-      	return false;
-    }
-    else
-	{
-      	for (unsigned long count=0; count < ior.profiles.length(); count++)
-		{
-			if (ior.profiles[count].tag == IOP::TAG_INTERNET_IOP)
-			{
-	  			IIOP::ProfileBody pBody;
-	  			IIOP::unmarshalProfile(ior.profiles[count],pBody);
+AutoTransaction::AutoTransaction(const char *lock_cmd,TransactionMode mode,DataBase *db):the_db(db),committed(false),hist_first(0),hist_seq(0)
+{
+	con_nb = the_db->get_connection();
+	transactional = the_db->is_transactional();
+	TangoSys_MemStream sql_query_stream;
 
 //
-// Three possible cases for host name:
-// 1 - The host is stored in IOR as IP numbers
-// 2 - The host name is stored in IOR as the canonical host name
-// 3 - The FQDN is stored in IOR
-// We allways try to get the host name as the FQDN
+// Read only transaction: Use a consistent snapshot to get the
+// same view for all the SELECT statements
 //
 
-				ho = pBody.address.host.in();
-				bool host_is_name = false;
+	if (transactional == true)
+	{
+		if (mode == TRANSACTION_READ)
+			sql_query_stream << "START TRANSACTION WITH CONSISTENT SNAPSHOT";
+		else
+			sql_query_stream << "START TRANSACTION";
+	}
+	else
+		sql_query_stream << lock_cmd;
 
-				std::string::size_type pos = ho.find('.');
-				if (pos == std::string::npos)
-					host_is_name = true;
-				else
-				{
-					for (unsigned int loop =0;loop < pos;++loop)
-					{
-						if (isdigit((int)ho[loop]) == 0)
-						{
-							host_is_name = true;
-							break;
-						}
-					}
-				}
+	try
+	{
+		the_db->simple_query(sql_query_stream.str(),"AutoTransaction",con_nb);
+	}
+	catch (...)
+	{
+		the_db->release_connection(con_nb);
+		throw;
+	}
+}
 
-				if (host_is_name == false)
-				{
-					struct sockaddr_in s;
-					char service[20];
+//
+// The history records are given to the writer only once the COMMIT
+// succeeded
+//
 
-					s.sin_family = AF_INET;
-					int res;
-#ifdef _TG_WINDOWS_
-					s.sin_addr.s_addr = inet_addr(ho.c_str());
-					if (s.sin_addr.s_addr != INADDR_NONE)
-#else
-					res = inet_pton(AF_INET,ho.c_str(),&(s.sin_addr.s_addr));
-					if (res == 1)
-#endif
-					{
-						res = getnameinfo((const struct sockaddr *)&s,sizeof(s),ho_name,sizeof(ho_name),service,sizeof(service),0);
-						if (res == 0)
-						{
-							h_p = ho_name;
-							h_p = h_p + ':';
-						}
-						else
-							h_p = ho + ':';
-					}
-					else
-						h_p = ho + ':';
-				}
-				else
-				{
-					if (pos == std::string::npos)
-					{
-						Tango::DeviceProxy::get_fqdn(ho);
-					}
+void AutoTransaction::commit()
+{
+	if (committed == true)
+		return;
 
-					h_p = ho + ':';
-				}
+	if (transactional == true)
+	{
+		TangoSys_MemStream sql_query_stream;
+		sql_query_stream << "COMMIT";
+		the_db->simple_query(sql_query_stream.str(),"AutoTransaction::commit",con_nb);
+	}
+	committed = true;
+
+	hist_seq = the_db->commit_history(con_nb,hist_first);
+}
 
 //
-// Add port number
+// A history write failure is reported (with the write delay of 0) by an
+// exception, unless the command is already failing
 //
 
-				std::stringstream ss;
-				ss << pBody.address.port;
-				h_p = h_p + ss.str();
+AutoTransaction::~AutoTransaction() noexcept(false)
+{
+	TangoSys_MemStream sql_query_stream;
+	if (transactional == false)
+		sql_query_stream << "UNLOCK TABLES";
+	else if (committed == false)
+		sql_query_stream << "ROLLBACK";
 
-				break;
-			}
+	if (sql_query_stream.str().empty() == false)
+	{
+		try
+		{
+			the_db->simple_query(sql_query_stream.str(),"~AutoTransaction",con_nb);
 		}
+		catch (Tango::DevFailed &) {}
 	}
+	the_db->drop_history(con_nb);
+	the_db->release_connection(con_nb);
 
-	return true;
+	if (std::uncaught_exception() == false)
+		the_db->wait_history(hist_first,hist_seq);
 }
 
 
 //+------------------------------------------------------------------
 /**
- *	method:	AutoLock class ctor and dtor
+ *	method:	InsertBatch class ctor, add and flush
  *
- *	description:	AutoLock is a small helper class which get a
- *					MySQL connection from the pool and which lock
- *					table(s). The exact lock statemen is passed to the
- *					ctor as a parameter
- *					The dtor release the table(s) lock
+ *	description:	InsertBatch builds one multi-row INSERT statement
+ *					from the rows given to add() (each row being the
+ *					"(v1,v2,...)" values list). The statement is sent
+ *					when it would become larger than the server
+ *					max_allowed_packet and by flush(). flush() has to
+ *					be called before any other statement which depends
+ *					on the inserted rows.
+ *					The statements of a history batch are given to the
+ *					asynchronous history writer when it is used
  *
  */
 //+------------------------------------------------------------------
 
-AutoLock::AutoLock(const char *lock_cmd,DataBase *db):the_db(db)
+InsertBatch::InsertBatch(DataBase *db,const char *insert_head,int con,const char *meth,bool hist):
+	the_db(db),head(insert_head),sql(insert_head),con_nb(con),method(meth),nb_rows(0),history(hist)
 {
-	con_nb = the_db->get_connection();
-	TangoSys_MemStream sql_query_stream;
+}
 
-	sql_query_stream << lock_cmd;
-	try
-	{
-		the_db->simple_query(sql_query_stream.str(),"AutoLock",con_nb);
-	}
-	catch (...)
-	{
-		the_db->release_connection(con_nb);
-		throw;
-	}
+void InsertBatch::add(const std::string &row)
+{
+	if (nb_rows != 0 && sql.size() + row.size() + 1 > the_db->get_max_insert_size())
+		flush();
+
+	if (nb_rows != 0)
+		sql += ',';
+	sql += row;
+	nb_rows++;
 }
 
-AutoLock::~AutoLock()
+void InsertBatch::flush()
 {
-	TangoSys_MemStream sql_query_stream;
-	sql_query_stream << "UNLOCK TABLES";
-	the_db->simple_query(sql_query_stream.str(),"~AutoLock",con_nb);
-	the_db->release_connection(con_nb);
+	if (nb_rows == 0)
+		return;
+
+	std::string full_sql;
+	full_sql.swap(sql);
+	sql = head;
+	nb_rows = 0;
+	if (history == false || the_db->defer_history(con_nb,"",full_sql) == false)
+		the_db->simple_query(full_sql,method,con_nb);
 }
 
 }
@@ -0,0 +1,451 @@
+//=============================================================================
+//
+// file :        bench_common.h
+//
+// description : Parts shared by the db_load_bench and db_storage_bench
+//               load generators: The commands and scenarios, the client
+//               thread loop, the command line options and the report of
+//               the throughput and latency percentiles (JSON or text).
+//               Each program gives its client class, running one command
+//               (through the DB server or on a storage engine).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _BENCH_COMMON_H
+#define _BENCH_COMMON_H
+
+#include <tango.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <algorithm>
+#include <iomanip>
+#include <atomic>
+
+#define	BENCH_HOST			"bench_host"
+#define	BENCH_DEV_PER_SERVER	10
+#define	BENCH_NB_PROP		10
+
+enum BenchCmd {CMD_IMPORT = 0, CMD_GET_PROP, CMD_PUT_PROP, CMD_EXPORT, CMD_SERVER_DATA, CMD_NB};
+
+static const char *cmd_keys[CMD_NB] = {"import","get_prop","put_prop","export","server_data"};
+static const char *cmd_names[CMD_NB] = {"DbImportDevice","DbGetDeviceProperty","DbPutDeviceProperty",
+										"DbExportDevice","DbGetDataForServerCache"};
+
+//
+// Scenarios: Default mix (weight of each command) and number of clients
+//
+
+typedef struct
+{
+	const char	*name;
+	int			weights[CMD_NB];
+	int			nb_threads;
+} Scenario;
+
+static const Scenario scenarios[] =
+{
+	//	name		import	get_prop	put_prop	export	server_data		threads
+	{"steady",		{60,	35,			4,			1,		0},				16},
+	{"restart",		{30,	10,			0,			30,		30},			64},
+	{"jive",		{20,	65,			15,			0,		0},				4}
+};
+static const int nb_scenario = sizeof(scenarios) / sizeof(Scenario);
+
+//
+// Latencies (ms) and errors recorded by one client thread
+//
+
+typedef struct
+{
+	std::vector<double>	latencies[CMD_NB];
+	long				nb_err[CMD_NB];
+} ClientStats;
+
+//
+// Command line options
+//
+
+typedef struct
+{
+	const Scenario	*scenario;
+	int				nb_threads;
+	int				duration;
+	int				warm_up;
+	int				nb_devices;
+	bool			json;
+	const char		*mix;
+	int				weights[CMD_NB];
+	std::string		target;			// DB device or database file
+} BenchOptions;
+
+//=========================================================
+/**
+ *	One client thread, running commands drawn at random
+ *	(according to the mix weights) on random devices until
+ *	the stop flag is set. Latencies are recorded only while
+ *	the record flag is set (after the warm up)
+ */
+//=========================================================
+class BenchClient: public omni_thread
+{
+public:
+	BenchClient(const std::vector<std::string> &devs,const int *w,unsigned int s,
+				std::atomic<bool> *rec,std::atomic<bool> *stop,ClientStats *st):
+		dev_names(devs),seed(s),record_flag(rec),stop_flag(stop),stats(st)
+	{
+		total_weight = 0;
+		for (int i = 0;i < CMD_NB;i++)
+		{
+			total_weight += w[i];
+			weights[i] = w[i];
+			stats->nb_err[i] = 0;
+		}
+	}
+
+	void *run_undetached(void *)
+	{
+		init_thread();
+		long loop = 0;
+
+		while (*stop_flag == false)
+		{
+			int r = rand_r(&seed) % total_weight;
+			int cmd = 0;
+			while (r >= weights[cmd])
+			{
+				r -= weights[cmd];
+				cmd++;
+			}
+			size_t dev = rand_r(&seed) % dev_names.size();
+
+			struct timeval before,after;
+			gettimeofday(&before,NULL);
+			try
+			{
+				run_command((BenchCmd)cmd,dev,loop);
+				gettimeofday(&after,NULL);
+				if (*record_flag == true)
+					stats->latencies[cmd].push_back((after.tv_sec - before.tv_sec) * 1000.0 + (after.tv_usec - before.tv_usec) / 1000.0);
+			}
+			catch (Tango::DevFailed &e)
+			{
+				if (*record_flag == true)
+				{
+					if (stats->nb_err[cmd] == 0)
+						Tango::Except::print_exception(e);
+					stats->nb_err[cmd]++;
+				}
+			}
+			loop++;
+		}
+		return NULL;
+	}
+
+	void start() {start_undetached();}
+
+protected:
+	virtual void init_thread() {}
+	virtual void run_command(BenchCmd,size_t,long) = 0;
+
+	const std::vector<std::string>	&dev_names;
+
+private:
+	int								weights[CMD_NB];
+	int								total_weight;
+	unsigned int					seed;
+	std::atomic<bool>				*record_flag;
+	std::atomic<bool>				*stop_flag;
+	ClientStats						*stats;
+};
+
+//=============================================================================
+//	Percentile of sorted latencies (the smallest value greater or equal to
+//	pct % of them)
+//=============================================================================
+static double percentile(const std::vector<double> &sorted,double pct)
+{
+	if (sorted.empty() == true)
+		return 0.0;
+	size_t rank = (size_t)ceil((pct / 100.0) * sorted.size());
+	if (rank == 0)
+		rank = 1;
+	if (rank > sorted.size())
+		rank = sorted.size();
+	return sorted[rank - 1];
+}
+
+//=============================================================================
+//	Parse a "command=weight,..." mix. Commands not given get a null weight
+//=============================================================================
+static bool parse_mix(const char *str,int *weights)
+{
+	for (int i = 0;i < CMD_NB;i++)
+		weights[i] = 0;
+
+	std::stringstream ss(str);
+	std::string item;
+	int total = 0;
+	while (std::getline(ss,item,','))
+	{
+		std::string::size_type pos = item.find('=');
+		if (pos == std::string::npos)
+			return false;
+		std::string key = item.substr(0,pos);
+		int w = atoi(item.c_str() + pos + 1);
+		int i;
+		for (i = 0;i < CMD_NB;i++)
+		{
+			if (key == cmd_keys[i])
+				break;
+		}
+		if (i == CMD_NB || w < 0)
+			return false;
+		weights[i] = w;
+		total += w;
+	}
+	return total > 0;
+}
+
+static void usage(const char *prog,const char *target_name)
+{
+	cerr << "usage: " << prog << " [-s steady|restart|jive] [-t threads] [-d duration (s)] [-w warm up (s)]" << std::endl;
+	cerr << "       [-n devices] [-m command=weight,...] [-f json|text] [" << target_name << "]" << std::endl;
+	cerr << "       commands: import, get_prop, put_prop, export, server_data" << std::endl;
+	exit(-1);
+}
+
+//=============================================================================
+//	Parse the command line. The target (last argument) keeps its default
+//	value if not given
+//=============================================================================
+static void parse_options(int argc,char *argv[],const char *target_name,BenchOptions &opt)
+{
+	opt.scenario = &scenarios[0];
+	opt.nb_threads = 0;
+	opt.duration = 30;
+	opt.warm_up = 5;
+	opt.nb_devices = 200;
+	opt.json = true;
+	opt.mix = NULL;
+
+	int c;
+	while ((c = getopt(argc,argv,"s:t:d:w:n:m:f:")) != -1)
+	{
+		switch (c)
+		{
+		case 's':
+		{
+			int i;
+			for (i = 0;i < nb_scenario;i++)
+			{
+				if (::strcmp(optarg,scenarios[i].name) == 0)
+					break;
+			}
+			if (i == nb_scenario)
+				usage(argv[0],target_name);
+			opt.scenario = &scenarios[i];
+			break;
+		}
+
+		case 't':
+			opt.nb_threads = atoi(optarg);
+			if (opt.nb_threads <= 0)
+				usage(argv[0],target_name);
+			break;
+
+		case 'd':
+			opt.duration = atoi(optarg);
+			break;
+
+		case 'w':
+			opt.warm_up = atoi(optarg);
+			break;
+
+		case 'n':
+			opt.nb_devices = atoi(optarg);
+			break;
+
+		case 'm':
+			opt.mix = optarg;
+			break;
+
+		case 'f':
+			if (::strcmp(optarg,"json") == 0)
+				opt.json = true;
+			else if (::strcmp(optarg,"text") == 0)
+				opt.json = false;
+			else
+				usage(argv[0],target_name);
+			break;
+
+		default:
+			usage(argv[0],target_name);
+		}
+	}
+	if (optind < argc)
+		opt.target = argv[optind];
+	if (opt.duration <= 0 || opt.warm_up < 0 || opt.nb_devices <= 0)
+		usage(argv[0],target_name);
+	if (opt.nb_threads == 0)
+		opt.nb_threads = opt.scenario->nb_threads;
+
+	if (opt.mix != NULL)
+	{
+		if (parse_mix(opt.mix,opt.weights) == false)
+			usage(argv[0],target_name);
+	}
+	else
+	{
+		for (int i = 0;i < CMD_NB;i++)
+			opt.weights[i] = opt.scenario->weights[i];
+	}
+}
+
+//=============================================================================
+//	Run the clients (deleted when done): Nothing is recorded during the
+//	warm up. Return the recording duration (s)
+//=============================================================================
+static double run_clients(std::vector<BenchClient *> &clients,std::atomic<bool> &record,std::atomic<bool> &stop,const BenchOptions &opt)
+{
+	cerr << "Running " << clients.size() << " clients (" << (opt.mix != NULL ? "custom" : opt.scenario->name) << " mix), warm up "
+		 << opt.warm_up << " s, duration " << opt.duration << " s" << std::endl;
+	for (size_t i = 0;i < clients.size();i++)
+		clients[i]->start();
+
+	sleep(opt.warm_up);
+	struct timeval before,after;
+	record = true;
+	gettimeofday(&before,NULL);
+	sleep(opt.duration);
+	record = false;
+	gettimeofday(&after,NULL);
+	stop = true;
+
+	for (size_t i = 0;i < clients.size();i++)
+		clients[i]->join(NULL);
+
+	return (after.tv_sec - before.tv_sec) + (after.tv_usec - before.tv_usec) / 1.0e6;
+}
+
+//=============================================================================
+//	Merge the client results and print them. The engine is only given by
+//	the in-process benchmarks
+//=============================================================================
+static void print_report(const BenchOptions &opt,const char *engine,std::vector<ClientStats> &stats,double elapsed)
+{
+	std::vector<double> all;
+	long all_err = 0;
+	std::stringstream out;
+	out.setf(std::ios::fixed);
+	out.precision(3);
+	const char *scenario_name = opt.mix != NULL ? "custom" : opt.scenario->name;
+
+	if (opt.json == true)
+	{
+		out << "{\n";
+		if (engine != NULL)
+			out << "  \"engine\": \"" << engine << "\",\n";
+		out << "  \"scenario\": \"" << scenario_name << "\",\n";
+		out << "  \"clients\": " << opt.nb_threads << ",\n";
+		out << "  \"devices\": " << opt.nb_devices << ",\n";
+		out << "  \"duration_s\": " << elapsed << ",\n";
+		out << "  \"mix\": {";
+		for (int i = 0;i < CMD_NB;i++)
+			out << (i == 0 ? "" : ", ") << "\"" << cmd_keys[i] << "\": " << opt.weights[i];
+		out << "},\n  \"commands\": {\n";
+	}
+	else
+	{
+		if (engine != NULL)
+			out << "Engine: " << engine << ", scenario: ";
+		else
+			out << "Scenario: ";
+		out << scenario_name << ", clients: " << opt.nb_threads;
+		out << ", devices: " << opt.nb_devices << ", duration: " << elapsed << " s" << std::endl;
+		out << "Command                      calls  errors      calls/s   p50 ms   p90 ms   p99 ms  p99.9 ms   max ms" << std::endl;
+	}
+
+	bool first = true;
+	for (int cmd = 0;cmd <= CMD_NB;cmd++)
+	{
+		std::vector<double> lat;
+		long nb_err = 0;
+		const char *name = "total";
+		if (cmd < CMD_NB)
+		{
+			if (opt.weights[cmd] == 0)
+				continue;
+			for (size_t i = 0;i < stats.size();i++)
+			{
+				lat.insert(lat.end(),stats[i].latencies[cmd].begin(),stats[i].latencies[cmd].end());
+				nb_err += stats[i].nb_err[cmd];
+			}
+			all.insert(all.end(),lat.begin(),lat.end());
+			all_err += nb_err;
+			name = cmd_names[cmd];
+		}
+		else
+		{
+			lat.swap(all);
+			nb_err = all_err;
+		}
+		std::sort(lat.begin(),lat.end());
+
+		double max = lat.empty() == true ? 0.0 : lat.back();
+		if (opt.json == true)
+		{
+			if (cmd == CMD_NB)
+				out << "\n  },\n  \"total\": ";
+			else
+				out << (first == true ? "" : ",\n") << "    \"" << name << "\": ";
+			out << "{\"calls\": " << lat.size() << ", \"errors\": " << nb_err;
+			out << ", \"throughput\": " << lat.size() / elapsed;
+			out << ", \"p50_ms\": " << percentile(lat,50.0) << ", \"p90_ms\": " << percentile(lat,90.0);
+			out << ", \"p99_ms\": " << percentile(lat,99.0) << ", \"p999_ms\": " << percentile(lat,99.9);
+			out << ", \"max_ms\": " << max << "}";
+		}
+		else
+		{
+			out << std::left << std::setw(24) << name << std::right;
+			out << std::setw(11) << lat.size() << std::setw(8) << nb_err << std::setw(13) << lat.size() / elapsed;
+			out << std::setw(9) << percentile(lat,50.0) << std::setw(9) << percentile(lat,90.0);
+			out << std::setw(9) << percentile(lat,99.0) << std::setw(10) << percentile(lat,99.9);
+			out << std::setw(9) << max << std::endl;
+		}
+		first = false;
+	}
+	if (opt.json == true)
+		out << "\n}\n";
+	cout << out.str();
+}
+
+#endif	// _BENCH_COMMON_H
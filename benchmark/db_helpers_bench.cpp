@@ -0,0 +1,325 @@
+//=============================================================================
+//
+// file :        db_helpers_bench.cpp
+//
+// description : Micro-benchmark of the helper functions called for (nearly)
+//               every request (db_helpers.cpp): Name checks, SQL escaping
+//               of names and property values, host:port decoding of an
+//               IOR and splitting of a ds_start result. Each benchmark is
+//               run with a growing number of iterations until it lasts at
+//               least the minimum time, then the time per iteration (and
+//               the throughput when meaningful) is printed, as Google
+//               Benchmark does.
+//
+//               usage: db_helpers_bench [-t min time (s)] [filter]
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+#include <db_helpers.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <iomanip>
+
+using namespace DataBase_ns;
+
+//=========================================================
+/**
+ *	State given to a benchmark function: The number of
+ *	iterations to run and the number of bytes processed
+ *	per iteration (for the throughput)
+ */
+//=========================================================
+class BenchState
+{
+public:
+	BenchState(unsigned long nb):nb_iter(nb),bytes(0) {}
+
+	unsigned long	nb_iter;
+	size_t			bytes;
+};
+
+typedef void (*BenchFunc)(BenchState &);
+
+typedef struct
+{
+	const char	*name;
+	BenchFunc	func;
+} Benchmark;
+
+//
+// Results are accumulated in this sink to prevent the compiler from
+// removing the benchmarked calls
+//
+
+static volatile size_t sink;
+
+//
+// Inputs
+//
+
+static const char *long_dev_name = "tango://ctrl-db-01.esrf.fr:10000/sr/d-mfdbk/horizontal-feedback-controller-01";
+static const char *dfm_dev_name = "sr/d-mfdbk/horizontal-feedback-controller-01";
+static const char *wildcard = "sr/d-mfdbk*/horizontal_feedback_controller*";
+static const char *quoted_name = "sr/d-mfdbk/o'brien \"test\" device";
+
+//
+// IOR of a Tango 9 device (omniORB, IIOP 1.2 profile with the ORB type
+// and code sets components). The host being a FQDN, no name resolution
+// is done
+//
+
+static const char *device_ior =
+	"IOR:010000001700000049444c3a54616e676f2f4465766963655f353a312e30"
+	"000001000000000000006800000001010200150000006374726c2d7372762d30"
+	"34322e657372662e6672000043b00d000000ff000102030405060708090a0b00"
+	"0000020000000000000008000000010000000054544101000000180000000100"
+	"00000100010000000000010001050100000009010100";
+
+//=============================================================================
+//	64 kB property value full of quotes and backslashes (e.g. a script or
+//	a JSON document stored as property)
+//=============================================================================
+static const std::string &quoted_value()
+{
+	static std::string value;
+	if (value.empty() == true)
+	{
+		const char *pattern = "{\"name\": \"it's\", \"path\": \"C:\\\\tango\\\\db\", \"re\": \"\\\\d+\"} ";
+		while (value.size() < 65536)
+			value += pattern;
+		value.resize(65536);
+	}
+	return value;
+}
+
+//=============================================================================
+//	ds_start result of a 200 devices server: The elements separated by '\0'
+//=============================================================================
+static const std::string &ds_start_result()
+{
+	static std::string result;
+	if (result.empty() == true)
+	{
+		std::stringstream ss;
+		ss << "sr/d-mfdbk/bench" << '\0' << "ctrl-srv-042.esrf.fr" << '\0' << "200";
+		for (int i = 0;i < 200;i++)
+		{
+			ss << '\0' << "sr/d-mfdbk/horizontal-feedback-controller-" << i << '\0' << "8";
+			for (int p = 0;p < 8;p++)
+				ss << '\0' << "property_" << p << '\0' << "1" << '\0' << "value of the property " << p;
+		}
+		result = ss.str();
+	}
+	return result;
+}
+
+//=============================================================================
+//	Benchmarks
+//=============================================================================
+static void bm_check_device_name(BenchState &state)
+{
+	for (unsigned long i = 0;i < state.nb_iter;i++)
+	{
+		std::string name(long_dev_name);
+		sink = sink + check_device_name(name);
+	}
+}
+
+static void bm_device_name_to_dfm(BenchState &state)
+{
+	char domain[256],family[256],member[256];
+	for (unsigned long i = 0;i < state.nb_iter;i++)
+	{
+		std::string name(dfm_dev_name);
+		device_name_to_dfm(name,domain,family,member);
+		sink = sink + member[0];
+	}
+}
+
+static void bm_replace_wildcard(BenchState &state)
+{
+	for (unsigned long i = 0;i < state.nb_iter;i++)
+		sink = sink + replace_wildcard(wildcard).size();
+}
+
+static void bm_escape_string_name(BenchState &state)
+{
+	for (unsigned long i = 0;i < state.nb_iter;i++)
+		sink = sink + escape_string(quoted_name).size();
+}
+
+static void bm_escape_string_64k(BenchState &state)
+{
+	const std::string &value = quoted_value();
+	for (unsigned long i = 0;i < state.nb_iter;i++)
+		sink = sink + escape_string(value.c_str()).size();
+	state.bytes = value.size();
+}
+
+static void bm_host_port_from_ior(BenchState &state)
+{
+	std::string h_p;
+	for (unsigned long i = 0;i < state.nb_iter;i++)
+	{
+		host_port_from_ior(device_ior,h_p);
+		sink = sink + h_p.size();
+	}
+	state.bytes = ::strlen(device_ior);
+}
+
+static void bm_count_elts(BenchState &state)
+{
+	const std::string &res = ds_start_result();
+	for (unsigned long i = 0;i < state.nb_iter;i++)
+		sink = sink + count_elts(res.data(),res.size());
+	state.bytes = res.size();
+}
+
+static void bm_split_elts_vector(BenchState &state)
+{
+	const std::string &res = ds_start_result();
+	std::vector<std::string> vs;
+	for (unsigned long i = 0;i < state.nb_iter;i++)
+	{
+		split_elts(res.data(),res.size(),vs);
+		sink = sink + vs.size();
+	}
+	state.bytes = res.size();
+}
+
+static void bm_split_elts_corba(BenchState &state)
+{
+	const std::string &res = ds_start_result();
+	for (unsigned long i = 0;i < state.nb_iter;i++)
+	{
+		Tango::DevVarStringArray argout;
+		split_elts(res.data(),res.size(),argout);
+		sink = sink + argout.length();
+	}
+	state.bytes = res.size();
+}
+
+static const Benchmark benchmarks[] =
+{
+	{"check_device_name/fqdn",				bm_check_device_name},
+	{"device_name_to_dfm",					bm_device_name_to_dfm},
+	{"replace_wildcard",					bm_replace_wildcard},
+	{"escape_string/name",					bm_escape_string_name},
+	{"escape_string/64k_quoted",			bm_escape_string_64k},
+	{"host_port_from_ior",					bm_host_port_from_ior},
+	{"ds_start/count_elts",					bm_count_elts},
+	{"ds_start/split_elts_vector",			bm_split_elts_vector},
+	{"ds_start/split_elts_string_array",	bm_split_elts_corba}
+};
+static const int nb_benchmark = sizeof(benchmarks) / sizeof(Benchmark);
+
+static double now()
+{
+	struct timeval tv;
+	gettimeofday(&tv,NULL);
+	return tv.tv_sec + tv.tv_usec / 1.0e6;
+}
+
+//=============================================================================
+//	Run a benchmark with 1, 10, 100... iterations (the number being then
+//	estimated from the previous run) until it lasts at least min_time
+//=============================================================================
+static void run(const Benchmark &bm,double min_time)
+{
+	unsigned long nb_iter = 1;
+	double elapsed;
+	size_t bytes;
+	while (true)
+	{
+		BenchState state(nb_iter);
+		double start = now();
+		bm.func(state);
+		elapsed = now() - start;
+		bytes = state.bytes;
+
+		if (elapsed >= min_time || nb_iter >= 1000000000UL)
+			break;
+
+		double next = elapsed > 0.0 ? nb_iter * min_time * 1.4 / elapsed : nb_iter * 10.0;
+		if (next > nb_iter * 10.0)
+			next = nb_iter * 10.0;
+		nb_iter = (unsigned long)next + 1;
+	}
+
+	double ns = elapsed * 1.0e9 / nb_iter;
+	cout << std::left << std::setw(36) << bm.name << std::right << std::fixed << std::setprecision(1);
+	cout << std::setw(14) << ns << " ns" << std::setw(12) << nb_iter;
+	if (bytes != 0)
+		cout << std::setw(12) << bytes * nb_iter / elapsed / (1024.0 * 1024.0) << " MB/s";
+	cout << std::endl;
+}
+
+static void usage(const char *prog)
+{
+	cerr << "usage: " << prog << " [-t min time (s)] [filter]" << std::endl;
+	exit(-1);
+}
+
+int main(int argc,char *argv[])
+{
+	double min_time = 0.5;
+
+	int c;
+	while ((c = getopt(argc,argv,"t:")) != -1)
+	{
+		switch (c)
+		{
+		case 't':
+			min_time = atof(optarg);
+			break;
+
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (min_time <= 0.0)
+		usage(argv[0]);
+	const char *filter = optind < argc ? argv[optind] : NULL;
+
+	cout << std::left << std::setw(36) << "Benchmark" << std::right << std::setw(17) << "Time" << std::setw(12) << "Iterations";
+	cout << std::setw(17) << "Throughput" << std::endl;
+	cout << std::string(82,'-') << std::endl;
+
+	for (int i = 0;i < nb_benchmark;i++)
+	{
+		if (filter != NULL && ::strstr(benchmarks[i].name,filter) == NULL)
+			continue;
+		run(benchmarks[i],min_time);
+	}
+
+	return 0;
+}
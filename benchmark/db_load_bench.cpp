@@ -0,0 +1,267 @@
+//=============================================================================
+//
+// file :        db_load_bench.cpp
+//
+// description : Load generator for the database server. Several client
+//               threads run a mix of DbImportDevice, DbGetDeviceProperty,
+//               DbPutDeviceProperty, DbExportDevice and
+//               DbGetDataForServerCache commands on devices created for
+//               the benchmark. The throughput and the latency percentiles
+//               of each command are printed in JSON (or as text).
+//               Scenarios give the mix of typical loads:
+//                 steady  : Running control system (clients importing
+//                           devices and reading properties)
+//                 restart : Control room restart storm (servers exporting
+//                           their devices and reading their data)
+//                 jive    : Jive browsing (property reads and edits)
+//
+//               usage: db_load_bench [-s steady|restart|jive] [-t threads]
+//                                    [-d duration (s)] [-w warm up (s)]
+//                                    [-n devices] [-m mix] [-f json|text]
+//                                    [db_device]
+//
+//               mix: comma separated command=weight list, command being
+//                    import, get_prop, put_prop, export or server_data
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+#include "bench_common.h"
+
+#define	BENCH_SERVER		"DbLoadBench/bench"
+#define	BENCH_CLASS			"DbLoadBench"
+
+//=========================================================
+/**
+ *	Client running the commands through its own
+ *	connection to the database device
+ */
+//=========================================================
+class ClientThread: public BenchClient
+{
+public:
+	ClientThread(const std::string &db_dev,const std::vector<std::string> &devs,const int *w,unsigned int s,
+				 std::atomic<bool> *rec,std::atomic<bool> *stop,ClientStats *st):
+		BenchClient(devs,w,s,rec,stop,st),db_name(db_dev),db(NULL) {}
+
+	~ClientThread() {delete db;}
+
+protected:
+	void init_thread()
+	{
+		db = new Tango::DeviceProxy(db_name);
+	}
+
+	void run_command(BenchCmd cmd,size_t dev,long loop)
+	{
+		const std::string &dev_name = dev_names[dev];
+		Tango::DeviceData din;
+
+		switch (cmd)
+		{
+		case CMD_IMPORT:
+			din << dev_name;
+			db->command_inout("DbImportDevice",din);
+			break;
+
+		case CMD_GET_PROP:
+		{
+			std::vector<std::string> argin;
+			argin.push_back(dev_name);
+			argin.push_back("*");
+			din << argin;
+			db->command_inout("DbGetDeviceProperty",din);
+			break;
+		}
+
+		case CMD_PUT_PROP:
+		{
+			std::stringstream name,val;
+			name << "bench_prop_" << loop % BENCH_NB_PROP;
+			val << loop;
+			std::vector<std::string> argin;
+			argin.push_back(dev_name);
+			argin.push_back("1");
+			argin.push_back(name.str());
+			argin.push_back("1");
+			argin.push_back(val.str());
+			din << argin;
+			db->command_inout("DbPutDeviceProperty",din);
+			break;
+		}
+
+		case CMD_EXPORT:
+		{
+			std::vector<std::string> argin;
+			argin.push_back(dev_name);
+			argin.push_back("IOR:0000");
+			argin.push_back(BENCH_HOST);
+			argin.push_back("1234");
+			argin.push_back("5");
+			din << argin;
+			db->command_inout("DbExportDevice",din);
+			break;
+		}
+
+		case CMD_SERVER_DATA:
+		{
+			std::stringstream ds_name;
+			ds_name << BENCH_SERVER << dev / BENCH_DEV_PER_SERVER;
+			std::vector<std::string> argin;
+			argin.push_back(ds_name.str());
+			argin.push_back(BENCH_HOST);
+			din << argin;
+			db->command_inout("DbGetDataForServerCache",din);
+			break;
+		}
+
+		default:
+			break;
+		}
+	}
+
+	std::string						db_name;
+	Tango::DeviceProxy				*db;
+};
+
+int main(int argc,char *argv[])
+{
+	BenchOptions opt;
+	opt.target = "sys/database/2";
+	parse_options(argc,argv,"db_device",opt);
+
+	std::vector<std::string> dev_names;
+	for (int i = 0;i < opt.nb_devices;i++)
+	{
+		std::stringstream ss;
+		ss << "bench/load/" << i;
+		dev_names.push_back(ss.str());
+	}
+	int nb_servers = (opt.nb_devices + BENCH_DEV_PER_SERVER - 1) / BENCH_DEV_PER_SERVER;
+
+	try
+	{
+		Tango::DeviceProxy db(opt.target);
+
+//
+// Create the servers (BENCH_DEV_PER_SERVER devices each), export their
+// devices and give them some properties
+//
+
+		cerr << "Creating " << opt.nb_devices << " devices in " << nb_servers << " servers" << std::endl;
+		for (int s = 0;s < nb_servers;s++)
+		{
+			std::stringstream ds_name;
+			ds_name << BENCH_SERVER << s;
+			std::vector<std::string> argin;
+			argin.push_back(ds_name.str());
+			for (int i = s * BENCH_DEV_PER_SERVER;i < opt.nb_devices && i < (s + 1) * BENCH_DEV_PER_SERVER;i++)
+			{
+				argin.push_back(dev_names[i]);
+				argin.push_back(BENCH_CLASS);
+			}
+			Tango::DeviceData din;
+			din << argin;
+			db.command_inout("DbAddServer",din);
+		}
+
+		for (int i = 0;i < opt.nb_devices;i++)
+		{
+			std::vector<std::string> exp;
+			exp.push_back(dev_names[i]);
+			exp.push_back("IOR:0000");
+			exp.push_back(BENCH_HOST);
+			exp.push_back("1234");
+			exp.push_back("5");
+			Tango::DeviceData dexp;
+			dexp << exp;
+			db.command_inout("DbExportDevice",dexp);
+
+			std::vector<std::string> prop;
+			std::stringstream nb;
+			nb << BENCH_NB_PROP;
+			prop.push_back(dev_names[i]);
+			prop.push_back(nb.str());
+			for (int p = 0;p < BENCH_NB_PROP;p++)
+			{
+				std::stringstream name;
+				name << "bench_prop_" << p;
+				prop.push_back(name.str());
+				prop.push_back("1");
+				prop.push_back("0");
+			}
+			Tango::DeviceData dprop;
+			dprop << prop;
+			db.command_inout("DbPutDeviceProperty",dprop);
+		}
+
+//
+// Run the clients
+//
+
+		std::atomic<bool> record(false);
+		std::atomic<bool> stop(false);
+		std::vector<ClientStats> stats(opt.nb_threads);
+		std::vector<BenchClient *> threads;
+		for (int i = 0;i < opt.nb_threads;i++)
+			threads.push_back(new ClientThread(opt.target,dev_names,opt.weights,1234 + i,&record,&stop,&stats[i]));
+
+		double elapsed = run_clients(threads,record,stop,opt);
+		print_report(opt,NULL,stats,elapsed);
+
+//
+// Remove what has been created
+//
+
+		for (int i = 0;i < opt.nb_devices;i++)
+		{
+			Tango::DeviceData dd;
+			dd << dev_names[i];
+			db.command_inout("DbDeleteDevice",dd);
+		}
+		for (int s = 0;s < nb_servers;s++)
+		{
+			std::stringstream ds_name;
+			ds_name << BENCH_SERVER << s;
+			std::string server_name(ds_name.str());
+			Tango::DeviceData ds;
+			ds << server_name;
+			db.command_inout("DbDeleteServer",ds);
+		}
+	}
+	catch (Tango::DevFailed &e)
+	{
+		Tango::Except::print_exception(e);
+		return -1;
+	}
+
+	return 0;
+}
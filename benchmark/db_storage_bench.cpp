@@ -0,0 +1,224 @@
+//=============================================================================
+//
+// file :        db_storage_bench.cpp
+//
+// description : In-process benchmark of the SQLite storage engine. Several
+//               client threads call the engine methods behind the
+//               DbImportDevice, DbGetDeviceProperty, DbPutDeviceProperty,
+//               DbExportDevice and DbGetDataForServerCache commands with
+//               the db_load_bench scenarios, on a database file created
+//               for the benchmark. No DB server, MySQL server or network
+//               is involved: The results are a repeatable baseline of the
+//               storage cost of the commands on the local machine.
+//
+//               usage: db_storage_bench [-s steady|restart|jive] [-t threads]
+//                                       [-d duration (s)] [-w warm up (s)]
+//                                       [-n devices] [-m mix] [-f json|text]
+//                                       [database file]
+//
+//               mix: comma separated command=weight list, command being
+//                    import, get_prop, put_prop, export or server_data
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+#include <sqlite_storage.h>
+#include "bench_common.h"
+
+#define	BENCH_SERVER		"DbStorageBench/bench"
+#define	BENCH_CLASS			"DbStorageBench"
+
+using namespace DataBase_ns;
+
+//=========================================================
+/**
+ *	Client calling the engine methods behind the commands
+ */
+//=========================================================
+class ClientThread: public BenchClient
+{
+public:
+	ClientThread(SqliteStorage *st,const std::vector<std::string> &devs,const int *w,unsigned int s,
+				 std::atomic<bool> *rec,std::atomic<bool> *stop,ClientStats *stat):
+		BenchClient(devs,w,s,rec,stop,stat),storage(st) {}
+
+protected:
+	void run_command(BenchCmd cmd,size_t dev,long loop)
+	{
+		const std::string &dev_name = dev_names[dev];
+
+		switch (cmd)
+		{
+		case CMD_IMPORT:
+		{
+			DbDeviceInfo info;
+			storage->import_device(dev_name,info);
+			break;
+		}
+
+		case CMD_GET_PROP:
+		{
+			std::vector<std::string> names(1,"*");
+			std::vector<DbProperty> props;
+			storage->get_device_property(dev_name.c_str(),names,props);
+			break;
+		}
+
+		case CMD_PUT_PROP:
+		{
+			std::stringstream name,val;
+			name << "bench_prop_" << loop % BENCH_NB_PROP;
+			val << loop;
+			std::vector<DbProperty> props(1);
+			props[0].name = name.str();
+			props[0].values.push_back(val.str());
+			storage->put_device_property(dev_name.c_str(),props);
+			break;
+		}
+
+		case CMD_EXPORT:
+			storage->export_device(dev_name,"IOR:0000",BENCH_HOST,"1234","5",NULL);
+			break;
+
+		case CMD_SERVER_DATA:
+		{
+			std::stringstream ds_name;
+			ds_name << BENCH_SERVER << dev / BENCH_DEV_PER_SERVER;
+			ServerData data;
+			storage->get_server_data(ds_name.str().c_str(),BENCH_HOST,data);
+			break;
+		}
+
+		default:
+			break;
+		}
+	}
+
+	SqliteStorage					*storage;
+};
+
+//=============================================================================
+//	Remove the database file and its WAL files
+//=============================================================================
+static void remove_db(const std::string &file)
+{
+	::unlink(file.c_str());
+	::unlink((file + "-wal").c_str());
+	::unlink((file + "-shm").c_str());
+}
+
+int main(int argc,char *argv[])
+{
+	BenchOptions opt;
+	opt.target = "db_storage_bench.db";
+	parse_options(argc,argv,"database file",opt);
+
+	std::vector<std::string> dev_names;
+	for (int i = 0;i < opt.nb_devices;i++)
+	{
+		std::stringstream ss;
+		ss << "bench/storage/" << i;
+		dev_names.push_back(ss.str());
+	}
+	int nb_servers = (opt.nb_devices + BENCH_DEV_PER_SERVER - 1) / BENCH_DEV_PER_SERVER;
+
+//
+// Always start from a new database
+//
+
+	remove_db(opt.target);
+
+	try
+	{
+		SqliteStorage storage(opt.target);
+		storage.open();
+		if (storage.get_journal_mode() != "wal")
+			cerr << opt.target << " not in WAL journal mode (" << storage.get_journal_mode() << ")" << std::endl;
+
+//
+// Create the servers (BENCH_DEV_PER_SERVER devices each), export their
+// devices and give them some properties
+//
+
+		cerr << "Creating " << opt.nb_devices << " devices in " << nb_servers << " servers in " << opt.target << std::endl;
+		for (int s = 0;s < nb_servers;s++)
+		{
+			std::stringstream ds_name;
+			ds_name << BENCH_SERVER << s;
+			std::vector<std::string> devs,classes;
+			for (int i = s * BENCH_DEV_PER_SERVER;i < opt.nb_devices && i < (s + 1) * BENCH_DEV_PER_SERVER;i++)
+			{
+				devs.push_back(dev_names[i]);
+				classes.push_back(BENCH_CLASS);
+			}
+			storage.add_server(ds_name.str(),devs,classes);
+		}
+
+		for (int i = 0;i < opt.nb_devices;i++)
+		{
+			storage.export_device(dev_names[i],"IOR:0000",BENCH_HOST,"1234","5",NULL);
+
+			std::vector<DbProperty> props(BENCH_NB_PROP);
+			for (int p = 0;p < BENCH_NB_PROP;p++)
+			{
+				std::stringstream name;
+				name << "bench_prop_" << p;
+				props[p].name = name.str();
+				props[p].values.push_back("0");
+			}
+			storage.put_device_property(dev_names[i].c_str(),props);
+		}
+
+//
+// Run the clients
+//
+
+		std::atomic<bool> record(false);
+		std::atomic<bool> stop(false);
+		std::vector<ClientStats> stats(opt.nb_threads);
+		std::vector<BenchClient *> threads;
+		for (int i = 0;i < opt.nb_threads;i++)
+			threads.push_back(new ClientThread(&storage,dev_names,opt.weights,1234 + i,&record,&stop,&stats[i]));
+
+		double elapsed = run_clients(threads,record,stop,opt);
+		print_report(opt,storage.get_name(),stats,elapsed);
+	}
+	catch (Tango::DevFailed &e)
+	{
+		Tango::Except::print_exception(e);
+		remove_db(opt.target);
+		return -1;
+	}
+
+	remove_db(opt.target);
+	return 0;
+}
@@ -0,0 +1,280 @@
+//=============================================================================
+//
+// file :        db_writer_bench.cpp
+//
+// description : Benchmark measuring the database server throughput with
+//               several clients concurrently modifying the database.
+//               Each writer thread works on its own device and loops
+//               on the DbExportDevice and/or DbPutDeviceProperty
+//               commands. Run it once with the MyISAM tables (table
+//               locks) and once after update_db_to_innodb.sql has been
+//               executed (transactions) to compare both configurations.
+//
+//               usage: db_writer_bench [-t threads] [-d duration (s)]
+//                                      [-c export|put|mixed] [db_device]
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+#include <tango.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+
+#define	BENCH_SERVER	"DbWriterBench/bench"
+#define	BENCH_CLASS		"DbWriterBench"
+
+enum BenchCmd {BENCH_EXPORT, BENCH_PUT, BENCH_MIXED};
+
+typedef struct
+{
+	long	nb_ok;
+	long	nb_err;
+} WriterStats;
+
+//=========================================================
+/**
+ *	One writer thread, looping on the requested command(s)
+ *	for its own device until the stop flag is set
+ */
+//=========================================================
+class WriterThread: public omni_thread
+{
+public:
+	WriterThread(const std::string &db_dev,const std::string &dev,BenchCmd c,std::atomic<bool> *stop,WriterStats *st):
+		db_name(db_dev),dev_name(dev),cmd(c),stop_flag(stop),stats(st) {}
+
+	void *run_undetached(void *)
+	{
+		Tango::DeviceProxy db(db_name);
+		long loop = 0;
+
+		while (*stop_flag == false)
+		{
+			try
+			{
+				if (cmd == BENCH_EXPORT || (cmd == BENCH_MIXED && (loop & 1) == 0))
+					export_device(db);
+				else
+					put_property(db,loop);
+				stats->nb_ok++;
+			}
+			catch (Tango::DevFailed &e)
+			{
+				if (stats->nb_err == 0)
+					Tango::Except::print_exception(e);
+				stats->nb_err++;
+			}
+			loop++;
+		}
+		return NULL;
+	}
+
+	void start() {start_undetached();}
+
+private:
+	void export_device(Tango::DeviceProxy &db)
+	{
+		Tango::DevVarStringArray *argin = new Tango::DevVarStringArray();
+		argin->length(5);
+		(*argin)[0] = CORBA::string_dup(dev_name.c_str());
+		(*argin)[1] = CORBA::string_dup("IOR:0000");
+		(*argin)[2] = CORBA::string_dup("bench_host");
+		(*argin)[3] = CORBA::string_dup("1234");
+		(*argin)[4] = CORBA::string_dup("5");
+
+		Tango::DeviceData din;
+		din << argin;
+		db.command_inout("DbExportDevice",din);
+	}
+
+	void put_property(Tango::DeviceProxy &db,long loop)
+	{
+		std::stringstream ss;
+		ss << loop;
+
+		Tango::DevVarStringArray *argin = new Tango::DevVarStringArray();
+		argin->length(5);
+		(*argin)[0] = CORBA::string_dup(dev_name.c_str());
+		(*argin)[1] = CORBA::string_dup("1");
+		(*argin)[2] = CORBA::string_dup("bench_prop");
+		(*argin)[3] = CORBA::string_dup("1");
+		(*argin)[4] = CORBA::string_dup(ss.str().c_str());
+
+		Tango::DeviceData din;
+		din << argin;
+		db.command_inout("DbPutDeviceProperty",din);
+	}
+
+	std::string		db_name;
+	std::string		dev_name;
+	BenchCmd		cmd;
+	std::atomic<bool>	*stop_flag;
+	WriterStats		*stats;
+};
+
+static void usage(const char *prog)
+{
+	cerr << "usage: " << prog << " [-t threads] [-d duration (s)] [-c export|put|mixed] [db_device]" << std::endl;
+	exit(-1);
+}
+
+int main(int argc,char *argv[])
+{
+	int nb_threads = 8;
+	int duration = 10;
+	BenchCmd cmd = BENCH_MIXED;
+	std::string db_dev("sys/database/2");
+
+	int c;
+	while ((c = getopt(argc,argv,"t:d:c:")) != -1)
+	{
+		switch (c)
+		{
+		case 't':
+			nb_threads = atoi(optarg);
+			break;
+
+		case 'd':
+			duration = atoi(optarg);
+			break;
+
+		case 'c':
+			if (::strcmp(optarg,"export") == 0)
+				cmd = BENCH_EXPORT;
+			else if (::strcmp(optarg,"put") == 0)
+				cmd = BENCH_PUT;
+			else if (::strcmp(optarg,"mixed") == 0)
+				cmd = BENCH_MIXED;
+			else
+				usage(argv[0]);
+			break;
+
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind < argc)
+		db_dev = argv[optind];
+	if (nb_threads <= 0 || duration <= 0)
+		usage(argv[0]);
+
+	std::vector<std::string> dev_names;
+	for (int i = 0;i < nb_threads;i++)
+	{
+		std::stringstream ss;
+		ss << "bench/writer/" << i;
+		dev_names.push_back(ss.str());
+	}
+
+	try
+	{
+		Tango::DeviceProxy db(db_dev);
+
+//
+// Create one device per writer thread
+//
+
+		Tango::DevVarStringArray *argin = new Tango::DevVarStringArray();
+		argin->length(1 + 2 * nb_threads);
+		(*argin)[0] = CORBA::string_dup(BENCH_SERVER);
+		for (int i = 0;i < nb_threads;i++)
+		{
+			(*argin)[1 + 2 * i] = CORBA::string_dup(dev_names[i].c_str());
+			(*argin)[2 + 2 * i] = CORBA::string_dup(BENCH_CLASS);
+		}
+		Tango::DeviceData din;
+		din << argin;
+		db.command_inout("DbAddServer",din);
+
+//
+// Run the writers
+//
+
+		std::atomic<bool> stop(false);
+		std::vector<WriterStats> stats(nb_threads);
+		std::vector<WriterThread *> threads;
+		for (int i = 0;i < nb_threads;i++)
+		{
+			stats[i].nb_ok = 0;
+			stats[i].nb_err = 0;
+			threads.push_back(new WriterThread(db_dev,dev_names[i],cmd,&stop,&stats[i]));
+		}
+
+		struct timeval before,after;
+		gettimeofday(&before,NULL);
+		for (int i = 0;i < nb_threads;i++)
+			threads[i]->start();
+
+		sleep(duration);
+		stop = true;
+
+		for (int i = 0;i < nb_threads;i++)
+			threads[i]->join(NULL);
+		gettimeofday(&after,NULL);
+
+		long nb_ok = 0;
+		long nb_err = 0;
+		for (int i = 0;i < nb_threads;i++)
+		{
+			nb_ok += stats[i].nb_ok;
+			nb_err += stats[i].nb_err;
+		}
+
+		double elapsed = (after.tv_sec - before.tv_sec) + (after.tv_usec - before.tv_usec) / 1.0e6;
+
+		cout << "Writers: " << nb_threads << ", elapsed: " << elapsed << " s" << std::endl;
+		cout << "Commands: " << nb_ok << " (errors: " << nb_err << ")" << std::endl;
+		cout << "Throughput: " << nb_ok / elapsed << " commands/s" << std::endl;
+
+//
+// Remove what has been created
+//
+
+		for (int i = 0;i < nb_threads;i++)
+		{
+			Tango::DeviceData dd;
+			dd << dev_names[i];
+			db.command_inout("DbDeleteDevice",dd);
+		}
+		std::string server_name(BENCH_SERVER);
+		Tango::DeviceData ds;
+		ds << server_name;
+		db.command_inout("DbDeleteServer",ds);
+	}
+	catch (Tango::DevFailed &e)
+	{
+		Tango::Except::print_exception(e);
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,189 @@
+//=============================================================================
+//
+// file :        ds_start_decode.cpp
+//
+// description : Reference decoder of the DbGetDataForServerCacheCompressed
+//               command reply. The data of a server are read with the
+//               DbGetDataForServerCache and DbGetDataForServerCacheCompressed
+//               commands, the compressed data are decoded and compared.
+//               The sizes and the command durations of both are printed.
+//
+//               usage: ds_start_decode [-n loops] ds_name host [db_device]
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+#include <tango.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <zlib.h>
+
+//=============================================================================
+//	Decode a "ds_start_zlib" DevEncoded: The uncompressed size (4 bytes, big
+//	endian) followed by the zlib stream of the elements separated by NUL
+//	characters
+//=============================================================================
+static void decode_ds_start(const Tango::DevEncoded &enc,std::vector<std::string> &data)
+{
+	if (::strcmp(enc.encoded_format.in(),"ds_start_zlib") != 0)
+	{
+		Tango::Except::throw_exception((const char *)"API_WrongFormat",
+					(const char *)"The encoded format is not ds_start_zlib",
+					(const char *)"decode_ds_start()");
+	}
+
+	unsigned long enc_len = enc.encoded_data.length();
+	const unsigned char *enc_buf = enc.encoded_data.get_buffer();
+	if (enc_len < 4)
+	{
+		Tango::Except::throw_exception((const char *)"API_WrongFormat",
+					(const char *)"The encoded data are too short",
+					(const char *)"decode_ds_start()");
+	}
+
+	uLongf len = ((uLongf)enc_buf[0] << 24) | ((uLongf)enc_buf[1] << 16) | ((uLongf)enc_buf[2] << 8) | enc_buf[3];
+	std::vector<char> buf(len + 1);
+	uLongf dest_len = len;
+	int ret = uncompress((Bytef *)&buf[0],&dest_len,enc_buf + 4,enc_len - 4);
+	if (ret != Z_OK || dest_len != len)
+	{
+		TangoSys_OMemStream o;
+		o << "zlib decompression failed (error " << ret << ")" << std::ends;
+		Tango::Except::throw_exception((const char *)"API_WrongFormat",o.str(),
+					(const char *)"decode_ds_start()");
+	}
+
+	data.clear();
+	const char *start = &buf[0];
+	const char *end = start + len;
+	const char *ptr;
+	while ((ptr = (const char *)::memchr(start,'\0',end - start)) != NULL)
+	{
+		data.push_back(std::string(start,ptr - start));
+		start = ptr + 1;
+	}
+	data.push_back(std::string(start,end - start));
+}
+
+static double elapsed(struct timeval &before,struct timeval &after)
+{
+	return (after.tv_sec - before.tv_sec) + (after.tv_usec - before.tv_usec) / 1.0e6;
+}
+
+static void usage(const char *prog)
+{
+	cerr << "usage: " << prog << " [-n loops] ds_name host [db_device]" << std::endl;
+	exit(-1);
+}
+
+int main(int argc,char *argv[])
+{
+	int nb_loops = 10;
+	std::string db_dev("sys/database/2");
+
+	int c;
+	while ((c = getopt(argc,argv,"n:")) != -1)
+	{
+		switch (c)
+		{
+		case 'n':
+			nb_loops = atoi(optarg);
+			break;
+
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (argc - optind < 2 || nb_loops <= 0)
+		usage(argv[0]);
+	if (argc - optind > 2)
+		db_dev = argv[optind + 2];
+
+	try
+	{
+		Tango::DeviceProxy db(db_dev);
+
+		std::vector<std::string> server;
+		server.push_back(argv[optind]);
+		server.push_back(argv[optind + 1]);
+		Tango::DeviceData din;
+		din << server;
+
+		struct timeval before,after;
+		std::vector<std::string> data;
+		unsigned long data_size = 0;
+
+		gettimeofday(&before,NULL);
+		for (int i = 0;i < nb_loops;i++)
+		{
+			Tango::DeviceData dout = db.command_inout("DbGetDataForServerCache",din);
+			dout >> data;
+		}
+		gettimeofday(&after,NULL);
+		double str_time = elapsed(before,after) / nb_loops;
+
+		for (size_t i = 0;i < data.size();i++)
+			data_size = data_size + data[i].size() + 1;
+
+		std::vector<std::string> decoded;
+		unsigned long enc_size = 0;
+
+		gettimeofday(&before,NULL);
+		for (int i = 0;i < nb_loops;i++)
+		{
+			Tango::DeviceData dout = db.command_inout("DbGetDataForServerCacheCompressed",din);
+			const Tango::DevEncoded *enc;
+			dout >> enc;
+			enc_size = enc->encoded_data.length();
+			decode_ds_start(*enc,decoded);
+		}
+		gettimeofday(&after,NULL);
+		double enc_time = elapsed(before,after) / nb_loops;
+
+		cout << "Elements: " << data.size() << ", " << data_size << " bytes" << std::endl;
+		cout << "DbGetDataForServerCache: " << str_time * 1000.0 << " ms" << std::endl;
+		cout << "DbGetDataForServerCacheCompressed: " << enc_size << " bytes, " << enc_time * 1000.0 << " ms (decoding included)" << std::endl;
+
+		if (decoded != data)
+		{
+			cerr << "Decoded data differ from the DbGetDataForServerCache data!" << std::endl;
+			return -1;
+		}
+		cout << "Decoded data are identical" << std::endl;
+	}
+	catch (Tango::DevFailed &e)
+	{
+		Tango::Except::print_exception(e);
+		return -1;
+	}
+
+	return 0;
+}
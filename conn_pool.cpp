@@ -0,0 +1,417 @@
+//=============================================================================
+//
+// file :        conn_pool.cpp
+//
+// description : Class managing which MySQL connections of the pool are
+//               free and the clients waiting for one, and thread
+//               opening/closing the connections.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+#include <DataBase.h>
+
+namespace DataBase_ns
+{
+
+static const char *wait_histo_labels[POOL_WAIT_HISTO_SIZE] =
+{
+	"<10us",
+	"<100us",
+	"<1ms",
+	"<10ms",
+	"<100ms",
+	"<1s",
+	">=1s",
+	"timeout"
+};
+
+//=============================================================================
+//=============================================================================
+ConnPool::ConnPool():timeout(DEFAULT_POOL_ACQUIRE_TIMEOUT),idle_timeout(DEFAULT_POOL_IDLE_TIMEOUT),
+					 min_size(1),max_size(0),nb_in_use(0),nb_open(0),nb_opening(0),
+					 stopped(false),work_cond(this),wait_sum(0.0)
+{
+	for (int i = 0;i < POOL_WAIT_HISTO_SIZE;i++)
+		wait_histo[i] = 0.0;
+}
+//=============================================================================
+//	Declare the connections [0 - nb_opened[ as opened and free. The
+//	others (up to max_conn) are closed
+//=============================================================================
+void ConnPool::init(int nb_opened,int max_conn)
+{
+	omni_mutex_lock sync(*this);
+
+	free_list.clear();
+	closed_list.clear();
+	last_release.assign(max_conn,time(NULL));
+	for (int i = nb_opened - 1;i >= 0;i--)
+		free_list.push_back(i);
+	for (int i = max_conn - 1;i >= nb_opened;i--)
+		closed_list.push_back(i);
+
+	max_size = max_conn;
+	nb_open = nb_opened;
+	nb_opening = 0;
+	nb_in_use = 0;
+	stopped = false;
+}
+//=============================================================================
+//=============================================================================
+void ConnPool::set_min_size(int nb)
+{
+	omni_mutex_lock sync(*this);
+	min_size = nb;
+	work_cond.signal();
+}
+//=============================================================================
+//=============================================================================
+int ConnPool::acquire()
+{
+	unsigned long start_s,start_ns;
+	omni_thread::get_time(&start_s,&start_ns);
+
+	omni_mutex_lock sync(*this);
+
+//
+// The most recently released connection is re-used first
+//
+
+	if (free_list.empty() == false)
+	{
+		int con_nb = free_list.back();
+		free_list.pop_back();
+		nb_in_use++;
+		record_wait(start_s,start_ns,false);
+		return con_nb;
+	}
+
+//
+// No free connection, queue this caller. The connection index is set
+// in the waiter structure by release() or opened(). Ask the maintainer
+// thread for one more connection
+//
+
+	PoolWaiter w(this);
+	waiters.push_back(&w);
+	work_cond.signal();
+
+	if (timeout > 0)
+	{
+		unsigned long abs_s,abs_ns;
+		omni_thread::get_time(&abs_s,&abs_ns,timeout / 1000,(timeout % 1000) * 1000000);
+		while (w.con_nb == -1)
+		{
+			if (w.cond.timedwait(abs_s,abs_ns) == 0)
+				break;
+		}
+	}
+	else
+	{
+		while (w.con_nb == -1)
+			w.cond.wait();
+	}
+
+	if (w.con_nb == -1)
+	{
+		std::deque<PoolWaiter *>::iterator pos = std::find(waiters.begin(),waiters.end(),&w);
+		if (pos != waiters.end())
+			waiters.erase(pos);
+		record_wait(start_s,start_ns,true);
+		return -1;
+	}
+
+	record_wait(start_s,start_ns,false);
+	return w.con_nb;
+}
+//=============================================================================
+//	Get a free connection index without waiting. Return -1 if none is free
+//=============================================================================
+int ConnPool::try_acquire()
+{
+	omni_mutex_lock sync(*this);
+
+	if (free_list.empty() == true)
+		return -1;
+
+	int con_nb = free_list.back();
+	free_list.pop_back();
+	nb_in_use++;
+	return con_nb;
+}
+//=============================================================================
+//	Give the connection to the oldest waiter. The number of connections
+//	in use is unchanged in this case
+//=============================================================================
+void ConnPool::release(int con_nb)
+{
+	omni_mutex_lock sync(*this);
+
+	if (waiters.empty() == false)
+	{
+		PoolWaiter *w = waiters.front();
+		waiters.pop_front();
+		w->con_nb = con_nb;
+		w->cond.signal();
+	}
+	else
+	{
+		nb_in_use--;
+		give_free(con_nb);
+	}
+}
+//=============================================================================
+//=============================================================================
+long ConnPool::get_nb_in_use()
+{
+	omni_mutex_lock sync(*this);
+	return nb_in_use;
+}
+//=============================================================================
+//=============================================================================
+long ConnPool::get_nb_waiters()
+{
+	omni_mutex_lock sync(*this);
+	return (long)waiters.size();
+}
+//=============================================================================
+//=============================================================================
+long ConnPool::get_nb_open()
+{
+	omni_mutex_lock sync(*this);
+	return nb_open;
+}
+//=============================================================================
+//	Copy the histogram in the caller buffer (POOL_WAIT_HISTO_SIZE elements)
+//=============================================================================
+void ConnPool::get_wait_histo(Tango::DevDouble *histo)
+{
+	omni_mutex_lock sync(*this);
+	for (int i = 0;i < POOL_WAIT_HISTO_SIZE;i++)
+		histo[i] = wait_histo[i];
+}
+//=============================================================================
+//=============================================================================
+double ConnPool::get_wait_sum()
+{
+	omni_mutex_lock sync(*this);
+	return wait_sum;
+}
+//=============================================================================
+//=============================================================================
+const char *ConnPool::get_wait_histo_label(int i)
+{
+	return wait_histo_labels[i];
+}
+//=============================================================================
+//	Return a closed slot if the pool is below its minimum size or if
+//	there are more waiters than connections being opened, -1 otherwise
+//=============================================================================
+int ConnPool::take_slot_to_open()
+{
+	omni_mutex_lock sync(*this);
+
+	if (stopped == true || closed_list.empty() == true)
+		return -1;
+
+	if (nb_open + nb_opening >= min_size && (long)waiters.size() <= nb_opening)
+		return -1;
+
+	int con_nb = closed_list.back();
+	closed_list.pop_back();
+	nb_opening++;
+	return con_nb;
+}
+//=============================================================================
+//=============================================================================
+void ConnPool::opened(int con_nb,bool success)
+{
+	omni_mutex_lock sync(*this);
+
+	nb_opening--;
+	if (success == false)
+	{
+		closed_list.push_back(con_nb);
+		return;
+	}
+
+	nb_open++;
+	if (waiters.empty() == false)
+	{
+		PoolWaiter *w = waiters.front();
+		waiters.pop_front();
+		w->con_nb = con_nb;
+		w->cond.signal();
+		nb_in_use++;
+	}
+	else
+		give_free(con_nb);
+}
+//=============================================================================
+//	Return the least recently used free connection if it is unused since
+//	more than the idle timeout and if the pool is above its minimum size,
+//	-1 otherwise
+//=============================================================================
+int ConnPool::take_idle_slot()
+{
+	omni_mutex_lock sync(*this);
+
+	if (stopped == true || idle_timeout <= 0 || nb_open <= min_size || free_list.empty() == true)
+		return -1;
+
+	int con_nb = free_list.front();
+	if (time(NULL) - last_release[con_nb] < idle_timeout)
+		return -1;
+
+	free_list.erase(free_list.begin());
+	nb_open--;
+	return con_nb;
+}
+//=============================================================================
+//=============================================================================
+void ConnPool::closed(int con_nb)
+{
+	omni_mutex_lock sync(*this);
+	closed_list.push_back(con_nb);
+}
+//=============================================================================
+//	Wait until a waiter needs a connection, a configuration change or
+//	the timeout (ms)
+//=============================================================================
+void ConnPool::wait_for_work(long ms)
+{
+	omni_mutex_lock sync(*this);
+
+	if (stopped == true)
+		return;
+
+	unsigned long abs_s,abs_ns;
+	omni_thread::get_time(&abs_s,&abs_ns,ms / 1000,(ms % 1000) * 1000000);
+	work_cond.timedwait(abs_s,abs_ns);
+}
+//=============================================================================
+//=============================================================================
+void ConnPool::stop()
+{
+	omni_mutex_lock sync(*this);
+	stopped = true;
+	work_cond.signal();
+}
+//=============================================================================
+//=============================================================================
+bool ConnPool::is_stopped()
+{
+	omni_mutex_lock sync(*this);
+	return stopped;
+}
+//=============================================================================
+//	Must be called with the pool mutex locked
+//=============================================================================
+void ConnPool::give_free(int con_nb)
+{
+	free_list.push_back(con_nb);
+	last_release[con_nb] = time(NULL);
+}
+//=============================================================================
+//	Must be called with the pool mutex locked
+//=============================================================================
+void ConnPool::record_wait(unsigned long start_s,unsigned long start_ns,bool timed_out)
+{
+	if (timed_out == true)
+	{
+		wait_histo[POOL_WAIT_HISTO_SIZE - 1]++;
+		return;
+	}
+
+	unsigned long now_s,now_ns;
+	omni_thread::get_time(&now_s,&now_ns);
+	double wait_us = (double)(now_s - start_s) * 1.0e6 + ((double)now_ns - (double)start_ns) / 1.0e3;
+
+	int bucket = 0;
+	double limit = 10.0;
+	while (bucket < POOL_WAIT_HISTO_SIZE - 2 && wait_us >= limit)
+	{
+		bucket++;
+		limit = limit * 10.0;
+	}
+	wait_histo[bucket]++;
+	wait_sum = wait_sum + wait_us / 1.0e6;
+}
+
+
+//=============================================================================
+//=============================================================================
+PoolMaintainer::PoolMaintainer(DataBase *db,ConnPool *p):the_db(db),pool(p)
+{
+}
+//=============================================================================
+//=============================================================================
+void *PoolMaintainer::run_undetached(TANGO_UNUSED(void *ptr))
+{
+	mysql_thread_init();
+
+	while (pool->is_stopped() == false)
+	{
+		int con_nb;
+
+//
+// Open connections as long as needed. Stop at the first failure,
+// it will be retried at next loop
+//
+
+		while ((con_nb = pool->take_slot_to_open()) != -1)
+		{
+			bool success = the_db->open_connection(con_nb);
+			pool->opened(con_nb,success);
+			if (success == false)
+				break;
+		}
+
+//
+// Close idle connections
+//
+
+		while ((con_nb = pool->take_idle_slot()) != -1)
+		{
+			the_db->close_connection(con_nb);
+			pool->closed(con_nb);
+		}
+
+		pool->wait_for_work(POOL_MAINTAINER_PERIOD);
+	}
+
+	mysql_thread_end();
+	return NULL;
+}
+
+}	//	namespace
@@ -0,0 +1,159 @@
+//=============================================================================
+//
+// file :        conn_pool.h
+//
+// description : Include for the class managing which MySQL connections
+//               of the pool are free and the clients waiting for one,
+//               and for the thread opening/closing the connections.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _CONN_POOL_H
+#define _CONN_POOL_H
+
+#include <tango.h>
+#include <deque>
+
+#define	DEFAULT_POOL_ACQUIRE_TIMEOUT	3000		// ms
+#define	DEFAULT_POOL_MIN_SIZE			4
+#define	DEFAULT_POOL_IDLE_TIMEOUT		300			// s
+#define	POOL_MAINTAINER_PERIOD			1000		// ms
+#define	POOL_WAIT_HISTO_SIZE			8
+
+namespace DataBase_ns {
+
+class DataBase;
+
+//=========================================================
+/**
+ *	Free list and FIFO wait queue of the MySQL connection pool.
+ *
+ *	Connections are identified by their index in the pool.
+ *	When no connection is free, the caller is queued and a released
+ *	connection is directly given to the oldest waiter.
+ *	The pool is elastic: Only some connections are opened. The
+ *	PoolMaintainer thread opens connections up to the minimum size,
+ *	opens more (up to the maximum size) when requests have to wait
+ *	and closes the ones which stayed unused longer than the idle
+ *	timeout (keeping the minimum size).
+ *	The time spent to get a connection is recorded in a histogram
+ *	(bucket upper limits: 10 us, 100 us, 1 ms, 10 ms, 100 ms, 1 s,
+ *	above). The last bucket counts the acquisitions which timed out.
+ */
+//=========================================================
+class ConnPool: public omni_mutex
+{
+public:
+	ConnPool();
+
+	void init(int,int);
+	void set_timeout(long ms) {omni_mutex_lock sync(*this);timeout = ms;}
+	long get_timeout() {return timeout;}
+	void set_min_size(int);
+	void set_idle_timeout(long s) {omni_mutex_lock sync(*this);idle_timeout = s;}
+
+/**
+ *	Get a free connection index. Wait for one (at most the acquire
+ *	timeout, for ever if the timeout is 0). Return -1 on timeout
+ */
+	int acquire();
+	int try_acquire();
+	void release(int);
+
+	long get_nb_in_use();
+	long get_nb_waiters();
+	long get_nb_open();
+	void get_wait_histo(Tango::DevDouble *);
+	double get_wait_sum();
+	static const char *get_wait_histo_label(int);
+
+/**
+ *	Methods used by the PoolMaintainer thread. A slot to open (or
+ *	an idle connection to close) is removed from the pool until
+ *	opened() (or closed()) is called
+ */
+	int take_slot_to_open();
+	void opened(int,bool);
+	int take_idle_slot();
+	void closed(int);
+	void wait_for_work(long);
+	void stop();
+	bool is_stopped();
+
+private:
+	struct PoolWaiter
+	{
+		PoolWaiter(omni_mutex *m):cond(m),con_nb(-1) {}
+		omni_condition	cond;
+		int				con_nb;
+	};
+
+	void record_wait(unsigned long,unsigned long,bool);
+	void give_free(int);
+
+	long						timeout;
+	long						idle_timeout;
+	int							min_size;
+	int							max_size;
+	long						nb_in_use;
+	long						nb_open;
+	long						nb_opening;
+	bool						stopped;
+	std::vector<int>			free_list;
+	std::vector<int>			closed_list;
+	std::vector<time_t>			last_release;
+	std::deque<PoolWaiter *>	waiters;
+	omni_condition				work_cond;
+	Tango::DevDouble			wait_histo[POOL_WAIT_HISTO_SIZE];
+	double						wait_sum;		// Seconds, connections got in time
+};
+
+//=========================================================
+/**
+ *	Thread opening and closing the pool MySQL connections
+ */
+//=========================================================
+class PoolMaintainer: public omni_thread
+{
+public:
+	PoolMaintainer(DataBase *,ConnPool *);
+
+	void *run_undetached(void *);
+	void start() {start_undetached();}
+
+private:
+	DataBase	*the_db;
+	ConnPool	*pool;
+};
+
+}	//	namespace
+
+#endif	// _CONN_POOL_H
@@ -0,0 +1,563 @@
+//=============================================================================
+//
+// file :        db_helpers.cpp
+//
+// description : Helper functions used by the commands which do not depend
+//               on the DataBase object. They are called for (nearly)
+//               every request and are also built in the micro-benchmark
+//               (benchmark/db_helpers_bench.cpp).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+#include <db_helpers.h>
+
+#ifdef _TG_WINDOWS_
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#endif
+
+using namespace std;
+
+namespace DataBase_ns {
+
+//+----------------------------------------------------------------------------
+//
+// function : 		replace_wildcard(char *wildcard_c_str)
+//
+// description : 	utility method to replace all occurrences of
+//			wildcards (*) with SQL wildcards % and to escape
+//			all occurrences	of '%' and '_' with '\'
+//
+// in :			string **wildcard_c_str - wildcard C string
+//
+// out :		void - nothing
+//
+//-----------------------------------------------------------------------------
+std::string replace_wildcard(const char *wildcard_c_str)
+{
+	std::string wildcard(wildcard_c_str);
+	std::string::size_type index;
+
+// escape %
+
+	index = 0;
+	while ((index = wildcard.find('%',index)) != std::string::npos)
+	{
+		wildcard.insert(index, 1, '\\');
+		index = index+2;
+	}
+
+// escape _
+
+	index = 0;
+	while ((index = wildcard.find('_',index)) != std::string::npos)
+	{
+		wildcard.insert(index, 1, '\\');
+		index = index+2;
+	}
+
+
+// escape "
+
+	index = 0;
+	while ((index = wildcard.find('"',index)) != std::string::npos)
+	{
+		wildcard.insert(index, 1, '\\');
+		index = index+2;
+	}
+
+
+// escape '
+
+	index = 0;
+	while ((index = wildcard.find('\'',index)) != std::string::npos)
+	{
+		wildcard.insert(index, 1, '\\');
+		index = index+2;
+	}
+
+// replace wildcard * with %
+
+	while ((index = wildcard.find('*')) != std::string::npos)
+	{
+		wildcard.replace(index, 1, 1, '%');
+	}
+
+	return wildcard;
+}
+
+//+----------------------------------------------------------------------------
+//
+// function : 		escape_string(char *string_c_str)
+//
+// description : 	utility method to escape all occurrences
+//			of ' and " with '\'
+//
+// in :			const char *string_c_str -  C string to be modified.
+//
+// out :		string - The result string .
+//
+//-----------------------------------------------------------------------------
+std::string escape_string(const char *string_c_str)
+{
+	std::string escaped_string(string_c_str);
+	std::string::size_type index;
+
+
+	//	escape bakckslash
+	index = 0;
+	while ((index = escaped_string.find('\\',index)) != std::string::npos)
+	{
+		//	Check if double backslash already treated by client
+		std::string	s = escaped_string.substr(index+1);
+
+			//	Check if another escape sequence treated by client
+		if (s.find('\"')==0 || s.find('\'')==0)
+			index++;
+		else
+		{
+			escaped_string.insert(index, 1, '\\');
+			index += 2;
+		}
+	}
+
+	//	escape "
+	index = 0;
+	while ((index = escaped_string.find('"',index)) != std::string::npos)
+	{
+		if (index==0)	//	Cannot have '\' at -1 !
+		{
+			escaped_string.insert(index, 1, '\\');
+			index += 2;
+		}
+		else
+		{
+			//	Check if double quotes already treated by client
+			std::string	s = escaped_string.substr(index-1);
+			if (s.find('\\')==0)
+				index++;
+			else
+			{
+				escaped_string.insert(index, 1, '\\');
+				index += 2;
+			}
+		}
+	}
+
+
+	//	escape '
+	index = 0;
+	while ((index = escaped_string.find('\'',index)) != std::string::npos)
+	{
+		if (index==0)	//	Cannot have '\' at -1 !
+		{
+			escaped_string.insert(index, 1, '\\');
+			index += 2;
+		}
+		else
+		{
+			//	Check if simple quotes already treated by client
+			std::string	s = escaped_string.substr(index-1);
+			if (s.find('\\')==0)
+				index++;
+			else
+			{
+				escaped_string.insert(index, 1, '\\');
+				index += 2;
+			}
+		}
+	}
+
+	return escaped_string;
+}
+
+//+----------------------------------------------------------------------------
+//
+// function : 		device_name_to_dfm(std::string &device_name,
+//			          char **domain, char **family, char **member)
+//
+// description : 	utility function to return domain, family and member
+//			from device name. Assumes device name has (optional)
+//			protocol and instance stripped off i.e. conforms
+//			to domain/family/member
+//
+// in :			char *devname - device name
+//
+// out :		bool - true or false
+//
+//-----------------------------------------------------------------------------
+bool device_name_to_dfm(std::string &devname, char domain[], char family[], char member[])
+{
+	std::string::size_type index, index2;
+
+
+	index = devname.find('/');
+	index2 = devname.find('/', index+1);
+
+	(devname.substr(0,index)).copy(domain,index);
+	domain[index] = '\0';
+
+	(devname.substr(index+1,index2-index)).copy(family,index2-index);
+	family[index2-index-1] = '\0';
+
+	(devname.substr(index2+1)).copy(member,devname.length()-index2);
+	member[devname.length()-index2-1] = '\0';
+
+
+	return true;
+}
+
+//+----------------------------------------------------------------------------
+//
+// function : 		check_device_name(std::string *device_name)
+//
+// description : 	utility function to check whether device name conforms
+//			to the TANGO naming convention of
+//
+//			[tango!taco:][//instance/]domain/family/member
+//
+// in :			string *device_name - device name
+//
+// out :		bool - true or false
+//
+//-----------------------------------------------------------------------------
+bool check_device_name(std::string &device_name_str)
+{
+	std::string devname(device_name_str);
+	std::string::size_type index, index2;
+
+
+// check there are no special characters which could be interpreted
+// as wildcards or which are otherwise excluded
+
+	if (devname.find('*') != std::string::npos) return false;
+
+// check protocol - "tango:" | "taco:"
+
+	if (devname.substr(0,6) == "tango:")
+	{
+		devname.erase(0,6);
+	}
+	else
+	{
+		if (devname.substr(0,5) == "taco:")
+		{
+			devname.erase(0,5);
+		}
+	}
+
+// check instance - "//instance/"
+
+	if (devname.substr(0,2) == "//")
+	{
+		index = devname.find('/',(string::size_type)2);
+		if (index == 0 || index == std::string::npos)
+		{
+			return false;
+
+		}
+		devname.erase(0,index+1);
+	}
+
+// check name conforms to "D/F/M"
+
+	index = devname.find('/');
+	index2 = devname.find('/',index+1);
+
+	if (index == 0 || index == std::string::npos || index2 == std::string::npos ||
+	    index2-index <= 0 || devname.length() - index2 <= 0)
+	{
+		return false;
+	}
+
+	device_name_str = devname;
+
+
+	return true;
+}
+
+
+//+------------------------------------------------------------------
+/**
+ *	function:	host_port_from_ior()
+ *
+ *	description:	Get host and port from a device IOR
+ *
+ */
+//+------------------------------------------------------------------
+
+bool host_port_from_ior(const char *iorstr,std::string &h_p)
+{
+	size_t s = (iorstr ? strlen(iorstr) : 0);
+
+  	if (s < 4)
+    	return false;
+
+  	const char *p = iorstr;
+  	if (p[0] != 'I' || p[1] != 'O' || p[2] != 'R' || p[3] != ':')
+    	return false;
+
+  	s = (s - 4) / 2;  // how many octets are there in the string
+  	p += 4;
+
+  	std::string ho;
+  	char ho_name[1024];
+  	cdrMemoryStream buf((CORBA::ULong)s,0);
+
+  	for (int i=0; i<(int)s; i++)
+	{
+    	int j = i*2;
+    	CORBA::Octet v;
+
+    	if (p[j] >= '0' && p[j] <= '9')
+		{
+      		v = ((p[j] - '0') << 4);
+    	}
+    	else if (p[j] >= 'a' && p[j] <= 'f')
+		{
+      		v = ((p[j] - 'a' + 10) << 4);
+    	}
+    	else if (p[j] >= 'A' && p[j] <= 'F')
+		{
+      		v = ((p[j] - 'A' + 10) << 4);
+    	}
+    	else
+      		return false;
+
+    	if (p[j+1] >= '0' && p[j+1] <= '9')
+		{
+      		v += (p[j+1] - '0');
+    	}
+    	else if (p[j+1] >= 'a' && p[j+1] <= 'f')
+		{
+      		v += (p[j+1] - 'a' + 10);
+    	}
+    	else if (p[j+1] >= 'A' && p[j+1] <= 'F')
+		{
+      		v += (p[j+1] - 'A' + 10);
+    	}
+    	else
+      		return false;
+
+    	buf.marshalOctet(v);
+  	}
+
+  	buf.rewindInputPtr();
+  	CORBA::Boolean b = buf.unmarshalBoolean();
+  	buf.setByteSwapFlag(b);
+
+  	IOP::IOR ior;
+
+  	ior.type_id = IOP::IOR::unmarshaltype_id(buf);
+  	ior.profiles <<= buf;
+
+
+    if (ior.profiles.length() == 0 && strlen(ior.type_id) == 0)
+	{
+      	return false;
+    }
+    else
+	{
+      	for (unsigned long count=0; count < ior.profiles.length(); count++)
+		{
+			if (ior.profiles[count].tag == IOP::TAG_INTERNET_IOP)
+			{
+	  			IIOP::ProfileBody pBody;
+	  			IIOP::unmarshalProfile(ior.profiles[count],pBody);
+
+//
+// Three possible cases for host name:
+// 1 - The host is stored in IOR as IP numbers
+// 2 - The host name is stored in IOR as the canonical host name
+// 3 - The FQDN is stored in IOR
+// We allways try to get the host name as the FQDN
+//
+
+				ho = pBody.address.host.in();
+				bool host_is_name = false;
+
+				std::string::size_type pos = ho.find('.');
+				if (pos == std::string::npos)
+					host_is_name = true;
+				else
+				{
+					for (unsigned int loop =0;loop < pos;++loop)
+					{
+						if (isdigit((int)ho[loop]) == 0)
+						{
+							host_is_name = true;
+							break;
+						}
+					}
+				}
+
+				if (host_is_name == false)
+				{
+					struct sockaddr_in s;
+					char service[20];
+
+					s.sin_family = AF_INET;
+					int res;
+#ifdef _TG_WINDOWS_
+					s.sin_addr.s_addr = inet_addr(ho.c_str());
+					if (s.sin_addr.s_addr != INADDR_NONE)
+#else
+					res = inet_pton(AF_INET,ho.c_str(),&(s.sin_addr.s_addr));
+					if (res == 1)
+#endif
+					{
+						res = getnameinfo((const struct sockaddr *)&s,sizeof(s),ho_name,sizeof(ho_name),service,sizeof(service),0);
+						if (res == 0)
+						{
+							h_p = ho_name;
+							h_p = h_p + ':';
+						}
+						else
+							h_p = ho + ':';
+					}
+					else
+						h_p = ho + ':';
+				}
+				else
+				{
+					if (pos == std::string::npos)
+					{
+						Tango::DeviceProxy::get_fqdn(ho);
+					}
+
+					h_p = ho + ':';
+				}
+
+//
+// Add port number
+//
+
+				std::stringstream ss;
+				ss << pBody.address.port;
+				h_p = h_p + ss.str();
+
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+//+------------------------------------------------------------------
+/**
+ *	function:	count_elts()
+ *
+ *	description:	Number of elements of a ds_start result (elements
+ *					separated by '\0'). The separators are searched
+ *					with memchr() which is vectorized by the C library
+ *
+ */
+//+------------------------------------------------------------------
+
+unsigned long count_elts(const char *buf,unsigned long len)
+{
+	unsigned long nb = 1;
+	const char *ptr = buf;
+	const char *end = buf + len;
+	while ((ptr = (const char *)::memchr(ptr,'\0',end - ptr)) != NULL)
+	{
+		nb++;
+		ptr++;
+	}
+	return nb;
+}
+
+//+------------------------------------------------------------------
+/**
+ *	function:	split_elts()
+ *
+ *	description:	Copy the elements of a ds_start result in a vector
+ *
+ */
+//+------------------------------------------------------------------
+
+void split_elts(const char *buf,unsigned long len,std::vector<std::string> &vs)
+{
+	vs.clear();
+	vs.reserve(count_elts(buf,len));
+	const char *start = buf;
+	const char *end = buf + len;
+	const char *ptr;
+	while ((ptr = (const char *)::memchr(start,'\0',end - start)) != NULL)
+	{
+		vs.push_back(std::string(start,ptr - start));
+		start = ptr + 1;
+	}
+	vs.push_back(std::string(start,end - start));
+}
+
+//+------------------------------------------------------------------
+/**
+ *	function:	split_elts()
+ *
+ *	description:	Copy the elements of a ds_start result in the
+ *					DbGetDataForServerCache reply. The sequence is sized
+ *					once and each element is copied once, from the
+ *					buffer to its CORBA string
+ *
+ */
+//+------------------------------------------------------------------
+
+void split_elts(const char *buf,unsigned long len,Tango::DevVarStringArray &argout)
+{
+	argout.length(count_elts(buf,len));
+
+	unsigned long idx = 0;
+	const char *start = buf;
+	const char *end = buf + len;
+	const char *ptr;
+	do
+	{
+		ptr = (const char *)::memchr(start,'\0',end - start);
+		size_t elt_len = (ptr == NULL ? end : ptr) - start;
+
+		char *elt = CORBA::string_alloc(elt_len);
+		::memcpy(elt,start,elt_len);
+		elt[elt_len] = '\0';
+		argout[idx++] = elt;
+
+		if (ptr != NULL)
+			start = ptr + 1;
+	}while (ptr != NULL);
+}
+
+}	//	namespace
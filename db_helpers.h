@@ -0,0 +1,58 @@
+//=============================================================================
+//
+// file :        db_helpers.h
+//
+// description : Include for the helper functions used by the commands
+//               which do not depend on the DataBase object (name checks,
+//               SQL escaping, IOR decoding, ds_start result splitting).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _DB_HELPERS_H
+#define _DB_HELPERS_H
+
+#include <tango.h>
+
+namespace DataBase_ns {
+
+bool check_device_name(std::string &);
+bool device_name_to_dfm(std::string &device_name, char domain[], char family[], char member[]);
+std::string replace_wildcard(const char*);
+std::string escape_string(const char *string_c_str);
+bool host_port_from_ior(const char *,std::string &);
+
+unsigned long count_elts(const char *,unsigned long);
+void split_elts(const char *,unsigned long,std::vector<std::string> &);
+void split_elts(const char *,unsigned long,Tango::DevVarStringArray &);
+
+}	//	namespace
+
+#endif	// _DB_HELPERS_H
@@ -0,0 +1,357 @@
+//=============================================================================
+//
+// file :        db_stmt.cpp
+//
+// description : MySQL prepared statements used by the most frequently
+//               called commands.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+#include <DataBase.h>
+
+#include <errmsg.h>
+#include <mysqld_error.h>
+
+namespace DataBase_ns
+{
+
+static const char *stmt_sql[STMT_NB] =
+{
+	// STMT_IMPORT_DEVICE_BY_NAME
+	"SELECT exported,ior,version,pid,server,host,class,name FROM device WHERE name = ?",
+	// STMT_IMPORT_DEVICE_BY_ALIAS
+	"SELECT exported,ior,version,pid,server,host,class,name FROM device WHERE alias = ?",
+	// STMT_EXPORT_GET_SERVER
+	"SELECT server FROM device WHERE name LIKE ?",
+	// STMT_EXPORT_UPDATE_DEVICE
+	"UPDATE device SET exported=1,ior=?,host=?,pid=?,version=?,started=NOW() WHERE name LIKE ?",
+	// STMT_EXPORT_UPDATE_SERVER
+	"UPDATE server SET host=? WHERE name LIKE ?",
+	// STMT_GET_DEVICE_PROPERTY
+	"SELECT count,value,name FROM property_device WHERE device = ? AND name LIKE ? ORDER BY count",
+	// STMT_DELETE_DEVICE_PROPERTY
+	"DELETE FROM property_device WHERE device LIKE ? AND name LIKE ?",
+	// STMT_INSERT_DEVICE_PROPERTY
+	"INSERT INTO property_device SET device=?,name=?,count=?,value=?,updated=NOW(),accessed=NOW()",
+	// STMT_INSERT_DEVICE_PROPERTY_HIST
+	"INSERT INTO property_device_hist SET device=?,id=?,name=?,count=?,value=?",
+	// STMT_COUNT_DEVICE_ATT_PROPERTY
+	"SELECT COUNT(DISTINCT attribute) FROM property_attribute_device WHERE device = ?",
+	// STMT_GET_DEVICE_ATT_PROPERTY
+	"SELECT name,value FROM property_attribute_device WHERE device = ? AND attribute LIKE ? ORDER BY name,count",
+	// STMT_GET_ALL_DEVICE_ATT_PROPERTY
+	"SELECT attribute,name,value FROM property_attribute_device WHERE device = ? ORDER BY attribute,name,count",
+	// STMT_UPDATE_MEM_ATT
+	"UPDATE property_attribute_device SET value=? WHERE device=? AND attribute=? AND name='__value' AND count=1",
+	// STMT_INSERT_MEM_ATT
+	"INSERT INTO property_attribute_device SET device=?,attribute=?,name='__value',count=1,value=?,updated=NOW(),accessed=NOW()",
+	// STMT_IMPORT_EVENT (same name comparison as the import_event stored procedure)
+	"SELECT exported,ior,version,pid,host FROM event WHERE name = REPLACE(?,'_','\\_')"
+};
+
+//
+// The multi-row INSERTs: Their head and the markers of one row
+//
+
+static const char *stmt_rows_sql[][2] =
+{
+	// STMT_INSERT_DEVICE_PROPERTY_ROWS
+	{"INSERT INTO property_device (device,name,count,value,updated,accessed) VALUES ","(?,?,?,?,NOW(),NOW())"},
+	// STMT_INSERT_DEVICE_PROPERTY_HIST_ROWS
+	{"INSERT INTO property_device_hist (device,id,name,count,value) VALUES ","(?,?,?,?,?)"}
+};
+
+//=============================================================================
+//=============================================================================
+DbStmt::DbStmt(DataBase *db,DbStmtId stmt_id,int con,const char *meth):
+	the_db(db),id(stmt_id),con_nb(con),need_release(false),method(meth),stmt(NULL),nb_bound(0),meta(NULL)
+{
+	if (con_nb == -1)
+	{
+		con_nb = the_db->get_connection();
+		need_release = true;
+	}
+
+	try
+	{
+		stmt = the_db->get_stmt(con_nb,id,method);
+	}
+	catch (Tango::DevFailed &)
+	{
+		if (need_release == true)
+			the_db->release_connection(con_nb);
+		throw;
+	}
+
+	unsigned long nb_param = mysql_stmt_param_count(stmt);
+	params.resize(nb_param);
+	param_int.resize(nb_param);
+	param_length.resize(nb_param);
+}
+//=============================================================================
+//=============================================================================
+DbStmt::~DbStmt()
+{
+	clear_result();
+	if (need_release == true)
+		the_db->release_connection(con_nb);
+}
+//=============================================================================
+//	Bind the next string parameter
+//=============================================================================
+void DbStmt::bind(const char *str)
+{
+	MYSQL_BIND &b = params[nb_bound];
+	::memset(&b,0,sizeof(MYSQL_BIND));
+	param_length[nb_bound] = ::strlen(str);
+	b.buffer_type = MYSQL_TYPE_STRING;
+	b.buffer = const_cast<char *>(str);
+	b.buffer_length = param_length[nb_bound];
+	b.length = &param_length[nb_bound];
+	nb_bound++;
+}
+//=============================================================================
+//	Bind the next integer parameter
+//=============================================================================
+void DbStmt::bind(long long val)
+{
+	MYSQL_BIND &b = params[nb_bound];
+	::memset(&b,0,sizeof(MYSQL_BIND));
+	param_int[nb_bound] = val;
+	b.buffer_type = MYSQL_TYPE_LONGLONG;
+	b.buffer = &param_int[nb_bound];
+	nb_bound++;
+}
+//=============================================================================
+//	Execute the statement with the bound parameters. The handle is prepared
+//	again (once) if it has been lost by a MySQL re-connection
+//=============================================================================
+void DbStmt::execute()
+{
+	clear_result();
+
+	if (nb_bound != params.size())
+	{
+		TangoSys_OMemStream o;
+		o << nb_bound << " parameter(s) bound for " << params.size() << " expected";
+		o << "\nThe statement was: " << get_sql(id) << std::ends;
+		nb_bound = 0;
+		Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),(const char *)"DbStmt::execute()");
+	}
+	nb_bound = 0;
+
+	TimeVal	before, exec_end, store_end;
+	GetTime(before);
+
+	bool retried = false;
+	while (true)
+	{
+		if ((params.empty() == true || mysql_stmt_bind_param(stmt,&params[0]) == 0) &&
+			mysql_stmt_execute(stmt) == 0)
+			break;
+
+		unsigned int err = mysql_stmt_errno(stmt);
+		if (retried == false &&
+			(err == CR_SERVER_GONE_ERROR || err == CR_SERVER_LOST ||
+			 err == ER_UNKNOWN_STMT_HANDLER || err == ER_NEED_REPREPARE))
+		{
+			retried = true;
+			stmt = the_db->reset_stmt(con_nb,id,method);
+			continue;
+		}
+
+		GetTime(exec_end);
+		the_db->profile_statement(get_sql(id),::strlen(get_sql(id)),before,exec_end,exec_end,0,method);
+		the_db->stmt_error(stmt,id,method);
+	}
+	GetTime(exec_end);
+
+	bind_result();
+	GetTime(store_end);
+
+	const char *sql = get_sql(id);
+	unsigned long long rows = meta != NULL ? mysql_stmt_num_rows(stmt) : mysql_stmt_affected_rows(stmt);
+	the_db->profile_statement(sql,::strlen(sql),before,exec_end,store_end,rows,method);
+}
+//=============================================================================
+//	Get the next row. Columns larger than their buffer are fetched again
+//	in a larger one
+//=============================================================================
+bool DbStmt::fetch()
+{
+	int ret = mysql_stmt_fetch(stmt);
+	if (ret == MYSQL_NO_DATA)
+		return false;
+	if (ret == 1)
+		the_db->stmt_error(stmt,id,method);
+
+	if (ret == MYSQL_DATA_TRUNCATED)
+	{
+		for (unsigned int i = 0;i < results.size();i++)
+		{
+			if (results[i].buffer_type != MYSQL_TYPE_STRING || res_null[i] != 0 ||
+				res_length[i] <= results[i].buffer_length)
+				continue;
+
+			res_buffer[i].resize(res_length[i] + 1);
+			results[i].buffer = &res_buffer[i][0];
+			results[i].buffer_length = res_length[i];
+			if (mysql_stmt_fetch_column(stmt,&results[i],i,0) != 0)
+				the_db->stmt_error(stmt,id,method);
+		}
+		mysql_stmt_bind_result(stmt,&results[0]);
+	}
+
+	return true;
+}
+//=============================================================================
+//	Return a string column of the current row, NULL if its value is NULL
+//=============================================================================
+const char *DbStmt::get_string(int col)
+{
+	if (res_null[col] != 0)
+		return NULL;
+
+	std::vector<char> &buf = res_buffer[col];
+	buf[res_length[col]] = '\0';
+	return &buf[0];
+}
+//=============================================================================
+//=============================================================================
+const char *DbStmt::get_sql(DbStmtId stmt_id)
+{
+	static std::vector<std::string> rows_sql = build_rows_sql();
+
+	if (stmt_id < STMT_INSERT_DEVICE_PROPERTY_ROWS)
+		return stmt_sql[stmt_id];
+	return rows_sql[stmt_id - STMT_INSERT_DEVICE_PROPERTY_ROWS].c_str();
+}
+//=============================================================================
+//	Build the SQL text of the multi-row INSERTs (once)
+//=============================================================================
+std::vector<std::string> DbStmt::build_rows_sql()
+{
+	std::vector<std::string> rows_sql;
+	for (size_t i = 0;i < sizeof(stmt_rows_sql) / sizeof(stmt_rows_sql[0]);i++)
+	{
+		for (int level = 1;level <= STMT_ROW_LEVELS;level++)
+		{
+			std::string sql(stmt_rows_sql[i][0]);
+			for (int row = 0;row < (1 << level);row++)
+			{
+				if (row != 0)
+					sql += ',';
+				sql += stmt_rows_sql[i][1];
+			}
+			rows_sql.push_back(sql);
+		}
+	}
+	return rows_sql;
+}
+//=============================================================================
+//	Get the multi-row INSERT of nb_rows rows (a power of 2, from 2 to
+//	2^STMT_ROW_LEVELS)
+//=============================================================================
+DbStmtId DbStmt::get_rows_id(DbStmtId rows_id,size_t nb_rows)
+{
+	int level = 0;
+	while (((size_t)2 << level) < nb_rows)
+		level++;
+	return (DbStmtId)(rows_id + level);
+}
+//=============================================================================
+//	Store the result set (if any) and bind one buffer per column, large
+//	enough for the longest value of the result. One more byte is allocated
+//	for the terminating NUL added by get_string()
+//=============================================================================
+void DbStmt::bind_result()
+{
+	meta = mysql_stmt_result_metadata(stmt);
+	if (meta == NULL)
+		return;
+
+	if (mysql_stmt_store_result(stmt) != 0)
+		the_db->stmt_error(stmt,id,method);
+
+	unsigned int nb_col = mysql_num_fields(meta);
+	MYSQL_FIELD *fields = mysql_fetch_fields(meta);
+
+	results.resize(nb_col);
+	res_buffer.resize(nb_col);
+	res_int.resize(nb_col);
+	res_length.resize(nb_col);
+	res_null.resize(nb_col);
+
+	for (unsigned int i = 0;i < nb_col;i++)
+	{
+		MYSQL_BIND &b = results[i];
+		::memset(&b,0,sizeof(MYSQL_BIND));
+		b.length = &res_length[i];
+		b.is_null = &res_null[i];
+
+		switch (fields[i].type)
+		{
+		case MYSQL_TYPE_TINY:
+		case MYSQL_TYPE_SHORT:
+		case MYSQL_TYPE_INT24:
+		case MYSQL_TYPE_LONG:
+		case MYSQL_TYPE_LONGLONG:
+			b.buffer_type = MYSQL_TYPE_LONGLONG;
+			b.buffer = &res_int[i];
+			break;
+
+		default:
+			res_buffer[i].resize(fields[i].max_length + 1);
+			b.buffer_type = MYSQL_TYPE_STRING;
+			b.buffer = &res_buffer[i][0];
+			b.buffer_length = fields[i].max_length;
+			break;
+		}
+	}
+
+	if (mysql_stmt_bind_result(stmt,&results[0]) != 0)
+		the_db->stmt_error(stmt,id,method);
+}
+//=============================================================================
+//=============================================================================
+void DbStmt::clear_result()
+{
+	if (meta != NULL)
+	{
+		mysql_free_result(meta);
+		meta = NULL;
+		mysql_stmt_free_result(stmt);
+	}
+}
+
+}	//	namespace
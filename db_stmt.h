@@ -0,0 +1,140 @@
+//=============================================================================
+//
+// file :        db_stmt.h
+//
+// description : Include for the MySQL prepared statements used by the
+//               most frequently called commands.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _DB_STMT_H
+#define _DB_STMT_H
+
+#include <tango.h>
+#include <mysql.h>
+
+namespace DataBase_ns {
+
+class DataBase;
+
+//
+// The prepared statements. Their SQL text is in db_stmt.cpp. The multi-row
+// INSERTs exist for 2,4,... (2^STMT_ROW_LEVELS) rows, see DbStmt::get_rows_id()
+//
+
+#define	STMT_ROW_LEVELS		6
+
+enum DbStmtId
+{
+	STMT_IMPORT_DEVICE_BY_NAME = 0,
+	STMT_IMPORT_DEVICE_BY_ALIAS,
+	STMT_EXPORT_GET_SERVER,
+	STMT_EXPORT_UPDATE_DEVICE,
+	STMT_EXPORT_UPDATE_SERVER,
+	STMT_GET_DEVICE_PROPERTY,
+	STMT_DELETE_DEVICE_PROPERTY,
+	STMT_INSERT_DEVICE_PROPERTY,
+	STMT_INSERT_DEVICE_PROPERTY_HIST,
+	STMT_COUNT_DEVICE_ATT_PROPERTY,
+	STMT_GET_DEVICE_ATT_PROPERTY,
+	STMT_GET_ALL_DEVICE_ATT_PROPERTY,
+	STMT_UPDATE_MEM_ATT,
+	STMT_INSERT_MEM_ATT,
+	STMT_IMPORT_EVENT,
+	STMT_INSERT_DEVICE_PROPERTY_ROWS,
+	STMT_INSERT_DEVICE_PROPERTY_HIST_ROWS = STMT_INSERT_DEVICE_PROPERTY_ROWS + STMT_ROW_LEVELS,
+	STMT_NB = STMT_INSERT_DEVICE_PROPERTY_HIST_ROWS + STMT_ROW_LEVELS
+};
+
+//=========================================================
+/**
+ *	Execution of one of the prepared statements.
+ *
+ *	The MYSQL_STMT handles are prepared once per MySQL connection and
+ *	kept in the connection pool (see DataBase::get_stmt()).
+ *	Parameters are bound in the order of the '?' markers. Strings are
+ *	not copied: They must stay valid until execute() returns.
+ *	Results are fetched with the binary protocol: Integer columns are
+ *	returned as long long, the others as strings.
+ *	If no connection is given, one is taken from the pool and released
+ *	by the destructor.
+ */
+//=========================================================
+class DbStmt
+{
+public:
+	DbStmt(DataBase *,DbStmtId,int,const char *);
+	~DbStmt();
+
+	void bind(const char *);
+	void bind(const std::string &str) {bind(str.c_str());}
+	void bind(long long);
+	void execute();
+	bool fetch();
+
+	bool is_null(int col) {return res_null[col] != 0;}
+	const char *get_string(int);
+	long long get_long(int col) {return res_null[col] != 0 ? -1 : res_int[col];}
+	my_ulonglong get_nb_rows() {return mysql_stmt_num_rows(stmt);}
+	my_ulonglong get_affected_rows() {return mysql_stmt_affected_rows(stmt);}
+	int get_con_nb() {return con_nb;}
+
+	static const char *get_sql(DbStmtId);
+	static DbStmtId get_rows_id(DbStmtId,size_t);
+
+private:
+	static std::vector<std::string> build_rows_sql();
+	void bind_result();
+	void clear_result();
+
+	DataBase						*the_db;
+	DbStmtId						id;
+	int								con_nb;
+	bool							need_release;
+	const char						*method;
+	MYSQL_STMT						*stmt;
+
+	unsigned int					nb_bound;
+	std::vector<MYSQL_BIND>			params;
+	std::vector<long long>			param_int;
+	std::vector<unsigned long>		param_length;
+
+	MYSQL_RES						*meta;
+	std::vector<MYSQL_BIND>			results;
+	std::vector<std::vector<char> >	res_buffer;
+	std::vector<long long>			res_int;
+	std::vector<unsigned long>		res_length;
+	std::vector<my_bool>			res_null;
+};
+
+}	//	namespace
+
+#endif	// _DB_STMT_H
@@ -0,0 +1,174 @@
+//=============================================================================
+//
+// file :        db_storage.h
+//
+// description : Include for the storage engine interface used by the
+//               commands (DbStorage).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _DB_STORAGE_H
+#define _DB_STORAGE_H
+
+#include <tango.h>
+#include <server_cache.h>
+#include <ds_start.h>
+
+namespace DataBase_ns {
+
+class DataBase;
+
+//
+// Import information of a device (DbImportDevice)
+//
+
+typedef struct
+{
+	std::string		name;
+	std::string		ior;
+	std::string		version;
+	std::string		server;
+	std::string		host;
+	std::string		class_name;
+	long			exported;
+	long			pid;
+} DbDeviceInfo;
+
+//
+// A property with its values
+//
+
+typedef struct
+{
+	std::string					name;
+	std::vector<std::string>	values;
+} DbProperty;
+
+//=========================================================
+/**
+ *	Storage engine used by the commands. The commands check their
+ *	arguments, manage the caches and notify the starters, the engine
+ *	reads and writes the data. Names are given as received by the
+ *	command (property names may contain * wildcards), except the
+ *	device names of import_device(), export_device() and
+ *	unexport_device() which are already in lower case.
+ *	Errors are reported with Tango exceptions (DB_DeviceNotDefined,
+ *	DB_SQLError...).
+ */
+//=========================================================
+class DbStorage
+{
+public:
+	virtual ~DbStorage() {}
+
+	virtual const char *get_name() = 0;
+
+//
+// Devices. import_device() searches the device by name, then by alias
+// and returns false if it is not defined. If previous_host is not NULL,
+// export_device() returns in it the host where the device was running
+// before
+//
+
+	virtual bool import_device(const std::string &,DbDeviceInfo &) = 0;
+	virtual void export_device(const std::string &,const char *,const char *,const char *,const char *,std::string *previous_host) = 0;
+	virtual void unexport_device(const std::string &) = 0;
+
+//
+// Device properties. get_device_property() returns one DbProperty per
+// requested name (with all the values of the properties matching it)
+//
+
+	virtual void get_device_property(const char *,const std::vector<std::string> &,std::vector<DbProperty> &) = 0;
+	virtual void put_device_property(const char *,const std::vector<DbProperty> &) = 0;
+	virtual void delete_device_property(const char *,const std::vector<std::string> &) = 0;
+
+//
+// DbGetDataForServerCache data of a server, and the classes and devices
+// this data depends on (for the server cache). get_server_data() returns
+// false if the data must not be cached
+//
+
+	virtual void get_server_dependencies(const std::string &,ServerCache::ServerEntry &) = 0;
+	virtual bool get_server_data(const char *,const char *,ServerData &) = 0;
+
+//
+// Called by the commands not using the engine around their writes in the
+// device table (or in the properties of the devices they add or remove)
+// in MySQL, without any MySQL connection held (see DirectWrite). Engines
+// applying their writes to MySQL later apply the writes done so far
+// before the lock is taken and hold the next ones until it is released
+//
+
+	virtual void lock_direct_write() {}
+	virtual void unlock_direct_write() {}
+
+//
+// Called by the same commands once the direct write is done and the lock
+// released. The devices are selected by a device table column ("name",
+// "alias" or "server") and a SQL LIKE pattern. Engines keeping their own
+// copy of the data reload the data of these devices
+//
+
+	virtual void reload_devices(const char *,const std::string &) {}
+
+//
+// Called by the commands reading device or device property data directly
+// from MySQL (without any MySQL connection held). Engines applying their
+// writes to MySQL later wait until the writes done so far are there
+//
+
+	virtual void sync() {}
+};
+
+//=========================================================
+/**
+ *	Direct write lock of the storage engine, released by the
+ *	destructor if not released before (same usage as
+ *	AutoTransaction)
+ */
+//=========================================================
+class DirectWrite
+{
+public:
+	DirectWrite(DbStorage *st):storage(st),locked(false) {storage->lock_direct_write();locked = true;}
+	~DirectWrite() {unlock();}
+
+	void unlock() {if (locked == true) {locked = false;storage->unlock_direct_write();}}
+
+private:
+	DbStorage	*storage;
+	bool		locked;
+};
+
+}	//	namespace
+
+#endif	// _DB_STORAGE_H
@@ -0,0 +1,1059 @@
+//=============================================================================
+//
+// file :        ds_start.cpp
+//
+// description : C++ implementation of the ds_start stored procedure
+//               (DbGetDataForServerCache command).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+#include <DataBase.h>
+
+#include <zlib.h>
+#include <iomanip>
+
+namespace DataBase_ns
+{
+
+static std::string lower_string(const std::string &str)
+{
+	std::string lower(str);
+	std::transform(lower.begin(),lower.end(),lower.begin(),::tolower);
+	return lower;
+}
+
+//
+// Names are compared like MySQL does with the (case insensitive)
+// default collation
+//
+
+static bool same_name(const char *n1,const char *n2)
+{
+	if (n1 == NULL || n2 == NULL)
+		return n1 == n2;
+	while (*n1 != '\0' && ::tolower(*n1) == ::tolower(*n2))
+	{
+		n1++;
+		n2++;
+	}
+	return ::tolower(*n1) == ::tolower(*n2);
+}
+
+//
+// Escape a name read from the database to use it between double quotes
+//
+
+static std::string escape_name(const std::string &name)
+{
+	std::string escaped;
+	for (size_t i = 0;i < name.size();i++)
+	{
+		if (name[i] == '\\' || name[i] == '"')
+			escaped.push_back('\\');
+		escaped.push_back(name[i]);
+	}
+	return escaped;
+}
+
+//=============================================================================
+//	The ds_start procedure adds the pipe properties if the client
+//	release is >= 9 and only uses the host name part of the argument
+//=============================================================================
+DsStart::DsStart(DataBase *db,const char *ds,const char *recev_host,const std::string &sql_ds,int nb,DsStartCommon *com):
+	the_db(db),ds_name(ds),sql_ds_name(sql_ds),host(recev_host),ds_pipe(false),fan_out(nb),common(com),
+	next_query(0),out(NULL),started(false),batch(0),cur_class(0),cur_dev(0),class_started(false),
+	dev_pos(0),loaded_end(0)
+{
+	adm_dev_name = "dserver/" + ds_name;
+
+	std::string::size_type pos = host.find("%%");
+	if (pos != std::string::npos)
+	{
+		ds_pipe = atoi(host.c_str() + pos + 2) >= 9;
+		host.erase(pos);
+	}
+}
+//=============================================================================
+//=============================================================================
+DsStart::~DsStart()
+{
+	for (int i = 0;i < Q_NB;i++)
+	{
+		if (queries[i].result != NULL)
+			mysql_free_result(queries[i].result);
+	}
+}
+//=============================================================================
+//	One query per kind of data. The property queries are sorted like the
+//	stored procedure cursors, the rows of one device (or class) being
+//	contiguous. The biggest ones are started first
+//=============================================================================
+void DsStart::init_queries()
+{
+	std::string devices("(SELECT DISTINCT name FROM device WHERE server=\"");
+	devices = devices + sql_ds_name + "\") d";
+	std::string classes("(SELECT DISTINCT class FROM device WHERE server=\"");
+	classes = classes + sql_ds_name + "\") c";
+
+//
+// When streamed, the device properties are read by batch of devices
+// (see load_devices()). Only the admin device ones are read first
+//
+
+	if (batch == 0)
+	{
+		queries[Q_DEV_ATT_PROP].sql = "SELECT p.device,p.attribute,p.name,p.count,p.value FROM property_attribute_device p,";
+		queries[Q_DEV_ATT_PROP].sql = queries[Q_DEV_ATT_PROP].sql + devices +
+					" WHERE p.device=d.name ORDER BY p.device,p.attribute,p.name,p.count";
+
+		queries[Q_DEV_PROP].sql = "SELECT p.device,p.name,p.count,p.value FROM property_device p,";
+		queries[Q_DEV_PROP].sql = queries[Q_DEV_PROP].sql + "(SELECT name FROM device WHERE server=\"" + sql_ds_name +
+					"\" UNION SELECT \"dserver/" + sql_ds_name + "\") d" +
+					" WHERE p.device=d.name ORDER BY p.device,p.name,p.count";
+	}
+	else
+	{
+		queries[Q_DEV_PROP].sql = "SELECT p.device,p.name,p.count,p.value FROM property_device p WHERE p.device=\"dserver/";
+		queries[Q_DEV_PROP].sql = queries[Q_DEV_PROP].sql + sql_ds_name + "\" ORDER BY p.device,p.name,p.count";
+	}
+
+	queries[Q_CLASS_ATT_PROP].sql = "SELECT p.class,p.attribute,p.name,p.count,p.value FROM property_attribute_class p,";
+	queries[Q_CLASS_ATT_PROP].sql = queries[Q_CLASS_ATT_PROP].sql + classes +
+				" WHERE p.class=c.class ORDER BY p.class,p.attribute,p.name,p.count";
+
+	queries[Q_CLASS_PROP].sql = "SELECT p.class,p.name,p.count,p.value FROM property_class p,";
+	queries[Q_CLASS_PROP].sql = queries[Q_CLASS_PROP].sql + "(SELECT DISTINCT class FROM device WHERE server=\"" + sql_ds_name + "\"";
+	if (common == NULL || common->class_props_done == false)
+		queries[Q_CLASS_PROP].sql = queries[Q_CLASS_PROP].sql + " UNION SELECT \"DServer\" UNION SELECT \"Default\"";
+	queries[Q_CLASS_PROP].sql = queries[Q_CLASS_PROP].sql + ") c WHERE p.class=c.class ORDER BY p.class,p.name,p.count";
+
+	if (ds_pipe == true)
+	{
+		if (batch == 0)
+		{
+			queries[Q_DEV_PIPE_PROP].sql = "SELECT p.device,p.pipe,p.name,p.count,p.value FROM property_pipe_device p,";
+			queries[Q_DEV_PIPE_PROP].sql = queries[Q_DEV_PIPE_PROP].sql + devices +
+					" WHERE p.device=d.name ORDER BY p.device,p.pipe,p.name,p.count";
+		}
+
+		queries[Q_CLASS_PIPE_PROP].sql = "SELECT p.class,p.pipe,p.name,p.count,p.value FROM property_pipe_class p,";
+		queries[Q_CLASS_PIPE_PROP].sql = queries[Q_CLASS_PIPE_PROP].sql + classes +
+				" WHERE p.class=c.class ORDER BY p.class,p.pipe,p.name,p.count";
+	}
+
+	queries[Q_DEV_LIST].sql = "SELECT DISTINCT name,class FROM device WHERE server=\"";
+	queries[Q_DEV_LIST].sql = queries[Q_DEV_LIST].sql + sql_ds_name + "\" ORDER BY name";
+
+//
+// Same query than the ds_start class cursor (no ORDER BY) to get the
+// classes in the same order
+//
+
+	queries[Q_CLASS_LIST].sql = "SELECT DISTINCT class FROM device WHERE server = \"";
+	queries[Q_CLASS_LIST].sql = queries[Q_CLASS_LIST].sql + sql_ds_name + "\"";
+
+	if (common == NULL || common->ctrl_done == false)
+		queries[Q_CTRL_PROP].sql = "SELECT name,count,value FROM property WHERE object=\"CtrlSystem\" ORDER BY name,count";
+}
+//=============================================================================
+//	Build the result. Without connection given, the one taken here is
+//	released before returning
+//=============================================================================
+void DsStart::build(std::vector<std::string> &res,int con_nb)
+{
+	out = &res;
+	out->clear();
+
+	if (con_nb != -1)
+	{
+		build_data(con_nb);
+		return;
+	}
+
+	con_nb = the_db->get_connection();
+	try
+	{
+		build_data(con_nb);
+	}
+	catch (Tango::DevFailed &)
+	{
+		the_db->release_connection(con_nb);
+		throw;
+	}
+
+	the_db->release_connection(con_nb);
+}
+//=============================================================================
+//	Build the next part of the result (at least max_elt elements unless it
+//	is the last one). The device properties are read by batch of
+//	DS_START_STREAM_BATCH devices. Return false if it is the last part
+//=============================================================================
+bool DsStart::build_chunk(std::vector<std::string> &res,size_t max_elt,int con_nb)
+{
+	out = &res;
+	out->clear();
+
+	if (started == false)
+	{
+		started = true;
+		batch = DS_START_STREAM_BATCH;
+		if (build_head(con_nb) == false)
+			return false;
+	}
+
+	while (out->size() < max_elt)
+	{
+		if (build_step(con_nb) == false)
+			return false;
+	}
+	return true;
+}
+//=============================================================================
+//=============================================================================
+void DsStart::build_data(int con_nb)
+{
+	started = true;
+	if (build_head(con_nb) == false)
+		return;
+	while (build_step(con_nb) == true)
+		;
+}
+//=============================================================================
+//	Result up to the number of classes. The common data are copied from
+//	(or to) the DsStartCommon object. Return false if the admin device is
+//	not defined (nothing more in the result)
+//=============================================================================
+bool DsStart::build_head(int con_nb)
+{
+	init_queries();
+
+	if (ds_pipe == true)
+		out->push_back(DS_START_RELEASE);
+
+	if (import_device(adm_dev_name,con_nb) == false)
+		return false;
+
+	size_t first = out->size();
+	if (common == NULL)
+		import_event("notifd/factory/" + host,con_nb);
+	else
+	{
+		std::string host_key = lower_string(host);
+		std::map<std::string,std::vector<std::string> >::iterator ite = common->notifd.find(host_key);
+		if (ite != common->notifd.end())
+			out->insert(out->end(),ite->second.begin(),ite->second.end());
+		else
+		{
+			import_event("notifd/factory/" + host,con_nb);
+			common->notifd[host_key].assign(out->begin() + first,out->end());
+		}
+	}
+	import_event(adm_dev_name,con_nb);
+
+	run_queries(con_nb);
+
+	if (common != NULL && common->class_props_done == true)
+		out->insert(out->end(),common->class_props.begin(),common->class_props.end());
+	else
+	{
+		first = out->size();
+		add_obj_props(Q_CLASS_PROP,"DServer");
+		add_obj_props(Q_CLASS_PROP,"Default");
+		if (common != NULL)
+		{
+			common->class_props.assign(out->begin() + first,out->end());
+			common->class_props_done = true;
+		}
+	}
+	add_obj_props(Q_DEV_PROP,adm_dev_name);
+
+//
+// The server classes (except the admin device one) and their devices
+//
+
+	Query &cl_q = queries[Q_CLASS_LIST];
+	for (size_t i = 0;i < cl_q.rows.size();i++)
+	{
+		if (cl_q.rows[i][0] != NULL && same_name(cl_q.rows[i][0],"dserver") == false)
+			class_list.push_back(cl_q.rows[i][0]);
+	}
+
+	Query &dev_q = queries[Q_DEV_LIST];
+	for (size_t i = 0;i < dev_q.rows.size();i++)
+	{
+		MYSQL_ROW row = dev_q.rows[i];
+		if (row[1] == NULL)
+			continue;
+		std::vector<std::string> &devs = class_devices[lower_string(row[1])];
+		if (devs.empty() == true || same_name(devs.back().c_str(),row[0]) == false)
+			devs.push_back(row[0]);
+	}
+
+	if (batch != 0)
+	{
+		for (size_t i = 0;i < class_list.size();i++)
+		{
+			std::vector<std::string> &devs = class_devices[lower_string(class_list[i])];
+			stream_devices.insert(stream_devices.end(),devs.begin(),devs.end());
+		}
+	}
+
+//
+// The stored procedure does not insert a number which would be the last
+// element of its result (no class, class without device)
+//
+
+	out->push_back(ds_name);
+	if (class_list.empty() == false)
+		add_count(out->size(),(long)class_list.size());
+
+	return true;
+}
+//=============================================================================
+//	Add the next class definition or the next device properties. At the
+//	end, add the control system part and return false
+//=============================================================================
+bool DsStart::build_step(int con_nb)
+{
+	if (cur_class == class_list.size())
+	{
+		build_ctrl(con_nb);
+		return false;
+	}
+
+	const std::string &cl = class_list[cur_class];
+	std::vector<std::string> &devs = class_devices[lower_string(cl)];
+
+	if (class_started == false)
+	{
+		add_obj_props(Q_CLASS_PROP,cl);
+		add_obj_att_props(Q_CLASS_ATT_PROP,cl);
+		if (ds_pipe == true)
+			add_obj_att_props(Q_CLASS_PIPE_PROP,cl);
+
+		out->push_back(cl);
+		if (devs.empty() == false)
+			add_count(out->size(),(long)devs.size());
+		out->insert(out->end(),devs.begin(),devs.end());
+		class_started = true;
+	}
+	else if (cur_dev < devs.size())
+	{
+		if (batch != 0 && dev_pos == loaded_end)
+		{
+			loaded_end = std::min(dev_pos + batch,stream_devices.size());
+			load_devices(dev_pos,loaded_end,con_nb);
+		}
+
+		add_obj_props(Q_DEV_PROP,devs[cur_dev]);
+		add_obj_att_props(Q_DEV_ATT_PROP,devs[cur_dev]);
+		if (ds_pipe == true)
+			add_obj_att_props(Q_DEV_PIPE_PROP,devs[cur_dev]);
+		cur_dev++;
+		dev_pos++;
+	}
+	else
+	{
+		cur_class++;
+		cur_dev = 0;
+		class_started = false;
+	}
+	return true;
+}
+//=============================================================================
+//	Control system properties and the access control device (defined in
+//	the Services property)
+//=============================================================================
+void DsStart::build_ctrl(int con_nb)
+{
+	if (common != NULL && common->ctrl_done == true)
+	{
+		out->insert(out->end(),common->ctrl.begin(),common->ctrl.end());
+		return;
+	}
+
+	size_t first = out->size();
+	Query &ctrl_q = queries[Q_CTRL_PROP];
+	std::string ca_dev;
+	bool serv_defined = false;
+	for (size_t i = 0;i < ctrl_q.rows.size();i++)
+	{
+		MYSQL_ROW row = ctrl_q.rows[i];
+		if (row[1] != NULL && atoi(row[1]) == 1)
+			serv_defined = same_name(row[0],"Services");
+		if (serv_defined == true && row[2] != NULL)
+			get_ca_device(row[2],ca_dev);
+	}
+
+	out->push_back("CtrlSystem");
+	add_props(ctrl_q,0,ctrl_q.rows.size(),0);
+
+	if (ca_dev.empty() == false)
+		import_device(ca_dev,con_nb);
+
+	if (common != NULL)
+	{
+		common->ctrl.assign(out->begin() + first,out->end());
+		common->ctrl_done = true;
+	}
+}
+//=============================================================================
+//	Read the properties of the streamed devices [first,last[. The previous
+//	batch rows are freed
+//=============================================================================
+void DsStart::load_devices(size_t first,size_t last,int con_nb)
+{
+	std::string in_list;
+	for (size_t i = first;i < last;i++)
+	{
+		if (i != first)
+			in_list = in_list + ',';
+		in_list = in_list + '"' + escape_name(stream_devices[i]) + '"';
+	}
+
+	reset_query(Q_DEV_PROP,"SELECT device,name,count,value FROM property_device WHERE device IN (" +
+				in_list + ") ORDER BY device,name,count");
+	reset_query(Q_DEV_ATT_PROP,"SELECT device,attribute,name,count,value FROM property_attribute_device WHERE device IN (" +
+				in_list + ") ORDER BY device,attribute,name,count");
+	if (ds_pipe == true)
+		reset_query(Q_DEV_PIPE_PROP,"SELECT device,pipe,name,count,value FROM property_pipe_device WHERE device IN (" +
+				in_list + ") ORDER BY device,pipe,name,count");
+
+	next_query = 0;
+	run_queries(con_nb);
+}
+//=============================================================================
+//=============================================================================
+void DsStart::reset_query(QueryId id,const std::string &sql)
+{
+	Query &q = queries[id];
+	if (q.result != NULL)
+		mysql_free_result(q.result);
+	q.result = NULL;
+	q.rows.clear();
+	q.index.clear();
+	q.failed = false;
+	q.done = false;
+	q.sql = sql;
+}
+//=============================================================================
+//	Share the queries between the caller and the worker threads. The first
+//	query error is re-thrown once all of them are done
+//=============================================================================
+void DsStart::run_queries(int con_nb)
+{
+	int nb_queries = 0;
+	for (int i = 0;i < Q_NB;i++)
+	{
+		if (queries[i].sql.empty() == false && queries[i].done == false)
+			nb_queries++;
+	}
+
+	std::vector<DsStartWorker *> workers;
+	for (int i = 1;i < fan_out && i < nb_queries;i++)
+	{
+		DsStartWorker *worker = new DsStartWorker(the_db,this);
+		worker->start();
+		workers.push_back(worker);
+	}
+
+	while (run_next_query(con_nb) == true)
+		;
+
+	for (size_t i = 0;i < workers.size();i++)
+		workers[i]->join(NULL);
+
+	for (int i = 0;i < Q_NB;i++)
+	{
+		if (queries[i].failed == true)
+			throw queries[i].error;
+	}
+}
+//=============================================================================
+//	Run the next query not yet started. Return false if there is none
+//=============================================================================
+bool DsStart::run_next_query(int con_nb)
+{
+	Query *q;
+	{
+		omni_mutex_lock sync(query_mutex);
+		while (next_query < Q_NB && (queries[next_query].sql.empty() == true || queries[next_query].done == true))
+			next_query++;
+		if (next_query == Q_NB)
+			return false;
+		q = &queries[next_query++];
+		q->done = true;
+	}
+
+	try
+	{
+		q->result = the_db->query(q->sql,"db_get_data_for_server_cache()",con_nb);
+
+		MYSQL_ROW row;
+		while ((row = mysql_fetch_row(q->result)) != NULL)
+			q->rows.push_back(row);
+
+		if (q != &queries[Q_DEV_LIST] && q != &queries[Q_CLASS_LIST] && q != &queries[Q_CTRL_PROP])
+			index_rows(*q);
+	}
+	catch (Tango::DevFailed &e)
+	{
+		q->failed = true;
+		q->error = e;
+	}
+
+	return true;
+}
+//=============================================================================
+//	Index the rows by their first column (device or class name)
+//=============================================================================
+void DsStart::index_rows(Query &q)
+{
+	const char *prev = NULL;
+	RowRange *range = NULL;
+	for (size_t i = 0;i < q.rows.size();i++)
+	{
+		const char *name = q.rows[i][0];
+		if (range == NULL || same_name(name,prev) == false)
+		{
+			range = &q.index[lower_string(name != NULL ? name : "")];
+			range->first = i;
+			prev = name;
+		}
+		range->last = i + 1;
+	}
+}
+//=============================================================================
+//=============================================================================
+DsStart::RowRange DsStart::find_rows(QueryId id,const std::string &name)
+{
+	std::map<std::string,RowRange>::iterator ite = queries[id].index.find(lower_string(name));
+	if (ite == queries[id].index.end())
+		return RowRange();
+	return ite->second;
+}
+//=============================================================================
+//	Same data as the import_device stored procedure. Return false if the
+//	device is not defined
+//=============================================================================
+bool DsStart::import_device(const std::string &dev_name,int con_nb)
+{
+	DbStmt stmt(the_db,STMT_IMPORT_DEVICE_BY_NAME,con_nb,"db_get_data_for_server_cache()");
+	stmt.bind(dev_name);
+	stmt.execute();
+
+	out->push_back(dev_name);
+	if (stmt.fetch() == false)
+	{
+		out->push_back("Not Found");
+		return false;
+	}
+
+//
+// Columns: exported,ior,version,pid,server,host,class
+//
+
+	char buf[32];
+	out->push_back(stmt.is_null(1) == true ? "" : stmt.get_string(1));
+	out->push_back(stmt.is_null(2) == true ? "" : stmt.get_string(2));
+	if (stmt.is_null(4) == false)
+		out->push_back(stmt.get_string(4));
+	if (stmt.is_null(5) == false)
+		out->push_back(stmt.get_string(5));
+	if (stmt.is_null(0) == false)
+	{
+		sprintf(buf,"%lld",stmt.get_long(0));
+		out->push_back(buf);
+	}
+	if (stmt.is_null(3) == true)
+		out->push_back("");
+	else
+	{
+		sprintf(buf,"%lld",stmt.get_long(3));
+		out->push_back(buf);
+	}
+	if (stmt.is_null(6) == false)
+		out->push_back(stmt.get_string(6));
+
+	return true;
+}
+//=============================================================================
+//	Same data as the import_event stored procedure: If the name is not
+//	found, retry with the part before the first dot
+//=============================================================================
+void DsStart::import_event(const std::string &ev_name,int con_nb)
+{
+	DbStmt stmt(the_db,STMT_IMPORT_EVENT,con_nb,"db_get_data_for_server_cache()");
+	stmt.bind(ev_name);
+	stmt.execute();
+
+	bool found = stmt.fetch();
+	std::string::size_type dot = ev_name.find('.');
+	if (found == false && dot != std::string::npos)
+	{
+		std::string canon_name = ev_name.substr(0,dot);
+		stmt.bind(canon_name);
+		stmt.execute();
+		found = stmt.fetch();
+	}
+
+	out->push_back(ev_name);
+	if (found == false)
+	{
+		out->push_back("Not Found");
+		return;
+	}
+
+//
+// Columns: exported,ior,version,pid,host. NULL ones are skipped
+// (CONCAT_WS)
+//
+
+	char buf[32];
+	if (stmt.is_null(1) == false)
+		out->push_back(stmt.get_string(1));
+	if (stmt.is_null(2) == false)
+		out->push_back(stmt.get_string(2));
+	if (stmt.is_null(4) == false)
+		out->push_back(stmt.get_string(4));
+	if (stmt.is_null(0) == false)
+	{
+		sprintf(buf,"%lld",stmt.get_long(0));
+		out->push_back(buf);
+	}
+	if (stmt.is_null(3) == false)
+	{
+		sprintf(buf,"%lld",stmt.get_long(3));
+		out->push_back(buf);
+	}
+}
+//=============================================================================
+//	Same data as the class_prop and dev_prop stored procedures
+//=============================================================================
+void DsStart::add_obj_props(QueryId id,const std::string &obj)
+{
+	out->push_back(obj);
+	RowRange range = find_rows(id,obj);
+	add_props(queries[id],range.first,range.last,1);
+}
+//=============================================================================
+//	Same data as the class_att_prop, dev_att_prop, class_pipe_prop and
+//	dev_pipe_prop stored procedures: The number of attributes (or pipes)
+//	then for each of them, its name and its properties
+//=============================================================================
+void DsStart::add_obj_att_props(QueryId id,const std::string &obj)
+{
+	Query &q = queries[id];
+	out->push_back(obj);
+	size_t att_nb_pos = out->size();
+	out->push_back("0");
+
+	RowRange range = find_rows(id,obj);
+	long att_nb = 0;
+	size_t i = range.first;
+	while (i < range.last)
+	{
+		size_t att_first = i;
+		while (i < range.last && same_name(q.rows[i][1],q.rows[att_first][1]) == true)
+			i++;
+
+		out->push_back(q.rows[att_first][1]);
+		add_props(q,att_first,i,2);
+		att_nb++;
+	}
+
+	add_count(att_nb_pos,att_nb);
+}
+//=============================================================================
+//	Add the number of properties and the properties of rows [first,last[.
+//	The property name is in column col followed by the count and the value
+//	columns. A property starts at its row with count 1: Its name then its
+//	number of values are added before its values
+//=============================================================================
+void DsStart::add_props(Query &q,size_t first,size_t last,int col)
+{
+	size_t prop_nb_pos = out->size();
+	out->push_back("0");
+
+	long prop_nb = 0;
+	long elt_nb = 0;
+	size_t elt_nb_pos = 0;
+	for (size_t i = first;i < last;i++)
+	{
+		MYSQL_ROW row = q.rows[i];
+		if (row[col + 1] != NULL && atoi(row[col + 1]) == 1)
+		{
+			if (prop_nb != 0)
+				add_count(elt_nb_pos,elt_nb);
+			out->push_back(row[col] != NULL ? row[col] : "");
+			elt_nb_pos = out->size();
+			out->push_back("");
+			prop_nb++;
+			elt_nb = 0;
+		}
+		out->push_back(row[col + 2] != NULL ? row[col + 2] : "");
+		elt_nb++;
+	}
+
+	if (prop_nb != 0)
+		add_count(elt_nb_pos,elt_nb);
+	add_count(prop_nb_pos,prop_nb);
+}
+//=============================================================================
+//	Set (or insert if pos is the end of the result) a number element
+//=============================================================================
+void DsStart::add_count(size_t pos,long nb)
+{
+	char buf[32];
+	sprintf(buf,"%ld",nb);
+	if (pos == out->size())
+		out->push_back(buf);
+	else
+		(*out)[pos] = buf;
+}
+//=============================================================================
+//	Device name of the access control service in one value of the
+//	CtrlSystem Services property ("AccessControl/tango:<device>", the
+//	device may be given with its tango:// host). Same parsing as the
+//	obj_prop stored procedure. The device is unchanged if the value does
+//	not define it
+//=============================================================================
+bool DsStart::get_ca_device(const char *value,std::string &dev)
+{
+	std::string val(value);
+	std::string lower_val = lower_string(val);
+	if (lower_val.find("accesscontrol/tango:") == std::string::npos)
+		return false;
+
+	dev = val.size() > 20 ? val.substr(20) : "";
+	if (lower_val.find("tango://",20) != std::string::npos)
+	{
+		std::string::size_type pos = dev.size();
+		for (int i = 0;i < 3 && pos != std::string::npos;i++)
+			pos = pos == 0 ? std::string::npos : dev.rfind('/',pos - 1);
+		if (pos != std::string::npos)
+			dev = dev.substr(pos + 1);
+	}
+	return true;
+}
+
+
+//=============================================================================
+//=============================================================================
+DsStartStreams::~DsStartStreams()
+{
+	std::map<std::string,Stream>::iterator ite;
+	for (ite = streams.begin();ite != streams.end();++ite)
+		delete ite->second.ds_start;
+}
+//=============================================================================
+//	Keep a retrieval in progress and return its continuation token, not
+//	guessable from the previous ones
+//=============================================================================
+std::string DsStartStreams::add(DsStart *ds_start)
+{
+	omni_mutex_lock sync(*this);
+
+	remove_expired();
+	if (streams.size() >= DS_START_MAX_STREAM)
+	{
+		TangoSys_OMemStream o;
+		o << "Too many DbGetDataForServerCacheChunk retrievals in progress (" << DS_START_MAX_STREAM << ")" << std::ends;
+		Tango::Except::throw_exception((const char *)"DB_TooManyRetrievals",o.str(),
+					(const char *)"DsStartStreams::add()");
+	}
+
+	std::string token;
+	do
+	{
+		TangoSys_OMemStream o;
+		o << std::hex << std::setfill('0');
+		for (int i = 0;i < 4;i++)
+			o << std::setw(8) << (unsigned long)token_source();
+		token = o.str();
+	}
+	while (streams.find(token) != streams.end());
+
+	Stream &st = streams[token];
+	st.ds_start = ds_start;
+	st.stamp = time(NULL);
+	return token;
+}
+//=============================================================================
+//	Get (and remove) the retrieval of a token. NULL if unknown, expired or
+//	started for another server (then kept)
+//=============================================================================
+DsStart *DsStartStreams::take(const std::string &token,const char *ds_name)
+{
+	omni_mutex_lock sync(*this);
+
+	remove_expired();
+	std::map<std::string,Stream>::iterator ite = streams.find(token);
+	if (ite == streams.end() || strcasecmp(ite->second.ds_start->get_ds_name().c_str(),ds_name) != 0)
+		return NULL;
+
+	DsStart *ds_start = ite->second.ds_start;
+	streams.erase(ite);
+	return ds_start;
+}
+//=============================================================================
+//	Must be called with the mutex locked
+//=============================================================================
+void DsStartStreams::remove_expired()
+{
+	time_t now = time(NULL);
+	std::map<std::string,Stream>::iterator ite = streams.begin();
+	while (ite != streams.end())
+	{
+		if (now - ite->second.stamp >= DS_START_STREAM_TIMEOUT)
+		{
+			delete ite->second.ds_start;
+			streams.erase(ite++);
+		}
+		else
+			++ite;
+	}
+}
+
+//=============================================================================
+//	A worker which does not get a free connection immediately leaves the
+//	queries to the others
+//=============================================================================
+void *DsStartWorker::run_undetached(TANGO_UNUSED(void *ptr))
+{
+	mysql_thread_init();
+
+	int con_nb = the_db->try_get_connection();
+	if (con_nb != -1)
+	{
+		while (ds_start->run_next_query(con_nb) == true)
+			;
+		the_db->release_connection(con_nb);
+	}
+
+	mysql_thread_end();
+	return NULL;
+}
+
+//=============================================================================
+//=============================================================================
+ServerData::~ServerData()
+{
+	if (result != NULL)
+		mysql_free_result(result);
+}
+//=============================================================================
+//	Keep the stored procedure result. The MySQL result is freed with this
+//	object
+//=============================================================================
+void ServerData::set_result(MYSQL_RES *res,const char *data,unsigned long data_len)
+{
+	if (result != NULL)
+		mysql_free_result(result);
+	result = res;
+	buf = data == NULL ? "" : data;
+	len = data == NULL ? 0 : data_len;
+	elts.clear();
+}
+//=============================================================================
+//	Number of elements
+//=============================================================================
+unsigned long ServerData::get_nb_elt()
+{
+	if (buf == NULL)
+		return elts.size();
+
+	return count_elts(buf,len);
+}
+//=============================================================================
+//=============================================================================
+bool ServerData::contains(const char *str)
+{
+	if (buf == NULL)
+	{
+		for (size_t i = 0;i < elts.size();i++)
+		{
+			if (elts[i].find(str) != std::string::npos)
+				return true;
+		}
+		return false;
+	}
+
+	size_t str_len = ::strlen(str);
+	const char *ptr = buf;
+	const char *end = buf + len;
+	while (end - ptr >= (long)str_len &&
+		   (ptr = (const char *)::memchr(ptr,str[0],end - ptr - str_len + 1)) != NULL)
+	{
+		if (::memcmp(ptr,str,str_len) == 0)
+			return true;
+		ptr++;
+	}
+	return false;
+}
+//=============================================================================
+//	Copy the elements in a vector (for the server cache)
+//=============================================================================
+void ServerData::get_elts(std::vector<std::string> &vs)
+{
+	if (buf == NULL)
+	{
+		vs = elts;
+		return;
+	}
+
+	split_elts(buf,len,vs);
+}
+//=============================================================================
+//	Build the DbGetDataForServerCache reply, directly from the MySQL buffer
+//=============================================================================
+void ServerData::to_string_array(Tango::DevVarStringArray &argout)
+{
+	if (buf == NULL)
+	{
+		argout.length(elts.size());
+		for (unsigned long i = 0;i < elts.size();i++)
+			argout[i] = CORBA::string_dup(elts[i].c_str());
+		return;
+	}
+
+	split_elts(buf,len,argout);
+}
+//=============================================================================
+//	Build the DbGetDataForServerCacheRaw reply: The elements separated by
+//	'\0' as returned by the stored procedure, with the "ds_start" format
+//=============================================================================
+void ServerData::to_encoded(Tango::DevEncoded &argout)
+{
+	argout.encoded_format = CORBA::string_dup("ds_start");
+
+	if (buf != NULL)
+	{
+		argout.encoded_data.length(len);
+		if (len != 0)
+			::memcpy(argout.encoded_data.get_buffer(),buf,len);
+		return;
+	}
+
+	unsigned long total = 0;
+	for (size_t i = 0;i < elts.size();i++)
+		total = total + elts[i].size() + 1;
+	if (total != 0)
+		total--;
+
+	argout.encoded_data.length(total);
+	unsigned char *ptr = argout.encoded_data.get_buffer();
+	for (size_t i = 0;i < elts.size();i++)
+	{
+		if (i != 0)
+			*ptr++ = '\0';
+		::memcpy(ptr,elts[i].data(),elts[i].size());
+		ptr = ptr + elts[i].size();
+	}
+}
+
+//=============================================================================
+//	Build the DbGetDataForServerCacheCompressed reply. The data are
+//	compressed directly in the reply buffer, allocated for the worst case
+//	and then shrunk
+//=============================================================================
+void ServerData::to_compressed(Tango::DevEncoded &argout)
+{
+	argout.encoded_format = CORBA::string_dup(DS_START_ZLIB_FORMAT);
+
+	unsigned long total = len;
+	if (buf == NULL)
+	{
+		total = 0;
+		for (size_t i = 0;i < elts.size();i++)
+			total = total + elts[i].size() + 1;
+		if (total != 0)
+			total--;
+	}
+
+	z_stream strm;
+	::memset(&strm,0,sizeof(z_stream));
+	if (deflateInit(&strm,DS_START_ZLIB_LEVEL) != Z_OK)
+	{
+		Tango::Except::throw_exception((const char *)"DB_CompressionFailed",
+					(const char *)"Cannot initialize the zlib compression",
+					(const char *)"ServerData::to_compressed()");
+	}
+
+	unsigned long bound = deflateBound(&strm,total);
+	argout.encoded_data.length(4 + bound);
+	unsigned char *out_buf = argout.encoded_data.get_buffer();
+	out_buf[0] = (unsigned char)(total >> 24);
+	out_buf[1] = (unsigned char)(total >> 16);
+	out_buf[2] = (unsigned char)(total >> 8);
+	out_buf[3] = (unsigned char)total;
+
+	strm.next_out = out_buf + 4;
+	strm.avail_out = bound;
+
+	int ret;
+	if (buf != NULL)
+	{
+		strm.next_in = (Bytef *)buf;
+		strm.avail_in = len;
+		ret = deflate(&strm,Z_FINISH);
+	}
+	else
+	{
+		ret = Z_STREAM_END;
+		for (size_t i = 0;i < elts.size() && ret != Z_STREAM_ERROR;i++)
+		{
+			bool last = i == elts.size() - 1;
+			strm.next_in = (Bytef *)elts[i].c_str();
+			strm.avail_in = elts[i].size() + (last == true ? 0 : 1);
+			ret = deflate(&strm,last == true ? Z_FINISH : Z_NO_FLUSH);
+		}
+		if (elts.empty() == true)
+			ret = deflate(&strm,Z_FINISH);
+	}
+
+	unsigned long comp_size = strm.total_out;
+	deflateEnd(&strm);
+
+	if (ret != Z_STREAM_END)
+	{
+		TangoSys_OMemStream o;
+		o << "zlib compression failed (error " << ret << ")" << std::ends;
+		Tango::Except::throw_exception((const char *)"DB_CompressionFailed",o.str(),
+					(const char *)"ServerData::to_compressed()");
+	}
+
+	argout.encoded_data.length(4 + comp_size);
+}
+
+}	//	namespace
@@ -0,0 +1,300 @@
+//=============================================================================
+//
+// file :        ds_start.h
+//
+// description : Include for the C++ implementation of the ds_start stored
+//               procedure (DbGetDataForServerCache command).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _DS_START_H
+#define _DS_START_H
+
+#include <tango.h>
+#include <mysql.h>
+#include <random>
+
+//
+// Release of the ds_start stored procedure whose result format is
+// implemented here (the COMMENT of its CREATE command)
+//
+
+#define	DS_START_RELEASE			"release 1.13"
+#define	DEFAULT_DS_START_NATIVE		0
+#define	DEFAULT_DS_START_FAN_OUT	4
+
+//
+// DbGetDataForServerCacheChunk: Default number of elements per chunk,
+// number of devices whose properties are read at once, maximum number
+// of retrievals in progress and their timeout (in seconds)
+//
+
+#define	DEFAULT_DS_START_CHUNK_SIZE	10000
+#define	DS_START_STREAM_BATCH		256
+#define	DS_START_MAX_STREAM			64
+#define	DS_START_STREAM_TIMEOUT		60
+
+//
+// DbGetDataForServerCacheCompressed reply: The uncompressed size (4 bytes,
+// big endian) followed by the zlib stream. The fastest level is used, the
+// data being very repetitive
+//
+
+#define	DS_START_ZLIB_FORMAT		"ds_start_zlib"
+#define	DS_START_ZLIB_LEVEL			1
+
+namespace DataBase_ns {
+
+class DataBase;
+
+//=========================================================
+/**
+ *	Part of the DbGetDataForServerCache result which is the same for all
+ *	the servers: The DServer and Default class properties, the control
+ *	system properties (with the access control device) and the notifd
+ *	event data of each host. It is filled by the first DsStart object
+ *	which needs it and re-used by the next ones (DbGetDataForServerCacheList
+ *	command)
+ */
+//=========================================================
+class DsStartCommon
+{
+public:
+	DsStartCommon():class_props_done(false),ctrl_done(false) {}
+
+	bool										class_props_done;
+	std::vector<std::string>					class_props;
+	bool										ctrl_done;
+	std::vector<std::string>					ctrl;
+	std::map<std::string,std::vector<std::string> >	notifd;
+};
+
+//=========================================================
+/**
+ *	Build the DbGetDataForServerCache result without the ds_start
+ *	stored procedure.
+ *
+ *	The stored procedure reads the properties device per device and
+ *	builds its result with repeated CONCAT_WS/INSERT calls. Here, each
+ *	kind of data (device properties, device attribute properties,
+ *	class properties...) is read for the whole server with one
+ *	query. The queries are independent and are shared between the
+ *	caller and (fan out - 1) threads, each using its own connection
+ *	of the pool. A thread which does not find a free connection
+ *	leaves its queries to the others. The result is then assembled in
+ *	the stored procedure order.
+ *	The server name used in the queries must be escaped by the caller.
+ *	With a DsStartCommon object, the data common to all servers are
+ *	read only once.
+ *	The result can also be built by parts (build_chunk()). The device
+ *	properties are then read by batch of devices, the memory used does
+ *	not depend on the number of devices.
+ */
+//=========================================================
+class DsStart
+{
+public:
+	DsStart(DataBase *,const char *,const char *,const std::string &,int,DsStartCommon *common = NULL);
+	~DsStart();
+
+	void build(std::vector<std::string> &,int con_nb = -1);
+	bool build_chunk(std::vector<std::string> &,size_t,int);
+	bool run_next_query(int);
+
+	const std::string &get_ds_name() {return ds_name;}
+
+	static bool get_ca_device(const char *,std::string &);
+
+private:
+	enum QueryId
+	{
+		Q_DEV_ATT_PROP = 0,
+		Q_DEV_PROP,
+		Q_DEV_PIPE_PROP,
+		Q_CLASS_ATT_PROP,
+		Q_CLASS_PROP,
+		Q_CLASS_PIPE_PROP,
+		Q_DEV_LIST,
+		Q_CLASS_LIST,
+		Q_CTRL_PROP,
+		Q_NB
+	};
+
+	struct RowRange
+	{
+		RowRange():first(0),last(0) {}
+		size_t		first;
+		size_t		last;
+	};
+
+	struct Query
+	{
+		Query():result(NULL),failed(false),done(false) {}
+		std::string							sql;
+		MYSQL_RES							*result;
+		std::vector<MYSQL_ROW>				rows;
+		std::map<std::string,RowRange>		index;
+		bool								failed;
+		bool								done;
+		Tango::DevFailed					error;
+	};
+
+	void init_queries();
+	void build_data(int);
+	bool build_head(int);
+	bool build_step(int);
+	void build_ctrl(int);
+	void load_devices(size_t,size_t,int);
+	void reset_query(QueryId,const std::string &);
+	void run_queries(int);
+	void index_rows(Query &);
+	RowRange find_rows(QueryId,const std::string &);
+
+	bool import_device(const std::string &,int);
+	void import_event(const std::string &,int);
+	void add_obj_props(QueryId,const std::string &);
+	void add_obj_att_props(QueryId,const std::string &);
+	void add_props(Query &,size_t,size_t,int);
+	void add_count(size_t,long);
+
+	DataBase					*the_db;
+	std::string					ds_name;
+	std::string					sql_ds_name;
+	std::string					host;
+	std::string					adm_dev_name;
+	bool						ds_pipe;
+	int							fan_out;
+	DsStartCommon				*common;
+
+	Query						queries[Q_NB];
+	int							next_query;
+	omni_mutex					query_mutex;
+
+	std::vector<std::string>	*out;
+
+	bool						started;
+	size_t						batch;
+	std::vector<std::string>	class_list;
+	std::map<std::string,std::vector<std::string> >	class_devices;
+	size_t						cur_class;
+	size_t						cur_dev;
+	bool						class_started;
+	std::vector<std::string>	stream_devices;
+	size_t						dev_pos;
+	size_t						loaded_end;
+};
+
+//=========================================================
+/**
+ *	DsStart objects of the DbGetDataForServerCacheChunk retrievals in
+ *	progress, each one known by its continuation token (128 random
+ *	bits) and only given back for the server it was started for. An
+ *	object is removed from the map while it is used. Retrievals not
+ *	continued within DS_START_STREAM_TIMEOUT seconds are abandoned
+ */
+//=========================================================
+class DsStartStreams: public omni_mutex
+{
+public:
+	DsStartStreams() {}
+	~DsStartStreams();
+
+	std::string add(DsStart *);
+	DsStart *take(const std::string &,const char *);
+
+private:
+	typedef struct
+	{
+		DsStart		*ds_start;
+		time_t		stamp;
+	} Stream;
+
+	void remove_expired();
+
+	std::random_device				token_source;
+	std::map<std::string,Stream>	streams;
+};
+
+//=========================================================
+/**
+ *	Thread running DsStart queries with its own connection
+ */
+//=========================================================
+class DsStartWorker: public omni_thread
+{
+public:
+	DsStartWorker(DataBase *db,DsStart *ds):the_db(db),ds_start(ds) {}
+
+	void *run_undetached(void *);
+	void start() {start_undetached();}
+
+private:
+	DataBase	*the_db;
+	DsStart		*ds_start;
+};
+
+//=========================================================
+/**
+ *	DbGetDataForServerCache result of one server.
+ *
+ *	The ds_start stored procedure returns its result as a single string
+ *	whose elements are separated by '\0'. This string is kept in the
+ *	MySQL result buffer (freed by the destructor) and is copied only
+ *	once, directly in the command reply. Results coming from the cache
+ *	or from the DsStart class are given as a vector of strings.
+ */
+//=========================================================
+class ServerData
+{
+public:
+	ServerData():result(NULL),buf(NULL),len(0) {}
+	~ServerData();
+
+	void set_result(MYSQL_RES *,const char *,unsigned long);
+	unsigned long get_nb_elt();
+	bool contains(const char *);
+
+	void get_elts(std::vector<std::string> &);
+	void to_string_array(Tango::DevVarStringArray &);
+	void to_encoded(Tango::DevEncoded &);
+	void to_compressed(Tango::DevEncoded &);
+
+	std::vector<std::string>	elts;
+
+private:
+	MYSQL_RES					*result;
+	const char					*buf;
+	unsigned long				len;
+};
+
+}	//	namespace
+
+#endif	// _DS_START_H
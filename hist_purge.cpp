@@ -0,0 +1,155 @@
+//=============================================================================
+//
+// file :        hist_purge.cpp
+//
+// description : Queue of property history tables to purge and thread
+//               purging them when the purge is done in background.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+
+#include <DataBase.h>
+
+namespace DataBase_ns
+{
+
+//=============================================================================
+//=============================================================================
+PurgeQueue::PurgeQueue():stopped(false),stop_cond(this)
+{
+}
+//=============================================================================
+//=============================================================================
+void PurgeQueue::init()
+{
+	omni_mutex_lock sync(*this);
+	pending.clear();
+	stopped = false;
+}
+//=============================================================================
+//=============================================================================
+void PurgeQueue::add(const char *table,const std::string &cond)
+{
+	omni_mutex_lock sync(*this);
+	pending.insert(PurgeEntry(table,cond));
+}
+//=============================================================================
+//=============================================================================
+long PurgeQueue::get_size()
+{
+	omni_mutex_lock sync(*this);
+	return (long)pending.size();
+}
+//=============================================================================
+//	Wait for the period (or the stop request) and give the pending purges
+//	to the caller
+//=============================================================================
+void PurgeQueue::take(long ms,std::set<PurgeEntry> &entries)
+{
+	omni_mutex_lock sync(*this);
+
+	if (stopped == false)
+	{
+		unsigned long abs_s,abs_ns;
+		omni_thread::get_time(&abs_s,&abs_ns,ms / 1000,(ms % 1000) * 1000000);
+		stop_cond.timedwait(abs_s,abs_ns);
+	}
+
+	entries.swap(pending);
+	pending.clear();
+}
+//=============================================================================
+//=============================================================================
+void PurgeQueue::stop()
+{
+	omni_mutex_lock sync(*this);
+	stopped = true;
+	stop_cond.signal();
+}
+//=============================================================================
+//=============================================================================
+bool PurgeQueue::is_stopped()
+{
+	omni_mutex_lock sync(*this);
+	return stopped;
+}
+
+
+//=============================================================================
+//=============================================================================
+HistoryPurger::HistoryPurger(DataBase *db,PurgeQueue *q,long per):the_db(db),queue(q),period(per)
+{
+}
+//=============================================================================
+//	The purges still pending when the thread is asked to stop are done
+//	before it exits
+//=============================================================================
+void *HistoryPurger::run_undetached(TANGO_UNUSED(void *ptr))
+{
+	mysql_thread_init();
+
+	std::set<PurgeQueue::PurgeEntry> entries;
+	bool last_loop = false;
+	while (last_loop == false)
+	{
+		last_loop = queue->is_stopped();
+		queue->take(period * 1000,entries);
+		purge(entries);
+		entries.clear();
+	}
+
+	mysql_thread_end();
+	return NULL;
+}
+//=============================================================================
+//	A failing purge is only reported. It will be done again at the next
+//	put of the same property
+//=============================================================================
+void HistoryPurger::purge(std::set<PurgeQueue::PurgeEntry> &entries)
+{
+	std::set<PurgeQueue::PurgeEntry>::iterator ite;
+	for (ite = entries.begin();ite != entries.end();++ite)
+	{
+		try
+		{
+			the_db->purge_history(ite->first.c_str(),ite->second);
+		}
+		catch (Tango::DevFailed &e)
+		{
+			DB_ERROR_STREAM(the_db) << "HistoryPurger: purge of " << ite->first << " (" << ite->second << ") failed: "
+									<< e.errors[0].desc << std::endl;
+		}
+	}
+}
+
+}	//	namespace
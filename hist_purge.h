@@ -0,0 +1,109 @@
+//=============================================================================
+//
+// file :        hist_purge.h
+//
+// description : Include for the queue of property history tables to purge
+//               and for the thread purging them when the purge is done
+//               in background.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _HIST_PURGE_H
+#define _HIST_PURGE_H
+
+#include <tango.h>
+#include <set>
+
+#define	DEFAULT_HISTORY_PURGE_PERIOD	0			// s
+
+namespace DataBase_ns {
+
+class DataBase;
+
+//=========================================================
+/**
+ *	Property history purges requested by the put commands when the
+ *	purge is done in background.
+ *
+ *	A purge is identified by the history table and the SQL condition
+ *	selecting the property (object, name...). Requesting several times
+ *	the same purge before it is done does it only once.
+ */
+//=========================================================
+class PurgeQueue: public omni_mutex
+{
+public:
+	typedef std::pair<std::string,std::string>	PurgeEntry;
+
+	PurgeQueue();
+
+	void init();
+	void add(const char *,const std::string &);
+	long get_size();
+
+/**
+ *	Methods used by the HistoryPurger thread. take() waits at most the
+ *	given time (ms) and moves the pending purges in the caller set
+ */
+	void take(long,std::set<PurgeEntry> &);
+	void stop();
+	bool is_stopped();
+
+private:
+	std::set<PurgeEntry>	pending;
+	bool					stopped;
+	omni_condition			stop_cond;
+};
+
+//=========================================================
+/**
+ *	Thread purging the property history tables
+ */
+//=========================================================
+class HistoryPurger: public omni_thread
+{
+public:
+	HistoryPurger(DataBase *,PurgeQueue *,long);
+
+	void *run_undetached(void *);
+	void start() {start_undetached();}
+
+private:
+	void purge(std::set<PurgeQueue::PurgeEntry> &);
+
+	DataBase	*the_db;
+	PurgeQueue	*queue;
+	long		period;
+};
+
+}	//	namespace
+
+#endif	// _HIST_PURGE_H
@@ -0,0 +1,323 @@
+//=============================================================================
+//
+// file :        hist_writer.cpp
+//
+// description : Queue of property history records written asynchronously
+//               and thread writing them in the history tables.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+
+
+#include <DataBase.h>
+
+namespace DataBase_ns
+{
+
+//=============================================================================
+//=============================================================================
+HistoryQueue::HistoryQueue():delay(DEFAULT_HISTORY_WRITE_DELAY),max_size(DEFAULT_HISTORY_QUEUE_SIZE),
+							 stopped(false),last_seq(0),written_seq(0),taken_first(0),oldest_s(0),oldest_ns(0),
+							 push_cond(this),written_cond(this)
+{
+}
+//=============================================================================
+//=============================================================================
+void HistoryQueue::init(long queue_size,long write_delay)
+{
+	omni_mutex_lock sync(*this);
+
+	records.clear();
+	max_size = queue_size;
+	delay = write_delay;
+	stopped = false;
+	last_seq = 0;
+	written_seq = 0;
+	taken_first = 0;
+	failed.clear();
+	oldest_s = 0;
+	oldest_ns = 0;
+}
+//=============================================================================
+//	A set of records larger than the queue is accepted if the queue is
+//	empty
+//=============================================================================
+unsigned long long HistoryQueue::push(std::vector<HistRecord> &recs)
+{
+	omni_mutex_lock sync(*this);
+
+	if (stopped == true || (records.empty() == false && (long)(records.size() + recs.size()) > max_size))
+		return 0;
+
+	unsigned long now_s,now_ns;
+	omni_thread::get_time(&now_s,&now_ns);
+	for (unsigned int i = 0;i < recs.size();i++)
+		records.push_back(QueuedRecord(recs[i],++last_seq,now_s,now_ns));
+
+	push_cond.signal();
+	return last_seq;
+}
+//=============================================================================
+//	Wait until the writer has written up to the last given record. The
+//	failed batches are kept only while some records of them are waited
+//	for
+//=============================================================================
+bool HistoryQueue::wait_written(unsigned long long first,unsigned long long last)
+{
+	omni_mutex_lock sync(*this);
+
+	SeqRange range(first,last);
+	std::list<SeqRange>::iterator waiter = waiters.insert(waiters.end(),range);
+	while (written_seq < last && stopped == false)
+		written_cond.wait();
+	waiters.erase(waiter);
+
+	bool ok = true;
+	std::list<SeqRange>::iterator ite = failed.begin();
+	while (ite != failed.end())
+	{
+		if (overlap(*ite,range) == true)
+			ok = false;
+
+		bool waited = false;
+		for (waiter = waiters.begin();waiter != waiters.end() && waited == false;++waiter)
+			waited = overlap(*ite,*waiter);
+		if (waited == false)
+			ite = failed.erase(ite);
+		else
+			++ite;
+	}
+	return ok;
+}
+//=============================================================================
+//=============================================================================
+long HistoryQueue::get_depth()
+{
+	omni_mutex_lock sync(*this);
+	return (long)records.size();
+}
+//=============================================================================
+//	Age (ms) of the oldest record not written yet (the ones being written
+//	included), 0 if there is none
+//=============================================================================
+double HistoryQueue::get_lag()
+{
+	omni_mutex_lock sync(*this);
+
+	unsigned long s = oldest_s;
+	unsigned long ns = oldest_ns;
+	if (s == 0)
+	{
+		if (records.empty() == true)
+			return 0.0;
+		s = records.front().time_s;
+		ns = records.front().time_ns;
+	}
+
+	unsigned long now_s,now_ns;
+	omni_thread::get_time(&now_s,&now_ns);
+	return (double)(now_s - s) * 1.0e3 + ((double)now_ns - (double)ns) / 1.0e6;
+}
+//=============================================================================
+//	Wait for records to write and move (at most max_nb of) them in the
+//	caller vector. Return the sequence number of the last record taken,
+//	0 when the queue is stopped and empty
+//=============================================================================
+unsigned long long HistoryQueue::take(std::vector<HistRecord> &recs,long max_nb)
+{
+	omni_mutex_lock sync(*this);
+
+	while (true)
+	{
+		if (records.empty() == true)
+		{
+			if (stopped == true)
+				return 0;
+			push_cond.wait();
+			continue;
+		}
+
+		if (stopped == true || delay <= 0 || (long)records.size() >= max_nb)
+			break;
+
+		unsigned long abs_s = records.front().time_s + delay / 1000;
+		unsigned long abs_ns = records.front().time_ns + (delay % 1000) * 1000000;
+		if (abs_ns >= 1000000000)
+		{
+			abs_s++;
+			abs_ns -= 1000000000;
+		}
+
+		unsigned long now_s,now_ns;
+		omni_thread::get_time(&now_s,&now_ns);
+		if (now_s > abs_s || (now_s == abs_s && now_ns >= abs_ns))
+			break;
+		push_cond.timedwait(abs_s,abs_ns);
+	}
+
+	oldest_s = records.front().time_s;
+	oldest_ns = records.front().time_ns;
+	taken_first = records.front().seq;
+
+	unsigned long long seq = 0;
+	while (records.empty() == false && (long)recs.size() < max_nb)
+	{
+		recs.push_back(records.front().rec);
+		seq = records.front().seq;
+		records.pop_front();
+	}
+	return seq;
+}
+//=============================================================================
+//	The batch taken last is written (or failed if ok is false)
+//=============================================================================
+void HistoryQueue::written(unsigned long long seq,bool ok)
+{
+	omni_mutex_lock sync(*this);
+
+	SeqRange range(taken_first,seq);
+	if (ok == false)
+	{
+		for (std::list<SeqRange>::iterator ite = waiters.begin();ite != waiters.end();++ite)
+		{
+			if (overlap(*ite,range) == true)
+			{
+				failed.push_back(range);
+				break;
+			}
+		}
+	}
+	written_seq = seq;
+	oldest_s = 0;
+	oldest_ns = 0;
+	written_cond.broadcast();
+}
+//=============================================================================
+//=============================================================================
+void HistoryQueue::stop()
+{
+	omni_mutex_lock sync(*this);
+	stopped = true;
+	push_cond.signal();
+	written_cond.broadcast();
+}
+//=============================================================================
+//=============================================================================
+bool HistoryQueue::is_stopped()
+{
+	omni_mutex_lock sync(*this);
+	return stopped;
+}
+
+
+//=============================================================================
+//=============================================================================
+HistoryWriter::HistoryWriter(DataBase *db,HistoryQueue *q):the_db(db),queue(q)
+{
+}
+//=============================================================================
+//	The records still queued when the thread is asked to stop are written
+//	before it exits
+//=============================================================================
+void *HistoryWriter::run_undetached(TANGO_UNUSED(void *ptr))
+{
+	mysql_thread_init();
+
+	std::vector<HistRecord> batch;
+	unsigned long long seq;
+	while ((seq = queue->take(batch,HISTORY_WRITER_BATCH_SIZE)) != 0)
+	{
+		bool ok = write(batch);
+		queue->written(seq,ok);
+		batch.clear();
+	}
+
+	mysql_thread_end();
+	return NULL;
+}
+//=============================================================================
+//	Write a batch of records within one transaction (if the tables use
+//	InnoDB). A failing batch is logged and false is returned (the
+//	commands waiting for it then fail)
+//=============================================================================
+bool HistoryWriter::write(std::vector<HistRecord> &batch)
+{
+	int con_nb;
+	try
+	{
+		con_nb = the_db->get_connection();
+	}
+	catch (Tango::DevFailed &e)
+	{
+		DB_ERROR_STREAM(the_db) << "HistoryWriter: " << batch.size() << " history record(s) lost: " << e.errors[0].desc << std::endl;
+		return false;
+	}
+
+	bool ok = true;
+
+	bool transactional = the_db->is_transactional();
+	try
+	{
+		if (transactional == true)
+			the_db->simple_query("START TRANSACTION","HistoryWriter",con_nb);
+
+		for (unsigned int i = 0;i < batch.size();i++)
+		{
+			if (batch[i].table.empty() == true)
+				the_db->simple_query(batch[i].sql,"HistoryWriter",con_nb);
+			else
+				the_db->start_purge(batch[i].table.c_str(),batch[i].sql,con_nb);
+		}
+
+		if (transactional == true)
+			the_db->simple_query("COMMIT","HistoryWriter",con_nb);
+	}
+	catch (Tango::DevFailed &e)
+	{
+		DB_ERROR_STREAM(the_db) << "HistoryWriter: " << batch.size() << " history record(s) lost: " << e.errors[0].desc << std::endl;
+		ok = false;
+		if (transactional == true)
+		{
+			try
+			{
+				the_db->simple_query("ROLLBACK","HistoryWriter",con_nb);
+			}
+			catch (Tango::DevFailed &) {}
+		}
+	}
+
+	the_db->release_connection(con_nb);
+	return ok;
+}
+
+}	//	namespace
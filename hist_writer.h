@@ -0,0 +1,166 @@
+//=============================================================================
+//
+// file :        hist_writer.h
+//
+// description : Include for the queue of property history records written
+//               asynchronously and for the thread writing them in the
+//               history tables.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _HIST_WRITER_H
+#define _HIST_WRITER_H
+
+#include <tango.h>
+#include <deque>
+#include <list>
+
+#define	DEFAULT_HISTORY_WRITE_DELAY		-1			// ms, -1 means synchronous
+#define	DEFAULT_HISTORY_QUEUE_SIZE		10000
+#define	HISTORY_WRITER_BATCH_SIZE		500
+
+namespace DataBase_ns {
+
+class DataBase;
+
+//=========================================================
+/**
+ *	One history record: A multi-row INSERT statement for a history
+ *	table or, when table is set, the purge of one property in this
+ *	history table (sql is then the purge condition)
+ */
+//=========================================================
+struct HistRecord
+{
+	HistRecord(const std::string &t,const std::string &s):table(t),sql(s) {}
+
+	std::string		table;
+	std::string		sql;
+};
+
+//=========================================================
+/**
+ *	Bounded FIFO of the history records waiting to be written.
+ *
+ *	Records are pushed by the put commands once their transaction is
+ *	committed. Every record gets a sequence number, the put command can
+ *	wait until the writer has written up to its last record and know
+ *	whether the batches holding its records failed.
+ *	With a write delay of 0, the writer takes the records as soon as
+ *	they are pushed (the put commands wait for them). Otherwise, it
+ *	waits until the oldest record is older than the delay (ms) or
+ *	until a full batch is available.
+ */
+//=========================================================
+class HistoryQueue: public omni_mutex
+{
+public:
+	HistoryQueue();
+
+	void init(long,long);
+	long get_delay() {return delay;}
+
+/**
+ *	Queue the records. Return the sequence number of the last one,
+ *	0 if the queue is full (the caller then writes them itself)
+ */
+	unsigned long long push(std::vector<HistRecord> &);
+
+/**
+ *	Wait until the writer has written the records [first,last]. Return
+ *	false if one of them was in a batch which failed
+ */
+	bool wait_written(unsigned long long,unsigned long long);
+
+	long get_depth();
+	double get_lag();
+
+/**
+ *	Methods used by the HistoryWriter thread
+ */
+	unsigned long long take(std::vector<HistRecord> &,long);
+	void written(unsigned long long,bool);
+	void stop();
+	bool is_stopped();
+
+private:
+	struct QueuedRecord
+	{
+		QueuedRecord(HistRecord &r,unsigned long long nb,unsigned long s,unsigned long ns):
+			rec(r),seq(nb),time_s(s),time_ns(ns) {}
+		HistRecord				rec;
+		unsigned long long		seq;
+		unsigned long			time_s;
+		unsigned long			time_ns;
+	};
+
+	typedef std::pair<unsigned long long,unsigned long long> SeqRange;
+
+	static bool overlap(const SeqRange &r1,const SeqRange &r2) {return r1.first <= r2.second && r2.first <= r1.second;}
+
+	long						delay;
+	long						max_size;
+	bool						stopped;
+	unsigned long long			last_seq;
+	unsigned long long			written_seq;
+	unsigned long long			taken_first;	// First record of the batch being written
+	unsigned long				oldest_s;		// Oldest record not written yet (0 if none)
+	unsigned long				oldest_ns;
+	std::deque<QueuedRecord>	records;
+	std::list<SeqRange>			waiters;		// Records waited for
+	std::list<SeqRange>			failed;			// Failed batches still waited for
+	omni_condition				push_cond;
+	omni_condition				written_cond;
+};
+
+//=========================================================
+/**
+ *	Thread writing the history records on its own MySQL connection
+ */
+//=========================================================
+class HistoryWriter: public omni_thread
+{
+public:
+	HistoryWriter(DataBase *,HistoryQueue *);
+
+	void *run_undetached(void *);
+	void start() {start_undetached();}
+
+private:
+	bool write(std::vector<HistRecord> &);
+
+	DataBase		*the_db;
+	HistoryQueue	*queue;
+};
+
+}	//	namespace
+
+#endif	// _HIST_WRITER_H
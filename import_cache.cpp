@@ -0,0 +1,289 @@
+//=============================================================================
+//
+// file :        import_cache.cpp
+//
+// description : In-memory cache used to answer the DbImportDevice and
+//               DbImportEvent commands without accessing MySQL.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+#include <import_cache.h>
+
+namespace DataBase_ns
+{
+
+static std::string lower_string(const std::string &str)
+{
+	std::string lower(str);
+	std::transform(lower.begin(),lower.end(),lower.begin(),::tolower);
+	return lower;
+}
+
+//=============================================================================
+//=============================================================================
+ImportCache::ImportCache():timeout(DEFAULT_IMPORT_CACHE_TIMEOUT),epoch(0),nb_negative(0),nb_hit(0),nb_miss(0)
+{
+}
+//=============================================================================
+//=============================================================================
+void ImportCache::set_timeout(int ti)
+{
+	omni_mutex_lock sync(*this);
+	timeout = ti;
+	entries.clear();
+	alias_keys.clear();
+	nb_negative = 0;
+	epoch++;
+}
+//=============================================================================
+//=============================================================================
+unsigned long ImportCache::get_epoch()
+{
+	omni_mutex_lock sync(*this);
+	return epoch;
+}
+//=============================================================================
+//=============================================================================
+bool ImportCache::lookup(const std::string &key,ImportEntry &entry)
+{
+	omni_mutex_lock sync(*this);
+
+	if (timeout <= 0)
+		return false;
+
+	std::map<std::string,ImportEntry>::iterator ite = entries.find(key);
+	if (ite == entries.end())
+	{
+		nb_miss++;
+		return false;
+	}
+
+	if (time(NULL) - ite->second.stamp >= timeout)
+	{
+		erase(ite);
+		nb_miss++;
+		return false;
+	}
+
+	entry = ite->second;
+	nb_hit++;
+	return true;
+}
+//=============================================================================
+//	Number of lookups which found (or not) a valid entry
+//=============================================================================
+void ImportCache::get_stats(unsigned long long &hits,unsigned long long &misses)
+{
+	omni_mutex_lock sync(*this);
+	hits = nb_hit;
+	misses = nb_miss;
+}
+//=============================================================================
+//=============================================================================
+void ImportCache::insert(const std::string &key,ImportEntry &entry,unsigned long entry_epoch)
+{
+	omni_mutex_lock sync(*this);
+
+//
+// Something has been modified since the caller read MySQL. Its data
+// may be outdated, do not store them
+//
+
+	if (timeout <= 0 || entry_epoch != epoch)
+		return;
+
+	std::map<std::string,ImportEntry>::iterator ite = entries.find(key);
+	if (ite != entries.end())
+		erase(ite);
+
+	if (entry.defined == false)
+	{
+		if (nb_negative >= MAX_IMPORT_CACHE_NEGATIVE)
+		{
+			for (ite = entries.begin();ite != entries.end();)
+			{
+				if (ite->second.defined == false)
+					entries.erase(ite++);
+				else
+					++ite;
+			}
+			nb_negative = 0;
+		}
+		nb_negative++;
+	}
+	else if (entry.device != key)
+	{
+		std::map<std::string,std::string>::iterator pos = alias_keys.find(entry.device);
+		if (pos != alias_keys.end())
+		{
+			ite = entries.find(pos->second);
+			if (ite != entries.end())
+				erase(ite);
+		}
+		alias_keys[entry.device] = key;
+	}
+
+	entry.stamp = time(NULL);
+	entries[key] = entry;
+}
+//=============================================================================
+//=============================================================================
+void ImportCache::invalidate(const std::string &name)
+{
+	std::string key = lower_string(name);
+
+	omni_mutex_lock sync(*this);
+	epoch++;
+
+	std::map<std::string,ImportEntry>::iterator ite = entries.find(key);
+	if (ite != entries.end())
+		erase(ite);
+
+	std::map<std::string,std::string>::iterator pos = alias_keys.find(key);
+	if (pos != alias_keys.end())
+	{
+		ite = entries.find(pos->second);
+		if (ite != entries.end())
+			erase(ite);
+		else
+			alias_keys.erase(pos);
+	}
+}
+//=============================================================================
+//=============================================================================
+void ImportCache::invalidate_device(const std::string &pattern)
+{
+	std::string lower_pattern = lower_string(pattern);
+
+	if (lower_pattern.find_first_of("%_\\") == std::string::npos)
+	{
+		invalidate(lower_pattern);
+		return;
+	}
+
+	omni_mutex_lock sync(*this);
+	epoch++;
+
+	std::map<std::string,ImportEntry>::iterator ite;
+	for (ite = entries.begin();ite != entries.end();)
+	{
+		if (like_match(lower_pattern.c_str(),ite->first.c_str()) == true ||
+			(ite->second.defined == true && like_match(lower_pattern.c_str(),ite->second.device.c_str()) == true))
+			erase(ite++);
+		else
+			++ite;
+	}
+}
+//=============================================================================
+//=============================================================================
+void ImportCache::invalidate_server(const std::string &pattern)
+{
+	std::string lower_pattern = lower_string(pattern);
+
+	omni_mutex_lock sync(*this);
+	epoch++;
+
+	std::map<std::string,ImportEntry>::iterator ite;
+	for (ite = entries.begin();ite != entries.end();)
+	{
+		if (ite->second.defined == true && like_match(lower_pattern.c_str(),ite->second.server.c_str()) == true)
+			erase(ite++);
+		else
+			++ite;
+	}
+}
+//=============================================================================
+//=============================================================================
+void ImportCache::clear()
+{
+	omni_mutex_lock sync(*this);
+	epoch++;
+	entries.clear();
+	alias_keys.clear();
+	nb_negative = 0;
+}
+//=============================================================================
+//	Must be called with the cache mutex locked
+//=============================================================================
+void ImportCache::erase(std::map<std::string,ImportEntry>::iterator ite)
+{
+	if (ite->second.defined == false)
+		nb_negative--;
+	else if (ite->second.device != ite->first)
+		alias_keys.erase(ite->second.device);
+	entries.erase(ite);
+}
+//=============================================================================
+//	Case insensitive SQL LIKE matching ('%', '_' and '\' escape)
+//=============================================================================
+bool ImportCache::like_match(const char *pattern,const char *str)
+{
+	while (*pattern != '\0')
+	{
+		if (*pattern == '%')
+		{
+			while (*pattern == '%')
+				pattern++;
+			if (*pattern == '\0')
+				return true;
+			for (;*str != '\0';str++)
+			{
+				if (like_match(pattern,str) == true)
+					return true;
+			}
+			return false;
+		}
+
+		if (*str == '\0')
+			return false;
+
+		if (*pattern == '_')
+		{
+			pattern++;
+			str++;
+			continue;
+		}
+
+		if (*pattern == '\\' && *(pattern + 1) != '\0')
+			pattern++;
+
+		if (::tolower(*pattern) != ::tolower(*str))
+			return false;
+		pattern++;
+		str++;
+	}
+
+	return *str == '\0';
+}
+
+}	//	namespace
@@ -0,0 +1,120 @@
+//=============================================================================
+//
+// file :        import_cache.h
+//
+// description : Include for the in-memory cache used to answer the
+//               DbImportDevice and DbImportEvent commands without
+//               accessing MySQL.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _IMPORT_CACHE_H
+#define _IMPORT_CACHE_H
+
+#include <tango.h>
+#include <time.h>
+
+#define	DEFAULT_IMPORT_CACHE_TIMEOUT	10
+#define	MAX_IMPORT_CACHE_NEGATIVE		10000
+
+namespace DataBase_ns {
+
+//=========================================================
+/**
+ *	Cache of import info (DbImportDevice/DbImportEvent replies).
+ *
+ *	Entries are keyed by the lower case name given by the client
+ *	(device name, device alias or event channel name). Unknown names
+ *	are stored as negative entries.
+ *	Every command modifying the underlying table has to invalidate the
+ *	matching entries after its SQL statements have been executed.
+ *	An entry read from MySQL is stored only if no invalidation
+ *	happened since the caller got the epoch with get_epoch(), this
+ *	prevents a concurrent import to re-insert outdated data.
+ *	Entries also expire after a timeout to cover the case of several
+ *	Databaseds sharing the same MySQL database.
+ */
+//=========================================================
+class ImportCache: public omni_mutex
+{
+public:
+	typedef struct
+	{
+		bool						defined;
+		std::string					device;
+		std::string					server;
+		std::vector<std::string>	svalue;
+		std::vector<Tango::DevLong>	lvalue;
+		time_t						stamp;
+	} ImportEntry;
+
+	ImportCache();
+
+	void set_timeout(int);
+	bool is_enabled() {return timeout > 0;}
+	unsigned long get_epoch();
+
+	bool lookup(const std::string &,ImportEntry &);
+	void insert(const std::string &,ImportEntry &,unsigned long);
+	void get_stats(unsigned long long &,unsigned long long &);
+
+/**
+ *	Remove the entry for the given name (or alias) and the alias entry
+ *	of the device if any
+ */
+	void invalidate(const std::string &);
+/**
+ *	Remove all entries for devices matching a SQL LIKE pattern
+ */
+	void invalidate_device(const std::string &);
+/**
+ *	Remove all entries for devices of servers matching a SQL LIKE pattern
+ */
+	void invalidate_server(const std::string &);
+	void clear();
+
+	static bool like_match(const char *,const char *);
+
+private:
+	void erase(std::map<std::string,ImportEntry>::iterator);
+
+	int									timeout;
+	unsigned long						epoch;
+	long								nb_negative;
+	unsigned long long					nb_hit;
+	unsigned long long					nb_miss;
+	std::map<std::string,ImportEntry>	entries;
+	std::map<std::string,std::string>	alias_keys;
+};
+
+}	//	namespace
+
+#endif	// _IMPORT_CACHE_H
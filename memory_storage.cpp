@@ -0,0 +1,1537 @@
+//=============================================================================
+//
+// file :        memory_storage.cpp
+//
+// description : In-memory storage engine, with a write-ahead log and
+//               periodic snapshots on local disk.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+#include <DataBase.h>
+
+#include <fstream>
+#include <set>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+//
+// Records of the log and of the snapshot. A record is written as
+// "<seq> <op> <nb fields>\n" followed by "<length>\n<field>\n" for each
+// field. The operations are:
+//
+//	S	Snapshot header (first record of a snapshot, seq is the one of
+//		the last record included): format version
+//	R	Whole data of a device (snapshot and reload from MySQL): device,
+//		defined (0/1), [name, alias, exported, ior, version, pid, server,
+//		host, class if defined], properties
+//	E	DbExportDevice: device, ior, host, pid, version
+//	U	DbUnExportDevice: device
+//	P	DbPutDeviceProperty: device, properties
+//	D	DbDeleteDeviceProperty: device, property names
+//
+// Properties are written as their number followed, for each one, by its
+// name, its number of values and the values
+//
+
+#define	MEM_SNAPSHOT_VERSION		"1"
+
+namespace DataBase_ns
+{
+
+static std::string lower_string(const std::string &str)
+{
+	std::string lower(str);
+	std::transform(lower.begin(),lower.end(),lower.begin(),::tolower);
+	return lower;
+}
+
+//=============================================================================
+//	Encode a record at the end of the buffer
+//=============================================================================
+static void encode_record(const MemRecord &rec,std::string &buf)
+{
+	std::stringstream ss;
+	ss << rec.seq << ' ' << rec.op << ' ' << rec.fields.size() << '\n';
+	for (size_t i = 0;i < rec.fields.size();i++)
+		ss << rec.fields[i].size() << '\n' << rec.fields[i] << '\n';
+	buf += ss.str();
+}
+//=============================================================================
+//	Read a number followed by the given separator
+//=============================================================================
+static bool decode_number(const std::string &buf,size_t &pos,char sep,unsigned long long &nb)
+{
+	size_t start = pos;
+	nb = 0;
+	while (pos < buf.size() && buf[pos] >= '0' && buf[pos] <= '9')
+		nb = nb * 10 + (buf[pos++] - '0');
+	if (pos == start || pos >= buf.size() || buf[pos] != sep)
+		return false;
+	pos++;
+	return true;
+}
+//=============================================================================
+//	Decode the record at pos. Return false (pos unchanged) if the buffer
+//	does not hold a complete record
+//=============================================================================
+static bool decode_record(const std::string &buf,size_t &pos,MemRecord &rec)
+{
+	size_t p = pos;
+	unsigned long long nb_fields;
+
+	if (decode_number(buf,p,' ',rec.seq) == false || p + 2 > buf.size() || buf[p + 1] != ' ')
+		return false;
+	rec.op = buf[p];
+	p = p + 2;
+	if (decode_number(buf,p,'\n',nb_fields) == false)
+		return false;
+
+	rec.fields.clear();
+	for (unsigned long long i = 0;i < nb_fields;i++)
+	{
+		unsigned long long len;
+		if (decode_number(buf,p,'\n',len) == false || p + len >= buf.size() || buf[p + len] != '\n')
+			return false;
+		rec.fields.push_back(buf.substr(p,len));
+		p = p + len + 1;
+	}
+
+	pos = p;
+	return true;
+}
+//=============================================================================
+//=============================================================================
+static std::string long_to_string(long val)
+{
+	std::stringstream ss;
+	ss << val;
+	return ss.str();
+}
+//=============================================================================
+//	Add properties to a record
+//=============================================================================
+static void encode_props(const std::vector<DbProperty> &props,MemRecord &rec)
+{
+	rec.fields.push_back(long_to_string(props.size()));
+	for (size_t i = 0;i < props.size();i++)
+	{
+		rec.fields.push_back(props[i].name);
+		rec.fields.push_back(long_to_string(props[i].values.size()));
+		rec.fields.insert(rec.fields.end(),props[i].values.begin(),props[i].values.end());
+	}
+}
+//=============================================================================
+//	Get the properties of a record, starting at field idx
+//=============================================================================
+static bool decode_props(const MemRecord &rec,size_t idx,std::vector<DbProperty> &props)
+{
+	if (idx >= rec.fields.size())
+		return false;
+	long nb_props = atol(rec.fields[idx++].c_str());
+
+	props.clear();
+	props.resize(nb_props);
+	for (long i = 0;i < nb_props;i++)
+	{
+		if (idx + 2 > rec.fields.size())
+			return false;
+		props[i].name = rec.fields[idx];
+		size_t nb_values = atol(rec.fields[idx + 1].c_str());
+		idx = idx + 2;
+		if (idx + nb_values > rec.fields.size())
+			return false;
+		props[i].values.assign(rec.fields.begin() + idx,rec.fields.begin() + idx + nb_values);
+		idx = idx + nb_values;
+	}
+	return true;
+}
+//=============================================================================
+//	Is the given (absolute) time reached ?
+//=============================================================================
+static bool time_reached(unsigned long abs_s,unsigned long abs_ns)
+{
+	unsigned long now_s,now_ns;
+	omni_thread::get_time(&now_s,&now_ns);
+	return now_s > abs_s || (now_s == abs_s && now_ns >= abs_ns);
+}
+//=============================================================================
+//	Do the names of the PropMap entry match a property name given to
+//	DbGetDeviceProperty/DbDeleteDeviceProperty (* as wildcard) ?
+//=============================================================================
+static bool prop_match(const std::string &name,const std::string &pattern,const std::string &key)
+{
+	if (name.find('*') == std::string::npos)
+		return key == lower_string(name);
+	return ImportCache::like_match(pattern.c_str(),key.c_str());
+}
+
+
+//=============================================================================
+//=============================================================================
+MirrorQueue::MirrorQueue():stopped(false),mirrored_seq(0),push_cond(this),mirrored_cond(this)
+{
+}
+//=============================================================================
+//=============================================================================
+void MirrorQueue::init(unsigned long long seq)
+{
+	omni_mutex_lock sync(*this);
+
+	records.clear();
+	stopped = false;
+	mirrored_seq = seq;
+}
+//=============================================================================
+//=============================================================================
+void MirrorQueue::push(const MemRecord &rec)
+{
+	omni_mutex_lock sync(*this);
+
+	records.push_back(rec);
+	push_cond.signal();
+}
+//=============================================================================
+//	Wait until the records up to the given one have been applied to MySQL,
+//	until the given (absolute) time
+//=============================================================================
+bool MirrorQueue::wait_mirrored(unsigned long long seq,unsigned long abs_s,unsigned long abs_ns)
+{
+	omni_mutex_lock sync(*this);
+	while (mirrored_seq < seq && stopped == false)
+	{
+		if (time_reached(abs_s,abs_ns) == true)
+			return false;
+		mirrored_cond.timedwait(abs_s,abs_ns);
+	}
+	return true;
+}
+//=============================================================================
+//=============================================================================
+long MirrorQueue::get_depth()
+{
+	omni_mutex_lock sync(*this);
+	return (long)records.size();
+}
+//=============================================================================
+//=============================================================================
+unsigned long long MirrorQueue::get_mirrored()
+{
+	omni_mutex_lock sync(*this);
+	return mirrored_seq;
+}
+//=============================================================================
+//	Wait for a record until the given (absolute) time
+//=============================================================================
+int MirrorQueue::take(MemRecord &rec,unsigned long abs_s,unsigned long abs_ns)
+{
+	omni_mutex_lock sync(*this);
+
+	while (records.empty() == true)
+	{
+		if (stopped == true)
+			return -1;
+		if (time_reached(abs_s,abs_ns) == true)
+			return 0;
+		push_cond.timedwait(abs_s,abs_ns);
+	}
+
+	rec = records.front();
+	records.pop_front();
+	return 1;
+}
+//=============================================================================
+//=============================================================================
+bool MirrorQueue::pause(long ms)
+{
+	omni_mutex_lock sync(*this);
+
+	unsigned long abs_s,abs_ns;
+	omni_thread::get_time(&abs_s,&abs_ns,ms / 1000,(ms % 1000) * 1000000);
+	while (stopped == false && time_reached(abs_s,abs_ns) == false)
+		push_cond.timedwait(abs_s,abs_ns);
+	return stopped == false;
+}
+//=============================================================================
+//=============================================================================
+void MirrorQueue::mirrored(unsigned long long seq)
+{
+	omni_mutex_lock sync(*this);
+	mirrored_seq = seq;
+	mirrored_cond.broadcast();
+}
+//=============================================================================
+//=============================================================================
+void MirrorQueue::stop()
+{
+	omni_mutex_lock sync(*this);
+	stopped = true;
+	push_cond.signal();
+	mirrored_cond.broadcast();
+}
+
+
+//=============================================================================
+//	The files are named after the device server instance so that several
+//	Databaseds may share the same directory
+//=============================================================================
+MemoryStorage::MemoryStorage(DataBase *db,DbStorage *mysql,const std::string &dir,long period,bool sync,long sync_tmo):
+	the_db(db),backing(mysql),snapshot_period(period),wal_sync(sync),sync_timeout(sync_tmo),wal_fd(-1),mark_fd(-1),wal_size(0),last_seq(0),wal_broken(false),
+	commit_cond(&commit_mutex),committing(false),committed_seq(0),failed_seq(0),commit_errno(0),applied_seq(0),thread(NULL)
+{
+	std::string base = dir + "/databaseds_" + Tango::Util::instance()->get_ds_inst_name();
+	snap_file = base + ".snap";
+	wal_file = base + ".wal";
+	old_wal_file = base + ".wal.1";
+	mark_file = base + ".mirrored";
+}
+//=============================================================================
+//	The records still queued are applied to MySQL before the thread exits,
+//	unless MySQL fails (they are then applied at the next startup)
+//=============================================================================
+MemoryStorage::~MemoryStorage()
+{
+	if (thread != NULL)
+	{
+		mirror_queue.stop();
+		thread->join(NULL);
+		thread = NULL;
+
+		unsigned long long mirrored = mirror_queue.get_mirrored();
+		if (mirrored < last_seq)
+		{
+			DB_WARN_STREAM(the_db) << "MemoryStorage: Records " << mirrored + 1 << " to " << last_seq
+								   << " not applied to MySQL, kept in the log for the next startup" << std::endl;
+		}
+	}
+
+	if (wal_fd != -1)
+		::close(wal_fd);
+	if (mark_fd != -1)
+		::close(mark_fd);
+	delete backing;
+}
+//=============================================================================
+//	Give back the MySQL engine (used if open() failed)
+//=============================================================================
+DbStorage *MemoryStorage::release_backing()
+{
+	DbStorage *tmp = backing;
+	backing = NULL;
+	return tmp;
+}
+//=============================================================================
+//	Replay the snapshot and the logs, load MySQL data if there is no
+//	snapshot, then start from a new snapshot and a log holding only the
+//	records not applied to MySQL yet
+//=============================================================================
+void MemoryStorage::open()
+{
+	unsigned long long snap_seq = 0;
+	std::map<unsigned long long,MemRecord> to_mirror;
+	bool has_snapshot = replay(snap_file,false,snap_seq,to_mirror);
+	last_seq = snap_seq;
+	replay(old_wal_file,true,snap_seq,to_mirror);
+	replay(wal_file,true,snap_seq,to_mirror);
+
+	if (has_snapshot == false)
+		seed();
+
+//
+// A mark above the last record is left by files removed since, all the
+// records replayed are then applied to MySQL
+//
+
+	unsigned long long mirrored_seq = read_mark();
+	if (mirrored_seq > last_seq)
+		mirrored_seq = 0;
+	to_mirror.erase(to_mirror.begin(),to_mirror.upper_bound(mirrored_seq));
+	if (to_mirror.empty() == true)
+		mirrored_seq = last_seq;
+	committed_seq = last_seq;
+	applied_seq = last_seq;
+
+	DB_INFO_STREAM(the_db) << "MemoryStorage: " << devices.size() << " devices, " << properties.size()
+						   << " devices with properties loaded" << std::endl;
+
+	std::string buf;
+	MemRecord header('S');
+	header.seq = last_seq;
+	header.fields.push_back(MEM_SNAPSHOT_VERSION);
+	encode_record(header,buf);
+
+	std::set<std::string> keys;
+	std::map<std::string,MemDevice>::iterator dev_ite;
+	for (dev_ite = devices.begin();dev_ite != devices.end();++dev_ite)
+		keys.insert(dev_ite->first);
+	std::map<std::string,PropMap>::iterator prop_ite;
+	for (prop_ite = properties.begin();prop_ite != properties.end();++prop_ite)
+		keys.insert(prop_ite->first);
+
+	std::set<std::string>::iterator key_ite;
+	for (key_ite = keys.begin();key_ite != keys.end();++key_ite)
+	{
+		MemRecord rec;
+		dump_device(*key_ite,rec);
+		encode_record(rec,buf);
+	}
+	write_snapshot(buf,last_seq);
+
+//
+// The new log replaces the previous ones once written (a crash in between
+// leaves records in both, replayed once)
+//
+
+	std::string wal_buf;
+	std::map<unsigned long long,MemRecord>::iterator rec_ite;
+	for (rec_ite = to_mirror.begin();rec_ite != to_mirror.end();++rec_ite)
+		encode_record(rec_ite->second,wal_buf);
+	write_file(wal_file,wal_buf);
+	::unlink(old_wal_file.c_str());
+	open_wal();
+	open_mark(mirrored_seq);
+
+	mirror_queue.init(mirrored_seq);
+	for (rec_ite = to_mirror.begin();rec_ite != to_mirror.end();++rec_ite)
+	{
+		note_seq(rec_ite->second);
+		mirror_queue.push(rec_ite->second);
+	}
+	if (to_mirror.empty() == false)
+	{
+		DB_INFO_STREAM(the_db) << "MemoryStorage: " << to_mirror.size() << " logged record(s) to apply to MySQL (from record "
+							   << to_mirror.begin()->first << ")" << std::endl;
+	}
+
+	thread = new MemoryStorageThread(this,&mirror_queue);
+	thread->start();
+}
+//=============================================================================
+//	Apply the records of a snapshot or of a log. Only the log records more
+//	recent than the snapshot are applied in memory, all of them are added
+//	to the records to apply to MySQL (open() keeps the ones after the mark).
+//	Return false if the file does not exist
+//=============================================================================
+bool MemoryStorage::replay(const std::string &file,bool is_log,unsigned long long &snap_seq,
+						   std::map<unsigned long long,MemRecord> &to_mirror)
+{
+	std::ifstream in(file.c_str(),std::ios::in | std::ios::binary);
+	if (!in)
+		return false;
+
+	std::stringstream ss;
+	ss << in.rdbuf();
+	std::string buf = ss.str();
+
+	size_t pos = 0;
+	long nb = 0;
+	MemRecord rec;
+	while (pos < buf.size())
+	{
+		if (decode_record(buf,pos,rec) == false)
+		{
+			if (is_log == false)
+			{
+				TangoSys_OMemStream o;
+				o << "Snapshot file " << file << " is corrupted (offset " << pos << ")" << std::ends;
+				Tango::Except::throw_exception((const char *)"DB_MemoryStorageError",o.str(),
+											   (const char *)"MemoryStorage::open()");
+			}
+
+//
+// The end of a log can be a partly written record (crash during the write)
+//
+
+			DB_WARN_STREAM(the_db) << "MemoryStorage: " << buf.size() - pos << " bytes of incomplete record ignored at the end of " << file << std::endl;
+			break;
+		}
+
+		if (is_log == false)
+		{
+			if (nb == 0)
+			{
+				if (rec.op != 'S' || rec.fields.empty() == true || rec.fields[0] != MEM_SNAPSHOT_VERSION)
+				{
+					TangoSys_OMemStream o;
+					o << "File " << file << " is not a snapshot or has an unsupported format" << std::ends;
+					Tango::Except::throw_exception((const char *)"DB_MemoryStorageError",o.str(),
+												   (const char *)"MemoryStorage::open()");
+				}
+				snap_seq = rec.seq;
+			}
+			else
+				apply(rec);
+		}
+		else
+		{
+			if (rec.seq > snap_seq)
+				apply(rec);
+			if (rec.op != 'R')
+				to_mirror[rec.seq] = rec;
+			if (rec.seq > last_seq)
+				last_seq = rec.seq;
+		}
+		nb++;
+	}
+
+	DB_INFO_STREAM(the_db) << "MemoryStorage: " << nb << " records read from " << file << std::endl;
+	return true;
+}
+//=============================================================================
+//	Load the device and property_device tables
+//=============================================================================
+void MemoryStorage::seed()
+{
+	MYSQL_RES *result;
+	MYSQL_ROW row;
+
+	devices.clear();
+	aliases.clear();
+	properties.clear();
+
+	result = the_db->query("SELECT name,alias,exported,ior,version,pid,server,host,class FROM device",
+						   "MemoryStorage::seed()");
+	while ((row = mysql_fetch_row(result)) != NULL)
+	{
+		std::string key = lower_string(row[0]);
+		MemDevice &dev = devices[key];
+		dev.info.name = row[0];
+		dev.alias = row[1] != NULL ? row[1] : "";
+		dev.info.exported = row[2] != NULL ? atol(row[2]) : 0;
+		dev.info.ior = row[3] != NULL ? row[3] : "";
+		dev.info.version = row[4] != NULL ? row[4] : "";
+		dev.info.pid = row[5] != NULL ? atol(row[5]) : 0;
+		dev.info.server = row[6] != NULL ? row[6] : "";
+		dev.info.host = row[7] != NULL ? row[7] : "";
+		dev.info.class_name = row[8] != NULL ? row[8] : "";
+		if (dev.alias.empty() == false)
+			aliases[lower_string(dev.alias)] = key;
+	}
+	mysql_free_result(result);
+
+	result = the_db->query("SELECT device,name,value FROM property_device ORDER BY device,name,count",
+						   "MemoryStorage::seed()");
+	while ((row = mysql_fetch_row(result)) != NULL)
+	{
+		DbProperty &prop = properties[lower_string(row[0])][lower_string(row[1])];
+		prop.name = row[1];
+		prop.values.push_back(row[2] != NULL ? row[2] : "");
+	}
+	mysql_free_result(result);
+}
+//=============================================================================
+//	Build the R record of a device from MySQL
+//=============================================================================
+void MemoryStorage::load_device(const std::string &key,MemRecord &rec)
+{
+	TangoSys_MemStream sql_query_stream;
+	MYSQL_RES *result;
+	MYSQL_ROW row;
+
+	rec.op = 'R';
+	rec.fields.clear();
+	rec.fields.push_back(key);
+
+	sql_query_stream << "SELECT name,alias,exported,ior,version,pid,server,host,class FROM device WHERE name=\""
+					 << key << "\"";
+	result = the_db->query(sql_query_stream.str(),"MemoryStorage::reload_devices()");
+	if ((row = mysql_fetch_row(result)) != NULL)
+	{
+		rec.fields.push_back("1");
+		for (int i = 0;i < 9;i++)
+			rec.fields.push_back(row[i] != NULL ? row[i] : (i == 2 || i == 5 ? "0" : ""));
+	}
+	else
+		rec.fields.push_back("0");
+	mysql_free_result(result);
+
+	sql_query_stream.str("");
+	sql_query_stream << "SELECT name,value FROM property_device WHERE device=\"" << key << "\" ORDER BY name,count";
+	result = the_db->query(sql_query_stream.str(),"MemoryStorage::reload_devices()");
+
+	std::vector<DbProperty> props;
+	while ((row = mysql_fetch_row(result)) != NULL)
+	{
+		if (props.empty() == true || props.back().name != row[0])
+		{
+			props.push_back(DbProperty());
+			props.back().name = row[0];
+		}
+		props.back().values.push_back(row[1] != NULL ? row[1] : "");
+	}
+	mysql_free_result(result);
+	encode_props(props,rec);
+}
+//=============================================================================
+//	Build the R record of a device from memory (object mutex locked)
+//=============================================================================
+void MemoryStorage::dump_device(const std::string &key,MemRecord &rec)
+{
+	rec.op = 'R';
+	rec.seq = 0;
+	rec.fields.clear();
+	rec.fields.push_back(key);
+
+	std::map<std::string,MemDevice>::iterator dev_ite = devices.find(key);
+	if (dev_ite != devices.end())
+	{
+		const DbDeviceInfo &info = dev_ite->second.info;
+		rec.fields.push_back("1");
+		rec.fields.push_back(info.name);
+		rec.fields.push_back(dev_ite->second.alias);
+		rec.fields.push_back(long_to_string(info.exported));
+		rec.fields.push_back(info.ior);
+		rec.fields.push_back(info.version);
+		rec.fields.push_back(long_to_string(info.pid));
+		rec.fields.push_back(info.server);
+		rec.fields.push_back(info.host);
+		rec.fields.push_back(info.class_name);
+	}
+	else
+		rec.fields.push_back("0");
+
+	std::vector<DbProperty> props;
+	std::map<std::string,PropMap>::iterator prop_ite = properties.find(key);
+	if (prop_ite != properties.end())
+	{
+		PropMap::iterator ite;
+		for (ite = prop_ite->second.begin();ite != prop_ite->second.end();++ite)
+			props.push_back(ite->second);
+	}
+	encode_props(props,rec);
+}
+//=============================================================================
+//	Apply a record in memory (object mutex locked or during open())
+//=============================================================================
+void MemoryStorage::apply(const MemRecord &rec)
+{
+	const std::vector<std::string> &f = rec.fields;
+	if (f.empty() == true)
+		return;
+	std::string key = lower_string(f[0]);
+
+	switch (rec.op)
+	{
+	case 'R':
+	{
+		std::map<std::string,MemDevice>::iterator dev_ite = devices.find(key);
+		if (dev_ite != devices.end())
+		{
+			if (dev_ite->second.alias.empty() == false)
+				aliases.erase(lower_string(dev_ite->second.alias));
+			devices.erase(dev_ite);
+		}
+		properties.erase(key);
+
+		size_t idx = 2;
+		if (f.size() > 1 && f[1] == "1")
+		{
+			if (f.size() < 11)
+				return;
+			MemDevice &dev = devices[key];
+			dev.info.name = f[2];
+			dev.alias = f[3];
+			dev.info.exported = atol(f[4].c_str());
+			dev.info.ior = f[5];
+			dev.info.version = f[6];
+			dev.info.pid = atol(f[7].c_str());
+			dev.info.server = f[8];
+			dev.info.host = f[9];
+			dev.info.class_name = f[10];
+			if (dev.alias.empty() == false)
+				aliases[lower_string(dev.alias)] = key;
+			idx = 11;
+		}
+
+		std::vector<DbProperty> props;
+		if (decode_props(rec,idx,props) == true && props.empty() == false)
+		{
+			PropMap &prop_map = properties[key];
+			for (size_t i = 0;i < props.size();i++)
+				prop_map[lower_string(props[i].name)] = props[i];
+		}
+		break;
+	}
+
+	case 'E':
+	{
+		std::map<std::string,MemDevice>::iterator dev_ite = devices.find(key);
+		if (dev_ite == devices.end() || f.size() < 5)
+			return;
+		DbDeviceInfo &info = dev_ite->second.info;
+		info.exported = 1;
+		info.ior = f[1];
+		info.host = f[2];
+		info.pid = atol(f[3].c_str());
+		info.version = f[4];
+		break;
+	}
+
+	case 'U':
+	{
+		std::map<std::string,MemDevice>::iterator dev_ite = devices.find(key);
+		if (dev_ite != devices.end())
+			dev_ite->second.info.exported = 0;
+		break;
+	}
+
+	case 'P':
+	{
+		std::vector<DbProperty> props;
+		if (decode_props(rec,1,props) == false)
+			return;
+		PropMap &prop_map = properties[key];
+		for (size_t i = 0;i < props.size();i++)
+		{
+			if (props[i].values.empty() == true)
+				prop_map.erase(lower_string(props[i].name));
+			else
+				prop_map[lower_string(props[i].name)] = props[i];
+		}
+		if (prop_map.empty() == true)
+			properties.erase(key);
+		break;
+	}
+
+	case 'D':
+	{
+		std::map<std::string,PropMap>::iterator prop_ite = properties.find(key);
+		if (prop_ite == properties.end())
+			return;
+		for (size_t i = 1;i < f.size();i++)
+		{
+			std::string pattern = lower_string(replace_wildcard(f[i].c_str()));
+			PropMap::iterator ite;
+			for (ite = prop_ite->second.begin();ite != prop_ite->second.end();)
+			{
+				if (prop_match(f[i],pattern,ite->first) == true)
+					prop_ite->second.erase(ite++);
+				else
+					++ite;
+			}
+		}
+		if (prop_ite->second.empty() == true)
+			properties.erase(prop_ite);
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+//=============================================================================
+//	Apply a record to MySQL. Return false if MySQL failed (the record is to
+//	be tried again). A record MySQL rejects (device removed meanwhile...) is
+//	only reported
+//=============================================================================
+bool MemoryStorage::mirror(const MemRecord &rec)
+{
+	const std::vector<std::string> &f = rec.fields;
+	try
+	{
+		switch (rec.op)
+		{
+		case 'E':
+			if (f.size() >= 5)
+				backing->export_device(f[0],f[1].c_str(),f[2].c_str(),f[3].c_str(),f[4].c_str(),NULL);
+			break;
+
+		case 'U':
+			if (f.size() >= 1)
+				backing->unexport_device(f[0]);
+			break;
+
+		case 'P':
+		{
+			std::vector<DbProperty> props;
+			if (decode_props(rec,1,props) == true)
+				backing->put_device_property(f[0].c_str(),props);
+			break;
+		}
+
+		case 'D':
+			if (f.size() >= 2)
+			{
+				std::vector<std::string> names(f.begin() + 1,f.end());
+				backing->delete_device_property(f[0].c_str(),names);
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+	catch (Tango::DevFailed &e)
+	{
+		std::string reason(e.errors[0].reason.in());
+		bool retry = reason == DB_SQLError || reason == DB_NoFreeMySQLConnection;
+		DB_ERROR_STREAM(the_db) << "MemoryStorage: Record " << rec.seq << " (" << rec.op << " " << (f.empty() == true ? "" : f[0])
+								<< ") not applied to MySQL" << (retry == true ? " (will be tried again): " : ": ")
+								<< e.errors[0].desc << std::endl;
+		return retry == false;
+	}
+	return true;
+}
+//=============================================================================
+//	Mark the last record applied to MySQL (the next ones are applied again
+//	at startup). The mark has a fixed size and is overwritten in place
+//=============================================================================
+void MemoryStorage::mark_mirrored(unsigned long long seq)
+{
+	char buf[32];
+	int len = snprintf(buf,sizeof(buf),"%020llu\n",seq);
+	if (::pwrite(mark_fd,buf,len,0) != len || (wal_sync == true && ::fdatasync(mark_fd) != 0))
+	{
+		DB_WARN_STREAM(the_db) << "MemoryStorage: Failed to write in " << mark_file << " (error=" << strerror(errno)
+							   << "), the records up to " << seq << " may be applied to MySQL again at startup" << std::endl;
+	}
+}
+//=============================================================================
+//	Return the last record marked as applied to MySQL, 0 if none
+//=============================================================================
+unsigned long long MemoryStorage::read_mark()
+{
+	std::ifstream in(mark_file.c_str());
+	unsigned long long seq = 0;
+	if (!(in >> seq))
+		seq = 0;
+	return seq;
+}
+//=============================================================================
+//=============================================================================
+void MemoryStorage::open_mark(unsigned long long seq)
+{
+	mark_fd = ::open(mark_file.c_str(),O_WRONLY | O_CREAT,0644);
+	if (mark_fd == -1)
+	{
+		TangoSys_OMemStream o;
+		o << "Can't open " << mark_file << " (error=" << strerror(errno) << ")" << std::ends;
+		Tango::Except::throw_exception((const char *)"DB_MemoryStorageError",o.str(),
+									   (const char *)"MemoryStorage::open_mark()");
+	}
+	mark_mirrored(seq);
+}
+//=============================================================================
+//	Append a record to the log (wal_mutex locked), without syncing it. The
+//	record is cut from the log if it cannot be fully written. commit() then
+//	syncs it and applies it. Return its sequence number
+//=============================================================================
+unsigned long long MemoryStorage::append(MemRecord &rec)
+{
+	if (wal_broken == true)
+	{
+		omni_mutex_lock cl(commit_mutex);
+		TangoSys_OMemStream o;
+		o << "Writes refused since " << wal_file << " could not be synced (error=" << strerror(commit_errno)
+		  << "), the DB server must be restarted" << std::ends;
+		Tango::Except::throw_exception((const char *)"DB_MemoryStorageError",o.str(),
+									   (const char *)"MemoryStorage::append()");
+	}
+
+	rec.seq = last_seq + 1;
+	std::string buf;
+	encode_record(rec,buf);
+
+	size_t done = 0;
+	while (done < buf.size())
+	{
+		ssize_t nb = ::write(wal_fd,buf.data() + done,buf.size() - done);
+		if (nb < 0 && errno == EINTR)
+			continue;
+		if (nb <= 0)
+			break;
+		done = done + nb;
+	}
+
+	if (done != buf.size())
+	{
+		int err = errno;
+		if (::ftruncate(wal_fd,wal_size) == 0)
+			::lseek(wal_fd,wal_size,SEEK_SET);
+
+		TangoSys_OMemStream o;
+		o << "Failed to write in " << wal_file << " (error=" << strerror(err) << ")" << std::ends;
+		Tango::Except::throw_exception((const char *)"DB_MemoryStorageError",o.str(),
+									   (const char *)"MemoryStorage::append()");
+	}
+
+	wal_size = wal_size + buf.size();
+	last_seq = rec.seq;
+	note_seq(rec);
+	unsynced.push_back(rec);
+	return rec.seq;
+}
+//=============================================================================
+//	Group commit: Wait until the log is synced up to the given record and
+//	the record applied (no lock held). The first waiting writer syncs the
+//	log for all the records written so far, applies them in memory and
+//	queues them for MySQL, in their order, the writers arriving meanwhile
+//	wait for the next sync. A failed sync leaves the log in an unknown
+//	state, the writes are then refused
+//=============================================================================
+void MemoryStorage::commit(unsigned long long seq)
+{
+	omni_mutex_lock cl(commit_mutex);
+
+	while (committed_seq < seq)
+	{
+		if (committing == true)
+		{
+			commit_cond.wait();
+			continue;
+		}
+		committing = true;
+		commit_mutex.unlock();
+
+//
+// The log file descriptor is duplicated, a snapshot may replace the log
+// during the sync
+//
+
+		std::vector<MemRecord> batch;
+		int fd = -1;
+		int err = 0;
+		{
+			omni_mutex_lock wl(wal_mutex);
+			batch.swap(unsynced);
+			if (wal_sync == true && (fd = ::dup(wal_fd)) == -1)
+				err = errno;
+		}
+		if (fd != -1)
+		{
+			if (::fdatasync(fd) != 0)
+				err = errno;
+			::close(fd);
+		}
+
+		if (err == 0)
+		{
+			{
+				omni_mutex_lock sync(*this);
+				for (size_t i = 0;i < batch.size();i++)
+					apply(batch[i]);
+				if (batch.empty() == false)
+					applied_seq = batch.back().seq;
+			}
+			for (size_t i = 0;i < batch.size();i++)
+				mirror_queue.push(batch[i]);
+		}
+		else
+		{
+			omni_mutex_lock wl(wal_mutex);
+			wal_broken = true;
+			batch.insert(batch.end(),unsynced.begin(),unsynced.end());
+			unsynced.clear();
+			DB_ERROR_STREAM(the_db) << "MemoryStorage: Failed to sync " << wal_file << " (error=" << strerror(err)
+									<< "), writes refused until the DB server is restarted" << std::endl;
+		}
+
+		commit_mutex.lock();
+		if (err != 0 && batch.empty() == false && failed_seq == 0)
+		{
+			failed_seq = batch.front().seq;
+			commit_errno = err;
+		}
+		if (batch.empty() == false && batch.back().seq > committed_seq)
+			committed_seq = batch.back().seq;
+		committing = false;
+		commit_cond.broadcast();
+	}
+
+	if (failed_seq != 0 && seq >= failed_seq)
+	{
+		TangoSys_OMemStream o;
+		o << "Failed to sync " << wal_file << " (error=" << strerror(commit_errno) << ")" << std::ends;
+		Tango::Except::throw_exception((const char *)"DB_MemoryStorageError",o.str(),
+									   (const char *)"MemoryStorage::commit()");
+	}
+}
+//=============================================================================
+//	Remember the last record of each device and of the devices of each
+//	server (wal_mutex locked or during open()). The server is the one of
+//	the device in memory and, for a reload, the one read from MySQL
+//=============================================================================
+void MemoryStorage::note_seq(const MemRecord &rec)
+{
+	if (rec.fields.empty() == true)
+		return;
+
+	std::string key = lower_string(rec.fields[0]);
+	key_seq[key] = rec.seq;
+
+	omni_mutex_lock sync(*this);
+	std::map<std::string,MemDevice>::iterator dev_ite = devices.find(key);
+	if (dev_ite != devices.end())
+		server_seq[lower_string(dev_ite->second.info.server)] = rec.seq;
+	if (rec.op == 'R' && rec.fields.size() > 8 && rec.fields[1] == "1")
+		server_seq[lower_string(rec.fields[8])] = rec.seq;
+}
+//=============================================================================
+//=============================================================================
+void MemoryStorage::open_wal()
+{
+	wal_fd = ::open(wal_file.c_str(),O_WRONLY | O_CREAT | O_APPEND,0644);
+	if (wal_fd == -1)
+	{
+		TangoSys_OMemStream o;
+		o << "Can't open " << wal_file << " (error=" << strerror(errno) << ")" << std::ends;
+		Tango::Except::throw_exception((const char *)"DB_MemoryStorageError",o.str(),
+									   (const char *)"MemoryStorage::open_wal()");
+	}
+
+	struct stat st;
+	wal_size = ::fstat(wal_fd,&st) == 0 ? st.st_size : 0;
+}
+//=============================================================================
+//	Write the snapshot in a temporary file renamed once synced, a crash
+//	leaves the previous snapshot unchanged
+//=============================================================================
+void MemoryStorage::write_snapshot(const std::string &buf,unsigned long long seq)
+{
+	write_file(snap_file,buf);
+	DB_INFO_STREAM(the_db) << "MemoryStorage: Snapshot written up to record " << seq << " (" << buf.size() << " bytes)" << std::endl;
+}
+//=============================================================================
+//	Write a file through a temporary file renamed once synced
+//=============================================================================
+void MemoryStorage::write_file(const std::string &file,const std::string &buf)
+{
+	std::string tmp_file = file + ".tmp";
+	int fd = ::open(tmp_file.c_str(),O_WRONLY | O_CREAT | O_TRUNC,0644);
+
+	size_t done = 0;
+	while (fd != -1 && done < buf.size())
+	{
+		ssize_t nb = ::write(fd,buf.data() + done,buf.size() - done);
+		if (nb < 0 && errno == EINTR)
+			continue;
+		if (nb <= 0)
+			break;
+		done = done + nb;
+	}
+
+	bool ok = fd != -1 && done == buf.size() && ::fsync(fd) == 0;
+	int err = errno;
+	if (fd != -1)
+		::close(fd);
+	if (ok == true && ::rename(tmp_file.c_str(),file.c_str()) != 0)
+	{
+		ok = false;
+		err = errno;
+	}
+
+	if (ok == false)
+	{
+		::unlink(tmp_file.c_str());
+
+		TangoSys_OMemStream o;
+		o << "Failed to write " << file << " (error=" << strerror(err) << ")" << std::ends;
+		Tango::Except::throw_exception((const char *)"DB_MemoryStorageError",o.str(),
+									   (const char *)"MemoryStorage::write_file()");
+	}
+}
+//=============================================================================
+//	Write a snapshot of the memory. The current log is renamed and a new
+//	one started, the renamed log is removed (remove_old_wal()) once the
+//	records it holds have been applied to MySQL. If the previous renamed
+//	log is still there, the log is not renamed (its records older than
+//	the snapshot will only be skipped at startup).
+//	Return the sequence number of the last record in the renamed log, 0
+//	if it failed
+//=============================================================================
+unsigned long long MemoryStorage::snapshot()
+{
+	std::string buf;
+	unsigned long long seq;
+	unsigned long long snap_seq;
+	{
+		omni_mutex_lock wl(wal_mutex);
+		seq = last_seq;
+
+		{
+			omni_mutex_lock sync(*this);
+
+//
+// The records not committed yet are not in memory, they are replayed
+// from the log
+//
+
+			snap_seq = applied_seq;
+			MemRecord header('S');
+			header.seq = snap_seq;
+			header.fields.push_back(MEM_SNAPSHOT_VERSION);
+			encode_record(header,buf);
+
+			std::set<std::string> keys;
+			std::map<std::string,MemDevice>::iterator dev_ite;
+			for (dev_ite = devices.begin();dev_ite != devices.end();++dev_ite)
+				keys.insert(dev_ite->first);
+			std::map<std::string,PropMap>::iterator prop_ite;
+			for (prop_ite = properties.begin();prop_ite != properties.end();++prop_ite)
+				keys.insert(prop_ite->first);
+
+			MemRecord rec;
+			std::set<std::string>::iterator key_ite;
+			for (key_ite = keys.begin();key_ite != keys.end();++key_ite)
+			{
+				dump_device(*key_ite,rec);
+				encode_record(rec,buf);
+			}
+		}
+
+//
+// The records not synced yet must be before the log is replaced, the
+// commit in progress syncs the new one
+//
+
+		if (::access(old_wal_file.c_str(),F_OK) != 0 &&
+			(wal_sync == false || unsynced.empty() == true || ::fdatasync(wal_fd) == 0) &&
+			::rename(wal_file.c_str(),old_wal_file.c_str()) == 0)
+		{
+			::close(wal_fd);
+			wal_fd = -1;
+			try
+			{
+				open_wal();
+			}
+			catch (Tango::DevFailed &)
+			{
+				::rename(old_wal_file.c_str(),wal_file.c_str());
+				try
+				{
+					open_wal();
+				}
+				catch (Tango::DevFailed &e)
+				{
+					DB_ERROR_STREAM(the_db) << "MemoryStorage: " << e.errors[0].desc << std::endl;
+				}
+			}
+		}
+	}
+
+	try
+	{
+		write_snapshot(buf,snap_seq);
+	}
+	catch (Tango::DevFailed &e)
+	{
+		DB_ERROR_STREAM(the_db) << "MemoryStorage: " << e.errors[0].desc << std::endl;
+		return 0;
+	}
+	return seq;
+}
+//=============================================================================
+//=============================================================================
+void MemoryStorage::remove_old_wal()
+{
+	::unlink(old_wal_file.c_str());
+}
+//=============================================================================
+//	Devices are searched by name, then by alias
+//=============================================================================
+bool MemoryStorage::import_device(const std::string &device,DbDeviceInfo &info)
+{
+	omni_mutex_lock sync(*this);
+
+	std::map<std::string,MemDevice>::iterator dev_ite = devices.find(device);
+	if (dev_ite == devices.end())
+	{
+		std::map<std::string,std::string>::iterator alias_ite = aliases.find(device);
+		if (alias_ite == aliases.end())
+			return false;
+		dev_ite = devices.find(alias_ite->second);
+		if (dev_ite == devices.end())
+			return false;
+	}
+
+	info = dev_ite->second.info;
+	return true;
+}
+//=============================================================================
+//=============================================================================
+void MemoryStorage::export_device(const std::string &device,const char *ior,const char *host,
+								  const char *pid,const char *version,std::string *previous_host)
+{
+	MemRecord rec('E');
+	rec.fields.push_back(device);
+	rec.fields.push_back(ior);
+	rec.fields.push_back(host);
+	rec.fields.push_back(pid);
+	rec.fields.push_back(version);
+
+	unsigned long long seq;
+	{
+		omni_mutex_lock wl(wal_mutex);
+
+		{
+			omni_mutex_lock sync(*this);
+
+			std::map<std::string,MemDevice>::iterator dev_ite = devices.find(device);
+			if (dev_ite == devices.end())
+			{
+				TangoSys_OMemStream o;
+				o << "device " << device << " not defined in the database !";
+				Tango::Except::throw_exception((const char *)DB_DeviceNotDefined,
+								o.str(),
+								(const char *)"DataBase::ExportDevice()");
+			}
+			if (previous_host != NULL)
+				*previous_host = dev_ite->second.info.host;
+		}
+
+		seq = append(rec);
+	}
+	commit(seq);
+}
+//=============================================================================
+//=============================================================================
+void MemoryStorage::unexport_device(const std::string &device)
+{
+	MemRecord rec('U');
+	rec.fields.push_back(device);
+	unsigned long long seq;
+	{
+		omni_mutex_lock wl(wal_mutex);
+		seq = append(rec);
+	}
+	commit(seq);
+}
+//=============================================================================
+//	The values of all the properties matching a name with wildcard are
+//	returned one property after the other
+//=============================================================================
+void MemoryStorage::get_device_property(const char *device,const std::vector<std::string> &names,std::vector<DbProperty> &props)
+{
+	props.clear();
+	props.resize(names.size());
+	for (size_t i = 0;i < names.size();i++)
+		props[i].name = names[i];
+
+	omni_mutex_lock sync(*this);
+
+	std::map<std::string,PropMap>::iterator prop_ite = properties.find(lower_string(device));
+	if (prop_ite == properties.end())
+		return;
+	PropMap &prop_map = prop_ite->second;
+
+	for (size_t i = 0;i < names.size();i++)
+	{
+		if (names[i].find('*') == std::string::npos)
+		{
+			PropMap::iterator ite = prop_map.find(lower_string(names[i]));
+			if (ite != prop_map.end())
+				props[i].values = ite->second.values;
+		}
+		else
+		{
+			std::string pattern = lower_string(replace_wildcard(names[i].c_str()));
+			PropMap::iterator ite;
+			for (ite = prop_map.begin();ite != prop_map.end();++ite)
+			{
+				if (prop_match(names[i],pattern,ite->first) == true)
+					props[i].values.insert(props[i].values.end(),ite->second.values.begin(),ite->second.values.end());
+			}
+		}
+	}
+}
+//=============================================================================
+//=============================================================================
+void MemoryStorage::put_device_property(const char *device,const std::vector<DbProperty> &props)
+{
+	MemRecord rec('P');
+	rec.fields.push_back(device);
+	encode_props(props,rec);
+	unsigned long long seq;
+	{
+		omni_mutex_lock wl(wal_mutex);
+		seq = append(rec);
+	}
+	commit(seq);
+}
+//=============================================================================
+//=============================================================================
+void MemoryStorage::delete_device_property(const char *device,const std::vector<std::string> &names)
+{
+	MemRecord rec('D');
+	rec.fields.push_back(device);
+	rec.fields.insert(rec.fields.end(),names.begin(),names.end());
+	unsigned long long seq;
+	{
+		omni_mutex_lock wl(wal_mutex);
+		seq = append(rec);
+	}
+	commit(seq);
+}
+//=============================================================================
+//	The server cache data is read from MySQL (it also needs the class
+//	properties)
+//=============================================================================
+void MemoryStorage::get_server_dependencies(const std::string &ds_name,ServerCache::ServerEntry &entry)
+{
+	backing->get_server_dependencies(ds_name,entry);
+}
+//=============================================================================
+//=============================================================================
+//=============================================================================
+//	The server cache data is read from MySQL once the records logged for
+//	the devices of the server are there (the records of the other servers
+//	are not waited for)
+//=============================================================================
+bool MemoryStorage::get_server_data(const char *ds_name,const char *host,ServerData &data)
+{
+	unsigned long long seq = 0;
+	{
+		omni_mutex_lock wl(wal_mutex);
+		std::map<std::string,unsigned long long>::iterator ite = server_seq.find(lower_string(ds_name));
+		if (ite != server_seq.end())
+			seq = ite->second;
+	}
+
+	unsigned long abs_s,abs_ns;
+	get_deadline(abs_s,abs_ns);
+	wait_mirrored(seq,abs_s,abs_ns,"MemoryStorage::get_server_data()");
+	return backing->get_server_data(ds_name,host,data);
+}
+//=============================================================================
+//	Wait until the records logged so far have been applied to MySQL
+//=============================================================================
+void MemoryStorage::sync()
+{
+	unsigned long long seq;
+	{
+		omni_mutex_lock wl(wal_mutex);
+		seq = last_seq;
+	}
+
+	unsigned long abs_s,abs_ns;
+	get_deadline(abs_s,abs_ns);
+	wait_mirrored(seq,abs_s,abs_ns,"MemoryStorage::sync()");
+}
+//=============================================================================
+//=============================================================================
+void MemoryStorage::get_deadline(unsigned long &abs_s,unsigned long &abs_ns)
+{
+	omni_thread::get_time(&abs_s,&abs_ns,sync_timeout / 1000,(sync_timeout % 1000) * 1000000);
+}
+//=============================================================================
+//	The commands do not wait for MySQL (down or overloaded, the records
+//	being tried again) longer than the sync timeout
+//=============================================================================
+void MemoryStorage::wait_mirrored(unsigned long long seq,unsigned long abs_s,unsigned long abs_ns,const char *method)
+{
+	if (mirror_queue.wait_mirrored(seq,abs_s,abs_ns) == false)
+	{
+		TangoSys_OMemStream o;
+		o << "The memory engine writes are not applied to MySQL after " << sync_timeout << " ms ("
+		  << mirror_queue.get_depth() << " pending), MySQL may be down or overloaded" << std::ends;
+		Tango::Except::throw_exception((const char *)"DB_MemoryStorageTimeout",o.str(),method);
+	}
+}
+//=============================================================================
+//	Lock the writers out (wal_mutex locked) once the records logged so far
+//	have been applied to MySQL, so that a record logged before a direct
+//	MySQL write is not applied after it. This is tried again if records
+//	have been logged meanwhile
+//=============================================================================
+void MemoryStorage::lock_direct_write()
+{
+	unsigned long long seq;
+	{
+		omni_mutex_lock wl(wal_mutex);
+		seq = last_seq;
+	}
+
+	unsigned long abs_s,abs_ns;
+	get_deadline(abs_s,abs_ns);
+	while (true)
+	{
+		wait_mirrored(seq,abs_s,abs_ns,"MemoryStorage::lock_direct_write()");
+		wal_mutex.lock();
+		if (last_seq == seq)
+			break;
+		seq = last_seq;
+		wal_mutex.unlock();
+	}
+}
+//=============================================================================
+//	Reload from MySQL the devices matching the pattern, in memory or in
+//	MySQL (added, removed or renamed devices). MySQL is read with the
+//	writers running, once their records for these devices are applied. A
+//	device written meanwhile is read again
+//=============================================================================
+void MemoryStorage::reload_devices(const char *field,const std::string &pattern)
+{
+	std::string lower_pattern = lower_string(pattern);
+	std::string what(field);
+	std::set<std::string> keys;
+	{
+		omni_mutex_lock sync(*this);
+
+		std::map<std::string,MemDevice>::iterator dev_ite;
+		for (dev_ite = devices.begin();dev_ite != devices.end();++dev_ite)
+		{
+			const std::string &val = what == "name" ? dev_ite->first : (what == "alias" ? dev_ite->second.alias : dev_ite->second.info.server);
+			if (val.empty() == false && ImportCache::like_match(lower_pattern.c_str(),val.c_str()) == true)
+				keys.insert(dev_ite->first);
+		}
+		if (what == "name")
+		{
+			std::map<std::string,PropMap>::iterator prop_ite;
+			for (prop_ite = properties.begin();prop_ite != properties.end();++prop_ite)
+			{
+				if (ImportCache::like_match(lower_pattern.c_str(),prop_ite->first.c_str()) == true)
+					keys.insert(prop_ite->first);
+			}
+		}
+	}
+
+	TangoSys_MemStream sql_query_stream;
+	sql_query_stream << "SELECT name FROM device WHERE " << field << " LIKE \"" << pattern << "\"";
+	MYSQL_RES *result = the_db->query(sql_query_stream.str(),"MemoryStorage::reload_devices()");
+	MYSQL_ROW row;
+	while ((row = mysql_fetch_row(result)) != NULL)
+		keys.insert(lower_string(row[0]));
+	mysql_free_result(result);
+
+	unsigned long abs_s,abs_ns;
+	get_deadline(abs_s,abs_ns);
+	std::set<std::string>::iterator key_ite;
+	while (keys.empty() == false)
+	{
+		std::map<std::string,unsigned long long> base;
+		unsigned long long seq = 0;
+		{
+			omni_mutex_lock wl(wal_mutex);
+			for (key_ite = keys.begin();key_ite != keys.end();++key_ite)
+			{
+				std::map<std::string,unsigned long long>::iterator ite = key_seq.find(*key_ite);
+				base[*key_ite] = ite != key_seq.end() ? ite->second : 0;
+				if (base[*key_ite] > seq)
+					seq = base[*key_ite];
+			}
+		}
+		wait_mirrored(seq,abs_s,abs_ns,"MemoryStorage::reload_devices()");
+
+		std::vector<MemRecord> recs(keys.size());
+		size_t i = 0;
+		for (key_ite = keys.begin();key_ite != keys.end();++key_ite,++i)
+			load_device(*key_ite,recs[i]);
+
+		std::set<std::string> written;
+		seq = 0;
+		{
+			omni_mutex_lock wl(wal_mutex);
+			for (i = 0;i < recs.size();i++)
+			{
+				std::map<std::string,unsigned long long>::iterator ite = key_seq.find(recs[i].fields[0]);
+				if ((ite != key_seq.end() ? ite->second : 0) != base[recs[i].fields[0]])
+					written.insert(recs[i].fields[0]);
+				else
+					seq = append(recs[i]);
+			}
+		}
+		if (seq != 0)
+			commit(seq);
+
+		keys.swap(written);
+		if (keys.empty() == false && time_reached(abs_s,abs_ns) == true)
+		{
+			TangoSys_OMemStream o;
+			o << keys.size() << " device(s) matching " << pattern << " written while reloaded during "
+			  << sync_timeout << " ms" << std::ends;
+			Tango::Except::throw_exception((const char *)"DB_MemoryStorageTimeout",o.str(),
+										   (const char *)"MemoryStorage::reload_devices()");
+		}
+	}
+}
+
+//=============================================================================
+//=============================================================================
+MemoryStorageThread::MemoryStorageThread(MemoryStorage *st,MirrorQueue *q):storage(st),queue(q)
+{
+}
+//=============================================================================
+//	Apply the records to MySQL and write a snapshot every period. The log
+//	renamed by the snapshot is removed once its records have been applied.
+//	A record MySQL fails to apply is tried again (with an increasing delay)
+//	until it is applied or the thread is stopped
+//=============================================================================
+void *MemoryStorageThread::run_undetached(TANGO_UNUSED(void *ptr))
+{
+	mysql_thread_init();
+
+	long period = storage->get_snapshot_period();
+	unsigned long next_s,next_ns;
+	omni_thread::get_time(&next_s,&next_ns,period > 0 ? period : 0x7fffffff,0);
+
+	unsigned long long pending_seq = 0;
+	MemRecord rec;
+	int ret;
+	while ((ret = queue->take(rec,next_s,next_ns)) != -1)
+	{
+		if (ret == 1)
+		{
+			long delay = MEMORY_MIRROR_RETRY_DELAY;
+			bool applied;
+			while ((applied = storage->mirror(rec)) == false && queue->pause(delay) == true)
+			{
+				if (delay < MEMORY_MIRROR_MAX_RETRY_DELAY)
+					delay = delay * 2 > MEMORY_MIRROR_MAX_RETRY_DELAY ? MEMORY_MIRROR_MAX_RETRY_DELAY : delay * 2;
+			}
+			if (applied == false)
+				break;
+
+			storage->mark_mirrored(rec.seq);
+			queue->mirrored(rec.seq);
+		}
+		else
+		{
+			unsigned long long seq = storage->snapshot();
+			if (seq != 0)
+				pending_seq = seq;
+			omni_thread::get_time(&next_s,&next_ns,period,0);
+		}
+
+		if (pending_seq != 0 && queue->get_mirrored() >= pending_seq)
+		{
+			storage->remove_old_wal();
+			pending_seq = 0;
+		}
+	}
+
+	mysql_thread_end();
+	return NULL;
+}
+
+}	//	namespace
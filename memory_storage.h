@@ -0,0 +1,260 @@
+//=============================================================================
+//
+// file :        memory_storage.h
+//
+// description : Include for the in-memory storage engine.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _MEMORY_STORAGE_H
+#define _MEMORY_STORAGE_H
+
+#include <db_storage.h>
+#include <deque>
+
+#define	DEFAULT_MEMORY_STORAGE_DIR			"."
+#define	DEFAULT_MEMORY_SNAPSHOT_PERIOD		600			// s
+#define	DEFAULT_MEMORY_WAL_SYNC				1
+#define	DEFAULT_MEMORY_SYNC_TIMEOUT			2000		// ms
+#define	MEMORY_MIRROR_RETRY_DELAY			1000		// ms, doubled up to the max
+#define	MEMORY_MIRROR_MAX_RETRY_DELAY		30000		// ms
+
+namespace DataBase_ns {
+
+class MemoryStorageThread;
+
+//=========================================================
+/**
+ *	One write-ahead log record: A sequence number, an operation
+ *	code (see memory_storage.cpp) and its arguments
+ */
+//=========================================================
+struct MemRecord
+{
+	MemRecord():seq(0),op(0) {}
+	MemRecord(char o):seq(0),op(o) {}
+
+	unsigned long long			seq;
+	char						op;
+	std::vector<std::string>	fields;
+};
+
+//=========================================================
+/**
+ *	FIFO of the logged records not yet applied to MySQL. The
+ *	queue has no size limit, the records being in the log.
+ *	The commands reading MySQL data written through the engine
+ *	wait until the records logged so far have been applied.
+ *	wait_mirrored() returns false if they are not applied at the
+ *	given (absolute) time
+ */
+//=========================================================
+class MirrorQueue: public omni_mutex
+{
+public:
+	MirrorQueue();
+
+	void init(unsigned long long);
+	void push(const MemRecord &);
+	bool wait_mirrored(unsigned long long,unsigned long,unsigned long);
+	long get_depth();
+
+/**
+ *	Methods used by the MemoryStorageThread. take() returns 1 when a
+ *	record has been taken, 0 when the given time is reached and -1 when
+ *	the queue is stopped and empty. pause() waits for the given time (ms)
+ *	and returns false if the queue is stopped
+ */
+	int take(MemRecord &,unsigned long,unsigned long);
+	bool pause(long);
+	void mirrored(unsigned long long);
+	unsigned long long get_mirrored();
+	void stop();
+
+private:
+	bool					stopped;
+	unsigned long long		mirrored_seq;
+	std::deque<MemRecord>	records;
+	omni_condition			push_cond;
+	omni_condition			mirrored_cond;
+};
+
+//=========================================================
+/**
+ *	In-memory storage engine. The devices and their properties are
+ *	kept in memory and the reads never go to MySQL.
+ *
+ *	A write is appended to the write-ahead log, then synced (if
+ *	requested) with the writes of the other clients arriving
+ *	meanwhile (group commit), applied in memory and queued to be
+ *	applied to the MySQL engine by a thread, so that the commands not using the
+ *	engine (and the history) still find the data in MySQL.
+ *	The thread also writes a snapshot of the memory periodically
+ *	and then removes the log written before it.
+ *
+ *	A record MySQL fails to apply is tried again (the next ones
+ *	waiting) and the log holding it is kept until it is applied. The
+ *	last record applied is marked in a file (.mirrored). The
+ *	commands waiting for records to be applied fail after a
+ *	timeout, DbGetDataForServerCache only waits for the records
+ *	of the devices of its server.
+ *
+ *	The commands writing the device tables directly in MySQL do it
+ *	with the writers locked out, once the logged records have been
+ *	applied to MySQL, then reload the devices they changed (read
+ *	from MySQL with the writers running).
+ *
+ *	At startup, the snapshot and the log are replayed, the memory is
+ *	loaded from MySQL if there is no snapshot, then a new snapshot is
+ *	written with a new log holding only the records after the mark
+ *	(queued to be applied to MySQL).
+ *	The engine assumes this server is the only one writing in the
+ *	MySQL database.
+ */
+//=========================================================
+class MemoryStorage: public DbStorage, public omni_mutex
+{
+public:
+	MemoryStorage(DataBase *,DbStorage *,const std::string &,long,bool,long sync_tmo = DEFAULT_MEMORY_SYNC_TIMEOUT);
+	~MemoryStorage();
+
+	void open();
+	DbStorage *release_backing();
+
+	const char *get_name() {return "memory";}
+
+	bool import_device(const std::string &,DbDeviceInfo &);
+	void export_device(const std::string &,const char *,const char *,const char *,const char *,std::string *);
+	void unexport_device(const std::string &);
+
+	void get_device_property(const char *,const std::vector<std::string> &,std::vector<DbProperty> &);
+	void put_device_property(const char *,const std::vector<DbProperty> &);
+	void delete_device_property(const char *,const std::vector<std::string> &);
+
+	void get_server_dependencies(const std::string &,ServerCache::ServerEntry &);
+	bool get_server_data(const char *,const char *,ServerData &);
+
+	void lock_direct_write();
+	void unlock_direct_write() {wal_mutex.unlock();}
+	void reload_devices(const char *,const std::string &);
+	void sync();
+
+/**
+ *	Methods used by the MemoryStorageThread
+ */
+	long get_snapshot_period() {return snapshot_period;}
+	bool mirror(const MemRecord &);
+	void mark_mirrored(unsigned long long);
+	unsigned long long snapshot();
+	void remove_old_wal();
+
+private:
+	typedef std::map<std::string,DbProperty> PropMap;
+
+	typedef struct
+	{
+		DbDeviceInfo	info;
+		std::string		alias;
+	} MemDevice;
+
+	unsigned long long append(MemRecord &);
+	void commit(unsigned long long);
+	void apply(const MemRecord &);
+	void load_device(const std::string &,MemRecord &);
+	void dump_device(const std::string &,MemRecord &);
+	void seed();
+	bool replay(const std::string &,bool,unsigned long long &,std::map<unsigned long long,MemRecord> &);
+	void write_snapshot(const std::string &,unsigned long long);
+	void write_file(const std::string &,const std::string &);
+	void open_wal();
+	unsigned long long read_mark();
+	void open_mark(unsigned long long);
+	void note_seq(const MemRecord &);
+	void wait_mirrored(unsigned long long,unsigned long,unsigned long,const char *);
+	void get_deadline(unsigned long &,unsigned long &);
+
+	DataBase							*the_db;
+	DbStorage							*backing;
+	std::string							snap_file;
+	std::string							wal_file;
+	std::string							old_wal_file;
+	std::string							mark_file;
+	long								snapshot_period;
+	bool								wal_sync;
+	long								sync_timeout;
+
+	omni_mutex							wal_mutex;			// Serialize the writers
+	int									wal_fd;
+	int									mark_fd;
+	long long							wal_size;
+	unsigned long long					last_seq;
+	bool								wal_broken;			// A sync failed, the writes are refused
+	std::vector<MemRecord>				unsynced;			// Logged records waiting for the group commit
+	std::map<std::string,unsigned long long>	key_seq;	// Device key -> its last record
+	std::map<std::string,unsigned long long>	server_seq;	// Lower case server -> last record of its devices
+
+	omni_mutex							commit_mutex;		// Group commit
+	omni_condition						commit_cond;
+	bool								committing;
+	unsigned long long					committed_seq;
+	unsigned long long					failed_seq;			// First record whose sync failed
+	int									commit_errno;
+	unsigned long long					applied_seq;		// Last record in memory (object mutex)
+	MirrorQueue							mirror_queue;
+	MemoryStorageThread					*thread;
+
+	std::map<std::string,MemDevice>		devices;			// Key: Lower case device name
+	std::map<std::string,std::string>	aliases;			// Lower case alias -> device key
+	std::map<std::string,PropMap>		properties;			// Key: Lower case device (and property) name
+};
+
+//=========================================================
+/**
+ *	Thread applying the logged records to MySQL and writing the
+ *	snapshots
+ */
+//=========================================================
+class MemoryStorageThread: public omni_thread
+{
+public:
+	MemoryStorageThread(MemoryStorage *,MirrorQueue *);
+
+	void *run_undetached(void *);
+	void start() {start_undetached();}
+
+private:
+	MemoryStorage	*storage;
+	MirrorQueue		*queue;
+};
+
+}	//	namespace
+
+#endif	// _MEMORY_STORAGE_H
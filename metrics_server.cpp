@@ -0,0 +1,216 @@
+//=============================================================================
+//
+// file :        metrics_server.cpp
+//
+// description : OpenMetrics HTTP endpoint (metricsPort device property).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+
+#include <DataBase.h>
+
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define	MSG_NOSIGNAL	0
+#endif
+
+namespace DataBase_ns
+{
+
+//=============================================================================
+//=============================================================================
+MetricsServer::MetricsServer(DataBase *db,int p,bool local):
+	the_db(db),port(p),local_only(local),sock(-1),stopped(false)
+{
+}
+//=============================================================================
+//	Open the listening socket and start the thread. Return false (the
+//	error being logged) if the port cannot be used
+//=============================================================================
+bool MetricsServer::start()
+{
+#ifdef WIN32
+	DB_ERROR_STREAM(the_db) << "The metrics endpoint is not supported on Windows" << std::endl;
+	return false;
+#else
+	sock = socket(AF_INET,SOCK_STREAM,0);
+	if (sock < 0)
+	{
+		DB_ERROR_STREAM(the_db) << "Metrics endpoint: socket() failed (" << strerror(errno) << ")" << std::endl;
+		return false;
+	}
+
+	int on = 1;
+	setsockopt(sock,SOL_SOCKET,SO_REUSEADDR,&on,sizeof(on));
+
+	struct sockaddr_in addr;
+	::memset(&addr,0,sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(local_only == true ? INADDR_LOOPBACK : INADDR_ANY);
+
+	if (bind(sock,(struct sockaddr *)&addr,sizeof(addr)) != 0 || listen(sock,8) != 0)
+	{
+		DB_ERROR_STREAM(the_db) << "Metrics endpoint: Can't listen on port " << port << " (" << strerror(errno) << ")" << std::endl;
+		close(sock);
+		sock = -1;
+		return false;
+	}
+
+	start_undetached();
+	return true;
+#endif
+}
+//=============================================================================
+//	Ask the thread to exit (within METRICS_POLL_PERIOD)
+//=============================================================================
+void MetricsServer::stop()
+{
+	omni_mutex_lock guard(stop_mutex);
+	stopped = true;
+}
+//=============================================================================
+//=============================================================================
+void *MetricsServer::run_undetached(TANGO_UNUSED(void *ptr))
+{
+#ifndef WIN32
+	while (true)
+	{
+		{
+			omni_mutex_lock guard(stop_mutex);
+			if (stopped == true)
+				break;
+		}
+
+		struct pollfd pfd;
+		pfd.fd = sock;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll(&pfd,1,METRICS_POLL_PERIOD) <= 0)
+			continue;
+
+		int con = accept(sock,NULL,NULL);
+		if (con < 0)
+			continue;
+
+		try
+		{
+			serve(con);
+		}
+		catch (...)
+		{
+		}
+		close(con);
+	}
+
+	close(sock);
+	sock = -1;
+#endif
+	return NULL;
+}
+//=============================================================================
+//	Read one request and send the reply. Only GET (and HEAD) of / or
+//	/metrics are supported
+//=============================================================================
+void MetricsServer::serve(int con)
+{
+#ifndef WIN32
+	struct timeval tv;
+	tv.tv_sec = METRICS_IO_TIMEOUT;
+	tv.tv_usec = 0;
+	setsockopt(con,SOL_SOCKET,SO_RCVTIMEO,&tv,sizeof(tv));
+	setsockopt(con,SOL_SOCKET,SO_SNDTIMEO,&tv,sizeof(tv));
+
+	std::string request;
+	char buf[1024];
+	while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192)
+	{
+		ssize_t nb = recv(con,buf,sizeof(buf),0);
+		if (nb <= 0)
+			break;
+		request.append(buf,nb);
+	}
+
+	std::string::size_type end = request.find("\r\n");
+	std::istringstream first_line(request.substr(0,end));
+	std::string method,path;
+	first_line >> method >> path;
+
+	std::string status("200 OK");
+	std::string content_type(METRICS_CONTENT_TYPE);
+	std::string body;
+	if (method != "GET" && method != "HEAD")
+	{
+		status = "405 Method Not Allowed";
+		content_type = "text/plain";
+		body = "Method not allowed\n";
+	}
+	else if (path != "/" && path != "/metrics")
+	{
+		status = "404 Not Found";
+		content_type = "text/plain";
+		body = "Not found (use /metrics)\n";
+	}
+	else
+		the_db->get_metrics(body);
+
+	std::ostringstream head;
+	head << "HTTP/1.0 " << status << "\r\n";
+	head << "Content-Type: " << content_type << "\r\n";
+	head << "Content-Length: " << body.size() << "\r\n";
+	head << "Connection: close\r\n\r\n";
+
+	std::string reply = head.str();
+	if (method != "HEAD")
+		reply = reply + body;
+
+	size_t sent = 0;
+	while (sent < reply.size())
+	{
+		ssize_t nb = send(con,reply.data() + sent,reply.size() - sent,MSG_NOSIGNAL);
+		if (nb <= 0)
+			break;
+		sent = sent + nb;
+	}
+#endif
+}
+
+}	//	namespace
@@ -0,0 +1,88 @@
+//=============================================================================
+//
+// file :        metrics_server.h
+//
+// description : Include for the OpenMetrics HTTP endpoint (metricsPort
+//               device property).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _METRICS_SERVER_H
+#define _METRICS_SERVER_H
+
+#include <tango.h>
+
+//
+// Default port of the metrics endpoint (0 means no endpoint) and default
+// for listening only on the loopback interface
+//
+
+#define	DEFAULT_METRICS_PORT		0
+#define	DEFAULT_METRICS_LOCAL_ONLY	1
+#define	METRICS_POLL_PERIOD			1000		// ms
+#define	METRICS_IO_TIMEOUT			2			// s
+#define	METRICS_CONTENT_TYPE		"application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+namespace DataBase_ns {
+
+class DataBase;
+
+//=========================================================
+/**
+ *	Thread serving the DB server statistics in the OpenMetrics text
+ *	format (GET /metrics) on a local HTTP port. The page is built from
+ *	the in-process statistics (DataBase::get_metrics()), no MySQL
+ *	connection is used. The requests are served one at a time.
+ */
+//=========================================================
+class MetricsServer: public omni_thread
+{
+public:
+	MetricsServer(DataBase *,int,bool);
+
+	bool start();
+	void stop();
+	void *run_undetached(void *);
+
+private:
+	void serve(int);
+
+	DataBase	*the_db;
+	int			port;
+	bool		local_only;
+	int			sock;
+	bool		stopped;
+	omni_mutex	stop_mutex;
+};
+
+}	//	namespace
+
+#endif	// _METRICS_SERVER_H
@@ -0,0 +1,493 @@
+//=============================================================================
+//
+// file :        mysql_storage.cpp
+//
+// description : MySQL storage engine. The SQL statements come from the
+//               commands which now use the DbStorage interface.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+#include <DataBase.h>
+
+namespace DataBase_ns
+{
+
+//
+// Bytes sent with each row of a multi-row INSERT, but its strings
+//
+
+#define	INSERT_ROW_OVERHEAD		64
+
+//=============================================================================
+//	Number of rows (a power of 2) sent by the next multi-row INSERT: As many
+//	as there are statement markers, the rows fitting in one MySQL packet
+//	(max_allowed_packet)
+//=============================================================================
+static size_t insert_chunk(DataBase *the_db,const std::vector<size_t> &row_sizes,size_t first)
+{
+	size_t nb = (size_t)1 << STMT_ROW_LEVELS;
+	while (nb > row_sizes.size() - first)
+		nb = nb >> 1;
+
+	while (nb > 1)
+	{
+		size_t size = 0;
+		for (size_t i = first;i < first + nb;i++)
+			size = size + row_sizes[i];
+		if (size <= the_db->get_max_insert_size())
+			break;
+		nb = nb >> 1;
+	}
+	return nb;
+}
+//=============================================================================
+//	Get the import information of a device, searched by name, then by alias
+//=============================================================================
+bool MySqlStorage::import_device(const std::string &device,DbDeviceInfo &info)
+{
+	AutoTransaction al("LOCK TABLE device READ",TRANSACTION_READ,the_db);
+
+	DbStmt by_name(the_db,STMT_IMPORT_DEVICE_BY_NAME,al.get_con_nb(),"db_import_device()");
+	DbStmt by_alias(the_db,STMT_IMPORT_DEVICE_BY_ALIAS,al.get_con_nb(),"db_import_device()");
+	DbStmt *stmt = &by_name;
+
+	by_name.bind(device);
+	by_name.execute();
+
+	if (by_name.get_nb_rows() <= 0)
+	{
+		by_alias.bind(device);
+		by_alias.execute();
+		stmt = &by_alias;
+
+		if (by_alias.get_nb_rows() <= 0)
+		{
+			al.commit();
+			return false;
+		}
+	}
+
+//
+// exported and pid are fetched as integers. The IOR may be NULL
+//
+
+	if (stmt->fetch() == false)
+	{
+		al.commit();
+		Tango::Except::throw_exception((const char *)DB_DeviceNotDefined,
+						(const char *)"Device import info not found in the database !",
+						(const char *)"DataBase::ImportDevice()");
+	}
+
+	const char *col;
+	info.exported = (long)stmt->get_long(0);
+	info.ior = (col = stmt->get_string(1)) != NULL ? col : "";
+	info.version = (col = stmt->get_string(2)) != NULL ? col : "";
+	info.pid = (long)stmt->get_long(3);
+	info.server = (col = stmt->get_string(4)) != NULL ? col : "";
+	info.host = (col = stmt->get_string(5)) != NULL ? col : "";
+	info.class_name = (col = stmt->get_string(6)) != NULL ? col : "";
+	info.name = (col = stmt->get_string(7)) != NULL ? col : "";
+
+	al.commit();
+	return true;
+}
+//=============================================================================
+//	Update the device export information and the host of its server
+//=============================================================================
+void MySqlStorage::export_device(const std::string &device,const char *ior,const char *host,
+								 const char *pid,const char *version,std::string *previous_host)
+{
+	AutoTransaction al("LOCK TABLES device WRITE, server WRITE",TRANSACTION_WRITE,the_db);
+
+	if (previous_host != NULL)
+	{
+		omni_mutex_lock oml(the_db->starter_mutex);
+
+		char *tmp_ptr = the_db->db_get_device_host((Tango::DevString)device.c_str(),al.get_con_nb());
+		*previous_host = tmp_ptr;
+		CORBA::string_free(tmp_ptr);
+	}
+
+//
+// check if device is defined and if so get server name in order to
+// update server table
+//
+
+	std::string server;
+	DbStmt get_server(the_db,STMT_EXPORT_GET_SERVER,al.get_con_nb(),"db_export_device()");
+	get_server.bind(device);
+	get_server.execute();
+
+	if (get_server.get_nb_rows() > 0)
+	{
+		if (get_server.fetch() == true)
+			server = get_server.get_string(0);
+	}
+	else
+	{
+		TangoSys_OMemStream o;
+		o << "device " << device << " not defined in the database !";
+		Tango::Except::throw_exception((const char *)DB_DeviceNotDefined,
+						o.str(),
+						(const char *)"DataBase::ExportDevice()");
+	}
+
+// update the new value for this tuple
+
+	DbStmt update_device(the_db,STMT_EXPORT_UPDATE_DEVICE,al.get_con_nb(),"db_export_device()");
+	update_device.bind(ior);
+	update_device.bind(host);
+	update_device.bind(pid);
+	update_device.bind(version);
+	update_device.bind(device);
+	update_device.execute();
+
+// update host name in server table
+
+	DbStmt update_server(the_db,STMT_EXPORT_UPDATE_SERVER,al.get_con_nb(),"db_export_device()");
+	update_server.bind(host);
+	update_server.bind(server);
+	update_server.execute();
+	al.commit();
+}
+//=============================================================================
+//=============================================================================
+void MySqlStorage::unexport_device(const std::string &device)
+{
+	TangoSys_MemStream sql_query_stream;
+	sql_query_stream << "UPDATE device SET exported=0,stopped=NOW() WHERE name like \"" << device << "\"";
+	the_db->simple_query(sql_query_stream.str(),"db_un_export_device()");
+}
+//=============================================================================
+//	Get the values of the properties matching each name, all read with the
+//	same prepared statement
+//=============================================================================
+void MySqlStorage::get_device_property(const char *device,const std::vector<std::string> &names,std::vector<DbProperty> &props)
+{
+	props.clear();
+	props.resize(names.size());
+
+	DbStmt stmt(the_db,STMT_GET_DEVICE_PROPERTY,-1,"db_get_device_property()");
+	for (size_t i = 0;i < names.size();i++)
+	{
+		props[i].name = names[i];
+		std::string tmp_name = replace_wildcard(names[i].c_str());
+		stmt.bind(device);
+		stmt.bind(tmp_name);
+		stmt.execute();
+
+		long n_rows = stmt.get_nb_rows();
+		if (n_rows > 0)
+		{
+			props[i].values.reserve(n_rows);
+			while (stmt.fetch() == true)
+			{
+				const char *val = stmt.get_string(1);
+				props[i].values.push_back(val != NULL ? val : "");
+			}
+		}
+	}
+}
+//=============================================================================
+//	Replace the values of each property and keep them in the history.
+//	The values are bound to prepared statements, not escaped: They may be
+//	large. They are sent by multi-row statements, as many as fit in one
+//	MySQL packet. The history rows are sent as SQL text (batched) only when
+//	the history writer defers them
+//=============================================================================
+void MySqlStorage::put_device_property(const char *device,const std::vector<DbProperty> &props)
+{
+	TangoSys_MemStream sql_query_stream;
+
+	AutoTransaction al("LOCK TABLES property_device WRITE, property_device_hist WRITE,device_history_id WRITE",TRANSACTION_WRITE,the_db);
+
+	DbStmt del_prop(the_db,STMT_DELETE_DEVICE_PROPERTY,al.get_con_nb(),"db_put_device_property()");
+	InsertBatch hist_batch(the_db,"INSERT INTO property_device_hist (device,id,name,count,value) VALUES ",
+						   al.get_con_nb(),"db_put_device_property()",true);
+	bool defer_hist = the_db->hist_writer != NULL;
+	size_t device_size = ::strlen(device);
+
+	for (size_t i = 0;i < props.size();i++)
+	{
+		const std::string &tmp_name = props[i].name;
+		const std::vector<std::string> &prop_values = props[i].values;
+
+// first delete all tuples (device,name) from the property table
+
+		del_prop.bind(device);
+		del_prop.bind(tmp_name);
+		del_prop.execute();
+
+		Tango::DevULong64 device_property_hist_id = the_db->get_id("device",al.get_con_nb());
+
+		std::vector<std::string> value_bufs(prop_values.size());
+		std::vector<const char *> values(prop_values.size());
+		std::vector<size_t> row_sizes(prop_values.size());
+		for (size_t j = 0;j < prop_values.size();j++)
+		{
+			values[j] = the_db->stored_value(prop_values[j].c_str(),value_bufs[j]);
+			row_sizes[j] = device_size + tmp_name.size() + ::strlen(values[j]) + INSERT_ROW_OVERHEAD;
+		}
+
+// then insert the new values for this tuple and into the history table
+
+		size_t nb;
+		for (size_t j = 0;j < values.size();j = j + nb)
+		{
+			nb = insert_chunk(the_db,row_sizes,j);
+
+			DbStmt ins_prop(the_db,nb == 1 ? STMT_INSERT_DEVICE_PROPERTY : DbStmt::get_rows_id(STMT_INSERT_DEVICE_PROPERTY_ROWS,nb),
+							al.get_con_nb(),"db_put_device_property()");
+			for (size_t k = j;k < j + nb;k++)
+			{
+				ins_prop.bind(device);
+				ins_prop.bind(tmp_name);
+				ins_prop.bind((long long)(k + 1));
+				ins_prop.bind(values[k]);
+			}
+			ins_prop.execute();
+
+			if (defer_hist == true)
+				continue;
+
+			DbStmt ins_hist(the_db,nb == 1 ? STMT_INSERT_DEVICE_PROPERTY_HIST : DbStmt::get_rows_id(STMT_INSERT_DEVICE_PROPERTY_HIST_ROWS,nb),
+							al.get_con_nb(),"db_put_device_property()");
+			for (size_t k = j;k < j + nb;k++)
+			{
+				ins_hist.bind(device);
+				ins_hist.bind((long long)device_property_hist_id);
+				ins_hist.bind(tmp_name);
+				ins_hist.bind((long long)(k + 1));
+				ins_hist.bind(values[k]);
+			}
+			ins_hist.execute();
+		}
+
+		for (size_t j = 0;j < prop_values.size() && defer_hist == true;j++)
+		{
+			sql_query_stream.str("");
+			sql_query_stream << "('" << device << "'," << device_property_hist_id
+							 << ",'" << tmp_name
+							 << "'," << j + 1
+							 << ",'" << escape_string(prop_values[j].c_str()) << "')";
+			hist_batch.add(sql_query_stream.str());
+		}
+		hist_batch.flush();
+		the_db->purge_property("property_device_hist","device",device,tmp_name.c_str(),al.get_con_nb());
+	}
+	al.commit();
+}
+//=============================================================================
+//	Delete the properties matching each name and mark them as deleted in
+//	the history
+//=============================================================================
+void MySqlStorage::delete_device_property(const char *device,const std::vector<std::string> &names)
+{
+	TangoSys_MemStream sql_query_stream;
+	MYSQL_RES *result;
+	MYSQL_ROW row;
+
+	AutoTransaction al("LOCK TABLES property_device WRITE, property_device_hist WRITE,device_history_id WRITE",TRANSACTION_WRITE,the_db);
+
+	for (size_t i = 0;i < names.size();i++)
+	{
+		std::string tmp_name = replace_wildcard(names[i].c_str());
+
+// Is there something to delete ?
+
+		sql_query_stream.str("");
+		sql_query_stream << "SELECT DISTINCT name FROM property_device WHERE device=\""
+						 << device << "\" AND name LIKE \"" << tmp_name << "\"";
+		result = the_db->query(sql_query_stream.str(),"db_delete_device_property()",al.get_con_nb());
+		int count = mysql_num_rows(result);
+
+		for (int j = 0;j < count;j++)
+		{
+			row = mysql_fetch_row(result);
+
+// delete the tuple (device,name,count) from the property table
+
+			sql_query_stream.str("");
+			sql_query_stream << "DELETE FROM property_device WHERE device=\""
+							 << device << "\" AND name=\"" << row[0] << "\"";
+			the_db->simple_query(sql_query_stream.str(),"db_delete_device_property()",al.get_con_nb());
+
+// Mark this property as deleted
+
+			Tango::DevULong64 device_property_hist_id = the_db->get_id("device",al.get_con_nb());
+			sql_query_stream.str("");
+			sql_query_stream << "INSERT INTO property_device_hist SET device='"
+							 << device << "',id='" << device_property_hist_id << "',name='"
+							 << row[0] << "',count='0',value='DELETED'";
+			the_db->simple_query(sql_query_stream.str(),"db_delete_device_property()",al.get_con_nb());
+
+			the_db->purge_property("property_device_hist","device",device,row[0],al.get_con_nb());
+		}
+
+		mysql_free_result(result);
+	}
+	al.commit();
+}
+//=============================================================================
+//=============================================================================
+void MySqlStorage::get_server_dependencies(const std::string &ds_name,ServerCache::ServerEntry &entry)
+{
+	the_db->get_server_cache_dependencies(ds_name,entry);
+}
+//=============================================================================
+//	Get the DbGetDataForServerCache data of a server with the C++ ds_start
+//	implementation or the ds_start stored procedure. The stored procedure
+//	result is kept in the MySQL result buffer. A stored procedure result
+//	reporting a MySQL error must not be cached
+//=============================================================================
+bool MySqlStorage::get_server_data(const char *ds_name,const char *host,ServerData &data)
+{
+	if (the_db->native_ds_start == false && the_db->mysql_svr_version < 50000)
+	{
+		Tango::Except::throw_exception((const char *)"DB_MySQLServerTooOld",
+						(const char *)"The MySQL server release does not support stored procedure. Update MySQL to release >= 5",
+						(const char *)"DataBase::DbGetDataForServerCache()");
+	}
+
+//
+// C++ implementation of the stored procedure
+//
+
+	if (the_db->native_ds_start == true)
+	{
+		DsStart ds_start(the_db,ds_name,host,escape_string(ds_name),the_db->ds_start_fan_out);
+		ds_start.build(data.elts);
+		return true;
+	}
+
+	MYSQL_RES *res;
+	MYSQL_ROW row;
+
+	Tango::Util *tg = Tango::Util::instance();
+	std::string	&db_inst_name = tg->get_ds_inst_name();
+	std::string tmp_var_name("@param_out");
+	tmp_var_name = tmp_var_name + db_inst_name;
+
+//
+// Do not use methods query() or simple_query() because we are
+// calling a stored procedure.
+// Calling a stored procedure needs special care to retrieve its OUT
+// parameter(s). We have to code a loop using mysql_next_result
+// function. The first result with data is the one we are
+// interested in
+//
+
+	std::string sql_query("CALL ");
+	sql_query = sql_query + the_db->mysql_db_name;
+	sql_query = sql_query + ".ds_start('" + ds_name + "','" + host + "'," + tmp_var_name + ")";
+	sql_query = sql_query + ";SELECT " + tmp_var_name;
+
+	int con_nb = the_db->get_connection();
+	MYSQL *db = the_db->conn_pool[con_nb].db;
+	if (mysql_real_query(db,sql_query.c_str(),sql_query.length()) != 0)
+	{
+		TangoSys_OMemStream o;
+		o << "Failed to query TANGO database (error=" << mysql_error(db) << ")";
+		o << "\nThe query was: " << sql_query << std::ends;
+
+		the_db->release_connection(con_nb);
+
+		Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),
+									   (const char *)"DataBase::DbGetDataForServerCache()");
+	}
+
+	int status;
+	do
+	{
+		if ((res = mysql_store_result(db)) != NULL)
+		{
+			break;
+		}
+		else
+		{
+			if (mysql_field_count(db) != 0)
+			{
+				TangoSys_OMemStream o;
+				o << "mysql_store_result() failed (error=" << mysql_error(db) << ")";
+
+				the_db->release_connection(con_nb);
+
+				Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),
+											   (const char *)"DataBase::DbGetDataForServerCache()");
+			}
+
+			if ((status = mysql_next_result(db)) > 0)
+			{
+				TangoSys_OMemStream o;
+				o << "mysql_next_result() failed (error=" << mysql_error(db) << ")";
+
+				the_db->release_connection(con_nb);
+
+				Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),
+											   (const char *)"DataBase::DbGetDataForServerCache()");
+			}
+		}
+	}while (status == 0);
+
+	the_db->release_connection(con_nb);
+
+//
+// The result stays in the MySQL buffer, it is split (or copied) only
+// once in the command reply
+//
+
+	row = mysql_fetch_row(res);
+	unsigned long *length_ptr = mysql_fetch_lengths(res);
+	data.set_result(res,row[0],length_ptr[0]);
+
+	if (data.get_nb_elt() == 1)
+	{
+		if (length_ptr[0] == 0)
+		{
+			Tango::Except::throw_exception((const char *)"DB_StoredProcedureNoResult",
+						(const char *)"The stored procedure did not return any results!!!",
+						(const char *)"DataBase::DbGetDataForServerCache()");
+		}
+		else
+		{
+			Tango::Except::throw_exception((const char *)"DB_StoredProcedureFailed",
+						(const char *)"The stored procedure failed with a MySQL error!!!",
+						(const char *)"DataBase::DbGetDataForServerCache()");
+		}
+	}
+
+	return data.contains("MySQL Error") == false && data.contains("MySQL ERROR") == false;
+}
+
+}	//	namespace
@@ -0,0 +1,74 @@
+//=============================================================================
+//
+// file :        mysql_storage.h
+//
+// description : Include for the MySQL storage engine.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _MYSQL_STORAGE_H
+#define _MYSQL_STORAGE_H
+
+#include <db_storage.h>
+
+namespace DataBase_ns {
+
+//=========================================================
+/**
+ *	MySQL storage engine, using the connection pool and the
+ *	prepared statements of the DataBase object
+ */
+//=========================================================
+class MySqlStorage: public DbStorage
+{
+public:
+	MySqlStorage(DataBase *db):the_db(db) {}
+
+	const char *get_name() {return "mysql";}
+
+	bool import_device(const std::string &,DbDeviceInfo &);
+	void export_device(const std::string &,const char *,const char *,const char *,const char *,std::string *);
+	void unexport_device(const std::string &);
+
+	void get_device_property(const char *,const std::vector<std::string> &,std::vector<DbProperty> &);
+	void put_device_property(const char *,const std::vector<DbProperty> &);
+	void delete_device_property(const char *,const std::vector<std::string> &);
+
+	void get_server_dependencies(const std::string &,ServerCache::ServerEntry &);
+	bool get_server_data(const char *,const char *,ServerData &);
+
+private:
+	DataBase	*the_db;
+};
+
+}	//	namespace
+
+#endif	// _MYSQL_STORAGE_H
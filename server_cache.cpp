@@ -0,0 +1,547 @@
+//=============================================================================
+//
+// file :        server_cache.cpp
+//
+// description : In-memory cache of the data returned by the
+//               DbGetDataForServerCache command (device server startup).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+#include <server_cache.h>
+#include <import_cache.h>
+
+namespace DataBase_ns
+{
+
+static std::string lower_string(const std::string &str)
+{
+	std::string lower(str);
+	std::transform(lower.begin(),lower.end(),lower.begin(),::tolower);
+	return lower;
+}
+
+//=============================================================================
+//=============================================================================
+ServerCache::ServerCache():timeout(DEFAULT_SERVER_CACHE_TIMEOUT),last_id(0),nb_hit(0),nb_miss(0)
+{
+}
+//=============================================================================
+//=============================================================================
+void ServerCache::set_timeout(int ti)
+{
+	omni_mutex_lock sync(*this);
+	timeout = ti;
+	entries.clear();
+}
+//=============================================================================
+//	The ds_start procedure adds the pipe properties if the client
+//	release is >= 9 and only uses the host name part of the argument
+//=============================================================================
+std::string ServerCache::make_key(const char *ds_name,const char *recev_host,std::string &server,std::string &host)
+{
+	std::string tmp_host(recev_host);
+	bool pipe = false;
+
+	std::string::size_type pos = tmp_host.find("%%");
+	if (pos != std::string::npos)
+	{
+		pipe = atoi(tmp_host.c_str() + pos + 2) >= 9;
+		tmp_host.erase(pos);
+	}
+
+	server = lower_string(ds_name);
+	host = lower_string(tmp_host);
+
+	std::string key(server);
+	key = key + '\n' + host + '\n' + (pipe == true ? '1' : '0');
+	return key;
+}
+//=============================================================================
+//=============================================================================
+bool ServerCache::lookup(const std::string &key,std::vector<std::string> &data)
+{
+	omni_mutex_lock sync(*this);
+
+	if (timeout <= 0)
+		return false;
+
+	std::map<std::string,ServerEntry>::iterator ite = entries.find(key);
+	if (ite == entries.end())
+	{
+		nb_miss++;
+		return false;
+	}
+
+	if (time(NULL) - ite->second.stamp >= timeout)
+	{
+		entries.erase(ite);
+		nb_miss++;
+		return false;
+	}
+
+	data = ite->second.data;
+	nb_hit++;
+	return true;
+}
+//=============================================================================
+//	Number of lookups which found (or not) a valid entry
+//=============================================================================
+void ServerCache::get_stats(unsigned long long &hits,unsigned long long &misses)
+{
+	omni_mutex_lock sync(*this);
+	hits = nb_hit;
+	misses = nb_miss;
+}
+//=============================================================================
+//	Register an entry being filled (its classes and devices are known).
+//	Return its identifier, 0 if the cache is disabled
+//=============================================================================
+unsigned long ServerCache::start(ServerEntry &entry)
+{
+	omni_mutex_lock sync(*this);
+
+	if (timeout <= 0)
+		return 0;
+
+	PendingEntry &pe = pending[++last_id];
+	pe.entry = entry;
+	pe.outdated = false;
+	return last_id;
+}
+//=============================================================================
+//=============================================================================
+void ServerCache::insert(unsigned long id,const std::string &key,ServerEntry &entry)
+{
+	omni_mutex_lock sync(*this);
+
+	std::map<unsigned long,PendingEntry>::iterator pos = pending.find(id);
+	if (pos == pending.end())
+		return;
+
+//
+// Something the entry depends on has been modified while the caller
+// was reading MySQL. Its data may be outdated, do not store them
+//
+
+	bool outdated = pos->second.outdated;
+	pending.erase(pos);
+	if (timeout <= 0 || outdated == true)
+		return;
+
+	entry.stamp = time(NULL);
+	entries[key] = entry;
+}
+//=============================================================================
+//=============================================================================
+void ServerCache::abort(unsigned long id)
+{
+	omni_mutex_lock sync(*this);
+	pending.erase(id);
+}
+//=============================================================================
+//	The access control device import info is part of every entry
+//=============================================================================
+void ServerCache::set_ca_device(const std::string &name)
+{
+	omni_mutex_lock sync(*this);
+	ca_device = lower_string(name);
+}
+//=============================================================================
+//=============================================================================
+void ServerCache::invalidate_server(const std::string &pattern)
+{
+	erase_matching(MATCH_SERVER,lower_string(pattern));
+}
+//=============================================================================
+//	Device definition or property change
+//=============================================================================
+void ServerCache::invalidate_device(const std::string &pattern)
+{
+	erase_matching(MATCH_DEVICE,lower_string(pattern));
+}
+//=============================================================================
+//	Device import info change (export/unexport). Only the admin device
+//	and access control device import info are part of the entries
+//=============================================================================
+void ServerCache::invalidate_import(const std::string &pattern)
+{
+	erase_matching(MATCH_ADMIN,lower_string(pattern));
+}
+//=============================================================================
+//=============================================================================
+void ServerCache::invalidate_class(const std::string &pattern)
+{
+	erase_matching(MATCH_CLASS,lower_string(pattern));
+}
+//=============================================================================
+//	Event channels are named after the admin device, the notification
+//	daemon factory is notifd/factory/<host>
+//=============================================================================
+void ServerCache::invalidate_event(const std::string &name)
+{
+	std::string lower_name = lower_string(name);
+	std::string notifd("notifd/factory/");
+
+	if (lower_name.compare(0,notifd.size(),notifd) == 0)
+		erase_matching(MATCH_HOST,lower_name.substr(notifd.size()));
+	else
+		erase_matching(MATCH_ADMIN,lower_name);
+}
+//=============================================================================
+//	Only the CtrlSystem free object properties are part of the entries
+//=============================================================================
+void ServerCache::invalidate_object(const std::string &pattern)
+{
+	std::string lower_pattern = lower_string(pattern);
+
+	if (ImportCache::like_match(lower_pattern.c_str(),"ctrlsystem") == true)
+		clear();
+}
+//=============================================================================
+//=============================================================================
+void ServerCache::clear()
+{
+	omni_mutex_lock sync(*this);
+
+	entries.clear();
+	std::map<unsigned long,PendingEntry>::iterator pos;
+	for (pos = pending.begin();pos != pending.end();++pos)
+		pos->second.outdated = true;
+}
+//=============================================================================
+//	Remove the entries (and mark the pending ones as outdated) matching
+//	the pattern
+//=============================================================================
+void ServerCache::erase_matching(MatchType type,const std::string &pattern)
+{
+	bool all = false;
+	if (type == MATCH_CLASS)
+	{
+		all = ImportCache::like_match(pattern.c_str(),"dserver") == true ||
+			  ImportCache::like_match(pattern.c_str(),"default") == true;
+	}
+	else if (type == MATCH_DEVICE || type == MATCH_ADMIN)
+	{
+		omni_mutex_lock sync(*this);
+		all = ca_device.empty() == false && ImportCache::like_match(pattern.c_str(),ca_device.c_str()) == true;
+	}
+
+	if (all == true)
+	{
+		clear();
+		return;
+	}
+
+	omni_mutex_lock sync(*this);
+
+	std::map<std::string,ServerEntry>::iterator ite;
+	for (ite = entries.begin();ite != entries.end();)
+	{
+		if (match(type,pattern,ite->second) == true)
+			entries.erase(ite++);
+		else
+			++ite;
+	}
+
+	std::map<unsigned long,PendingEntry>::iterator pos;
+	for (pos = pending.begin();pos != pending.end();++pos)
+	{
+		if (match(type,pattern,pos->second.entry) == true)
+			pos->second.outdated = true;
+	}
+}
+//=============================================================================
+//	Must be called with the cache mutex locked
+//=============================================================================
+bool ServerCache::match(MatchType type,const std::string &pattern,const ServerEntry &entry)
+{
+	switch (type)
+	{
+	case MATCH_SERVER:
+		return ImportCache::like_match(pattern.c_str(),entry.server.c_str());
+
+	case MATCH_DEVICE:
+		return match_one(pattern,entry.devices);
+
+	case MATCH_ADMIN:
+		return ImportCache::like_match(pattern.c_str(),("dserver/" + entry.server).c_str());
+
+	case MATCH_CLASS:
+		return match_one(pattern,entry.classes);
+
+	case MATCH_HOST:
+		return ImportCache::like_match(pattern.c_str(),entry.host.c_str());
+	}
+	return false;
+}
+//=============================================================================
+//	Must be called with the cache mutex locked
+//=============================================================================
+bool ServerCache::match_one(const std::string &pattern,const std::set<std::string> &names)
+{
+	if (pattern.find_first_of("%_\\") == std::string::npos)
+		return names.find(pattern) != names.end();
+
+	std::set<std::string>::const_iterator ite;
+	for (ite = names.begin();ite != names.end();++ite)
+	{
+		if (ImportCache::like_match(pattern.c_str(),ite->c_str()) == true)
+			return true;
+	}
+	return false;
+}
+
+//=============================================================================
+//	The tokens of a previous instance (or of another DB server sharing the
+//	same database) are not valid
+//=============================================================================
+void ServerVersions::set_instance(const std::string &dev_name)
+{
+	omni_mutex_lock sync(*this);
+
+	TangoSys_OMemStream o;
+	o << dev_name << ':' << std::hex << time(NULL) << ':';
+	instance = o.str();
+	entries.clear();
+	lru.clear();
+	total_size = 0;
+}
+//=============================================================================
+//	Set the memory limit of the kept data (in MB)
+//=============================================================================
+void ServerVersions::set_max_size(long mb)
+{
+	omni_mutex_lock sync(*this);
+
+	max_size = mb > 0 ? (size_t)mb * 1024 * 1024 : 0;
+	trim();
+}
+//=============================================================================
+//=============================================================================
+std::string ServerVersions::make_token(unsigned long version)
+{
+	TangoSys_OMemStream o;
+	o << instance << version;
+	return o.str();
+}
+//=============================================================================
+//	Compare the current data of a server with the kept ones and give the
+//	reply to a client having the data of token. Return SERVER_DATA_UNCHANGED
+//	(the client data are the current ones), SERVER_DATA_DELTA (hunks to
+//	apply to the client data) or SERVER_DATA_FULL
+//=============================================================================
+int ServerVersions::update(const std::string &key,const std::vector<std::string> &data,const std::string &token,
+						   std::string &new_token,std::vector<Hunk> &hunks)
+{
+	omni_mutex_lock sync(*this);
+
+	hunks.clear();
+
+	std::map<std::string,VersionEntry>::iterator ite = entries.find(key);
+	if (ite == entries.end())
+	{
+		VersionEntry &entry = entries[key];
+		entry.version = ++last_version;
+		entry.size = 0;
+		entry.lru_pos = lru.insert(lru.begin(),key);
+		new_token = make_token(entry.version);
+		store(entry,data);
+		return SERVER_DATA_FULL;
+	}
+
+	VersionEntry &entry = ite->second;
+	lru.splice(lru.begin(),lru,entry.lru_pos);
+	bool client_up_to_date = token == make_token(entry.version);
+
+	if (entry.data == data)
+	{
+		new_token = make_token(entry.version);
+		return client_up_to_date == true ? SERVER_DATA_UNCHANGED : SERVER_DATA_FULL;
+	}
+
+	int ret = SERVER_DATA_FULL;
+	if (client_up_to_date == true)
+	{
+		diff(entry.data,data,hunks);
+		ret = SERVER_DATA_DELTA;
+	}
+
+	entry.version = ++last_version;
+	new_token = make_token(entry.version);
+	store(entry,data);
+	return ret;
+}
+//=============================================================================
+//	Keep the data of an entry, then remove the least recently asked
+//	entries (maybe this one) over the memory limit
+//=============================================================================
+void ServerVersions::store(VersionEntry &entry,const std::vector<std::string> &data)
+{
+	entry.data = data;
+	total_size = total_size - entry.size;
+	entry.size = 0;
+	for (size_t i = 0;i < data.size();i++)
+		entry.size = entry.size + sizeof(std::string) + data[i].size();
+	total_size = total_size + entry.size;
+	trim();
+}
+//=============================================================================
+//=============================================================================
+void ServerVersions::trim()
+{
+	while (total_size > max_size && lru.empty() == false)
+	{
+		std::map<std::string,VersionEntry>::iterator ite = entries.find(lru.back());
+		total_size = total_size - ite->second.size;
+		entries.erase(ite);
+		lru.pop_back();
+	}
+}
+//=============================================================================
+//	Hunks transforming old_data into new_data. After the common head and
+//	tail are skipped, the shortest edit script is searched (Myers
+//	algorithm) with at most SERVER_DATA_MAX_EDIT element insertions or
+//	deletions. Over this limit, the whole middle part is one hunk
+//=============================================================================
+void ServerVersions::diff(const std::vector<std::string> &old_data,const std::vector<std::string> &new_data,std::vector<Hunk> &hunks)
+{
+	hunks.clear();
+
+	long n = old_data.size();
+	long m = new_data.size();
+	long head = 0;
+	while (head < n && head < m && old_data[head] == new_data[head])
+		head++;
+	long tail = 0;
+	while (tail < n - head && tail < m - head && old_data[n - 1 - tail] == new_data[m - 1 - tail])
+		tail++;
+
+	long nb_old = n - head - tail;
+	long nb_new = m - head - tail;
+	if (nb_old == 0 && nb_new == 0)
+		return;
+
+//
+// v[off + k] is the furthest old data index reached on diagonal k.
+// Its value after each step is kept to get the edit script back
+//
+
+	long max_d = nb_old + nb_new;
+	if (max_d > SERVER_DATA_MAX_EDIT)
+		max_d = SERVER_DATA_MAX_EDIT;
+	long off = max_d + 1;
+	std::vector<long> v(2 * max_d + 3,0);
+	std::vector<std::vector<long> > trace;
+
+	long d;
+	bool found = false;
+	for (d = 0;d <= max_d && found == false;d++)
+	{
+		for (long k = -d;k <= d;k = k + 2)
+		{
+			long x;
+			if (k == -d || (k != d && v[off + k - 1] < v[off + k + 1]))
+				x = v[off + k + 1];
+			else
+				x = v[off + k - 1] + 1;
+			long y = x - k;
+			while (x < nb_old && y < nb_new && old_data[head + x] == new_data[head + y])
+			{
+				x++;
+				y++;
+			}
+			v[off + k] = x;
+			if (x >= nb_old && y >= nb_new)
+			{
+				found = true;
+				break;
+			}
+		}
+		trace.push_back(v);
+	}
+
+	if (found == false)
+	{
+		Hunk h = {(unsigned long)head,(unsigned long)nb_old,(unsigned long)head,(unsigned long)nb_new};
+		hunks.push_back(h);
+		return;
+	}
+
+//
+// Walk back from the end. Each step is one insertion or deletion,
+// consecutive ones are merged in one hunk
+//
+
+	long x = nb_old;
+	long y = nb_new;
+	for (d = trace.size() - 1;d > 0;d--)
+	{
+		std::vector<long> &prev_v = trace[d - 1];
+		long k = x - y;
+		long prev_k;
+		if (k == -d || (k != d && prev_v[off + k - 1] < prev_v[off + k + 1]))
+			prev_k = k + 1;
+		else
+			prev_k = k - 1;
+		long prev_x = prev_v[off + prev_k];
+		long prev_y = prev_x - prev_k;
+
+		unsigned long old_pos = head + prev_x;
+		unsigned long new_pos = head + prev_y;
+		bool insert = prev_k == k + 1;
+
+		if (hunks.empty() == false && hunks.back().old_start == old_pos + (insert == true ? 0 : 1) &&
+			hunks.back().new_start == new_pos + (insert == true ? 1 : 0))
+		{
+			Hunk &h = hunks.back();
+			h.old_start = old_pos;
+			h.new_start = new_pos;
+			if (insert == true)
+				h.new_len++;
+			else
+				h.old_len++;
+		}
+		else
+		{
+			Hunk h = {old_pos,insert == true ? 0UL : 1UL,new_pos,insert == true ? 1UL : 0UL};
+			hunks.push_back(h);
+		}
+
+		x = prev_x;
+		y = prev_y;
+	}
+
+	std::reverse(hunks.begin(),hunks.end());
+}
+
+}	//	namespace
@@ -0,0 +1,227 @@
+//=============================================================================
+//
+// file :        server_cache.h
+//
+// description : Include for the in-memory cache of the data returned by
+//               the DbGetDataForServerCache command (device server startup).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _SERVER_CACHE_H
+#define _SERVER_CACHE_H
+
+#include <tango.h>
+#include <time.h>
+#include <set>
+#include <list>
+
+#define	DEFAULT_SERVER_CACHE_TIMEOUT	60
+#define	DEFAULT_SERVER_VERSIONS_SIZE	64		// MB
+
+//
+// DbGetDataForServerCacheDelta reply status and maximum number of
+// element insertions/deletions searched when computing a delta
+//
+
+#define	SERVER_DATA_UNCHANGED			0
+#define	SERVER_DATA_DELTA				1
+#define	SERVER_DATA_FULL				2
+#define	SERVER_DATA_MAX_EDIT			256
+
+namespace DataBase_ns {
+
+//=========================================================
+/**
+ *	Cache of the DbGetDataForServerCache replies (result of the ds_start
+ *	stored procedure split on the NUL characters).
+ *
+ *	Entries are keyed by the lower case server name, host name (without
+ *	the Tango release appended by the client) and by the pipe flag (the
+ *	client release is >= 9). Every entry keeps the classes and devices
+ *	of the server. A change of a property (device, class, attribute or
+ *	pipe), of a device definition or of the admin device import info
+ *	removes the entries which depend on it. A change of the DServer or
+ *	Default class properties, of the CtrlSystem object properties or of
+ *	the access control device removes all entries.
+ *	The classes and devices are read before calling the stored
+ *	procedure and registered with start(). An invalidation matching
+ *	them while the procedure runs prevents insert() to store the
+ *	(maybe outdated) result. Entries also expire after a timeout to
+ *	cover the case of several Databaseds sharing the same MySQL database.
+ */
+//=========================================================
+class ServerCache: public omni_mutex
+{
+public:
+	typedef struct
+	{
+		std::string					server;
+		std::string					host;
+		std::set<std::string>		classes;
+		std::set<std::string>		devices;
+		std::vector<std::string>	data;
+		time_t						stamp;
+	} ServerEntry;
+
+	ServerCache();
+
+	void set_timeout(int);
+	bool is_enabled() {return timeout > 0;}
+
+/**
+ *	Build the key for a server name and the host name sent by the
+ *	client (which may end with %%<Tango release>)
+ */
+	static std::string make_key(const char *,const char *,std::string &,std::string &);
+
+	bool lookup(const std::string &,std::vector<std::string> &);
+	void get_stats(unsigned long long &,unsigned long long &);
+	unsigned long start(ServerEntry &);
+	void insert(unsigned long,const std::string &,ServerEntry &);
+	void abort(unsigned long);
+	void set_ca_device(const std::string &);
+
+/**
+ *	Invalidation methods. The names may be SQL LIKE patterns
+ */
+	void invalidate_server(const std::string &);
+	void invalidate_device(const std::string &);
+	void invalidate_import(const std::string &);
+	void invalidate_class(const std::string &);
+	void invalidate_event(const std::string &);
+	void invalidate_object(const std::string &);
+	void clear();
+
+private:
+	enum MatchType {MATCH_SERVER,MATCH_DEVICE,MATCH_ADMIN,MATCH_CLASS,MATCH_HOST};
+
+	typedef struct
+	{
+		ServerEntry		entry;
+		bool			outdated;
+	} PendingEntry;
+
+	void erase_matching(MatchType,const std::string &);
+	bool match(MatchType,const std::string &,const ServerEntry &);
+	bool match_one(const std::string &,const std::set<std::string> &);
+
+	int										timeout;
+	unsigned long							last_id;
+	unsigned long long						nb_hit;
+	unsigned long long						nb_miss;
+	std::string								ca_device;
+	std::map<std::string,ServerEntry>		entries;
+	std::map<unsigned long,PendingEntry>	pending;
+};
+
+//=========================================================
+/**
+ *	Fill one ServerCache entry. The registration done by start() is
+ *	cancelled by the dtor if store() is not called
+ */
+//=========================================================
+class ServerCacheFill
+{
+public:
+	ServerCacheFill(ServerCache *c,const std::string &k):cache(c),key(k),id(0) {}
+	~ServerCacheFill() {if (id != 0) cache->abort(id);}
+
+	void start(ServerCache::ServerEntry &entry) {id = cache->start(entry);}
+	void store(ServerCache::ServerEntry &entry) {if (id != 0) {cache->insert(id,key,entry);id = 0;}}
+
+private:
+	ServerCache		*cache;
+	std::string		key;
+	unsigned long	id;
+};
+
+//=========================================================
+/**
+ *	Versions of the DbGetDataForServerCache data (delta command).
+ *
+ *	The last data sent for each server (same key than the ServerCache)
+ *	is kept with its version. The version changes when the data read
+ *	for the server differ from the kept ones. After a write command,
+ *	this is detected as soon as the ServerCache entry has been removed.
+ *	The token given to the client is the version prefixed by an
+ *	identifier of this DB server instance. A client giving the token of
+ *	the kept data gets the changes between them and the current data as
+ *	a list of hunks: Hunk i replaces old_len elements of the previous
+ *	data starting at old_start by new_len elements of the current data
+ *	starting at new_start.
+ *	The memory used by the kept data is limited: The data of the
+ *	servers not asked for the longest time are removed first (their
+ *	clients then get the full data).
+ */
+//=========================================================
+class ServerVersions: public omni_mutex
+{
+public:
+	typedef struct
+	{
+		unsigned long	old_start;
+		unsigned long	old_len;
+		unsigned long	new_start;
+		unsigned long	new_len;
+	} Hunk;
+
+	ServerVersions():last_version(0),max_size(DEFAULT_SERVER_VERSIONS_SIZE * 1024 * 1024),total_size(0) {}
+
+	void set_instance(const std::string &);
+	void set_max_size(long);
+	int update(const std::string &,const std::vector<std::string> &,const std::string &,std::string &,std::vector<Hunk> &);
+
+	static void diff(const std::vector<std::string> &,const std::vector<std::string> &,std::vector<Hunk> &);
+
+private:
+	typedef struct
+	{
+		unsigned long							version;
+		std::vector<std::string>				data;
+		size_t									size;
+		std::list<std::string>::iterator		lru_pos;
+	} VersionEntry;
+
+	std::string make_token(unsigned long);
+	void store(VersionEntry &,const std::vector<std::string> &);
+	void trim();
+
+	std::string								instance;
+	unsigned long							last_version;
+	size_t									max_size;		// Bytes
+	size_t									total_size;
+	std::map<std::string,VersionEntry>		entries;
+	std::list<std::string>					lru;			// Keys, most recently asked first
+};
+
+}	//	namespace
+
+#endif	// _SERVER_CACHE_H
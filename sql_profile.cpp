@@ -0,0 +1,339 @@
+//=============================================================================
+//
+// file :        sql_profile.cpp
+//
+// description : SQL statements profiling (GetSqlProfile command).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+
+#include <sql_profile.h>
+#include <algorithm>
+
+namespace DataBase_ns
+{
+
+//
+// Phases of the statements run by the calling thread since the start of
+// the command it executes
+//
+
+typedef struct
+{
+	double				phases[SqlProfile::NB_PHASE];
+	unsigned long long	stmts;
+} CmdPhases;
+
+static thread_local CmdPhases cur_cmd;
+
+//=============================================================================
+//	Allocate the per command counters. As for the timing statistics, a re-
+//	initialisation only resets them
+//=============================================================================
+void SqlProfile::init(int nb)
+{
+	if (cmds == NULL)
+	{
+		cmds = new CmdCounter[nb];
+		nb_cmd = nb;
+	}
+	reset();
+}
+//=============================================================================
+//	The template shard of the calling thread. Threads get the shards in turn
+//=============================================================================
+int SqlProfile::shard_index()
+{
+	static std::atomic<unsigned int> next_shard(0);
+	static thread_local int index = -1;
+
+	if (index == -1)
+		index = next_shard.fetch_add(1,std::memory_order_relaxed) % SQL_PROFILE_NB_SHARD;
+	return index;
+}
+//=============================================================================
+//	A command starts in the calling thread
+//=============================================================================
+void SqlProfile::start_command()
+{
+	for (int i = 0;i < NB_PHASE;i++)
+		cur_cmd.phases[i] = 0.0;
+	cur_cmd.stmts = 0;
+}
+//=============================================================================
+//	The command executed by the calling thread is done (total duration in
+//	ms): Add its phases to its counters
+//=============================================================================
+void SqlProfile::end_command(int cmd,double total)
+{
+	if (cmd >= nb_cmd)
+		return;
+
+	double other = total - cur_cmd.phases[POOL_WAIT] - cur_cmd.phases[EXEC] - cur_cmd.phases[STORE];
+	cur_cmd.phases[OTHER] = other > 0.0 ? other : 0.0;
+
+	CmdCounter &c = cmds[cmd];
+	c.calls.fetch_add(1,std::memory_order_relaxed);
+	c.stmts.fetch_add(cur_cmd.stmts,std::memory_order_relaxed);
+	for (int i = 0;i < NB_PHASE;i++)
+		c.phases[i].fetch_add((unsigned long long)(cur_cmd.phases[i] * 1.0e6),std::memory_order_relaxed);
+}
+//=============================================================================
+//	Time spent to get a MySQL connection (ms)
+//=============================================================================
+void SqlProfile::add_pool_wait(double wait)
+{
+	cur_cmd.phases[POOL_WAIT] = cur_cmd.phases[POOL_WAIT] + wait;
+}
+//=============================================================================
+//	A statement is done: Execution and result transfer durations (ms) and
+//	number of rows (returned or affected). Its template is only computed
+//	and counted if enabled
+//=============================================================================
+void SqlProfile::add_statement(const char *sql,size_t len,double exec,double store,unsigned long long rows)
+{
+	cur_cmd.phases[EXEC] = cur_cmd.phases[EXEC] + exec;
+	cur_cmd.phases[STORE] = cur_cmd.phases[STORE] + store;
+	cur_cmd.stmts++;
+
+	if (templates == false)
+		return;
+
+	std::string templ;
+	make_template(sql,len,templ);
+
+	Shard &sh = shards[shard_index()];
+	omni_mutex_lock guard(sh.mutex);
+
+	std::map<std::string,StmtCounter>::iterator ite = sh.stmts.find(templ);
+	if (ite == sh.stmts.end())
+	{
+		StmtCounter init = {0,0.0,0.0,0.0,0};
+		if (sh.stmts.size() >= SQL_PROFILE_MAX_TEMPLATE)
+			templ = SQL_PROFILE_OTHER;
+		ite = sh.stmts.insert(std::make_pair(templ,init)).first;
+	}
+
+	StmtCounter &c = ite->second;
+	c.count++;
+	c.exec = c.exec + exec;
+	c.store = c.store + store;
+	if (exec + store > c.maximum)
+		c.maximum = exec + store;
+	c.rows = c.rows + rows;
+}
+//=============================================================================
+//	Statement template: The literals (strings and numbers) are replaced by
+//	'?', a list of literals by a single '?' and the white spaces by a single
+//	space. The template is truncated to SQL_PROFILE_MAX_SQL_LENGTH characters
+//=============================================================================
+static void add_placeholder(std::string &templ)
+{
+	size_t n = templ.size();
+	if (n >= 2 && templ[n - 1] == ',' && templ[n - 2] == '?')
+		templ.resize(n - 1);
+	else if (n >= 3 && templ[n - 1] == ' ' && templ[n - 2] == ',' && templ[n - 3] == '?')
+		templ.resize(n - 2);
+	else
+		templ.push_back('?');
+}
+
+void SqlProfile::make_template(const char *sql,size_t len,std::string &templ)
+{
+	templ.clear();
+
+	size_t i = 0;
+	while (i < len && templ.size() < SQL_PROFILE_MAX_SQL_LENGTH)
+	{
+		char c = sql[i];
+		if (c == '\'' || c == '"')
+		{
+			for (i++;i < len;i++)
+			{
+				if (sql[i] == '\\')
+					i++;
+				else if (sql[i] == c)
+				{
+					if (i + 1 < len && sql[i + 1] == c)
+						i++;
+					else
+						break;
+				}
+			}
+			i++;
+			add_placeholder(templ);
+		}
+		else if (isdigit((unsigned char)c) != 0 &&
+				 (i == 0 || (isalnum((unsigned char)sql[i - 1]) == 0 && sql[i - 1] != '_')))
+		{
+			while (i < len && (isdigit((unsigned char)sql[i]) != 0 || sql[i] == '.'))
+				i++;
+			add_placeholder(templ);
+		}
+		else if (isspace((unsigned char)c) != 0)
+		{
+			if (templ.empty() == false && templ[templ.size() - 1] != ' ')
+				templ.push_back(' ');
+			i++;
+		}
+		else
+		{
+			templ.push_back(c);
+			i++;
+		}
+	}
+
+//
+// Multi-rows INSERT
+//
+
+	const char *rows[] = {"(?),(?)","(?), (?)"};
+	for (int j = 0;j < 2;j++)
+	{
+		std::string::size_type pos;
+		while ((pos = templ.find(rows[j])) != std::string::npos)
+			templ.erase(pos + 3,::strlen(rows[j]) - 3);
+	}
+}
+//=============================================================================
+//	Profile as text lines: Per command (average per call, in ms), then per
+//	statement template (total time in ms), the most expensive first
+//=============================================================================
+static bool cmp_stmt(const std::pair<double,std::string> &a,const std::pair<double,std::string> &b)
+{
+	return a.first > b.first;
+}
+
+void SqlProfile::get_report(const std::vector<std::string> &cmd_names,std::vector<std::string> &lines)
+{
+	char line[256];
+
+	lines.push_back("command\tcalls\tstatements\tpool wait\tmysql\tstore result\tother");
+	for (int i = 0;i < nb_cmd && i < (int)cmd_names.size();i++)
+	{
+		CmdCounter &c = cmds[i];
+		unsigned long long calls = c.calls.load(std::memory_order_relaxed);
+		if (calls == 0)
+			continue;
+
+		double avg[NB_PHASE];
+		for (int j = 0;j < NB_PHASE;j++)
+			avg[j] = (double)c.phases[j].load(std::memory_order_relaxed) / calls / 1.0e6;
+		sprintf(line,"\t%llu\t%.1f\t%6.3f\t%6.3f\t%6.3f\t%6.3f",calls,
+				(double)c.stmts.load(std::memory_order_relaxed) / calls,
+				avg[POOL_WAIT],avg[EXEC],avg[STORE],avg[OTHER]);
+		lines.push_back(cmd_names[i] + line);
+	}
+
+	std::map<std::string,StmtCounter> all;
+	for (int i = 0;i < SQL_PROFILE_NB_SHARD;i++)
+	{
+		omni_mutex_lock guard(shards[i].mutex);
+		std::map<std::string,StmtCounter>::iterator ite;
+		for (ite = shards[i].stmts.begin();ite != shards[i].stmts.end();++ite)
+		{
+			std::map<std::string,StmtCounter>::iterator pos = all.find(ite->first);
+			if (pos == all.end())
+			{
+				all.insert(*ite);
+				continue;
+			}
+			StmtCounter &c = pos->second;
+			c.count = c.count + ite->second.count;
+			c.exec = c.exec + ite->second.exec;
+			c.store = c.store + ite->second.store;
+			if (ite->second.maximum > c.maximum)
+				c.maximum = ite->second.maximum;
+			c.rows = c.rows + ite->second.rows;
+		}
+	}
+
+	std::vector<std::pair<double,std::string> > order;
+	std::map<std::string,StmtCounter>::iterator ite;
+	for (ite = all.begin();ite != all.end();++ite)
+		order.push_back(std::make_pair(ite->second.exec + ite->second.store,ite->first));
+	std::sort(order.begin(),order.end(),cmp_stmt);
+
+	lines.push_back(" ");
+	if (templates == false)
+	{
+		lines.push_back("Statement templates not profiled (sqlProfileTemplates property = 0)");
+		return;
+	}
+	lines.push_back("count\tmysql\tstore result\tmaximum\trows\tstatement");
+	for (size_t i = 0;i < order.size();i++)
+	{
+		StmtCounter &c = all[order[i].second];
+		sprintf(line,"%llu\t%.3f\t%.3f\t%6.3f\t%llu\t",c.count,c.exec,c.store,c.maximum,c.rows);
+		lines.push_back(line + order[i].second);
+	}
+}
+//=============================================================================
+//	Counters of one command: Calls, statements and total time of each phase
+//	(in s)
+//=============================================================================
+void SqlProfile::get_command(int cmd,unsigned long long &calls,unsigned long long &stmts,double *phases)
+{
+	calls = stmts = 0;
+	for (int i = 0;i < NB_PHASE;i++)
+		phases[i] = 0.0;
+	if (cmd >= nb_cmd)
+		return;
+
+	CmdCounter &c = cmds[cmd];
+	calls = c.calls.load(std::memory_order_relaxed);
+	stmts = c.stmts.load(std::memory_order_relaxed);
+	for (int i = 0;i < NB_PHASE;i++)
+		phases[i] = (double)c.phases[i].load(std::memory_order_relaxed) / 1.0e9;
+}
+//=============================================================================
+//=============================================================================
+void SqlProfile::reset()
+{
+	for (int i = 0;i < nb_cmd;i++)
+	{
+		CmdCounter &c = cmds[i];
+		c.calls.store(0,std::memory_order_relaxed);
+		c.stmts.store(0,std::memory_order_relaxed);
+		for (int j = 0;j < NB_PHASE;j++)
+			c.phases[j].store(0,std::memory_order_relaxed);
+	}
+
+	for (int i = 0;i < SQL_PROFILE_NB_SHARD;i++)
+	{
+		omni_mutex_lock guard(shards[i].mutex);
+		shards[i].stmts.clear();
+	}
+}
+
+}	//	namespace
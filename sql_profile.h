@@ -0,0 +1,143 @@
+//=============================================================================
+//
+// file :        sql_profile.h
+//
+// description : Include for the SQL statements profiling (GetSqlProfile
+//               command) and slow statement log.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _SQL_PROFILE_H
+#define _SQL_PROFILE_H
+
+#include <tango.h>
+#include <atomic>
+
+//
+// Default slow statement threshold (in ms, 0 means no slow statement log),
+// default statement template profiling (0 = off), maximum number of
+// statement templates (the next ones are counted together) and of
+// characters of a template or of a logged statement
+//
+
+#define	DEFAULT_SLOW_QUERY_THRESHOLD	0
+#define	DEFAULT_SQL_PROFILE_TEMPLATES	0
+#define	SQL_PROFILE_MAX_TEMPLATE		1000
+#define	SQL_PROFILE_MAX_SQL_LENGTH		512
+#define	SQL_PROFILE_NB_SHARD			16
+#define	SQL_PROFILE_OTHER				"(other statements)"
+
+namespace DataBase_ns {
+
+//=========================================================
+/**
+ *	Profiling of the SQL statements.
+ *
+ *	Each statement is timed in two phases: Its execution by MySQL
+ *	(mysql_real_query / mysql_stmt_execute) and the transfer of its result
+ *	(mysql_store_result). The time spent to get a MySQL connection from
+ *	the pool is also measured.
+ *	When enabled, the statements are aggregated per template, the
+ *	statement text with its literals replaced by '?'. The templates are kept in
+ *	SQL_PROFILE_NB_SHARD maps, each thread using always the same one.
+ *	The phases are also summed per command (timing index of the command):
+ *	The statements run by a thread are added to the command it executes.
+ *	The remaining time of the command (its own CPU, reply building) is
+ *	given as "other".
+ */
+//=========================================================
+class SqlProfile
+{
+public:
+	enum Phase
+	{
+		POOL_WAIT = 0,
+		EXEC,
+		STORE,
+		OTHER,
+		NB_PHASE
+	};
+
+	SqlProfile():nb_cmd(0),cmds(NULL),slow_threshold(DEFAULT_SLOW_QUERY_THRESHOLD),
+				 templates(DEFAULT_SQL_PROFILE_TEMPLATES != 0) {}
+	~SqlProfile() {delete [] cmds;}
+
+	void init(int);
+	void set_slow_threshold(long ms) {slow_threshold = ms;}
+	bool is_slow(double ms) {return slow_threshold > 0 && ms >= slow_threshold;}
+	void set_templates(bool on) {templates = on;}
+
+	static void start_command();
+	void end_command(int,double);
+	static void add_pool_wait(double);
+	void add_statement(const char *,size_t,double,double,unsigned long long);
+
+	void get_report(const std::vector<std::string> &,std::vector<std::string> &);
+	void get_command(int,unsigned long long &,unsigned long long &,double *);
+	void reset();
+
+	static void make_template(const char *,size_t,std::string &);
+
+private:
+	static int shard_index();
+
+	typedef struct
+	{
+		std::atomic<unsigned long long>	calls;
+		std::atomic<unsigned long long>	stmts;
+		std::atomic<unsigned long long>	phases[NB_PHASE];
+	} CmdCounter;
+
+	typedef struct
+	{
+		unsigned long long	count;
+		double				exec;
+		double				store;
+		double				maximum;
+		unsigned long long	rows;
+	} StmtCounter;
+
+	typedef struct
+	{
+		omni_mutex							mutex;
+		std::map<std::string,StmtCounter>	stmts;
+	} Shard;
+
+	int							nb_cmd;
+	CmdCounter					*cmds;
+	long						slow_threshold;
+	bool						templates;
+	Shard						shards[SQL_PROFILE_NB_SHARD];
+};
+
+}	//	namespace
+
+#endif	// _SQL_PROFILE_H
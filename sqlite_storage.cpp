@@ -0,0 +1,1126 @@
+//=============================================================================
+//
+// file :        sqlite_storage.cpp
+//
+// description : SQLite storage engine (WAL journal mode, prepared
+//               statements, C++ DbGetDataForServerCache data).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+#include <DataBase.h>
+#include <sqlite_storage.h>
+
+#include <strings.h>
+
+//
+// Tables of create_db_tables.sql used by the engine, in the SQLite dialect.
+// The name columns are compared without case (MySQL collation) and the
+// indexes are the ones of the queries done here
+//
+
+static const char *create_tables_sql =
+	"CREATE TABLE IF NOT EXISTS device ("
+	"  name varchar(255) NOT NULL default 'nada' COLLATE NOCASE,"
+	"  alias varchar(255) default NULL COLLATE NOCASE,"
+	"  domain varchar(85) NOT NULL default 'nada' COLLATE NOCASE,"
+	"  family varchar(85) NOT NULL default 'nada' COLLATE NOCASE,"
+	"  member varchar(85) NOT NULL default 'nada' COLLATE NOCASE,"
+	"  exported int(11) default 0,"
+	"  ior text,"
+	"  host varchar(255) NOT NULL default 'nada' COLLATE NOCASE,"
+	"  server varchar(255) NOT NULL default 'nada' COLLATE NOCASE,"
+	"  pid int(11) default 0,"
+	"  class varchar(255) NOT NULL default 'nada' COLLATE NOCASE,"
+	"  version varchar(8) NOT NULL default 'nada',"
+	"  started datetime NULL default NULL,"
+	"  stopped datetime NULL default NULL,"
+	"  comment text);"
+	"CREATE INDEX IF NOT EXISTS device_name ON device (name);"
+	"CREATE INDEX IF NOT EXISTS device_alias ON device (alias);"
+	"CREATE INDEX IF NOT EXISTS device_server ON device (server);"
+
+	"CREATE TABLE IF NOT EXISTS server ("
+	"  name varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  host varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  mode int(11) default 0,"
+	"  level int(11) default 0);"
+	"CREATE INDEX IF NOT EXISTS server_name ON server (name);"
+
+	"CREATE TABLE IF NOT EXISTS event ("
+	"  name varchar(255) default NULL COLLATE NOCASE,"
+	"  exported int(11) default NULL,"
+	"  ior text,"
+	"  host varchar(255) default NULL COLLATE NOCASE,"
+	"  server varchar(255) default NULL COLLATE NOCASE,"
+	"  pid int(11) default NULL,"
+	"  version varchar(8) default NULL,"
+	"  started datetime NULL default NULL,"
+	"  stopped datetime NULL default NULL);"
+	"CREATE INDEX IF NOT EXISTS event_name ON event (name);"
+
+	"CREATE TABLE IF NOT EXISTS property ("
+	"  object varchar(255) default NULL COLLATE NOCASE,"
+	"  name varchar(255) default NULL COLLATE NOCASE,"
+	"  count int(11) default NULL,"
+	"  value text default NULL,"
+	"  updated timestamp NOT NULL default CURRENT_TIMESTAMP,"
+	"  accessed timestamp NOT NULL default '2000-01-01 00:00:00',"
+	"  comment text);"
+	"CREATE INDEX IF NOT EXISTS property_object ON property (object,name);"
+
+	"CREATE TABLE IF NOT EXISTS property_class ("
+	"  class varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  name varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  count int(11) NOT NULL default 0,"
+	"  value text default NULL,"
+	"  updated timestamp NOT NULL default CURRENT_TIMESTAMP,"
+	"  accessed timestamp NOT NULL default '2000-01-01 00:00:00',"
+	"  comment text);"
+	"CREATE INDEX IF NOT EXISTS property_class_index ON property_class (class,name,count);"
+
+	"CREATE TABLE IF NOT EXISTS property_device ("
+	"  device varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  name varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  domain varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  family varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  member varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  count int(11) NOT NULL default 0,"
+	"  value text default NULL,"
+	"  updated timestamp NOT NULL default CURRENT_TIMESTAMP,"
+	"  accessed timestamp NOT NULL default '2000-01-01 00:00:00',"
+	"  comment text);"
+	"CREATE INDEX IF NOT EXISTS property_device_index ON property_device (device,name,count);"
+
+	"CREATE TABLE IF NOT EXISTS property_attribute_class ("
+	"  class varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  attribute varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  name varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  count int(11) NOT NULL default 0,"
+	"  value text default NULL,"
+	"  updated timestamp NOT NULL default CURRENT_TIMESTAMP,"
+	"  accessed timestamp NOT NULL default '2000-01-01 00:00:00',"
+	"  comment text);"
+	"CREATE INDEX IF NOT EXISTS property_attribute_class_index ON property_attribute_class (class,attribute,name,count);"
+
+	"CREATE TABLE IF NOT EXISTS property_attribute_device ("
+	"  device varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  attribute varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  name varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  count int(11) NOT NULL default 0,"
+	"  value text default NULL,"
+	"  updated timestamp NOT NULL default CURRENT_TIMESTAMP,"
+	"  accessed timestamp NOT NULL default '2000-01-01 00:00:00',"
+	"  comment text);"
+	"CREATE INDEX IF NOT EXISTS property_attribute_device_index ON property_attribute_device (device,attribute,name,count);"
+
+	"CREATE TABLE IF NOT EXISTS property_pipe_class ("
+	"  class varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  pipe varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  name varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  count int(11) NOT NULL default 0,"
+	"  value text default NULL,"
+	"  updated timestamp NOT NULL default CURRENT_TIMESTAMP,"
+	"  accessed timestamp NOT NULL default '2000-01-01 00:00:00',"
+	"  comment text);"
+	"CREATE INDEX IF NOT EXISTS property_pipe_class_index ON property_pipe_class (class,pipe,name,count);"
+
+	"CREATE TABLE IF NOT EXISTS property_pipe_device ("
+	"  device varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  pipe varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  name varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  count int(11) NOT NULL default 0,"
+	"  value text default NULL,"
+	"  updated timestamp NOT NULL default CURRENT_TIMESTAMP,"
+	"  accessed timestamp NOT NULL default '2000-01-01 00:00:00',"
+	"  comment text);"
+	"CREATE INDEX IF NOT EXISTS property_pipe_device_index ON property_pipe_device (device,pipe,name,count);"
+
+	"CREATE TABLE IF NOT EXISTS device_history_id ("
+	"  id bigint unsigned NOT NULL default 0);"
+	"INSERT INTO device_history_id SELECT 0 WHERE NOT EXISTS (SELECT * FROM device_history_id);"
+
+	"CREATE TABLE IF NOT EXISTS property_device_hist ("
+	"  id bigint unsigned NOT NULL default 0,"
+	"  date timestamp NOT NULL default CURRENT_TIMESTAMP,"
+	"  device varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  name varchar(255) NOT NULL default '' COLLATE NOCASE,"
+	"  count int(11) NOT NULL default 0,"
+	"  value text);"
+	"CREATE INDEX IF NOT EXISTS property_device_hist_index ON property_device_hist (device,name,id);";
+
+//
+// SQL text of the prepared statements, in the SqliteStmtId order. LIKE
+// patterns are escaped with a backslash (replace_wildcard())
+//
+
+static const char *stmt_sql[] =
+{
+	// SQ_IMPORT_DEVICE_BY_NAME
+	"SELECT exported,ior,version,pid,server,host,class,name FROM device WHERE name = ?",
+	// SQ_IMPORT_DEVICE_BY_ALIAS
+	"SELECT exported,ior,version,pid,server,host,class,name FROM device WHERE alias = ?",
+	// SQ_EXPORT_GET_DEVICE
+	"SELECT server,host FROM device WHERE name = ?",
+	// SQ_EXPORT_UPDATE_DEVICE
+	"UPDATE device SET exported=1,ior=?,host=?,pid=?,version=?,started=datetime('now') WHERE name = ?",
+	// SQ_EXPORT_UPDATE_SERVER
+	"UPDATE server SET host=? WHERE name = ?",
+	// SQ_UNEXPORT_DEVICE
+	"UPDATE device SET exported=0,stopped=datetime('now') WHERE name = ?",
+	// SQ_GET_DEVICE_PROPERTY
+	"SELECT count,value,name FROM property_device WHERE device = ? AND name LIKE ? ESCAPE '\\' ORDER BY count",
+	// SQ_GET_DEVICE_PROPERTY_NAMES
+	"SELECT DISTINCT name FROM property_device WHERE device = ? AND name LIKE ? ESCAPE '\\'",
+	// SQ_DELETE_DEVICE_PROPERTY
+	"DELETE FROM property_device WHERE device = ? AND name = ?",
+	// SQ_INSERT_DEVICE_PROPERTY
+	"INSERT INTO property_device (device,name,count,value,updated,accessed) VALUES (?,?,?,?,datetime('now'),datetime('now'))",
+	// SQ_INSERT_DEVICE_PROPERTY_HIST
+	"INSERT INTO property_device_hist (device,id,name,count,value,date) VALUES (?,?,?,?,?,datetime('now'))",
+	// SQ_NEXT_DEVICE_HIST_ID
+	"UPDATE device_history_id SET id=id+1",
+	// SQ_GET_DEVICE_HIST_ID
+	"SELECT id FROM device_history_id",
+	// SQ_PURGE_FIRST_ID
+	"SELECT DISTINCT id FROM property_device_hist WHERE device = ? AND name = ? ORDER BY id DESC LIMIT ?,1",
+	// SQ_PURGE_DEVICE_PROPERTY_HIST
+	"DELETE FROM property_device_hist WHERE device = ? AND name = ? AND id <= ?",
+	// SQ_IMPORT_EVENT
+	"SELECT exported,ior,version,pid,host FROM event WHERE name LIKE REPLACE(?,'_','\\_') ESCAPE '\\'",
+	// SQ_SERVER_DEVICES
+	"SELECT name,class FROM device WHERE server = ? ORDER BY name",
+	// SQ_SERVER_CLASSES (in the device table order, like the ds_start class cursor)
+	"SELECT class FROM device WHERE server = ? GROUP BY class ORDER BY MIN(rowid)",
+	// SQ_DEVICE_PROPS
+	"SELECT name,count,value FROM property_device WHERE device = ? ORDER BY name,count",
+	// SQ_CLASS_PROPS
+	"SELECT name,count,value FROM property_class WHERE class = ? ORDER BY name,count",
+	// SQ_DEVICE_ATT_PROPS
+	"SELECT attribute,name,count,value FROM property_attribute_device WHERE device = ? ORDER BY attribute,name,count",
+	// SQ_CLASS_ATT_PROPS
+	"SELECT attribute,name,count,value FROM property_attribute_class WHERE class = ? ORDER BY attribute,name,count",
+	// SQ_DEVICE_PIPE_PROPS
+	"SELECT pipe,name,count,value FROM property_pipe_device WHERE device = ? ORDER BY pipe,name,count",
+	// SQ_CLASS_PIPE_PROPS
+	"SELECT pipe,name,count,value FROM property_pipe_class WHERE class = ? ORDER BY pipe,name,count",
+	// SQ_CTRL_PROPS
+	"SELECT name,count,value FROM property WHERE object = 'CtrlSystem' ORDER BY name,count",
+	// SQ_DELETE_DEVICE
+	"DELETE FROM device WHERE name = ?",
+	// SQ_INSERT_DEVICE
+	"INSERT INTO device (name,domain,family,member,exported,ior,host,server,pid,class,version) "
+	"VALUES (?,?,?,?,0,'nada','nada',?,0,?,'0')"
+};
+
+namespace DataBase_ns
+{
+
+static std::string lower_string(const std::string &str)
+{
+	std::string lower(str);
+	std::transform(lower.begin(),lower.end(),lower.begin(),::tolower);
+	return lower;
+}
+
+//
+// Value as stored by MySQL from its escape_string() literal: A backslash
+// sent by the client before a quote is removed
+//
+
+static std::string stored_value(const std::string &value)
+{
+	std::string stored;
+	stored.reserve(value.size());
+	for (size_t i = 0;i < value.size();i++)
+	{
+		if (value[i] == '\\' && i + 1 < value.size() && (value[i + 1] == '"' || value[i + 1] == '\''))
+			continue;
+		stored += value[i];
+	}
+	return stored;
+}
+
+//
+// Set a number element of a ds_start result
+//
+
+static void set_count(std::vector<std::string> &out,size_t pos,long nb)
+{
+	char buf[32];
+	sprintf(buf,"%ld",nb);
+	out[pos] = buf;
+}
+
+//=========================================================
+/**
+ *	Properties in the ds_start result format, added row by row:
+ *	Their number then for each of them, its name, its number of
+ *	values and the values. A property starts at its row with
+ *	count 1 (see DsStart::add_props())
+ */
+//=========================================================
+class PropWriter
+{
+public:
+	PropWriter(std::vector<std::string> &o):out(o),prop_nb_pos(0),prop_nb(0),elt_nb_pos(0),elt_nb(0) {}
+
+	void start()
+	{
+		prop_nb_pos = out.size();
+		out.push_back("0");
+		prop_nb = 0;
+		elt_nb = 0;
+	}
+
+//
+// Row whose name, count and value columns start at col
+//
+
+	void add(SqliteStmt &stmt,int col)
+	{
+		if (stmt.is_null(col + 1) == false && stmt.get_long(col + 1) == 1)
+		{
+			if (prop_nb != 0)
+				set_count(out,elt_nb_pos,elt_nb);
+			const char *name = stmt.get_string(col);
+			out.push_back(name != NULL ? name : "");
+			elt_nb_pos = out.size();
+			out.push_back("");
+			prop_nb++;
+			elt_nb = 0;
+		}
+		const char *val = stmt.get_string(col + 2);
+		out.push_back(val != NULL ? val : "");
+		elt_nb++;
+	}
+
+	void end()
+	{
+		if (prop_nb != 0)
+			set_count(out,elt_nb_pos,elt_nb);
+		set_count(out,prop_nb_pos,prop_nb);
+	}
+
+private:
+	std::vector<std::string>	&out;
+	size_t						prop_nb_pos;
+	long						prop_nb;
+	size_t						elt_nb_pos;
+	long						elt_nb;
+};
+
+//=============================================================================
+//=============================================================================
+SqliteStmt::SqliteStmt(SqliteStorage *st,SqliteStmtId i,const char *m):
+	storage(st),id(i),method(m),nb_bound(0),executed(false),row_pending(false),done(false)
+{
+	stmt = storage->get_stmt(id);
+}
+//=============================================================================
+//=============================================================================
+SqliteStmt::~SqliteStmt()
+{
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+}
+//=============================================================================
+//	Make the statement ready for a new execution
+//=============================================================================
+void SqliteStmt::reset()
+{
+	sqlite3_reset(stmt);
+	nb_bound = 0;
+	executed = false;
+	row_pending = false;
+	done = false;
+}
+//=============================================================================
+//=============================================================================
+void SqliteStmt::bind(const char *str)
+{
+	if (executed == true)
+		reset();
+
+	int ret;
+	if (str == NULL)
+		ret = sqlite3_bind_null(stmt,++nb_bound);
+	else
+		ret = sqlite3_bind_text(stmt,++nb_bound,str,-1,SQLITE_TRANSIENT);
+	if (ret != SQLITE_OK)
+		storage->throw_error(method,SqliteStorage::get_sql(id));
+}
+//=============================================================================
+//=============================================================================
+void SqliteStmt::bind(long long val)
+{
+	if (executed == true)
+		reset();
+
+	if (sqlite3_bind_int64(stmt,++nb_bound,(sqlite3_int64)val) != SQLITE_OK)
+		storage->throw_error(method,SqliteStorage::get_sql(id));
+}
+//=============================================================================
+//	Run the statement up to its first row (kept for fetch())
+//=============================================================================
+void SqliteStmt::execute()
+{
+	if (executed == true)
+	{
+		sqlite3_reset(stmt);
+		row_pending = false;
+		done = false;
+	}
+	executed = true;
+
+	int ret = sqlite3_step(stmt);
+	if (ret == SQLITE_ROW)
+		row_pending = true;
+	else if (ret == SQLITE_DONE)
+		done = true;
+	else
+		storage->throw_error(method,SqliteStorage::get_sql(id));
+}
+//=============================================================================
+//	Get the next row. Return false when there is no more row
+//=============================================================================
+bool SqliteStmt::fetch()
+{
+	if (row_pending == true)
+	{
+		row_pending = false;
+		return true;
+	}
+	if (done == true || executed == false)
+		return false;
+
+	int ret = sqlite3_step(stmt);
+	if (ret == SQLITE_ROW)
+		return true;
+	if (ret != SQLITE_DONE)
+		storage->throw_error(method,SqliteStorage::get_sql(id));
+	done = true;
+	return false;
+}
+
+//=============================================================================
+//=============================================================================
+SqliteTransaction::SqliteTransaction(SqliteStorage *st,const char *m,bool write):
+	storage(st),method(m),committed(false)
+{
+	storage->exec(write == true ? "BEGIN IMMEDIATE" : "BEGIN",method);
+}
+//=============================================================================
+//=============================================================================
+SqliteTransaction::~SqliteTransaction()
+{
+	if (committed == false)
+		storage->rollback();
+}
+//=============================================================================
+//=============================================================================
+void SqliteTransaction::commit()
+{
+	storage->exec("COMMIT",method);
+	committed = true;
+}
+
+//=============================================================================
+//=============================================================================
+SqliteStorage::SqliteStorage(const std::string &f,long depth):
+	file(f),history_depth(depth),db(NULL)
+{
+	for (int i = 0;i < SQ_NB;i++)
+		stmts[i] = NULL;
+}
+//=============================================================================
+//=============================================================================
+SqliteStorage::~SqliteStorage()
+{
+	for (int i = 0;i < SQ_NB;i++)
+	{
+		if (stmts[i] != NULL)
+			sqlite3_finalize(stmts[i]);
+	}
+	if (db != NULL)
+		sqlite3_close(db);
+}
+//=============================================================================
+//	Open (or create) the database file in WAL journal mode, create the
+//	missing tables and prepare the statements
+//=============================================================================
+void SqliteStorage::open()
+{
+	omni_mutex_lock oml(*this);
+
+	if (sqlite3_open_v2(file.c_str(),&db,SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX,NULL) != SQLITE_OK)
+	{
+		TangoSys_OMemStream o;
+		o << "Can't open SQLite database " << file << " (error=" << (db != NULL ? sqlite3_errmsg(db) : "out of memory") << ")" << std::ends;
+		Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),
+									   (const char *)"SqliteStorage::open()");
+	}
+	sqlite3_busy_timeout(db,DEFAULT_SQLITE_BUSY_TIMEOUT);
+
+//
+// The journal mode stays the previous one if the file system does not
+// support WAL (no shared memory), the caller reports it
+//
+
+	sqlite3_stmt *mode_stmt;
+	if (sqlite3_prepare_v2(db,"PRAGMA journal_mode=WAL",-1,&mode_stmt,NULL) != SQLITE_OK)
+		throw_error("open()","PRAGMA journal_mode=WAL");
+	journal_mode.clear();
+	if (sqlite3_step(mode_stmt) == SQLITE_ROW && sqlite3_column_text(mode_stmt,0) != NULL)
+		journal_mode = lower_string((const char *)sqlite3_column_text(mode_stmt,0));
+	sqlite3_finalize(mode_stmt);
+
+	exec("PRAGMA synchronous=NORMAL","open()");
+	create_tables();
+
+	for (int i = 0;i < SQ_NB;i++)
+	{
+		if (sqlite3_prepare_v2(db,stmt_sql[i],-1,&stmts[i],NULL) != SQLITE_OK)
+			throw_error("open()",stmt_sql[i]);
+	}
+}
+//=============================================================================
+//=============================================================================
+void SqliteStorage::create_tables()
+{
+	SqliteTransaction tr(this,"open()");
+	exec(create_tables_sql,"open()");
+	tr.commit();
+}
+//=============================================================================
+//	Run SQL without result
+//=============================================================================
+void SqliteStorage::exec(const char *sql,const char *method)
+{
+	if (sqlite3_exec(db,sql,NULL,NULL,NULL) != SQLITE_OK)
+		throw_error(method,sql);
+}
+//=============================================================================
+//=============================================================================
+const char *SqliteStorage::get_sql(SqliteStmtId id)
+{
+	return stmt_sql[id];
+}
+//=============================================================================
+//	Report the last SQLite error of the connection
+//=============================================================================
+void SqliteStorage::throw_error(const char *method,const char *sql)
+{
+	TangoSys_OMemStream o;
+	TangoSys_OMemStream o2;
+
+	o << "Failed to query TANGO database (error=" << sqlite3_errmsg(db) << ")";
+	if (sql != NULL)
+		o << "\nThe statement was: " << sql;
+	o << std::ends;
+	o2 << "SqliteStorage::" << method << std::ends;
+
+	Tango::Except::throw_exception((const char *)DB_SQLError,o.str(),o2.str());
+}
+
+//=============================================================================
+//	Get the import information of a device, searched by name, then by alias
+//=============================================================================
+bool SqliteStorage::import_device(const std::string &device,DbDeviceInfo &info)
+{
+	omni_mutex_lock oml(*this);
+
+	SqliteStmt stmt(this,SQ_IMPORT_DEVICE_BY_NAME,"import_device()");
+	stmt.bind(device);
+	stmt.execute();
+
+	SqliteStmt by_alias(this,SQ_IMPORT_DEVICE_BY_ALIAS,"import_device()");
+	SqliteStmt *found = &stmt;
+	if (stmt.fetch() == false)
+	{
+		by_alias.bind(device);
+		by_alias.execute();
+		if (by_alias.fetch() == false)
+			return false;
+		found = &by_alias;
+	}
+
+	const char *col;
+	info.exported = found->is_null(0) == true ? -1 : (long)found->get_long(0);
+	info.ior = (col = found->get_string(1)) != NULL ? col : "";
+	info.version = (col = found->get_string(2)) != NULL ? col : "";
+	info.pid = found->is_null(3) == true ? -1 : (long)found->get_long(3);
+	info.server = (col = found->get_string(4)) != NULL ? col : "";
+	info.host = (col = found->get_string(5)) != NULL ? col : "";
+	info.class_name = (col = found->get_string(6)) != NULL ? col : "";
+	info.name = (col = found->get_string(7)) != NULL ? col : "";
+	return true;
+}
+//=============================================================================
+//	Update the device export information and the host of its server
+//=============================================================================
+void SqliteStorage::export_device(const std::string &device,const char *ior,const char *host,
+								  const char *pid,const char *version,std::string *previous_host)
+{
+	omni_mutex_lock oml(*this);
+	SqliteTransaction tr(this,"export_device()");
+
+	SqliteStmt get_device(this,SQ_EXPORT_GET_DEVICE,"export_device()");
+	get_device.bind(device);
+	get_device.execute();
+	if (get_device.fetch() == false)
+	{
+		TangoSys_OMemStream o;
+		o << "device " << device << " not defined in the database !";
+		Tango::Except::throw_exception((const char *)DB_DeviceNotDefined,
+						o.str(),
+						(const char *)"DataBase::ExportDevice()");
+	}
+
+	const char *col;
+	std::string server = (col = get_device.get_string(0)) != NULL ? col : "";
+	if (previous_host != NULL)
+		*previous_host = (col = get_device.get_string(1)) != NULL ? col : "";
+	get_device.reset();
+
+	SqliteStmt update_device(this,SQ_EXPORT_UPDATE_DEVICE,"export_device()");
+	update_device.bind(ior);
+	update_device.bind(host);
+	update_device.bind(pid);
+	update_device.bind(version);
+	update_device.bind(device);
+	update_device.execute();
+
+	SqliteStmt update_server(this,SQ_EXPORT_UPDATE_SERVER,"export_device()");
+	update_server.bind(host);
+	update_server.bind(server);
+	update_server.execute();
+
+	tr.commit();
+}
+//=============================================================================
+//=============================================================================
+void SqliteStorage::unexport_device(const std::string &device)
+{
+	omni_mutex_lock oml(*this);
+
+	SqliteStmt stmt(this,SQ_UNEXPORT_DEVICE,"unexport_device()");
+	stmt.bind(device);
+	stmt.execute();
+}
+//=============================================================================
+//	Get the values of the properties matching each name
+//=============================================================================
+void SqliteStorage::get_device_property(const char *device,const std::vector<std::string> &names,std::vector<DbProperty> &props)
+{
+	omni_mutex_lock oml(*this);
+
+	props.clear();
+	props.resize(names.size());
+
+	SqliteStmt stmt(this,SQ_GET_DEVICE_PROPERTY,"get_device_property()");
+	for (size_t i = 0;i < names.size();i++)
+	{
+		props[i].name = names[i];
+		stmt.bind(device);
+		stmt.bind(replace_wildcard(names[i].c_str()));
+		stmt.execute();
+
+		while (stmt.fetch() == true)
+		{
+			const char *val = stmt.get_string(1);
+			props[i].values.push_back(val != NULL ? val : "");
+		}
+	}
+}
+//=============================================================================
+//	Replace the values of each property and keep them in the history
+//=============================================================================
+void SqliteStorage::put_device_property(const char *device,const std::vector<DbProperty> &props)
+{
+	omni_mutex_lock oml(*this);
+	SqliteTransaction tr(this,"put_device_property()");
+
+	SqliteStmt del_prop(this,SQ_DELETE_DEVICE_PROPERTY,"put_device_property()");
+	SqliteStmt ins_prop(this,SQ_INSERT_DEVICE_PROPERTY,"put_device_property()");
+	SqliteStmt ins_hist(this,SQ_INSERT_DEVICE_PROPERTY_HIST,"put_device_property()");
+
+	for (size_t i = 0;i < props.size();i++)
+	{
+		const std::string &name = props[i].name;
+
+		del_prop.bind(device);
+		del_prop.bind(name);
+		del_prop.execute();
+
+		Tango::DevULong64 hist_id = get_hist_id();
+		for (size_t j = 0;j < props[i].values.size();j++)
+		{
+			std::string value = stored_value(props[i].values[j]);
+
+			ins_prop.bind(device);
+			ins_prop.bind(name);
+			ins_prop.bind((long long)(j + 1));
+			ins_prop.bind(value);
+			ins_prop.execute();
+
+			ins_hist.bind(device);
+			ins_hist.bind((long long)hist_id);
+			ins_hist.bind(name);
+			ins_hist.bind((long long)(j + 1));
+			ins_hist.bind(value);
+			ins_hist.execute();
+		}
+		purge_hist(device,name);
+	}
+	tr.commit();
+}
+//=============================================================================
+//	Delete the properties matching each name and mark them as deleted in
+//	the history
+//=============================================================================
+void SqliteStorage::delete_device_property(const char *device,const std::vector<std::string> &names)
+{
+	omni_mutex_lock oml(*this);
+	SqliteTransaction tr(this,"delete_device_property()");
+
+	SqliteStmt get_names(this,SQ_GET_DEVICE_PROPERTY_NAMES,"delete_device_property()");
+	SqliteStmt del_prop(this,SQ_DELETE_DEVICE_PROPERTY,"delete_device_property()");
+	SqliteStmt ins_hist(this,SQ_INSERT_DEVICE_PROPERTY_HIST,"delete_device_property()");
+
+	for (size_t i = 0;i < names.size();i++)
+	{
+		std::vector<std::string> deleted;
+		get_names.bind(device);
+		get_names.bind(replace_wildcard(names[i].c_str()));
+		get_names.execute();
+		while (get_names.fetch() == true)
+			deleted.push_back(get_names.get_string(0));
+		get_names.reset();
+
+		for (size_t j = 0;j < deleted.size();j++)
+		{
+			del_prop.bind(device);
+			del_prop.bind(deleted[j]);
+			del_prop.execute();
+
+			ins_hist.bind(device);
+			ins_hist.bind((long long)get_hist_id());
+			ins_hist.bind(deleted[j]);
+			ins_hist.bind(0LL);
+			ins_hist.bind("DELETED");
+			ins_hist.execute();
+
+			purge_hist(device,deleted[j]);
+		}
+	}
+	tr.commit();
+}
+//=============================================================================
+//	Next device property history id (within the caller transaction)
+//=============================================================================
+Tango::DevULong64 SqliteStorage::get_hist_id()
+{
+	SqliteStmt next_id(this,SQ_NEXT_DEVICE_HIST_ID,"get_hist_id()");
+	next_id.execute();
+
+	SqliteStmt get_id(this,SQ_GET_DEVICE_HIST_ID,"get_hist_id()");
+	get_id.execute();
+	if (get_id.fetch() == false)
+		throw_error("get_hist_id()",get_sql(SQ_GET_DEVICE_HIST_ID));
+	return (Tango::DevULong64)get_id.get_long(0);
+}
+//=============================================================================
+//	Keep only the history_depth newest values of a device property (same
+//	as DataBase::purge_history())
+//=============================================================================
+void SqliteStorage::purge_hist(const char *device,const std::string &name)
+{
+	SqliteStmt first_id(this,SQ_PURGE_FIRST_ID,"purge_hist()");
+	first_id.bind(device);
+	first_id.bind(name);
+	first_id.bind((long long)history_depth);
+	first_id.execute();
+	if (first_id.fetch() == false)
+		return;
+	long long id = first_id.get_long(0);
+	first_id.reset();
+
+	SqliteStmt purge(this,SQ_PURGE_DEVICE_PROPERTY_HIST,"purge_hist()");
+	purge.bind(device);
+	purge.bind(name);
+	purge.bind(id);
+	purge.execute();
+}
+//=============================================================================
+//	Classes and devices of a server (in lower case). The access control
+//	device is not managed by the engine
+//=============================================================================
+void SqliteStorage::get_server_dependencies(const std::string &ds_name,ServerCache::ServerEntry &entry)
+{
+	omni_mutex_lock oml(*this);
+
+	SqliteStmt stmt(this,SQ_SERVER_DEVICES,"get_server_dependencies()");
+	stmt.bind(ds_name);
+	stmt.execute();
+	while (stmt.fetch() == true)
+	{
+		entry.devices.insert(lower_string(stmt.get_string(0)));
+		if (stmt.is_null(1) == false)
+			entry.classes.insert(lower_string(stmt.get_string(1)));
+	}
+}
+//=============================================================================
+//	DbGetDataForServerCache data of a server, in the ds_start stored
+//	procedure order (see DsStart::build_head() and build_step()). The
+//	data is read in one transaction, with one indexed query per object.
+//	The host may be followed by "%%<client release>": The pipe properties
+//	are added from release 9
+//=============================================================================
+bool SqliteStorage::get_server_data(const char *ds_name,const char *recev_host,ServerData &data)
+{
+	omni_mutex_lock oml(*this);
+	SqliteTransaction tr(this,"get_server_data()",false);
+
+	std::vector<std::string> &out = data.elts;
+	out.clear();
+
+	std::string host(recev_host);
+	bool ds_pipe = false;
+	std::string::size_type pos = host.find("%%");
+	if (pos != std::string::npos)
+	{
+		ds_pipe = atoi(host.c_str() + pos + 2) >= 9;
+		host.erase(pos);
+	}
+	std::string adm_dev_name("dserver/");
+	adm_dev_name = adm_dev_name + ds_name;
+
+	if (ds_pipe == true)
+		out.push_back(DS_START_RELEASE);
+
+	if (ds_import_device(adm_dev_name,out) == false)
+	{
+		tr.commit();
+		return true;
+	}
+	ds_import_event("notifd/factory/" + host,out);
+	ds_import_event(adm_dev_name,out);
+
+	ds_add_obj_props(SQ_CLASS_PROPS,"DServer",out);
+	ds_add_obj_props(SQ_CLASS_PROPS,"Default",out);
+	ds_add_obj_props(SQ_DEVICE_PROPS,adm_dev_name,out);
+
+//
+// The server classes (except the admin device one) and their devices
+//
+
+	std::vector<std::string> class_list;
+	SqliteStmt classes(this,SQ_SERVER_CLASSES,"get_server_data()");
+	classes.bind(ds_name);
+	classes.execute();
+	while (classes.fetch() == true)
+	{
+		const char *cl = classes.get_string(0);
+		if (cl != NULL && ::strcasecmp(cl,"dserver") != 0)
+			class_list.push_back(cl);
+	}
+
+	std::map<std::string,std::vector<std::string> > class_devices;
+	SqliteStmt devices(this,SQ_SERVER_DEVICES,"get_server_data()");
+	devices.bind(ds_name);
+	devices.execute();
+	while (devices.fetch() == true)
+	{
+		if (devices.is_null(1) == true)
+			continue;
+		const char *dev = devices.get_string(0);
+		std::vector<std::string> &devs = class_devices[lower_string(devices.get_string(1))];
+		if (devs.empty() == true || ::strcasecmp(devs.back().c_str(),dev) != 0)
+			devs.push_back(dev);
+	}
+
+	out.push_back(ds_name);
+	if (class_list.empty() == false)
+	{
+		out.push_back("");
+		set_count(out,out.size() - 1,(long)class_list.size());
+	}
+
+	for (size_t i = 0;i < class_list.size();i++)
+	{
+		const std::string &cl = class_list[i];
+		std::vector<std::string> &devs = class_devices[lower_string(cl)];
+
+		ds_add_obj_props(SQ_CLASS_PROPS,cl,out);
+		ds_add_obj_att_props(SQ_CLASS_ATT_PROPS,cl,out);
+		if (ds_pipe == true)
+			ds_add_obj_att_props(SQ_CLASS_PIPE_PROPS,cl,out);
+
+		out.push_back(cl);
+		if (devs.empty() == false)
+		{
+			out.push_back("");
+			set_count(out,out.size() - 1,(long)devs.size());
+		}
+		out.insert(out.end(),devs.begin(),devs.end());
+
+		for (size_t j = 0;j < devs.size();j++)
+		{
+			ds_add_obj_props(SQ_DEVICE_PROPS,devs[j],out);
+			ds_add_obj_att_props(SQ_DEVICE_ATT_PROPS,devs[j],out);
+			if (ds_pipe == true)
+				ds_add_obj_att_props(SQ_DEVICE_PIPE_PROPS,devs[j],out);
+		}
+	}
+
+//
+// Control system properties and the access control device (defined in
+// the Services property)
+//
+
+	out.push_back("CtrlSystem");
+	SqliteStmt ctrl(this,SQ_CTRL_PROPS,"get_server_data()");
+	ctrl.execute();
+
+	PropWriter writer(out);
+	writer.start();
+	bool serv_defined = false;
+	std::string ca_dev;
+	while (ctrl.fetch() == true)
+	{
+		if (ctrl.is_null(1) == false && ctrl.get_long(1) == 1)
+			serv_defined = ::strcasecmp(ctrl.get_string(0),"Services") == 0;
+		if (serv_defined == true && ctrl.is_null(2) == false)
+			DsStart::get_ca_device(ctrl.get_string(2),ca_dev);
+		writer.add(ctrl,0);
+	}
+	writer.end();
+
+	if (ca_dev.empty() == false)
+		ds_import_device(ca_dev,out);
+
+	tr.commit();
+	return true;
+}
+//=============================================================================
+//	Same data as the import_device stored procedure. Return false if the
+//	device is not defined
+//=============================================================================
+bool SqliteStorage::ds_import_device(const std::string &dev_name,std::vector<std::string> &out)
+{
+	SqliteStmt stmt(this,SQ_IMPORT_DEVICE_BY_NAME,"get_server_data()");
+	stmt.bind(dev_name);
+	stmt.execute();
+
+	out.push_back(dev_name);
+	if (stmt.fetch() == false)
+	{
+		out.push_back("Not Found");
+		return false;
+	}
+
+//
+// Columns: exported,ior,version,pid,server,host,class
+//
+
+	char buf[32];
+	out.push_back(stmt.is_null(1) == true ? "" : stmt.get_string(1));
+	out.push_back(stmt.is_null(2) == true ? "" : stmt.get_string(2));
+	if (stmt.is_null(4) == false)
+		out.push_back(stmt.get_string(4));
+	if (stmt.is_null(5) == false)
+		out.push_back(stmt.get_string(5));
+	if (stmt.is_null(0) == false)
+	{
+		sprintf(buf,"%lld",stmt.get_long(0));
+		out.push_back(buf);
+	}
+	if (stmt.is_null(3) == true)
+		out.push_back("");
+	else
+	{
+		sprintf(buf,"%lld",stmt.get_long(3));
+		out.push_back(buf);
+	}
+	if (stmt.is_null(6) == false)
+		out.push_back(stmt.get_string(6));
+
+	return true;
+}
+//=============================================================================
+//	Same data as the import_event stored procedure: If the name is not
+//	found, retry with the part before the first dot
+//=============================================================================
+void SqliteStorage::ds_import_event(const std::string &ev_name,std::vector<std::string> &out)
+{
+	SqliteStmt stmt(this,SQ_IMPORT_EVENT,"get_server_data()");
+	stmt.bind(ev_name);
+	stmt.execute();
+
+	bool found = stmt.fetch();
+	std::string::size_type dot = ev_name.find('.');
+	if (found == false && dot != std::string::npos)
+	{
+		stmt.bind(ev_name.substr(0,dot));
+		stmt.execute();
+		found = stmt.fetch();
+	}
+
+	out.push_back(ev_name);
+	if (found == false)
+	{
+		out.push_back("Not Found");
+		return;
+	}
+
+//
+// Columns: exported,ior,version,pid,host. NULL ones are skipped
+// (CONCAT_WS)
+//
+
+	char buf[32];
+	if (stmt.is_null(1) == false)
+		out.push_back(stmt.get_string(1));
+	if (stmt.is_null(2) == false)
+		out.push_back(stmt.get_string(2));
+	if (stmt.is_null(4) == false)
+		out.push_back(stmt.get_string(4));
+	if (stmt.is_null(0) == false)
+	{
+		sprintf(buf,"%lld",stmt.get_long(0));
+		out.push_back(buf);
+	}
+	if (stmt.is_null(3) == false)
+	{
+		sprintf(buf,"%lld",stmt.get_long(3));
+		out.push_back(buf);
+	}
+}
+//=============================================================================
+//	Same data as the class_prop and dev_prop stored procedures
+//=============================================================================
+void SqliteStorage::ds_add_obj_props(SqliteStmtId id,const std::string &obj,std::vector<std::string> &out)
+{
+	out.push_back(obj);
+
+	SqliteStmt stmt(this,id,"get_server_data()");
+	stmt.bind(obj);
+	stmt.execute();
+
+	PropWriter writer(out);
+	writer.start();
+	while (stmt.fetch() == true)
+		writer.add(stmt,0);
+	writer.end();
+}
+//=============================================================================
+//	Same data as the class_att_prop, dev_att_prop, class_pipe_prop and
+//	dev_pipe_prop stored procedures: The number of attributes (or pipes)
+//	then for each of them, its name and its properties
+//=============================================================================
+void SqliteStorage::ds_add_obj_att_props(SqliteStmtId id,const std::string &obj,std::vector<std::string> &out)
+{
+	out.push_back(obj);
+	size_t att_nb_pos = out.size();
+	out.push_back("0");
+
+	SqliteStmt stmt(this,id,"get_server_data()");
+	stmt.bind(obj);
+	stmt.execute();
+
+	PropWriter writer(out);
+	std::string att;
+	long att_nb = 0;
+	while (stmt.fetch() == true)
+	{
+		const char *row_att = stmt.get_string(0);
+		if (row_att == NULL)
+			row_att = "";
+		if (att_nb == 0 || ::strcasecmp(att.c_str(),row_att) != 0)
+		{
+			if (att_nb != 0)
+				writer.end();
+			att = row_att;
+			out.push_back(att);
+			writer.start();
+			att_nb++;
+		}
+		writer.add(stmt,1);
+	}
+	if (att_nb != 0)
+		writer.end();
+
+	set_count(out,att_nb_pos,att_nb);
+}
+//=============================================================================
+//	Define the devices of a server (replacing the ones with the same name)
+//	and its admin device
+//=============================================================================
+void SqliteStorage::add_server(const std::string &ds_name,const std::vector<std::string> &devices,
+							   const std::vector<std::string> &classes)
+{
+	if (devices.size() != classes.size())
+	{
+		Tango::Except::throw_exception((const char *)DB_IncorrectArguments,
+						(const char *)"One class needed per device",
+						(const char *)"SqliteStorage::add_server()");
+	}
+
+	omni_mutex_lock oml(*this);
+	SqliteTransaction tr(this,"add_server()");
+
+	SqliteStmt del_device(this,SQ_DELETE_DEVICE,"add_server()");
+	SqliteStmt ins_device(this,SQ_INSERT_DEVICE,"add_server()");
+
+	for (size_t i = 0;i <= devices.size();i++)
+	{
+		std::string dev = i < devices.size() ? devices[i] : "dserver/" + ds_name;
+		const char *cl = i < devices.size() ? classes[i].c_str() : "DServer";
+		char domain[256],family[256],member[256];
+		device_name_to_dfm(dev,domain,family,member);
+
+		del_device.bind(dev);
+		del_device.execute();
+
+		ins_device.bind(dev);
+		ins_device.bind(domain);
+		ins_device.bind(family);
+		ins_device.bind(member);
+		ins_device.bind(ds_name);
+		ins_device.bind(cl);
+		ins_device.execute();
+	}
+	tr.commit();
+}
+
+}	//	namespace
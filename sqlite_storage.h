@@ -0,0 +1,222 @@
+//=============================================================================
+//
+// file :        sqlite_storage.h
+//
+// description : Include for the SQLite storage engine.
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _SQLITE_STORAGE_H
+#define _SQLITE_STORAGE_H
+
+#include <db_storage.h>
+#include <sqlite3.h>
+
+#define	DEFAULT_SQLITE_BUSY_TIMEOUT		5000		// ms
+#define	DEFAULT_SQLITE_HISTORY_DEPTH	10
+
+namespace DataBase_ns {
+
+//
+// The prepared statements. Their SQL text is in sqlite_storage.cpp
+//
+
+enum SqliteStmtId
+{
+	SQ_IMPORT_DEVICE_BY_NAME = 0,
+	SQ_IMPORT_DEVICE_BY_ALIAS,
+	SQ_EXPORT_GET_DEVICE,
+	SQ_EXPORT_UPDATE_DEVICE,
+	SQ_EXPORT_UPDATE_SERVER,
+	SQ_UNEXPORT_DEVICE,
+	SQ_GET_DEVICE_PROPERTY,
+	SQ_GET_DEVICE_PROPERTY_NAMES,
+	SQ_DELETE_DEVICE_PROPERTY,
+	SQ_INSERT_DEVICE_PROPERTY,
+	SQ_INSERT_DEVICE_PROPERTY_HIST,
+	SQ_NEXT_DEVICE_HIST_ID,
+	SQ_GET_DEVICE_HIST_ID,
+	SQ_PURGE_FIRST_ID,
+	SQ_PURGE_DEVICE_PROPERTY_HIST,
+	SQ_IMPORT_EVENT,
+	SQ_SERVER_DEVICES,
+	SQ_SERVER_CLASSES,
+	SQ_DEVICE_PROPS,
+	SQ_CLASS_PROPS,
+	SQ_DEVICE_ATT_PROPS,
+	SQ_CLASS_ATT_PROPS,
+	SQ_DEVICE_PIPE_PROPS,
+	SQ_CLASS_PIPE_PROPS,
+	SQ_CTRL_PROPS,
+	SQ_DELETE_DEVICE,
+	SQ_INSERT_DEVICE,
+	SQ_NB
+};
+
+class SqliteStorage;
+
+//=========================================================
+/**
+ *	Execution of one of the prepared statements (same usage as
+ *	DbStmt). Parameters are bound in the order of the '?'
+ *	markers, the strings are copied. Binding a parameter after
+ *	execute() starts a new execution. The statement is reset by
+ *	the destructor. Must be used with the engine mutex locked
+ */
+//=========================================================
+class SqliteStmt
+{
+public:
+	SqliteStmt(SqliteStorage *,SqliteStmtId,const char *);
+	~SqliteStmt();
+
+	void bind(const char *);
+	void bind(const std::string &str) {bind(str.c_str());}
+	void bind(long long);
+	void execute();
+	bool fetch();
+	void reset();
+
+	bool is_null(int col) {return sqlite3_column_type(stmt,col) == SQLITE_NULL;}
+	const char *get_string(int col) {return (const char *)sqlite3_column_text(stmt,col);}
+	long long get_long(int col) {return sqlite3_column_int64(stmt,col);}
+
+private:
+	SqliteStorage		*storage;
+	SqliteStmtId		id;
+	const char			*method;
+	sqlite3_stmt		*stmt;
+	int					nb_bound;
+	bool				executed;
+	bool				row_pending;
+	bool				done;
+};
+
+//=========================================================
+/**
+ *	Transaction rolled back by the destructor if not committed
+ *	(same usage as AutoTransaction). A write transaction takes
+ *	the database write lock at its beginning, a read one sees
+ *	the database as it is at its first statement
+ */
+//=========================================================
+class SqliteTransaction
+{
+public:
+	SqliteTransaction(SqliteStorage *,const char *,bool write = true);
+	~SqliteTransaction();
+
+	void commit();
+
+private:
+	SqliteStorage		*storage;
+	const char			*method;
+	bool				committed;
+};
+
+//=========================================================
+/**
+ *	SQLite storage engine, for single node and test deployments
+ *	without MySQL server.
+ *
+ *	The database is one file, created with the device, server,
+ *	event and property tables of create_db_tables.sql (same
+ *	columns, names compared without case like with the MySQL
+ *	collation) if it does not exist. It is used in WAL journal
+ *	mode: A commit appends to the log without rewriting the
+ *	database pages, and other processes (sqlite3 shell, backup)
+ *	can read the file while the DB server writes. The log is
+ *	synced at checkpoint time only (synchronous=NORMAL).
+ *	All the statements are prepared when the file is opened and
+ *	the connection is used by one command at a time.
+ *	DbGetDataForServerCache data is built in C++ with the order
+ *	and format of the ds_start stored procedure (see DsStart),
+ *	there is no stored procedure in SQLite.
+ */
+//=========================================================
+class SqliteStorage: public DbStorage, public omni_mutex
+{
+public:
+	SqliteStorage(const std::string &,long history_depth = DEFAULT_SQLITE_HISTORY_DEPTH);
+	~SqliteStorage();
+
+	void open();
+
+	const char *get_name() {return "sqlite";}
+	const std::string &get_journal_mode() {return journal_mode;}
+
+	bool import_device(const std::string &,DbDeviceInfo &);
+	void export_device(const std::string &,const char *,const char *,const char *,const char *,std::string *);
+	void unexport_device(const std::string &);
+
+	void get_device_property(const char *,const std::vector<std::string> &,std::vector<DbProperty> &);
+	void put_device_property(const char *,const std::vector<DbProperty> &);
+	void delete_device_property(const char *,const std::vector<std::string> &);
+
+	void get_server_dependencies(const std::string &,ServerCache::ServerEntry &);
+	bool get_server_data(const char *,const char *,ServerData &);
+
+/**
+ *	Define a server with its devices and their classes (same as
+ *	the DbAddServer command, the admin device is added)
+ */
+	void add_server(const std::string &,const std::vector<std::string> &,const std::vector<std::string> &);
+
+/**
+ *	Methods used by SqliteStmt and SqliteTransaction
+ */
+	sqlite3_stmt *get_stmt(SqliteStmtId id) {return stmts[id];}
+	void exec(const char *,const char *);
+	void rollback() {sqlite3_exec(db,"ROLLBACK",NULL,NULL,NULL);}
+	void throw_error(const char *,const char *);
+
+	static const char *get_sql(SqliteStmtId);
+
+private:
+	void create_tables();
+	Tango::DevULong64 get_hist_id();
+	void purge_hist(const char *,const std::string &);
+
+	bool ds_import_device(const std::string &,std::vector<std::string> &);
+	void ds_import_event(const std::string &,std::vector<std::string> &);
+	void ds_add_obj_props(SqliteStmtId,const std::string &,std::vector<std::string> &);
+	void ds_add_obj_att_props(SqliteStmtId,const std::string &,std::vector<std::string> &);
+
+	std::string			file;
+	std::string			journal_mode;
+	long				history_depth;
+	sqlite3				*db;
+	sqlite3_stmt		*stmts[SQ_NB];
+};
+
+}	//	namespace
+
+#endif	// _SQLITE_STORAGE_H
@@ -0,0 +1,335 @@
+//=============================================================================
+//
+// file :        timing_stats.cpp
+//
+// description : Command timing statistics (Timing_xxx attributes).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+
+
+
+#include <DataBase.h>
+#include <algorithm>
+#include <limits.h>
+#include <math.h>
+
+namespace DataBase_ns
+{
+
+//=============================================================================
+//	Allocate the counters of the commands. The commands of a device do not
+//	change, the counters are only reset when the device is re-initialised
+//	(other commands may run at the same time)
+//=============================================================================
+void TimingStats::init(const std::vector<std::string> &cmd_names)
+{
+	if (nb_cmd != 0)
+	{
+		reset();
+		return;
+	}
+
+	names = cmd_names;
+	for (int i = 0;i < TIMING_NB_SHARD;i++)
+		shards[i] = new Counter[names.size()];
+	nb_cmd = names.size();
+	reset();
+}
+//=============================================================================
+//=============================================================================
+TimingStats::~TimingStats()
+{
+	if (nb_cmd != 0)
+	{
+		for (int i = 0;i < TIMING_NB_SHARD;i++)
+			delete [] shards[i];
+	}
+}
+//=============================================================================
+//	The shard of the calling thread. Threads get the shards in turn
+//=============================================================================
+int TimingStats::shard_index()
+{
+	static std::atomic<unsigned int> next_shard(0);
+	static thread_local int index = -1;
+
+	if (index == -1)
+		index = next_shard.fetch_add(1,std::memory_order_relaxed) % TIMING_NB_SHARD;
+	return index;
+}
+//=============================================================================
+//	Add one command execution (duration in ms)
+//=============================================================================
+void TimingStats::update(int cmd,double elapsed)
+{
+	unsigned long long ns = elapsed > 0.0 ? (unsigned long long)(elapsed * 1.0e6) : 0;
+	Counter &c = shards[shard_index()][cmd];
+
+	c.calls.fetch_add(1,std::memory_order_relaxed);
+	c.total.fetch_add(ns,std::memory_order_relaxed);
+
+	unsigned long long cur = c.minimum.load(std::memory_order_relaxed);
+	while (ns < cur && c.minimum.compare_exchange_weak(cur,ns,std::memory_order_relaxed) == false)
+		;
+	cur = c.maximum.load(std::memory_order_relaxed);
+	while (ns > cur && c.maximum.compare_exchange_weak(cur,ns,std::memory_order_relaxed) == false)
+		;
+
+	c.buckets[bucket_index(ns / 1000)].fetch_add(1,std::memory_order_relaxed);
+}
+//=============================================================================
+//	Histogram bucket of a duration (in us). The first TIMING_HISTO_SUB
+//	buckets are 1 us wide, then each power of 2 is split in TIMING_HISTO_SUB
+//	buckets
+//=============================================================================
+int TimingStats::bucket_index(unsigned long long us)
+{
+	if (us < TIMING_HISTO_SUB)
+		return (int)us;
+
+	int msb = 3;
+	while ((us >> (msb + 1)) != 0)
+		msb++;
+	int octave = msb - 3;
+	if (octave >= TIMING_HISTO_OCTAVES)
+		return TIMING_NB_BUCKET - 1;
+
+	return TIMING_HISTO_SUB + octave * TIMING_HISTO_SUB + (int)(us >> octave) - TIMING_HISTO_SUB;
+}
+//=============================================================================
+//	Lower and upper limits of a histogram bucket (in ms)
+//=============================================================================
+void TimingStats::get_bucket_limits(int bucket,double &low,double &high)
+{
+	if (bucket < TIMING_HISTO_SUB)
+	{
+		low = bucket / 1000.0;
+		high = (bucket + 1) / 1000.0;
+		return;
+	}
+
+	int octave = (bucket - TIMING_HISTO_SUB) / TIMING_HISTO_SUB;
+	int sub = (bucket - TIMING_HISTO_SUB) % TIMING_HISTO_SUB;
+	low = (double)((unsigned long long)(TIMING_HISTO_SUB + sub) << octave) / 1000.0;
+	high = (double)((unsigned long long)(TIMING_HISTO_SUB + sub + 1) << octave) / 1000.0;
+}
+//=============================================================================
+//	Histogram of one command (TIMING_NB_BUCKET counts)
+//=============================================================================
+void TimingStats::get_histogram(int cmd,std::vector<unsigned long long> &histo)
+{
+	histo.assign(TIMING_NB_BUCKET,0);
+	for (int i = 0;i < TIMING_NB_SHARD;i++)
+	{
+		Counter &c = shards[i][cmd];
+		for (int j = 0;j < TIMING_NB_BUCKET;j++)
+			histo[j] = histo[j] + c.buckets[j].load(std::memory_order_relaxed);
+	}
+}
+//=============================================================================
+//	Percentile (0 - 100) of a histogram, in ms: The upper limit of the bucket
+//	holding it (0 if the histogram is empty)
+//=============================================================================
+double TimingStats::percentile(const std::vector<unsigned long long> &histo,double pct)
+{
+	unsigned long long nb = 0;
+	for (size_t i = 0;i < histo.size();i++)
+		nb = nb + histo[i];
+	if (nb == 0)
+		return 0.0;
+
+	unsigned long long rank = (unsigned long long)ceil(pct * nb / 100.0);
+	if (rank == 0)
+		rank = 1;
+
+	unsigned long long sum = 0;
+	size_t i;
+	for (i = 0;i < histo.size() - 1;i++)
+	{
+		sum = sum + histo[i];
+		if (sum >= rank)
+			break;
+	}
+
+	double low,high;
+	get_bucket_limits((int)i,low,high);
+	return high;
+}
+//=============================================================================
+//	Percentile of one command, not larger than its maximum duration
+//=============================================================================
+double TimingStats::get_percentile(int cmd,double pct)
+{
+	std::vector<unsigned long long> histo;
+	get_histogram(cmd,histo);
+	double value = percentile(histo,pct);
+
+	double calls,average,minimum,maximum;
+	get(cmd,calls,average,minimum,maximum);
+	if (value > maximum)
+		value = maximum;
+	return value;
+}
+//=============================================================================
+//	Statistics of one command (durations in ms, 0 if never called)
+//=============================================================================
+void TimingStats::get(int cmd,double &calls,double &average,double &minimum,double &maximum)
+{
+	unsigned long long nb = 0;
+	unsigned long long total = 0;
+	unsigned long long mini = ULLONG_MAX;
+	unsigned long long maxi = 0;
+
+	for (int i = 0;i < TIMING_NB_SHARD;i++)
+	{
+		Counter &c = shards[i][cmd];
+		nb = nb + c.calls.load(std::memory_order_relaxed);
+		total = total + c.total.load(std::memory_order_relaxed);
+		unsigned long long v = c.minimum.load(std::memory_order_relaxed);
+		if (v < mini)
+			mini = v;
+		v = c.maximum.load(std::memory_order_relaxed);
+		if (v > maxi)
+			maxi = v;
+	}
+
+	calls = (double)nb;
+	if (nb == 0)
+	{
+		average = minimum = maximum = 0.0;
+		return;
+	}
+	average = (double)total / nb / 1.0e6;
+	minimum = (double)mini / 1.0e6;
+	maximum = (double)maxi / 1.0e6;
+}
+//=============================================================================
+//	A command running during the reset may be partly counted
+//=============================================================================
+void TimingStats::reset()
+{
+	for (int i = 0;i < TIMING_NB_SHARD;i++)
+	{
+		for (int j = 0;j < nb_cmd;j++)
+		{
+			Counter &c = shards[i][j];
+			c.calls.store(0,std::memory_order_relaxed);
+			c.total.store(0,std::memory_order_relaxed);
+			c.minimum.store(ULLONG_MAX,std::memory_order_relaxed);
+			c.maximum.store(0,std::memory_order_relaxed);
+			for (int k = 0;k < TIMING_NB_BUCKET;k++)
+				c.buckets[k].store(0,std::memory_order_relaxed);
+		}
+	}
+}
+//=============================================================================
+//=============================================================================
+TimedCommand::TimedCommand(Tango::Command *timed_cmd,int timing_index):
+	Tango::Command(timed_cmd->get_name().c_str(),timed_cmd->get_in_type(),timed_cmd->get_out_type(),
+				   timed_cmd->get_in_type_desc().c_str(),timed_cmd->get_out_type_desc().c_str(),
+				   timed_cmd->get_disp_level()),
+	cmd(timed_cmd),index(timing_index)
+{
+}
+//=============================================================================
+//	Execute the wrapped command. Failed executions are also counted
+//=============================================================================
+CORBA::Any *TimedCommand::execute(Tango::DeviceImpl *device,const CORBA::Any &in_any)
+{
+	DataBase *the_db = static_cast<DataBase *>(device);
+	TimeVal	before, after;
+	GetTime(before);
+	SqlProfile::start_command();
+
+	CORBA::Any *ret;
+	try
+	{
+		ret = cmd->execute(device,in_any);
+	}
+	catch (...)
+	{
+		GetTime(after);
+		the_db->update_timing_stats(before,after,index);
+		throw;
+	}
+
+	GetTime(after);
+	the_db->update_timing_stats(before,after,index);
+	return ret;
+}
+//=============================================================================
+//=============================================================================
+bool TimedCommand::is_allowed(Tango::DeviceImpl *device,const CORBA::Any &in_any)
+{
+	return cmd->is_allowed(device,in_any);
+}
+//=============================================================================
+//	Replace the commands of the class by timed commands. The Tango commands
+//	(State, Status, Init) are not timed. The timing indexes follow the
+//	alphabetical order of the command names
+//=============================================================================
+void TimedCommand::wrap_commands(std::vector<Tango::Command *> &cmd_list)
+{
+	std::vector<std::string> cmd_names;
+	for (size_t i = 0;i < cmd_list.size();i++)
+	{
+		const std::string &lower = cmd_list[i]->get_lower_name();
+		if (lower != "state" && lower != "status" && lower != "init")
+			cmd_names.push_back(cmd_list[i]->get_name());
+	}
+	std::sort(cmd_names.begin(),cmd_names.end());
+
+	for (size_t i = 0;i < cmd_list.size();i++)
+	{
+		std::vector<std::string>::iterator pos = std::lower_bound(cmd_names.begin(),cmd_names.end(),cmd_list[i]->get_name());
+		if (pos != cmd_names.end() && *pos == cmd_list[i]->get_name())
+			cmd_list[i] = new TimedCommand(cmd_list[i],pos - cmd_names.begin());
+	}
+}
+//=============================================================================
+//	Names of the timed commands, in timing index order
+//=============================================================================
+void TimedCommand::get_names(std::vector<Tango::Command *> &cmd_list,std::vector<std::string> &cmd_names)
+{
+	cmd_names.clear();
+	for (size_t i = 0;i < cmd_list.size();i++)
+	{
+		TimedCommand *timed = dynamic_cast<TimedCommand *>(cmd_list[i]);
+		if (timed == NULL)
+			continue;
+		if ((size_t)timed->get_timing_index() >= cmd_names.size())
+			cmd_names.resize(timed->get_timing_index() + 1);
+		cmd_names[timed->get_timing_index()] = timed->get_name();
+	}
+}
+
+}	//	namespace
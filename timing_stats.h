@@ -0,0 +1,149 @@
+//=============================================================================
+//
+// file :        timing_stats.h
+//
+// description : Include for the command timing statistics (Timing_xxx
+//               attributes).
+//
+// project :     TANGO Database server.
+//
+// $Author$
+//
+// Copyright (C) :      2004,2005,2006,2007,2008,2009,2010,2011,2012,2013
+//						European Synchrotron Radiation Facility
+//                      BP 220, Grenoble 38043
+//                      FRANCE
+//
+// This file is part of Tango.
+//
+// Tango is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Tango is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Tango.  If not, see <http://www.gnu.org/licenses/>.
+//
+// $Revision$
+// $Date$
+//
+// $HeadURL:$
+//
+//=============================================================================
+#ifndef _TIMING_STATS_H
+#define _TIMING_STATS_H
+
+#include <tango.h>
+#include <atomic>
+
+#define	TIMING_NB_SHARD		16
+
+//
+// The Timing_xxx attributes are spectrums of one element per timed command,
+// Timing_info has TIMING_INFO_HEADER more lines
+//
+
+#define	TIMING_INFO_HEADER	4
+
+//
+// Latency histograms: Durations are counted in micro-seconds, in buckets
+// of TIMING_HISTO_SUB sub-buckets per power of 2 (relative precision 12.5 %)
+// from 0 up to 2^(TIMING_HISTO_OCTAVES + 3) us (about 268 s). Longer
+// durations are counted in the last bucket
+//
+
+#define	TIMING_HISTO_SUB		8
+#define	TIMING_HISTO_OCTAVES	25
+#define	TIMING_NB_BUCKET		(TIMING_HISTO_SUB * (TIMING_HISTO_OCTAVES + 1))
+
+namespace DataBase_ns {
+
+//=========================================================
+/**
+ *	Timing statistics of the commands, each one known by its index
+ *	(Timing_index attribute order).
+ *
+ *	The counters are updated without lock: Each thread adds its command
+ *	durations to the atomic counters of one shard (chosen once per
+ *	thread, TIMING_NB_SHARD shards). The shards are summed only when the
+ *	statistics are read. Durations are counted in nanoseconds and in a
+ *	log-bucketed histogram from which the percentiles are computed.
+ */
+//=========================================================
+class TimingStats
+{
+public:
+	TimingStats():nb_cmd(0) {}
+	~TimingStats();
+
+	void init(const std::vector<std::string> &);
+	int get_nb_cmd() {return nb_cmd;}
+	const std::string &get_name(int cmd) {return names[cmd];}
+
+	void update(int,double);
+	void get(int,double &,double &,double &,double &);
+	void get_histogram(int,std::vector<unsigned long long> &);
+	double get_percentile(int,double);
+	void reset();
+
+	static void get_bucket_limits(int,double &,double &);
+	static double percentile(const std::vector<unsigned long long> &,double);
+
+private:
+	typedef struct
+	{
+		std::atomic<unsigned long long>	calls;
+		std::atomic<unsigned long long>	total;
+		std::atomic<unsigned long long>	minimum;
+		std::atomic<unsigned long long>	maximum;
+		std::atomic<unsigned long long>	buckets[TIMING_NB_BUCKET];
+	} Counter;
+
+	static int shard_index();
+	static int bucket_index(unsigned long long);
+
+	int							nb_cmd;
+	std::vector<std::string>	names;
+
+//
+// Shards are allocated separately, they do not share cache lines
+//
+
+	Counter						*shards[TIMING_NB_SHARD];
+};
+
+//=========================================================
+/**
+ *	Wrapper of a command of the DataBase class, adding the duration of
+ *	each execution to the timing statistics of the device. The commands
+ *	are wrapped once by the class command factory, their timing index
+ *	being resolved at that time.
+ */
+//=========================================================
+class TimedCommand: public Tango::Command
+{
+public:
+	TimedCommand(Tango::Command *,int);
+	~TimedCommand() {delete cmd;}
+
+	virtual CORBA::Any *execute(Tango::DeviceImpl *,const CORBA::Any &);
+	virtual bool is_allowed(Tango::DeviceImpl *,const CORBA::Any &);
+
+	int get_timing_index() {return index;}
+
+	static void wrap_commands(std::vector<Tango::Command *> &);
+	static void get_names(std::vector<Tango::Command *> &,std::vector<std::string> &);
+
+private:
+	Tango::Command		*cmd;
+	int					index;
+};
+
+}	//	namespace
+
+#endif	// _TIMING_STATS_H
@@ -43,7 +43,7 @@ namespace DataBase_ns
 {
 //=============================================================================
 //=============================================================================
-UpdStarterData::UpdStarterData(std::string domain)
+UpdStarterData::UpdStarterData(std::string domain):nb_pending(0)
 {
     starter_header = domain;
 	starter_header += STARTER_DEVNAME_FAMILY;
@@ -76,10 +76,26 @@ void UpdStarterData::send_starter_cmd(std::vector<std::string> hostnames)
 		devname += hostnames[i];
 		starter_devnames.push_back(devname);
 	}
+	nb_pending = starter_devnames.size();
 
 	//	Awake thread
 	signal();
 }
+//=============================================================================
+//=============================================================================
+long UpdStarterData::get_nb_pending()
+{
+	omni_mutex_lock sync(*this);
+	return nb_pending;
+}
+//=============================================================================
+//=============================================================================
+void UpdStarterData::notified()
+{
+	omni_mutex_lock sync(*this);
+	if (nb_pending > 0)
+		nb_pending--;
+}
 
 
 //=============================================================================
@@ -124,6 +140,7 @@ void *UpdateStarter::run_undetached(TANGO_UNUSED(void *ptr))
 				}
 				delete dev;
 			}
+			shared->notified();
 		}
 		//	Wait until next command.
 		{
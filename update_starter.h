@@ -56,6 +56,7 @@ class UpdStarterData: public Tango::TangoMonitor
 private:
 	std::vector<std::string>	starter_devnames;
     std::string starter_header;
+	long						nb_pending;
 public:
 	UpdStarterData(std::string starter_domain);
 /**
@@ -67,6 +68,11 @@ std::string get_starter_header();
  *	Set the host name to send cmd
  */
 void send_starter_cmd(std::vector<std::string> hostnames);
+/**
+ *	Number of starters still to be notified
+ */
+long get_nb_pending();
+void notified();
 };
 //=========================================================
 /**